@@ -6,10 +6,15 @@ layout (location = 0) out vec4 out_colour;
 layout (set = 1, binding = 0) uniform local_uniform_object
 {
     vec4 diffuse_colour;
+    // Where the diffuse map is in its atlas: scale in xy, offset in zw. Identity for a texture of its own.
+    vec4 diffuse_uv_transform;
+    // The array layer of the diffuse map, in x. For a map in an atlas, its repeat modes in y and z, and
+    // 1 in w.
+    vec4 diffuse_layer;
 } object_ubo;
 
 // Samplers
-layout (set = 1, binding = 1) uniform sampler2D diffuse_sampler;
+layout (set = 1, binding = 1) uniform sampler2DArray diffuse_sampler;
 
 // Data transfer object
 layout (location = 1) in struct dto
@@ -17,7 +22,46 @@ layout (location = 1) in struct dto
     vec2 tex_coord;
 } in_dto;
 
+// Wraps a coordinate into an atlas entry size texels across. Must match texture_atlas_wrap.
+float wrap(float coordinate, float size, float repeat, float level)
+{
+    // Repeat. The entry's padding repeats it, so filtering across the wrap is already right.
+    if (repeat < 0.5)
+    {
+        return fract(coordinate);
+    }
+
+    // Mirrored repeat, where every other repeat is flipped.
+    if (repeat < 1.5)
+    {
+        float period = mod(coordinate, 2.0);
+        coordinate = period > 1.0 ? 2.0 - period : period;
+    }
+
+    // Half a texel of the coarsest level sampled in from the edges, so filtering doesn't reach into the
+    // padding at any level.
+    float edge = min(0.5 * exp2(level) / size, 0.5);
+    return clamp(coordinate, edge, 1.0 - edge);
+}
+
 void main() 
 {
-    out_colour = object_ubo.diffuse_colour * texture(diffuse_sampler, in_dto.tex_coord);
+    // A texture of its own is wrapped by its sampler.
+    if (object_ubo.diffuse_layer.w < 0.5)
+    {
+        out_colour = object_ubo.diffuse_colour * texture(diffuse_sampler, vec3(in_dto.tex_coord, object_ubo.diffuse_layer.x));
+        return;
+    }
+
+    // Wrap within the diffuse map's part of the atlas. Gradients come from the unwrapped coordinates,
+    // so the wrap doesn't drop to the smallest mip level along the seam.
+    vec2 scale = object_ubo.diffuse_uv_transform.xy;
+    vec2 size = scale * vec2(textureSize(diffuse_sampler, 0).xy);
+    // Trilinear filtering also reads the next coarser level than the one queried, which the query already
+    // clamps to the atlas's last level.
+    float level = ceil(textureQueryLod(diffuse_sampler, in_dto.tex_coord * scale).x);
+    vec2 uv = vec2(wrap(in_dto.tex_coord.x, size.x, object_ubo.diffuse_layer.y, level), wrap(in_dto.tex_coord.y, size.y, object_ubo.diffuse_layer.z, level));
+    uv = uv * scale + object_ubo.diffuse_uv_transform.zw;
+    vec4 diffuse = textureGrad(diffuse_sampler, vec3(uv, object_ubo.diffuse_layer.x), dFdx(in_dto.tex_coord) * scale, dFdy(in_dto.tex_coord) * scale);
+    out_colour = object_ubo.diffuse_colour * diffuse;
 } 
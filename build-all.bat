@@ -24,4 +24,8 @@ REM Tests
 make -f "Makefile.tests.windows.mak" all
 IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
 
+REM Tools
+make -f "Makefile.tools.windows.mak" all
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
 ECHO "All assemblies built successfully.h" 
\ No newline at end of file
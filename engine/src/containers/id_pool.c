@@ -0,0 +1,53 @@
+#include "id_pool.h"
+
+#include "core/logger.h"
+#include "core/mmemory.h"
+
+void id_pool_create(u32 capacity, void *memory, id_pool *out_pool)
+{
+    if (!memory || !out_pool)
+    {
+        MERROR("id_pool_create failed! Pointer to memory and out_pool are required.");
+        return;
+    }
+    
+    out_pool->capacity = capacity;
+    out_pool->free_count = capacity;
+    out_pool->free_ids = memory;
+    
+    // Ids come off the top of the stack, so push them in descending order.
+    for (u32 i = 0; i < capacity; ++i)
+    {
+        out_pool->free_ids[i] = capacity - 1 - i;
+    }
+}
+
+void id_pool_destroy(id_pool *pool)
+{
+    if (pool)
+    {
+        mzero_memory(pool, sizeof(id_pool));
+    }
+}
+
+b8 id_pool_acquire(id_pool *pool, u32 *out_id)
+{
+    if (pool->free_count == 0)
+    {
+        return false;
+    }
+    
+    *out_id = pool->free_ids[--pool->free_count];
+    return true;
+}
+
+void id_pool_release(id_pool *pool, u32 id)
+{
+    if (id >= pool->capacity || pool->free_count == pool->capacity)
+    {
+        MERROR("id_pool_release - id %u was not acquired from this pool.", id);
+        return;
+    }
+    
+    pool->free_ids[pool->free_count++] = id;
+}
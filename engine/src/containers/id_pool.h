@@ -0,0 +1,49 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief Hands out ids from 0 to capacity - 1 in constant time, by keeping the free ones on a
+ * stack. Released ids are reused first. Members of this structure should not be modified outside
+ * of the functions associated with it.
+ */
+typedef struct id_pool
+{
+    u32 capacity;
+    u32 free_count;
+    u32 *free_ids;
+} id_pool;
+
+/**
+ * @brief Creates an id pool with every id free, and stores it in out_pool. Ids are first handed out
+ * in ascending order.
+ * 
+ * @param capacity The number of ids. Cannot be resized.
+ * @param memory A block of memory to be used. Should be sizeof(u32) * capacity.
+ * @param out_pool A pointer to an id pool to hold the relevant data.
+ */
+MAPI void id_pool_create(u32 capacity, void *memory, id_pool *out_pool);
+
+/**
+ * @brief Destroys the provided id pool. Does not free the memory it was given.
+ * 
+ * @param pool A pointer to the pool to be destroyed.
+ */
+MAPI void id_pool_destroy(id_pool *pool);
+
+/**
+ * @brief Takes a free id.
+ * 
+ * @param pool A pointer to the pool.
+ * @param out_id A pointer to hold the id.
+ * @return True; or false if every id is in use.
+ */
+MAPI b8 id_pool_acquire(id_pool *pool, u32 *out_id);
+
+/**
+ * @brief Returns an id to the pool. Releasing an id which is already free is an error.
+ * 
+ * @param pool A pointer to the pool.
+ * @param id The id to release.
+ */
+MAPI void id_pool_release(id_pool *pool, u32 id);
@@ -4,10 +4,17 @@
 #include "logger.h"
 
 #include "platform/platform.h"
+#include "platform/async_io.h"
+#include "platform/vfs.h"
+#include "platform/file_watcher.h"
 #include "core/mmemory.h"
 #include "core/event.h"
 #include "core/input.h"
 #include "core/clock.h"
+#include "core/frame_pacer.h"
+#include "core/fixed_timestep.h"
+#include "core/mstring.h"
+#include "core/job_system.h"
 
 #include "memory/linear_allocator.h"
 
@@ -26,6 +33,8 @@ typedef struct application_state
     i16 height;
     clock clock;
     f64 last_time;
+    frame_pacer frame_pacer;
+    fixed_timestep timestep;
     linear_allocator systems_allocator;
     
     u64 event_system_memory_requirement;
@@ -43,6 +52,15 @@ typedef struct application_state
     u64 platform_system_memory_requirement;
     void *platform_system_state;
     
+    u64 job_system_memory_requirement;
+    void *job_system_state;
+    
+    u64 vfs_system_memory_requirement;
+    void *vfs_system_state;
+    
+    u64 async_io_system_memory_requirement;
+    void *async_io_system_state;
+    
     u64 renderer_system_memory_requirement;
     void *renderer_system_state;
     
@@ -51,6 +69,9 @@ typedef struct application_state
     
     u64 material_system_memory_requirement;
     void *material_system_state;
+    
+    u64 file_watcher_system_memory_requirement;
+    void *file_watcher_system_state;
 } application_state;
 
 static application_state *app_state;
@@ -60,6 +81,8 @@ b8 application_on_event(u16 code, void *sender, void *listener_inst, event_conte
 b8 application_on_key(u16 code, void *sender, void *listener_inst, event_context context);
 b8 application_on_resized(u16 code, void *sender, void *listener_inst, event_context context);
 
+void application_on_asset_changed(const char *path, void *user_data);
+
 b8 application_create(game *game_inst)
 {
     if (game_inst->application_state)
@@ -118,10 +141,46 @@ b8 application_create(game *game_inst)
         return false;
     }
     
+    // Job system. One worker per processor, less one for the main thread.
+    job_system_config job_sys_config;
+    job_sys_config.worker_count = 0;
+    job_sys_config.fiber_count = 128;
+    job_sys_config.fiber_stack_size = 0;
+    job_system_initialise(&app_state->job_system_memory_requirement, 0, job_sys_config);
+    app_state->job_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->job_system_memory_requirement);
+    if (!job_system_initialise(&app_state->job_system_memory_requirement, app_state->job_system_state, job_sys_config))
+    {
+        MFATAL("Failed to initialise job system. Aborting application.");
+        return false;
+    }
+    
+    // Virtual filesystem. Resolves asset names through the pack archive, if there is one.
+    vfs_config vfs_sys_config;
+    vfs_sys_config.archive_path = "assets.mpk";
+    vfs_sys_config.root_path = "assets";
+    vfs_initialise(&app_state->vfs_system_memory_requirement, 0, vfs_sys_config);
+    app_state->vfs_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->vfs_system_memory_requirement);
+    if (!vfs_initialise(&app_state->vfs_system_memory_requirement, app_state->vfs_system_state, vfs_sys_config))
+    {
+        MFATAL("Failed to initialise virtual filesystem. Aborting application.");
+        return false;
+    }
+    
+    // Async I/O.
+    async_io_config async_io_sys_config;
+    async_io_sys_config.worker_count = 0;
+    async_io_initialise(&app_state->async_io_system_memory_requirement, 0, async_io_sys_config);
+    app_state->async_io_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->async_io_system_memory_requirement);
+    if (!async_io_initialise(&app_state->async_io_system_memory_requirement, app_state->async_io_system_state, async_io_sys_config))
+    {
+        MFATAL("Failed to initialise async I/O system. Aborting application.");
+        return false;
+    }
+    
     // Renderer startup
-    renderer_system_initialise(&app_state->renderer_system_memory_requirement, 0, 0);
+    renderer_system_initialise(&app_state->renderer_system_memory_requirement, 0, 0, RENDERER_BACKEND_TYPE_VULKAN);
     app_state->renderer_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->renderer_system_memory_requirement);
-    if (!renderer_system_initialise(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, game_inst->app_config.name))
+    if (!renderer_system_initialise(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, game_inst->app_config.name, RENDERER_BACKEND_TYPE_VULKAN))
     {
         MFATAL("Failed to initialise renderer. Aborting application.");
         return false;
@@ -130,6 +189,10 @@ b8 application_create(game *game_inst)
     // Texture system.
     texture_system_config texture_sys_config;
     texture_sys_config.max_texture_count = 65536;
+    texture_sys_config.streaming_budget = 512 * 1024 * 1024;
+    texture_sys_config.cache_path = "cache/textures";
+    texture_sys_config.atlas_size = 1024;
+    texture_sys_config.atlas_layer_count = 4;
     texture_system_initialise(&app_state->texture_system_memory_requirement, 0, texture_sys_config);
     app_state->texture_system_state = linear_allocator_allocate(&app_state->systems_allocator, 
                                                                 app_state->texture_system_memory_requirement);
@@ -157,6 +220,23 @@ b8 application_create(game *game_inst)
         return false;
     }
     
+    // File watcher, so edited assets are reloaded while running.
+    file_watcher_config file_watcher_sys_config;
+    file_watcher_sys_config.root_path = "assets";
+    file_watcher_sys_config.debounce_seconds = 0.25;
+    file_watcher_sys_config.on_change = application_on_asset_changed;
+    file_watcher_sys_config.user_data = 0;
+    file_watcher_initialise(&app_state->file_watcher_system_memory_requirement, 0, file_watcher_sys_config);
+    app_state->file_watcher_system_state = linear_allocator_allocate(&app_state->systems_allocator, 
+                                                                     app_state->file_watcher_system_memory_requirement);
+    if (!file_watcher_initialise(&app_state->file_watcher_system_memory_requirement, 
+                                 app_state->file_watcher_system_state, 
+                                 file_watcher_sys_config))
+    {
+        MFATAL("Failed to initialise file watcher. Aborting application.");
+        return false;
+    }
+    
     // Initialise the game.
     if (!app_state->game_inst->initialise(app_state->game_inst))
     {
@@ -176,10 +256,11 @@ b8 application_run()
     clock_update(&app_state->clock);
     app_state->last_time = app_state->clock.elapsed;
     f64 running_time = 0;
-    f64 frame_count = 0;
-    f64 target_frame_seconds = 1.0f / 60;
+    u64 frame_count = 0;
+    frame_pacer_create(app_state->game_inst->app_config.target_frame_rate, &app_state->frame_pacer);
+    fixed_timestep_create(app_state->game_inst->app_config.update_rate, &app_state->timestep);
     
-    MINFO(get_memory_use_str());
+    MINFO("%s", get_memory_use_str());
     
     while (app_state->is_running)
     {
@@ -194,17 +275,49 @@ b8 application_run()
             clock_update(&app_state->clock);
             f64 current_time = app_state->clock.elapsed;
             f64 delta = (current_time - app_state->last_time);
+            
+            // Input recordings are made and replayed with a fixed timestep, so replays are deterministic.
+            f64 playback_timestep = input_playback_timestep();
+            if (playback_timestep > 0)
+            {
+                delta = playback_timestep;
+            }
             f64 frame_start_time = platform_get_absolute_time();
             
-            if (!app_state->game_inst->update(app_state->game_inst, (f32)delta))
+            // Queue reloads of any assets that have settled since they were changed.
+            file_watcher_update(frame_start_time);
+            
+            // Submit reads queued last frame and run the callbacks of any that have finished.
+            async_io_update();
+            
+            // Run jobs which have to be on the main thread.
+            job_system_update();
+            
+            // Run however many updates fit in the time that has passed.
+            f64 step = 0;
+            u32 step_count = fixed_timestep_advance(&app_state->timestep, delta, &step);
+            for (u32 i = 0; i < step_count; ++i)
+            {
+                if (!app_state->game_inst->update(app_state->game_inst, (f32)step))
+                {
+                    MFATAL("Game update failed, shutting down.");
+                    app_state->is_running = false;
+                    break;
+                }
+                
+                // NOTE: Input update/state copying should always be handled after any input should be recorded;
+                // I.E before this line. It happens per update rather than per frame, so a key press is seen
+                // by exactly one update, even in frames which run none or several.
+                input_update(step);
+            }
+            if (!app_state->is_running)
             {
-                MFATAL("Game update failed, shutting down.");
-                app_state->is_running = false;
                 break;
             }
             
             // Call the game's render routine.
-            if (!app_state->game_inst->render(app_state->game_inst, (f32)delta))
+            f32 alpha = fixed_timestep_alpha(&app_state->timestep);
+            if (!app_state->game_inst->render(app_state->game_inst, (f32)delta, alpha))
             {
                 MFATAL("Game render failed, shutting down.");
                 app_state->is_running = false;
@@ -212,33 +325,21 @@ b8 application_run()
             }
             
             // TODO(satvik): refactor packet creation.
+            // Upload the texture atlas, and stream texture mip levels based on what was last drawn.
+            texture_system_update();
+            
             render_packet packet;
             packet.delta_time = delta;
             renderer_draw_frame(&packet);
             
             // Figure out how long the frame took
             f64 frame_end_time = platform_get_absolute_time();
-            f64 frame_elapsed_time = frame_end_time = frame_start_time;
+            f64 frame_elapsed_time = frame_end_time - frame_start_time;
             running_time += frame_elapsed_time;
-            f64 remaining_seconds = target_frame_seconds - frame_elapsed_time;
-            
-            if (remaining_seconds > 0)
-            {
-                u64 remaining_ms = (remaining_seconds * 1000);
-                
-                // If there is time left, give it back to the OS.
-                b8 limit_frames = false;
-                if (remaining_ms > 0 && limit_frames)
-                {
-                    platform_sleep(remaining_ms - 1);
-                }
-                
-                frame_count++;
-            }
+            frame_count++;
             
-            // NOTE: Input update/state copying should always be handled after any input should be recorded;
-            // I.E before this line.
-            input_update(delta);
+            // Wait out the rest of the frame, if frames are limited.
+            frame_pacer_end_frame(&app_state->frame_pacer);
             
             // Update last time
             app_state->last_time = current_time;
@@ -247,6 +348,18 @@ b8 application_run()
     
     app_state->is_running = false;
     
+    if (frame_count > 0)
+    {
+        frame_pacer_stats *stats = &app_state->frame_pacer.stats;
+        MINFO("Ran %llu frames, averaging %.3fms of work. Pacing: %llu missed, ended on average %.3fms and at worst %.3fms late.",
+              frame_count, running_time * 1000.0 / frame_count, stats->missed_count,
+              frame_pacer_average_error(&app_state->frame_pacer) * 1000.0, stats->max_error * 1000.0);
+        if (app_state->timestep.dropped_step_count > 0)
+        {
+            MWARN("Fell behind and dropped %llu updates.", app_state->timestep.dropped_step_count);
+        }
+    }
+    
     // Shutdown event system.
     event_unregister(EVENT_CODE_APPLICATION_QUIT, 0, application_on_event);
     event_unregister(EVENT_CODE_KEY_PRESSED, 0, application_on_key);
@@ -255,12 +368,20 @@ b8 application_run()
     
     input_system_shutdown(app_state->input_system_state);
     
+    file_watcher_shutdown(app_state->file_watcher_system_state);
+    
     material_system_shutdown(app_state->material_system_state);
     
     texture_system_shutdown(app_state->texture_system_state);
     
     renderer_system_shutdown(app_state->renderer_system_state);
     
+    async_io_shutdown(app_state->async_io_system_state);
+    
+    vfs_shutdown(app_state->vfs_system_state);
+    
+    job_system_shutdown(app_state->job_system_state);
+    
     platform_system_shutdown(&app_state->platform_system_state);
     
     memory_system_shutdown(app_state->memory_system_state);
@@ -272,6 +393,13 @@ b8 application_run()
 
 void application_get_framebuffer_size(u32 *width, u32 *height)
 {
+    // The renderer can run without an application, i.e. in tools.
+    if (!app_state)
+    {
+        *width = 0;
+        *height = 0;
+        return;
+    }
     *width = app_state->width;
     *height = app_state->height;
 }
@@ -325,12 +453,52 @@ b8 application_on_key(u16 code, void *sender, void *listener_inst, event_context
         }
         else
         {
-            MDEBUG("'%c' key released in window.", key_code)
+            MDEBUG("'%c' key released in window.", key_code);
         }
     }
     return false;
 }
 
+// Extracts the asset name from a path like "<directory>/<name>.<extension>". False if the path doesn't match.
+static b8 asset_name_from_path(const char *path, const char *directory, const char *extension, char *out_name, u64 name_size)
+{
+    u64 path_length = string_length(path);
+    u64 directory_length = string_length(directory);
+    u64 extension_length = string_length(extension);
+    if (path_length <= directory_length + 1 + extension_length + 1 || path[directory_length] != '/' || 
+        path[path_length - extension_length - 1] != '.')
+    {
+        return false;
+    }
+    
+    string_view prefix = {path, directory_length};
+    string_view suffix = {path + path_length - extension_length, extension_length};
+    if (!string_view_equali(prefix, directory) || !string_view_equali(suffix, extension))
+    {
+        return false;
+    }
+    
+    string_view name = {path + directory_length + 1, path_length - directory_length - 1 - extension_length - 1};
+    return string_view_copy(out_name, name, name_size) == name.length;
+}
+
+void application_on_asset_changed(const char *path, void *user_data)
+{
+    char name[TEXTURE_NAME_MAX_LENGTH];
+    if (asset_name_from_path(path, "textures", "png", name, sizeof(name)))
+    {
+        texture_system_reload(name);
+    }
+    else if (asset_name_from_path(path, "materials", "mmt", name, MATERIAL_NAME_MAX_LENGTH))
+    {
+        material_system_reload(name);
+    }
+    else
+    {
+        MDEBUG_CH(LOG_CHANNEL_PLATFORM, "Asset '%s' changed, but nothing reloads it.", path);
+    }
+}
+
 b8 application_on_resized(u16 code, void *sender, void *listener_inst, event_context context)
 {
     if (code == EVENT_CODE_RESIZED)
@@ -21,6 +21,12 @@ typedef struct application_config
     
     // The application name used in windowing, if applicable.
     char *name;
+    
+    // Frames per second to limit to, or 0 for no limit.
+    u32 target_frame_rate;
+    
+    // Game updates per second, independent of the frame rate, or 0 to update once per frame.
+    u32 update_rate;
 } application_config;
 
 MAPI b8 application_create(struct game *game_inst);
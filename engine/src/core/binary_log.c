@@ -0,0 +1,669 @@
+#include "binary_log.h"
+
+#include "core/mmemory.h"
+#include "core/mstring.h"
+#include "containers/darray.h"
+#include "platform/platform.h"
+
+#include <stdio.h>
+
+typedef struct binary_log_header
+{
+    u32 magic;
+    u32 version;
+} binary_log_header;
+
+static u8 *reserve(binary_log_state *state, u64 size)
+{
+    if (state->buffer_used + size > BINARY_LOG_BUFFER_SIZE)
+    {
+        binary_log_flush(state);
+        if (state->buffer_used + size > BINARY_LOG_BUFFER_SIZE)
+        {
+            // Either there is no file to flush to, or the record can never fit.
+            return 0;
+        }
+    }
+    u8 *block = state->buffer + state->buffer_used;
+    state->buffer_used += size;
+    return block;
+}
+
+// Appends a value to a write cursor. Copies byte-wise since records are not aligned.
+#define WRITE_VALUE(cursor, value)                        \
+{                                                     \
+mcopy_memory(cursor, &(value), sizeof(value));    \
+cursor += sizeof(value);                          \
+}
+
+#define READ_VALUE(cursor, end, out_value)                    \
+{                                                         \
+if ((cursor) + sizeof(out_value) > (end))             \
+{                                                     \
+return false;                                     \
+}                                                     \
+mcopy_memory(&(out_value), cursor, sizeof(out_value)); \
+cursor += sizeof(out_value);                          \
+}
+
+static binary_log_arg_type integer_type(char length_modifier, b8 is_double_length)
+{
+    switch (length_modifier)
+    {
+        case 'l':
+        // 'long' is 32 bits on Windows, 'long long' is always 64.
+        return (is_double_length || sizeof(long) == 8) ? BINARY_LOG_ARG_I64 : BINARY_LOG_ARG_I32;
+        case 'z':
+        case 'j':
+        case 't':
+        return BINARY_LOG_ARG_I64;
+        default:
+        // char and short are promoted to int.
+        return BINARY_LOG_ARG_I32;
+    }
+}
+
+b8 binary_log_next_spec(const char *format, u32 offset, binary_log_spec *out_spec)
+{
+    const char *p = format + offset;
+    while (*p && *p != '%')
+    {
+        p++;
+    }
+    if (!*p)
+    {
+        return false;
+    }
+
+    out_spec->start = (u32)(p - format);
+    out_spec->width_is_arg = false;
+    out_spec->precision_is_arg = false;
+    out_spec->precision = -1;
+    out_spec->type = BINARY_LOG_ARG_UNSUPPORTED;
+    p++;
+
+    if (*p == '%')
+    {
+        out_spec->type = BINARY_LOG_ARG_NONE;
+        out_spec->length = 2;
+        return true;
+    }
+
+    // Flags.
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+    {
+        p++;
+    }
+
+    // Width.
+    if (*p == '*')
+    {
+        out_spec->width_is_arg = true;
+        p++;
+    }
+    else
+    {
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+    }
+
+    // Precision.
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            out_spec->precision_is_arg = true;
+            p++;
+        }
+        else
+        {
+            out_spec->precision = 0;
+            while (*p >= '0' && *p <= '9')
+            {
+                out_spec->precision = out_spec->precision * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+
+    // Length modifier.
+    char length_modifier = 0;
+    b8 is_double_length = false;
+    if (*p == 'h' || *p == 'l' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'L')
+    {
+        length_modifier = *p;
+        p++;
+        if ((length_modifier == 'h' || length_modifier == 'l') && *p == length_modifier)
+        {
+            is_double_length = true;
+            p++;
+        }
+    }
+
+    switch (*p)
+    {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        out_spec->type = integer_type(length_modifier, is_double_length);
+        break;
+        case 'c':
+        out_spec->type = length_modifier == 0 ? BINARY_LOG_ARG_I32 : BINARY_LOG_ARG_UNSUPPORTED;
+        break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        // float is promoted to double. long double is not supported.
+        out_spec->type = length_modifier == 'L' ? BINARY_LOG_ARG_UNSUPPORTED : BINARY_LOG_ARG_F64;
+        break;
+        case 's':
+        // Wide strings are not supported.
+        out_spec->type = length_modifier == 0 ? BINARY_LOG_ARG_STRING : BINARY_LOG_ARG_UNSUPPORTED;
+        break;
+        case 'p':
+        out_spec->type = BINARY_LOG_ARG_PTR;
+        break;
+        default:
+        // %n, or a malformed specification.
+        out_spec->type = BINARY_LOG_ARG_UNSUPPORTED;
+        break;
+    }
+
+    if (*p)
+    {
+        p++;
+    }
+    out_spec->length = (u32)(p - format) - out_spec->start;
+    return true;
+}
+
+static void parse_format(const char *format, binary_log_format_entry *entry)
+{
+    entry->deferrable = true;
+    entry->arg_count = 0;
+
+    binary_log_spec spec;
+    u32 offset = 0;
+    while (binary_log_next_spec(format, offset, &spec))
+    {
+        offset = spec.start + spec.length;
+        if (spec.type == BINARY_LOG_ARG_NONE)
+        {
+            continue;
+        }
+
+        u8 needed = 1 + (spec.width_is_arg ? 1 : 0) + (spec.precision_is_arg ? 1 : 0);
+        if (spec.type == BINARY_LOG_ARG_UNSUPPORTED || entry->arg_count + needed > BINARY_LOG_MAX_ARGS)
+        {
+            entry->deferrable = false;
+            return;
+        }
+
+        if (spec.width_is_arg)
+        {
+            entry->arg_precisions[entry->arg_count] = -1;
+            entry->arg_types[entry->arg_count++] = BINARY_LOG_ARG_I32;
+        }
+        if (spec.precision_is_arg)
+        {
+            entry->arg_precisions[entry->arg_count] = -1;
+            entry->arg_types[entry->arg_count++] = BINARY_LOG_ARG_PRECISION;
+        }
+        entry->arg_precisions[entry->arg_count] = (i16)(spec.precision > 0x7FFF ? 0x7FFF : spec.precision);
+        entry->arg_types[entry->arg_count++] = (u8)spec.type;
+    }
+}
+
+static binary_log_format_entry *acquire_format(binary_log_state *state, const char *format)
+{
+    // Format strings are literals, so hash the pointer rather than the contents.
+    u64 hash = ((u64)format >> 3) * 0x9E3779B97F4A7C15ULL;
+    u32 mask = BINARY_LOG_MAX_FORMATS - 1;
+    u32 index = (u32)(hash >> 32) & mask;
+
+    for (u32 probe = 0; probe < BINARY_LOG_MAX_FORMATS; ++probe)
+    {
+        binary_log_format_entry *entry = &state->formats[(index + probe) & mask];
+        if (entry->format == format)
+        {
+            return entry;
+        }
+        if (entry->format == 0)
+        {
+            // First time this format has been seen. Write its definition before any entry using it.
+            u64 length = string_length(format);
+            if (length > 0xFFFF)
+            {
+                return 0;
+            }
+            u16 length16 = (u16)length;
+            u8 type = BINARY_LOG_RECORD_FORMAT;
+            u8 *cursor = reserve(state, sizeof(u8) + sizeof(u32) + sizeof(u16) + length16);
+            if (!cursor)
+            {
+                return 0;
+            }
+
+            entry->format = format;
+            entry->id = state->next_format_id++;
+            parse_format(format, entry);
+
+            WRITE_VALUE(cursor, type);
+            WRITE_VALUE(cursor, entry->id);
+            WRITE_VALUE(cursor, length16);
+            mcopy_memory(cursor, format, length16);
+            return entry;
+        }
+    }
+
+    // Table is full.
+    return 0;
+}
+
+static void write_text(binary_log_state *state, log_channel channel, log_level level, f64 timestamp, const char *format, va_list args)
+{
+    char message[32000];
+    i32 length = string_format_v(message, format, args);
+    if (length < 0)
+    {
+        return;
+    }
+    u16 length16 = length > 0xFFFF ? 0xFFFF : (u16)length;
+
+    u8 type = BINARY_LOG_RECORD_TEXT;
+    u8 channel8 = (u8)channel;
+    u8 level8 = (u8)level;
+    u8 *cursor = reserve(state, sizeof(u8) * 3 + sizeof(f64) + sizeof(u16) + length16);
+    if (!cursor)
+    {
+        return;
+    }
+    WRITE_VALUE(cursor, type);
+    WRITE_VALUE(cursor, channel8);
+    WRITE_VALUE(cursor, level8);
+    WRITE_VALUE(cursor, timestamp);
+    WRITE_VALUE(cursor, length16);
+    mcopy_memory(cursor, message, length16);
+}
+
+void binary_log_begin(binary_log_state *state, file_handle *file)
+{
+    mzero_memory(state->formats, sizeof(state->formats));
+    state->file = file;
+    state->next_format_id = 0;
+    state->buffer_used = 0;
+
+    binary_log_header header;
+    header.magic = BINARY_LOG_MAGIC;
+    header.version = BINARY_LOG_VERSION;
+    u8 *cursor = reserve(state, sizeof(binary_log_header));
+    WRITE_VALUE(cursor, header);
+}
+
+void binary_log_write(binary_log_state *state, log_channel channel, log_level level, const char *format, va_list args)
+{
+    f64 timestamp = platform_get_absolute_time();
+
+    binary_log_format_entry *entry = acquire_format(state, format);
+    if (!entry || !entry->deferrable)
+    {
+        write_text(state, channel, level, timestamp, format, args);
+        return;
+    }
+
+    // Copy the raw arguments into a payload. Strings must be copied, since the pointers
+    // are not guaranteed to outlive this call.
+    u8 payload[BINARY_LOG_MAX_ARGS * (sizeof(u16) + BINARY_LOG_MAX_STRING_LENGTH)];
+    u8 *cursor = payload;
+    i32 pending_precision = -1;
+    for (u8 i = 0; i < entry->arg_count; ++i)
+    {
+        // A '*' precision only applies to the argument straight after it.
+        i32 precision = pending_precision;
+        pending_precision = -1;
+        switch (entry->arg_types[i])
+        {
+            case BINARY_LOG_ARG_I32:
+            {
+                i32 value = va_arg(args, i32);
+                WRITE_VALUE(cursor, value);
+            }
+            break;
+            case BINARY_LOG_ARG_PRECISION:
+            {
+                i32 value = va_arg(args, i32);
+                pending_precision = value;
+                WRITE_VALUE(cursor, value);
+            }
+            break;
+            case BINARY_LOG_ARG_I64:
+            {
+                i64 value = va_arg(args, i64);
+                WRITE_VALUE(cursor, value);
+            }
+            break;
+            case BINARY_LOG_ARG_F64:
+            {
+                f64 value = va_arg(args, f64);
+                WRITE_VALUE(cursor, value);
+            }
+            break;
+            case BINARY_LOG_ARG_PTR:
+            {
+                u64 value = (u64)va_arg(args, void *);
+                WRITE_VALUE(cursor, value);
+            }
+            break;
+            case BINARY_LOG_ARG_STRING:
+            {
+                const char *str = va_arg(args, const char *);
+                if (!str)
+                {
+                    str = "(null)";
+                }
+
+                // Only read as far as the precision allows, as the string may not be terminated.
+                i32 limit = precision >= 0 ? precision : entry->arg_precisions[i];
+                if (limit < 0 || limit > BINARY_LOG_MAX_STRING_LENGTH)
+                {
+                    limit = BINARY_LOG_MAX_STRING_LENGTH;
+                }
+                u16 length = 0;
+                while (length < limit && str[length])
+                {
+                    length++;
+                }
+
+                WRITE_VALUE(cursor, length);
+                mcopy_memory(cursor, str, length);
+                cursor += length;
+            }
+            break;
+        }
+    }
+
+    u16 payload_size = (u16)(cursor - payload);
+    u8 type = BINARY_LOG_RECORD_ENTRY;
+    u8 channel8 = (u8)channel;
+    u8 level8 = (u8)level;
+    u8 *record = reserve(state, sizeof(u8) * 3 + sizeof(u32) + sizeof(f64) + sizeof(u16) + payload_size);
+    if (!record)
+    {
+        return;
+    }
+    WRITE_VALUE(record, type);
+    WRITE_VALUE(record, channel8);
+    WRITE_VALUE(record, level8);
+    WRITE_VALUE(record, entry->id);
+    WRITE_VALUE(record, timestamp);
+    WRITE_VALUE(record, payload_size);
+    mcopy_memory(record, payload, payload_size);
+}
+
+void binary_log_flush(binary_log_state *state)
+{
+    if (!state->file || !state->file->is_valid || state->buffer_used == 0)
+    {
+        return;
+    }
+
+    u64 written = 0;
+    if (!filesystem_write(state->file, state->buffer_used, state->buffer, &written))
+    {
+        platform_console_write_error("ERROR writing to binary log.\n", LOG_LEVEL_ERROR);
+    }
+    state->buffer_used = 0;
+}
+
+/**
+ * Formats a single conversion specification with the arguments read from cursor, appending the
+ * result to out_message. Returns false if the payload is truncated.
+ */
+static b8 format_spec(const char *format, binary_log_spec *spec, const u8 **cursor, const u8 *end, char *out_message, u64 *out_length, u64 max_length)
+{
+    if (spec->type == BINARY_LOG_ARG_NONE)
+    {
+        if (*out_length < max_length - 1)
+        {
+            out_message[(*out_length)++] = '%';
+        }
+        return true;
+    }
+
+    char spec_str[64];
+    u32 spec_length = spec->length < sizeof(spec_str) - 1 ? spec->length : sizeof(spec_str) - 1;
+    mcopy_memory(spec_str, format + spec->start, spec_length);
+    spec_str[spec_length] = 0;
+
+    // Collect star arguments first, in order.
+    i32 stars[2];
+    u32 star_count = 0;
+    if (spec->width_is_arg)
+    {
+        READ_VALUE(*cursor, end, stars[star_count]);
+        star_count++;
+    }
+    if (spec->precision_is_arg)
+    {
+        READ_VALUE(*cursor, end, stars[star_count]);
+        star_count++;
+    }
+
+    char *dest = out_message + *out_length;
+    u64 remaining = max_length - *out_length;
+    i32 written = 0;
+
+    // Calls snprintf with however many star arguments preceed the value.
+#define FORMAT_WITH_STARS(value)                                                    \
+switch (star_count)                                                         \
+{                                                                           \
+case 0: written = snprintf(dest, remaining, spec_str, value); break;                     \
+case 1: written = snprintf(dest, remaining, spec_str, stars[0], value); break;           \
+default: written = snprintf(dest, remaining, spec_str, stars[0], stars[1], value); break; \
+}
+
+    switch (spec->type)
+    {
+        case BINARY_LOG_ARG_I32:
+        {
+            i32 value;
+            READ_VALUE(*cursor, end, value);
+            FORMAT_WITH_STARS(value);
+        }
+        break;
+        case BINARY_LOG_ARG_I64:
+        {
+            i64 value;
+            READ_VALUE(*cursor, end, value);
+            FORMAT_WITH_STARS(value);
+        }
+        break;
+        case BINARY_LOG_ARG_F64:
+        {
+            f64 value;
+            READ_VALUE(*cursor, end, value);
+            FORMAT_WITH_STARS(value);
+        }
+        break;
+        case BINARY_LOG_ARG_PTR:
+        {
+            u64 value;
+            READ_VALUE(*cursor, end, value);
+            FORMAT_WITH_STARS((void *)value);
+        }
+        break;
+        case BINARY_LOG_ARG_STRING:
+        {
+            u16 length;
+            READ_VALUE(*cursor, end, length);
+            // The writer never stores more than BINARY_LOG_MAX_STRING_LENGTH, so anything longer is corrupt.
+            char str[BINARY_LOG_MAX_STRING_LENGTH + 1];
+            if (*cursor + length > end || length >= sizeof(str))
+            {
+                return false;
+            }
+            mcopy_memory(str, *cursor, length);
+            str[length] = 0;
+            *cursor += length;
+            FORMAT_WITH_STARS(str);
+        }
+        break;
+        default:
+        return false;
+    }
+#undef FORMAT_WITH_STARS
+
+    if (written > 0)
+    {
+        *out_length += (u64)written < remaining ? (u64)written : remaining - 1;
+    }
+    return true;
+}
+
+static b8 decode_records(const u8 *cursor, const u8 *end, char ***formats, PFN_binary_log_on_entry on_entry, void *user_data)
+{
+    char message[32000];
+
+    binary_log_header header;
+    READ_VALUE(cursor, end, header);
+    if (header.magic != BINARY_LOG_MAGIC || header.version != BINARY_LOG_VERSION)
+    {
+        return false;
+    }
+
+    while (cursor < end)
+    {
+        u8 type;
+        READ_VALUE(cursor, end, type);
+        switch (type)
+        {
+            case BINARY_LOG_RECORD_FORMAT:
+            {
+                u32 id;
+                u16 length;
+                READ_VALUE(cursor, end, id);
+                READ_VALUE(cursor, end, length);
+                if (cursor + length > end || id != darray_length(*formats))
+                {
+                    return false;
+                }
+                char *format = mallocate(length + 1, MEMORY_TAG_STRING);
+                mcopy_memory(format, cursor, length);
+                format[length] = 0;
+                cursor += length;
+                darray_push(*formats, format);
+            }
+            break;
+            case BINARY_LOG_RECORD_ENTRY:
+            {
+                u8 channel;
+                u8 level;
+                u32 id;
+                f64 timestamp;
+                u16 payload_size;
+                READ_VALUE(cursor, end, channel);
+                READ_VALUE(cursor, end, level);
+                READ_VALUE(cursor, end, id);
+                READ_VALUE(cursor, end, timestamp);
+                READ_VALUE(cursor, end, payload_size);
+                if (cursor + payload_size > end || id >= darray_length(*formats) || level > LOG_LEVEL_TRACE || channel >= LOG_CHANNEL_MAX)
+                {
+                    return false;
+                }
+
+                const char *format = (*formats)[id];
+                const u8 *payload = cursor;
+                const u8 *payload_end = cursor + payload_size;
+                cursor = payload_end;
+
+                u64 length = 0;
+                u32 offset = 0;
+                binary_log_spec spec;
+                while (binary_log_next_spec(format, offset, &spec))
+                {
+                    // Copy the literal text up to the specification.
+                    u32 literal_length = spec.start - offset;
+                    if (length + literal_length >= sizeof(message))
+                    {
+                        literal_length = sizeof(message) - 1 - length;
+                    }
+                    mcopy_memory(message + length, format + offset, literal_length);
+                    length += literal_length;
+
+                    if (!format_spec(format, &spec, &payload, payload_end, message, &length, sizeof(message)))
+                    {
+                        return false;
+                    }
+                    offset = spec.start + spec.length;
+                }
+                u64 tail_length = string_length(format + offset);
+                if (length + tail_length >= sizeof(message))
+                {
+                    tail_length = sizeof(message) - 1 - length;
+                }
+                mcopy_memory(message + length, format + offset, tail_length);
+                length += tail_length;
+                message[length] = 0;
+
+                on_entry((log_channel)channel, (log_level)level, timestamp, message, user_data);
+            }
+            break;
+            case BINARY_LOG_RECORD_TEXT:
+            {
+                u8 channel;
+                u8 level;
+                f64 timestamp;
+                u16 length;
+                READ_VALUE(cursor, end, channel);
+                READ_VALUE(cursor, end, level);
+                READ_VALUE(cursor, end, timestamp);
+                READ_VALUE(cursor, end, length);
+                if (cursor + length > end || length >= sizeof(message) || level > LOG_LEVEL_TRACE || channel >= LOG_CHANNEL_MAX)
+                {
+                    return false;
+                }
+                mcopy_memory(message, cursor, length);
+                message[length] = 0;
+                cursor += length;
+
+                on_entry((log_channel)channel, (log_level)level, timestamp, message, user_data);
+            }
+            break;
+            default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+b8 binary_log_decode(const u8 *data, u64 size, PFN_binary_log_on_entry on_entry, void *user_data)
+{
+    if (!data || !on_entry)
+    {
+        return false;
+    }
+
+    char **formats = darray_create(char *);
+    b8 result = decode_records(data, data + size, &formats, on_entry, user_data);
+
+    u64 format_count = darray_length(formats);
+    for (u64 i = 0; i < format_count; ++i)
+    {
+        mfree(formats[i], string_length(formats[i]) + 1, MEMORY_TAG_STRING);
+    }
+    darray_destroy(formats);
+
+    return result;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "defines.h"
+#include "core/logger.h"
+#include "platform/filesystem.h"
+
+#include <stdarg.h>
+
+// 'MLOG', little-endian.
+#define BINARY_LOG_MAGIC 0x474F4C4DU
+#define BINARY_LOG_VERSION 2
+
+// Size of the staging buffer entries are encoded into before being written to disk.
+#define BINARY_LOG_BUFFER_SIZE (64 * 1024)
+
+// Maximum number of distinct format strings tracked. Must be a power of 2.
+#define BINARY_LOG_MAX_FORMATS 2048
+
+// Maximum number of arguments (including '*' width/precision arguments) in a single entry.
+#define BINARY_LOG_MAX_ARGS 16
+
+// Maximum number of bytes stored for a single string argument. Longer strings are truncated.
+#define BINARY_LOG_MAX_STRING_LENGTH 1024
+
+typedef enum binary_log_record_type
+{
+    // Defines a format string. u32 id, u16 length, char[length].
+    BINARY_LOG_RECORD_FORMAT = 1,
+    // A log entry. u8 channel, u8 level, u32 format id, f64 timestamp, u16 payload size, u8[payload size].
+    BINARY_LOG_RECORD_ENTRY = 2,
+    // A pre-formatted entry, for formats which cannot be deferred. u8 channel, u8 level, f64 timestamp, u16 length, char[length].
+    BINARY_LOG_RECORD_TEXT = 3,
+} binary_log_record_type;
+
+typedef enum binary_log_arg_type
+{
+    BINARY_LOG_ARG_NONE,
+    BINARY_LOG_ARG_I32,
+    BINARY_LOG_ARG_I64,
+    BINARY_LOG_ARG_F64,
+    BINARY_LOG_ARG_PTR,
+    BINARY_LOG_ARG_STRING,
+    // A '*' precision. Encoded as an i32, and also bounds the length of a following string.
+    BINARY_LOG_ARG_PRECISION,
+    // Anything that cannot be deferred, such as %n or long double.
+    BINARY_LOG_ARG_UNSUPPORTED,
+} binary_log_arg_type;
+
+/**
+ * @brief A single conversion specification parsed out of a printf-style format string.
+ */
+typedef struct binary_log_spec
+{
+    // Offset of the '%' in the format string.
+    u32 start;
+    // Number of characters in the specification, including the '%'.
+    u32 length;
+    b8 width_is_arg;
+    b8 precision_is_arg;
+    // Literal precision, or -1 if not given.
+    i32 precision;
+    binary_log_arg_type type;
+} binary_log_spec;
+
+typedef struct binary_log_format_entry
+{
+    // The format string pointer used as the cache key. Format strings are literals, so the
+    // pointer is stable for the lifetime of the program.
+    const char *format;
+    u32 id;
+    // False if the format contains something which cannot be deferred (i.e. %n, long double).
+    b8 deferrable;
+    u8 arg_count;
+    u8 arg_types[BINARY_LOG_MAX_ARGS];
+    // Literal precision per argument, or -1. Bounds how much of a string argument is read.
+    i16 arg_precisions[BINARY_LOG_MAX_ARGS];
+} binary_log_format_entry;
+
+typedef struct binary_log_state
+{
+    file_handle *file;
+    u32 next_format_id;
+    u64 buffer_used;
+    binary_log_format_entry formats[BINARY_LOG_MAX_FORMATS];
+    u8 buffer[BINARY_LOG_BUFFER_SIZE];
+} binary_log_state;
+
+/**
+ * @brief Invoked by the decoder for each decoded entry.
+ *
+ * @param channel The channel the entry was logged on.
+ * @param level The level the entry was logged at.
+ * @param timestamp The absolute time the entry was logged at.
+ * @param message The formatted message, without a trailing newline.
+ * @param user_data The user data passed to the decoder.
+ */
+typedef void (*PFN_binary_log_on_entry)(log_channel channel, log_level level, f64 timestamp, const char *message, void *user_data);
+
+/**
+ * @brief Resets the provided state and writes the file header into its buffer.
+ *
+ * @param state A pointer to the state to be reset.
+ * @param file A pointer to an open file the buffer is flushed to. May be 0, in which case the buffer is never flushed.
+ */
+MAPI void binary_log_begin(binary_log_state *state, file_handle *file);
+
+/**
+ * @brief Encodes an entry into the provided state without formatting it. If the format string
+ * cannot be deferred, the entry is formatted immediately and stored as text instead.
+ *
+ * @param state A pointer to the state to encode into.
+ * @param channel The log channel.
+ * @param level The log level.
+ * @param format The format string. Must have static storage duration.
+ * @param args The arguments for the format string.
+ */
+MAPI void binary_log_write(binary_log_state *state, log_channel channel, log_level level, const char *format, va_list args);
+
+/**
+ * @brief Writes everything buffered so far out to the file, if there is one.
+ */
+MAPI void binary_log_flush(binary_log_state *state);
+
+/**
+ * @brief Parses the next conversion specification out of format, starting at offset.
+ *
+ * @param format The format string.
+ * @param offset The offset to start searching from.
+ * @param out_spec A pointer to hold the specification found.
+ * @return True if a specification was found; otherwise false.
+ */
+MAPI b8 binary_log_next_spec(const char *format, u32 offset, binary_log_spec *out_spec);
+
+/**
+ * @brief Decodes a binary log, invoking on_entry for every entry in it.
+ *
+ * @param data The contents of the binary log.
+ * @param size The size of data in bytes.
+ * @param on_entry The callback to invoke for each entry.
+ * @param user_data Passed through to on_entry.
+ * @return True if the whole log was decoded; false if it was malformed or truncated.
+ */
+MAPI b8 binary_log_decode(const u8 *data, u64 size, PFN_binary_log_on_entry on_entry, void *user_data);
@@ -0,0 +1,211 @@
+#include "compression.h"
+
+#include <string.h> // memcpy
+
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define HASH_BITS 12
+// The format requires the last bytes to be literals, so matches stop short of the end.
+#define LAST_LITERALS 5
+#define MATCH_FIND_LIMIT 12
+
+static u32 read_u32(const u8 *p)
+{
+    u32 value;
+    memcpy(&value, p, sizeof(u32));
+    return value;
+}
+
+static u32 hash_sequence(u32 sequence)
+{
+    return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static u8 *write_length(u8 *out, u64 length)
+{
+    while (length >= 255)
+    {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (u8)length;
+    return out;
+}
+
+static u8 *write_sequence(u8 *out, const u8 *literals, u64 literal_length, u64 offset, u64 match_length)
+{
+    u8 *token = out++;
+    *token = (u8)((literal_length >= 15 ? 15 : literal_length) << 4);
+    if (literal_length >= 15)
+    {
+        out = write_length(out, literal_length - 15);
+    }
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+    
+    // The final sequence is literals only.
+    if (offset == 0)
+    {
+        return out;
+    }
+    
+    match_length -= MIN_MATCH;
+    *token |= (u8)(match_length >= 15 ? 15 : match_length);
+    *out++ = (u8)(offset & 0xFF);
+    *out++ = (u8)(offset >> 8);
+    if (match_length >= 15)
+    {
+        out = write_length(out, match_length - 15);
+    }
+    return out;
+}
+
+u64 compression_bound(u64 source_size)
+{
+    return source_size + source_size / 255 + 16;
+}
+
+u64 compression_compress(const void *source, u64 source_size, void *dest, u64 dest_capacity)
+{
+    if (source_size >= 0xFFFFFFFFULL || dest_capacity < compression_bound(source_size))
+    {
+        return 0;
+    }
+    
+    const u8 *src = source;
+    const u8 *in = src;
+    const u8 *anchor = src;
+    const u8 *end = src + source_size;
+    u8 *out = dest;
+    
+    if (source_size >= MATCH_FIND_LIMIT)
+    {
+        // Position + 1 of the last occurrence of each hashed 4-byte sequence; 0 is empty.
+        u32 table[1 << HASH_BITS];
+        memset(table, 0, sizeof(table));
+        
+        const u8 *match_limit = end - LAST_LITERALS;
+        const u8 *search_limit = end - MATCH_FIND_LIMIT;
+        while (in <= search_limit)
+        {
+            u32 sequence = read_u32(in);
+            u32 hash = hash_sequence(sequence);
+            u32 candidate = table[hash];
+            table[hash] = (u32)(in - src) + 1;
+            
+            if (candidate == 0)
+            {
+                in++;
+                continue;
+            }
+            const u8 *ref = src + candidate - 1;
+            if (in - ref > MAX_OFFSET || read_u32(ref) != sequence)
+            {
+                in++;
+                continue;
+            }
+            
+            const u8 *match_end = in + MIN_MATCH;
+            ref += MIN_MATCH;
+            while (match_end < match_limit && *match_end == *ref)
+            {
+                match_end++;
+                ref++;
+            }
+            
+            out = write_sequence(out, anchor, (u64)(in - anchor), (u64)(match_end - ref), (u64)(match_end - in));
+            in = match_end;
+            anchor = in;
+        }
+    }
+    
+    out = write_sequence(out, anchor, (u64)(end - anchor), 0, 0);
+    return (u64)(out - (u8 *)dest);
+}
+
+static b8 read_length(const u8 **in, const u8 *end, u64 *length)
+{
+    u8 byte;
+    do
+    {
+        if (*in >= end)
+        {
+            return false;
+        }
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+b8 compression_decompress(const void *source, u64 source_size, void *dest, u64 dest_size)
+{
+    const u8 *in = source;
+    const u8 *in_end = in + source_size;
+    u8 *out = dest;
+    u8 *out_start = dest;
+    u8 *out_end = out + dest_size;
+    
+    while (in < in_end)
+    {
+        u8 token = *in++;
+        
+        u64 literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(&in, in_end, &literal_length))
+        {
+            return false;
+        }
+        if (literal_length > (u64)(in_end - in) || literal_length > (u64)(out_end - out))
+        {
+            return false;
+        }
+        memcpy(out, in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        
+        // The final sequence has no match.
+        if (in == in_end)
+        {
+            break;
+        }
+        
+        if (in_end - in < 2)
+        {
+            return false;
+        }
+        u64 offset = (u64)in[0] | ((u64)in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > (u64)(out - out_start))
+        {
+            return false;
+        }
+        
+        u64 match_length = token & 15;
+        if (match_length == 15 && !read_length(&in, in_end, &match_length))
+        {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if (match_length > (u64)(out_end - out))
+        {
+            return false;
+        }
+        
+        const u8 *match = out - offset;
+        if (offset >= match_length)
+        {
+            memcpy(out, match, match_length);
+            out += match_length;
+        }
+        else
+        {
+            // Overlapping copy, i.e. a repeating run; must go byte by byte.
+            for (u64 i = 0; i < match_length; ++i)
+            {
+                *out++ = *match++;
+            }
+        }
+    }
+    
+    return out == out_end;
+}
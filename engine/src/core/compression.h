@@ -0,0 +1,36 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * A fast LZ77 byte compressor in the style of LZ4: literal runs and back references
+ * within a 64 KB window, with no entropy coding. Decompression is a tight copy loop,
+ * which is what matters for data that is compressed once at build time and loaded often.
+ */
+
+/**
+ * @brief Gets the size dest must be to compress source_size bytes, for incompressible input.
+ */
+MAPI u64 compression_bound(u64 source_size);
+
+/**
+ * @brief Compresses source into dest.
+ * 
+ * @param source The data to compress. Must be less than 4 GB.
+ * @param source_size The size of source in bytes.
+ * @param dest The destination buffer. Must hold at least compression_bound(source_size) bytes.
+ * @param dest_capacity The size of dest in bytes.
+ * @return The compressed size in bytes, or 0 on failure.
+ */
+MAPI u64 compression_compress(const void *source, u64 source_size, void *dest, u64 dest_capacity);
+
+/**
+ * @brief Decompresses source into dest. Malformed input is rejected, never read or written out of bounds.
+ * 
+ * @param source The compressed data.
+ * @param source_size The size of source in bytes.
+ * @param dest The destination buffer.
+ * @param dest_size The exact decompressed size in bytes.
+ * @return True if source decompressed to exactly dest_size bytes; otherwise false.
+ */
+MAPI b8 compression_decompress(const void *source, u64 source_size, void *dest, u64 dest_size);
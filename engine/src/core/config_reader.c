@@ -0,0 +1,78 @@
+#include "config_reader.h"
+
+#include <string.h> // memchr
+
+static b8 is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static string_view trim(const char *start, const char *end)
+{
+    while (start < end && is_space(*start))
+    {
+        start++;
+    }
+    while (end > start && is_space(end[-1]))
+    {
+        end--;
+    }
+    
+    string_view view;
+    view.str = start;
+    view.length = (u64)(end - start);
+    return view;
+}
+
+void config_reader_create(const char *data, u64 size, config_reader *out_reader)
+{
+    out_reader->data = data;
+    out_reader->size = size;
+    out_reader->offset = 0;
+    out_reader->line_number = 0;
+}
+
+b8 config_reader_next(config_reader *reader, config_entry *out_entry)
+{
+    while (reader->offset < reader->size)
+    {
+        const char *line_start = reader->data + reader->offset;
+        u64 remaining = reader->size - reader->offset;
+        const char *line_end = memchr(line_start, '\n', remaining);
+        if (line_end)
+        {
+            reader->offset += (u64)(line_end - line_start) + 1;
+        }
+        else
+        {
+            line_end = line_start + remaining;
+            reader->offset = reader->size;
+        }
+        reader->line_number++;
+        
+        string_view line = trim(line_start, line_end);
+        
+        // Skip blank lines and comments.
+        if (line.length == 0 || line.str[0] == '#')
+        {
+            continue;
+        }
+        
+        out_entry->line_number = reader->line_number;
+        
+        const char *equals = memchr(line.str, '=', line.length);
+        if (!equals)
+        {
+            out_entry->key = line;
+            out_entry->value.str = 0;
+            out_entry->value.length = 0;
+            return true;
+        }
+        
+        out_entry->key = trim(line.str, equals);
+        out_entry->value = trim(equals + 1, line.str + line.length);
+        return true;
+    }
+    
+    return false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "defines.h"
+#include "core/mstring.h"
+
+/**
+ * A tokenising reader over an in-memory "key = value" config file, i.e. a material (.mmt) file.
+ * Yields views into the buffer, so nothing is copied and the buffer must outlive the entries.
+ * Blank lines and lines starting with '#' are skipped; whitespace around keys and values is trimmed.
+ */
+typedef struct config_reader
+{
+    const char *data;
+    u64 size;
+    u64 offset;
+    u32 line_number;
+} config_reader;
+
+typedef struct config_entry
+{
+    string_view key;
+    // The value. str is 0 if the line has no '=', in which case key holds the whole line.
+    string_view value;
+    // The 1-based line the entry was read from.
+    u32 line_number;
+} config_entry;
+
+/**
+ * @brief Creates a reader over the given buffer. The buffer need not be null-terminated.
+ * 
+ * @param data The file contents.
+ * @param size The size of data in bytes.
+ * @param out_reader A pointer to hold the reader.
+ */
+MAPI void config_reader_create(const char *data, u64 size, config_reader *out_reader);
+
+/**
+ * @brief Reads the next entry, skipping blank lines and comments.
+ * 
+ * @param reader A pointer to the reader.
+ * @param out_entry A pointer to hold the entry.
+ * @return True if an entry was read; false at the end of the buffer.
+ */
+MAPI b8 config_reader_next(config_reader *reader, config_entry *out_entry);
@@ -1,6 +1,7 @@
 #include "core/event.h"
 
 #include "core/mmemory.h"
+#include "core/logger.h"
 #include "containers/darray.h"
 
 typedef struct registered_event
@@ -69,7 +70,7 @@ b8 event_register(u16 code, void *listener, PFN_on_event on_event)
     {
         if (state_ptr->registered[code].events[i].listener == listener)
         {
-            // TODO(satvik): warn
+            MWARN_CH(LOG_CHANNEL_EVENT, "event_register: listener already registered for code %i.", code);
             return false;
         }
     }
@@ -91,7 +92,7 @@ b8 event_unregister(u16 code, void *listener, PFN_on_event on_event)
     // On nothing is registered for the code, boot out.
     if (state_ptr->registered[code].events == 0)
     {
-        // TODO(satvik): warn
+        MWARN_CH(LOG_CHANNEL_EVENT, "event_unregister: nothing is registered for code %i.", code);
         return false;
     }
     
@@ -0,0 +1,59 @@
+#include "fixed_timestep.h"
+
+#include "core/mmemory.h"
+
+void fixed_timestep_create(u32 update_rate, fixed_timestep *out_timestep)
+{
+    mzero_memory(out_timestep, sizeof(fixed_timestep));
+    fixed_timestep_set_rate(out_timestep, update_rate);
+}
+
+void fixed_timestep_set_rate(fixed_timestep *timestep, u32 update_rate)
+{
+    timestep->step_seconds = update_rate ? 1.0 / update_rate : 0;
+    if (timestep->step_seconds == 0)
+    {
+        timestep->accumulator = 0;
+    }
+}
+
+u32 fixed_timestep_advance(fixed_timestep *timestep, f64 delta_time, f64 *out_step_seconds)
+{
+    if (timestep->step_seconds == 0)
+    {
+        *out_step_seconds = delta_time;
+        return 1;
+    }
+    
+    *out_step_seconds = timestep->step_seconds;
+    timestep->accumulator += delta_time > 0 ? delta_time : 0;
+    
+    u32 step_count = 0;
+    while (timestep->accumulator >= timestep->step_seconds && step_count < FIXED_TIMESTEP_MAX_STEPS)
+    {
+        timestep->accumulator -= timestep->step_seconds;
+        step_count++;
+    }
+    
+    if (timestep->accumulator >= timestep->step_seconds)
+    {
+        // Too far behind, i.e. after a hitch or a breakpoint. Drop the backlog but keep the fraction
+        // of a step, so alpha carries on smoothly.
+        u64 behind = (u64)(timestep->accumulator / timestep->step_seconds);
+        timestep->dropped_step_count += behind;
+        timestep->accumulator -= behind * timestep->step_seconds;
+    }
+    
+    return step_count;
+}
+
+f32 fixed_timestep_alpha(const fixed_timestep *timestep)
+{
+    if (timestep->step_seconds == 0)
+    {
+        return 1.0f;
+    }
+    
+    f32 alpha = (f32)(timestep->accumulator / timestep->step_seconds);
+    return alpha < 1.0f ? alpha : 1.0f;
+}
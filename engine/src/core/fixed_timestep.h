@@ -0,0 +1,49 @@
+#pragma once
+
+#include "defines.h"
+
+// Most updates to run in one frame. Past this the simulation falls behind real time instead of
+// running ever more updates to catch up, each frame taking longer than the last.
+#define FIXED_TIMESTEP_MAX_STEPS 8
+
+typedef struct fixed_timestep
+{
+    // Length of each update in seconds, or 0 to update once per frame with the frame's delta.
+    f64 step_seconds;
+    // Time passed which has not been simulated yet. Always less than a step after fixed_timestep_advance.
+    f64 accumulator;
+    // Updates skipped because a frame needed more than FIXED_TIMESTEP_MAX_STEPS.
+    u64 dropped_step_count;
+} fixed_timestep;
+
+/**
+ * @brief Creates a timestep with nothing accumulated.
+ *
+ * @param update_rate Updates per second, or 0 to update once per frame.
+ * @param out_timestep A pointer to hold the timestep.
+ */
+MAPI void fixed_timestep_create(u32 update_rate, fixed_timestep *out_timestep);
+
+/**
+ * @brief Changes the update rate. Time already accumulated is kept.
+ *
+ * @param update_rate Updates per second, or 0 to update once per frame.
+ */
+MAPI void fixed_timestep_set_rate(fixed_timestep *timestep, u32 update_rate);
+
+/**
+ * @brief Adds a frame's time and takes as many whole steps out of it as fit, leaving the remainder
+ * for later frames. A frame shorter than a step may run no updates at all.
+ *
+ * @param timestep The timestep.
+ * @param delta_time The time the frame took, in seconds.
+ * @param out_step_seconds A pointer to hold the length of each update; delta_time when not fixed.
+ * @return The number of updates to run this frame.
+ */
+MAPI u32 fixed_timestep_advance(fixed_timestep *timestep, f64 delta_time, f64 *out_step_seconds);
+
+/**
+ * @brief Gets how far between the last update and the next one the current frame is, from 0 to 1.
+ * Rendering blends the previous and current simulation states by this. Always 1 when not fixed.
+ */
+MAPI f32 fixed_timestep_alpha(const fixed_timestep *timestep);
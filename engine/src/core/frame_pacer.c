@@ -0,0 +1,86 @@
+#include "frame_pacer.h"
+
+#include "core/mmemory.h"
+#include "platform/platform.h"
+
+// Spin margin to start with, before anything is known about how late the OS wakes threads.
+#define FRAME_PACER_INITIAL_SPIN_MARGIN 0.002
+// Extra on top of the worst recent oversleep.
+#define FRAME_PACER_SPIN_MARGIN_PADDING 0.0002
+#define FRAME_PACER_MAX_SPIN_MARGIN 0.004
+
+void frame_pacer_create(u32 target_frame_rate, frame_pacer *out_pacer)
+{
+    mzero_memory(out_pacer, sizeof(frame_pacer));
+    out_pacer->spin_margin = FRAME_PACER_INITIAL_SPIN_MARGIN;
+    frame_pacer_set_target(out_pacer, target_frame_rate);
+    out_pacer->deadline = platform_get_absolute_time() + out_pacer->target_frame_seconds;
+}
+
+void frame_pacer_set_target(frame_pacer *pacer, u32 target_frame_rate)
+{
+    pacer->target_frame_seconds = target_frame_rate ? 1.0 / target_frame_rate : 0;
+}
+
+void frame_pacer_end_frame(frame_pacer *pacer)
+{
+    pacer->stats.frame_count++;
+    f64 now = platform_get_absolute_time();
+    if (pacer->target_frame_seconds == 0)
+    {
+        pacer->deadline = now;
+        return;
+    }
+
+    if (now >= pacer->deadline)
+    {
+        // Overran. Start the next frame now; catching up would just mean a burst of short frames.
+        pacer->stats.missed_count++;
+        pacer->deadline = now + pacer->target_frame_seconds;
+        return;
+    }
+
+    f64 wake_time = pacer->deadline - pacer->spin_margin;
+    if (now < wake_time)
+    {
+        platform_sleep_until(wake_time);
+
+        // Track how late the OS wakes us, so the margin covers it without spinning needlessly.
+        f64 oversleep = platform_get_absolute_time() - wake_time;
+        f64 needed = oversleep + FRAME_PACER_SPIN_MARGIN_PADDING;
+        if (needed > pacer->spin_margin)
+        {
+            pacer->spin_margin = needed < FRAME_PACER_MAX_SPIN_MARGIN ? needed : FRAME_PACER_MAX_SPIN_MARGIN;
+        }
+        else
+        {
+            pacer->spin_margin = pacer->spin_margin * 0.99 + needed * 0.01;
+        }
+    }
+
+    while ((now = platform_get_absolute_time()) < pacer->deadline)
+    {
+        platform_cpu_relax();
+    }
+
+    f64 error = now - pacer->deadline;
+    pacer->stats.total_error += error;
+    if (error > pacer->stats.max_error)
+    {
+        pacer->stats.max_error = error;
+    }
+
+    // Frames are spaced from the deadline rather than from when the wait ended, so error doesn't accumulate.
+    pacer->deadline += pacer->target_frame_seconds;
+}
+
+f64 frame_pacer_average_error(const frame_pacer *pacer)
+{
+    u64 paced = pacer->stats.frame_count - pacer->stats.missed_count;
+    return paced ? pacer->stats.total_error / paced : 0;
+}
+
+void frame_pacer_reset_stats(frame_pacer *pacer)
+{
+    mzero_memory(&pacer->stats, sizeof(frame_pacer_stats));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "defines.h"
+
+typedef struct frame_pacer_stats
+{
+    // Frames paced since the stats were last reset.
+    u64 frame_count;
+    // Frames whose work ran past their deadline, so there was nothing to wait for.
+    u64 missed_count;
+    // How far after their deadline the waited-for frames actually ended, in seconds.
+    f64 total_error;
+    f64 max_error;
+} frame_pacer_stats;
+
+typedef struct frame_pacer
+{
+    // 0 when frames are not limited.
+    f64 target_frame_seconds;
+    // When the current frame should end.
+    f64 deadline;
+    // How long before the deadline to stop sleeping and spin instead. Grows to cover however
+    // late the OS wakes the thread, then slowly shrinks back.
+    f64 spin_margin;
+    frame_pacer_stats stats;
+} frame_pacer;
+
+/**
+ * @brief Starts pacing frames, with the first frame beginning now.
+ *
+ * @param target_frame_rate Frames per second to aim for, or 0 to not limit frames.
+ * @param out_pacer A pointer to hold the pacer.
+ */
+MAPI void frame_pacer_create(u32 target_frame_rate, frame_pacer *out_pacer);
+
+/**
+ * @brief Changes the frame rate, starting from the next frame.
+ *
+ * @param target_frame_rate Frames per second to aim for, or 0 to not limit frames.
+ */
+MAPI void frame_pacer_set_target(frame_pacer *pacer, u32 target_frame_rate);
+
+/**
+ * @brief Ends a frame, waiting until its deadline. Sleeps for most of the wait and spins for the
+ * last moment, since the OS may wake the thread late. A frame which overran its deadline starts
+ * the next one straight away rather than trying to catch up.
+ *
+ * @param pacer The pacer.
+ */
+MAPI void frame_pacer_end_frame(frame_pacer *pacer);
+
+/**
+ * @brief Gets the average time frames ended after their deadline, in seconds.
+ */
+MAPI f64 frame_pacer_average_error(const frame_pacer *pacer);
+
+/**
+ * @brief Clears the stats.
+ */
+MAPI void frame_pacer_reset_stats(frame_pacer *pacer);
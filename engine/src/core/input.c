@@ -3,25 +3,115 @@
 #include "core/event.h"
 #include "core/mmemory.h"
 #include "core/logger.h"
+#include "containers/darray.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
 
+// 'MREC', little-endian.
+#define INPUT_RECORDING_MAGIC 0x4345524DU
+#define INPUT_RECORDING_VERSION 1
+
+typedef enum input_record_type
+{
+    INPUT_RECORD_KEY,
+    INPUT_RECORD_BUTTON,
+    INPUT_RECORD_MOUSE_MOVE,
+    INPUT_RECORD_MOUSE_WHEEL,
+    // Marks the frame recording was stopped on, so replays run for the same number of frames.
+    INPUT_RECORD_END,
+} input_record_type;
+
+// A single input state transition. x holds the pressed state for keys and buttons, and the
+// delta for the mouse wheel.
+typedef struct input_record
+{
+    u32 frame;
+    u8 type;
+    u8 code;
+    i16 x;
+    i16 y;
+} input_record;
+
+typedef struct input_recording_header
+{
+    u32 magic;
+    u32 version;
+    f64 timestep;
+    u64 record_count;
+} input_recording_header;
+
+typedef enum input_playback_mode
+{
+    INPUT_PLAYBACK_NONE,
+    INPUT_PLAYBACK_RECORDING,
+    INPUT_PLAYBACK_REPLAYING,
+} input_playback_mode;
+
+#define KEY_WORD_COUNT (256 / 64)
+
+// One bit per key, so the whole keyboard can be copied and compared a word at a time.
 typedef struct keyboard_state
 {
-    b8 keys[256];
+    u64 keys[KEY_WORD_COUNT];
 } keyboard_state;
 
 typedef struct mouse_state
 {
     i16 x;
     i16 y;
-    u8 buttons[BUTTON_MAX_BUTTONS];
+    // One bit per button.
+    u32 buttons;
 } mouse_state;
 
+typedef struct input_action_binding
+{
+    keyboard_state keys;
+    u32 buttons;
+} input_action_binding;
+
+#define KEY_WORD(key) ((u32)(key) >> 6)
+#define KEY_BIT(key) (1ULL << ((u32)(key) & 63))
+#define BUTTON_BIT(button) (1U << (u32)(button))
+
 typedef struct input_state
 {
     keyboard_state keyboard_current;
     keyboard_state keyboard_previous;
     mouse_state mouse_current;
     mouse_state mouse_previous;
+    
+    // Edges between previous and current, recomputed lazily when the state has changed.
+    b8 edges_dirty;
+    keyboard_state keys_pressed;
+    keyboard_state keys_released;
+    u32 buttons_pressed;
+    u32 buttons_released;
+    
+    // One bit per action, resolved alongside the edges.
+    input_action_binding action_bindings[INPUT_MAX_ACTIONS];
+    u64 actions_down;
+    u64 actions_pressed;
+    u64 actions_released;
+    
+    input_playback_mode playback_mode;
+    // Frames since recording or replay started.
+    u32 frame;
+    f64 timestep;
+    file_handle recording_file;
+    // darray while recording.
+    input_record *records;
+    // The contents of the recording file while replaying.
+    u8 *replay_data;
+    u64 replay_data_size;
+    u64 replay_record_count;
+    u64 replay_index;
+    
+    // Every transition since the last input_update, ordered by timestamp.
+    u32 frame_event_count;
+    u32 dropped_event_count;
+    input_event frame_events[INPUT_MAX_FRAME_EVENTS];
+    // When the mouse reached mouse_previous, the start point for interpolation.
+    f64 previous_mouse_timestamp;
 } input_state;
 
 static input_state *state_ptr;
@@ -40,10 +130,110 @@ void input_system_initialise(u64 *memory_requirements, void *state)
 
 void input_system_shutdown(void *state)
 {
-    // TODO(satvik): Add shutdown routines when needed.
+    if (state_ptr)
+    {
+        input_recording_stop();
+        input_replay_stop();
+    }
     state_ptr = 0;
 }
 
+static void push_record(input_record_type type, u8 code, i16 x, i16 y)
+{
+    input_record record;
+    record.frame = state_ptr->frame;
+    record.type = type;
+    record.code = code;
+    record.x = x;
+    record.y = y;
+    darray_push(state_ptr->records, record);
+}
+
+static void apply_key(keys key, b8 pressed, f64 timestamp);
+static void apply_button(buttons button, b8 pressed, f64 timestamp);
+static void apply_mouse_move(i16 x, i16 y, f64 timestamp);
+static void apply_mouse_wheel(i8 z_delta, f64 timestamp);
+
+static void push_event(input_event_type type, u8 code, i16 x, i16 y, f64 timestamp)
+{
+    if (state_ptr->frame_event_count == INPUT_MAX_FRAME_EVENTS)
+    {
+        state_ptr->dropped_event_count++;
+        return;
+    }
+    
+    // Events nearly always arrive in order, but platforms can deliver older ones late (i.e.
+    // coalesced mouse moves), so insert sorted from the back.
+    u32 index = state_ptr->frame_event_count;
+    while (index > 0 && state_ptr->frame_events[index - 1].timestamp > timestamp)
+    {
+        state_ptr->frame_events[index] = state_ptr->frame_events[index - 1];
+        index--;
+    }
+    
+    input_event *event = &state_ptr->frame_events[index];
+    event->timestamp = timestamp;
+    event->type = type;
+    event->code = code;
+    event->x = x;
+    event->y = y;
+    state_ptr->frame_event_count++;
+}
+
+// Releases every key and button which is held.
+static void release_all(f64 timestamp)
+{
+    for (u32 i = 0; i < 256; ++i)
+    {
+        apply_key((keys)i, false, timestamp);
+    }
+    for (u32 i = 0; i < BUTTON_MAX_BUTTONS; ++i)
+    {
+        apply_button((buttons)i, false, timestamp);
+    }
+}
+
+static void replay_records()
+{
+    const input_record *records = (const input_record *)(state_ptr->replay_data + sizeof(input_recording_header));
+    f64 now = platform_get_absolute_time();
+    while (state_ptr->replay_index < state_ptr->replay_record_count)
+    {
+        const input_record *record = &records[state_ptr->replay_index];
+        if (record->frame > state_ptr->frame)
+        {
+            return;
+        }
+        state_ptr->replay_index++;
+        
+        switch (record->type)
+        {
+            case INPUT_RECORD_KEY:
+            apply_key((keys)record->code, (b8)record->x, now);
+            break;
+            case INPUT_RECORD_BUTTON:
+            if (record->code < BUTTON_MAX_BUTTONS)
+            {
+                apply_button((buttons)record->code, (b8)record->x, now);
+            }
+            break;
+            case INPUT_RECORD_MOUSE_MOVE:
+            apply_mouse_move(record->x, record->y, now);
+            break;
+            case INPUT_RECORD_MOUSE_WHEEL:
+            apply_mouse_wheel((i8)record->x, now);
+            break;
+            case INPUT_RECORD_END:
+            default:
+            input_replay_stop();
+            return;
+        }
+    }
+    
+    // Ran out of records without an end marker.
+    input_replay_stop();
+}
+
 void input_update(f64 delta_time)
 {
     if (!state_ptr)
@@ -52,14 +242,248 @@ void input_update(f64 delta_time)
     // Copy current states to previous ones.
     mcopy_memory(&state_ptr->keyboard_previous, &state_ptr->keyboard_current, sizeof(keyboard_state));
     mcopy_memory(&state_ptr->mouse_previous, &state_ptr->mouse_current, sizeof(mouse_state));
+    state_ptr->edges_dirty = true;
+    
+    // Start a new frame's worth of events.
+    for (u32 i = state_ptr->frame_event_count; i > 0; --i)
+    {
+        if (state_ptr->frame_events[i - 1].type == INPUT_EVENT_MOUSE_MOVE)
+        {
+            state_ptr->previous_mouse_timestamp = state_ptr->frame_events[i - 1].timestamp;
+            break;
+        }
+    }
+    if (state_ptr->dropped_event_count > 0)
+    {
+        MWARN("input_update: dropped %u input events this frame.", state_ptr->dropped_event_count);
+        state_ptr->dropped_event_count = 0;
+    }
+    state_ptr->frame_event_count = 0;
+    
+    if (state_ptr->playback_mode != INPUT_PLAYBACK_NONE)
+    {
+        state_ptr->frame++;
+        if (state_ptr->playback_mode == INPUT_PLAYBACK_REPLAYING)
+        {
+            // Apply the next frame's transitions so they are visible to its update.
+            replay_records();
+        }
+    }
 }
 
-void input_process_key(keys key, b8 pressed)
+b8 input_recording_start(const char *path, f64 timestep)
 {
-    if (state_ptr && state_ptr->keyboard_current.keys[key] != pressed)
+    if (!state_ptr || state_ptr->playback_mode != INPUT_PLAYBACK_NONE || timestep <= 0)
+        return false;
+    
+    if (!filesystem_open(path, FILE_MODE_WRITE, true, &state_ptr->recording_file))
+    {
+        MERROR("input_recording_start: unable to open '%s' for writing.", path);
+        return false;
+    }
+    
+    state_ptr->playback_mode = INPUT_PLAYBACK_RECORDING;
+    state_ptr->frame = 0;
+    state_ptr->timestep = timestep;
+    state_ptr->records = darray_create(input_record);
+    
+    // Capture whatever is already held down, so the replay starts from the same state.
+    for (u32 i = 0; i < 256; ++i)
+    {
+        if (state_ptr->keyboard_current.keys[KEY_WORD(i)] & KEY_BIT(i))
+        {
+            push_record(INPUT_RECORD_KEY, (u8)i, true, 0);
+        }
+    }
+    for (u32 i = 0; i < BUTTON_MAX_BUTTONS; ++i)
+    {
+        if (state_ptr->mouse_current.buttons & BUTTON_BIT(i))
+        {
+            push_record(INPUT_RECORD_BUTTON, (u8)i, true, 0);
+        }
+    }
+    push_record(INPUT_RECORD_MOUSE_MOVE, 0, state_ptr->mouse_current.x, state_ptr->mouse_current.y);
+    
+    MINFO("Input recording started to '%s'.", path);
+    return true;
+}
+
+void input_recording_stop()
+{
+    if (!state_ptr || state_ptr->playback_mode != INPUT_PLAYBACK_RECORDING)
+        return;
+    
+    push_record(INPUT_RECORD_END, 0, 0, 0);
+    
+    input_recording_header header;
+    header.magic = INPUT_RECORDING_MAGIC;
+    header.version = INPUT_RECORDING_VERSION;
+    header.timestep = state_ptr->timestep;
+    header.record_count = darray_length(state_ptr->records);
+    
+    u64 written = 0;
+    if (!filesystem_write(&state_ptr->recording_file, sizeof(input_recording_header), &header, &written) ||
+        !filesystem_write(&state_ptr->recording_file, sizeof(input_record) * header.record_count, state_ptr->records, &written))
+    {
+        MERROR("input_recording_stop: failed to write recording.");
+    }
+    filesystem_close(&state_ptr->recording_file);
+    
+    MINFO("Input recording stopped after %u frames (%llu transitions).", state_ptr->frame, header.record_count);
+    
+    darray_destroy(state_ptr->records);
+    state_ptr->records = 0;
+    state_ptr->playback_mode = INPUT_PLAYBACK_NONE;
+}
+
+b8 input_replay_start(const char *path)
+{
+    if (!state_ptr || state_ptr->playback_mode != INPUT_PLAYBACK_NONE)
+        return false;
+    
+    file_handle file;
+    if (!filesystem_open(path, FILE_MODE_READ, true, &file))
+    {
+        MERROR("input_replay_start: unable to open '%s'.", path);
+        return false;
+    }
+    
+    u8 *data = 0;
+    u64 size = 0;
+    b8 read = filesystem_read_all_bytes(&file, &data, &size);
+    filesystem_close(&file);
+    
+    input_recording_header header;
+    if (!read || size < sizeof(input_recording_header))
+    {
+        MERROR("input_replay_start: unable to read '%s'.", path);
+        if (data)
+        {
+            mfree(data, size, MEMORY_TAG_STRING);
+        }
+        return false;
+    }
+    mcopy_memory(&header, data, sizeof(input_recording_header));
+    if (header.magic != INPUT_RECORDING_MAGIC || header.version != INPUT_RECORDING_VERSION || header.timestep <= 0 ||
+        header.record_count > (size - sizeof(input_recording_header)) / sizeof(input_record))
+    {
+        MERROR("input_replay_start: '%s' is not a valid input recording.", path);
+        mfree(data, size, MEMORY_TAG_STRING);
+        return false;
+    }
+    
+    // Release everything currently held so the replay starts from a known state.
+    release_all(platform_get_absolute_time());
+    
+    state_ptr->playback_mode = INPUT_PLAYBACK_REPLAYING;
+    state_ptr->frame = 0;
+    state_ptr->timestep = header.timestep;
+    state_ptr->replay_data = data;
+    state_ptr->replay_data_size = size;
+    state_ptr->replay_record_count = header.record_count;
+    state_ptr->replay_index = 0;
+    
+    MINFO("Input replay started from '%s'.", path);
+    
+    // Frame 0 holds the initial state.
+    replay_records();
+    return true;
+}
+
+void input_replay_stop()
+{
+    if (!state_ptr || state_ptr->playback_mode != INPUT_PLAYBACK_REPLAYING)
+        return;
+    
+    MINFO("Input replay stopped after %u frames.", state_ptr->frame);
+    
+    mfree(state_ptr->replay_data, state_ptr->replay_data_size, MEMORY_TAG_STRING);
+    state_ptr->replay_data = 0;
+    state_ptr->replay_data_size = 0;
+    state_ptr->playback_mode = INPUT_PLAYBACK_NONE;
+    
+    // Nothing the replay pressed stays held once it ends, whether it finished or was aborted.
+    release_all(platform_get_absolute_time());
+}
+
+b8 input_is_recording()
+{
+    return state_ptr && state_ptr->playback_mode == INPUT_PLAYBACK_RECORDING;
+}
+
+b8 input_is_replaying()
+{
+    return state_ptr && state_ptr->playback_mode == INPUT_PLAYBACK_REPLAYING;
+}
+
+f64 input_playback_timestep()
+{
+    if (!state_ptr || state_ptr->playback_mode == INPUT_PLAYBACK_NONE)
+        return 0;
+    return state_ptr->timestep;
+}
+
+void input_process_key(keys key, b8 pressed, f64 timestamp)
+{
+    if (!state_ptr)
+        return;
+    
+    if (state_ptr->playback_mode == INPUT_PLAYBACK_REPLAYING)
+    {
+        // Live input is ignored during a replay, apart from escape which aborts it.
+        if (key == KEY_ESCAPE && pressed)
+        {
+            input_replay_stop();
+        }
+        return;
+    }
+    
+    apply_key(key, pressed, timestamp);
+}
+
+void input_process_button(buttons button, b8 pressed, f64 timestamp)
+{
+    if (state_ptr && state_ptr->playback_mode != INPUT_PLAYBACK_REPLAYING)
+    {
+        apply_button(button, pressed, timestamp);
+    }
+}
+
+void input_process_mouse_move(i16 x, i16 y, f64 timestamp)
+{
+    if (state_ptr && state_ptr->playback_mode != INPUT_PLAYBACK_REPLAYING)
+    {
+        apply_mouse_move(x, y, timestamp);
+    }
+}
+
+void input_process_mouse_wheel(i8 z_delta, f64 timestamp)
+{
+    if (state_ptr && state_ptr->playback_mode != INPUT_PLAYBACK_REPLAYING)
+    {
+        apply_mouse_wheel(z_delta, timestamp);
+    }
+}
+
+static void apply_key(keys key, b8 pressed, f64 timestamp)
+{
+    if ((u32)key >= 256)
+    {
+        return;
+    }
+    
+    u64 *word = &state_ptr->keyboard_current.keys[KEY_WORD(key)];
+    if (((*word & KEY_BIT(key)) != 0) != pressed)
     {
         // Update internal state_ptr->
-        state_ptr->keyboard_current.keys[key] = pressed;
+        *word ^= KEY_BIT(key);
+        state_ptr->edges_dirty = true;
+        
+        if (state_ptr->playback_mode == INPUT_PLAYBACK_RECORDING)
+        {
+            push_record(INPUT_RECORD_KEY, (u8)key, pressed, 0);
+        }
+        push_event(INPUT_EVENT_KEY, (u8)key, pressed, 0, timestamp);
         
         if (key == KEY_LALT)
         {
@@ -95,12 +519,19 @@ void input_process_key(keys key, b8 pressed)
     }
 }
 
-void input_process_button(buttons button, b8 pressed)
+static void apply_button(buttons button, b8 pressed, f64 timestamp)
 {
     // If the state changed, fire an event.
-    if (state_ptr->mouse_current.buttons[button] != pressed)
+    if (((state_ptr->mouse_current.buttons & BUTTON_BIT(button)) != 0) != pressed)
     {
-        state_ptr->mouse_current.buttons[button] = pressed;
+        state_ptr->mouse_current.buttons ^= BUTTON_BIT(button);
+        state_ptr->edges_dirty = true;
+        
+        if (state_ptr->playback_mode == INPUT_PLAYBACK_RECORDING)
+        {
+            push_record(INPUT_RECORD_BUTTON, (u8)button, pressed, 0);
+        }
+        push_event(INPUT_EVENT_BUTTON, (u8)button, pressed, 0, timestamp);
         
         // Fire the event.
         event_context context;
@@ -109,7 +540,7 @@ void input_process_button(buttons button, b8 pressed)
     }
 }
 
-void input_process_mouse_move(i16 x, i16 y)
+static void apply_mouse_move(i16 x, i16 y, f64 timestamp)
 {
     // Only process if actually different
     if (state_ptr->mouse_current.x != x || state_ptr->mouse_current.y != y)
@@ -121,6 +552,12 @@ void input_process_mouse_move(i16 x, i16 y)
         state_ptr->mouse_current.x = x;
         state_ptr->mouse_current.y = y;
         
+        if (state_ptr->playback_mode == INPUT_PLAYBACK_RECORDING)
+        {
+            push_record(INPUT_RECORD_MOUSE_MOVE, 0, x, y);
+        }
+        push_event(INPUT_EVENT_MOUSE_MOVE, 0, x, y, timestamp);
+        
         // Fire the event.
         event_context context;
         context.data.u16[0] = x;
@@ -129,9 +566,14 @@ void input_process_mouse_move(i16 x, i16 y)
     }
 }
 
-void input_process_mouse_wheel(i8 z_delta)
+static void apply_mouse_wheel(i8 z_delta, f64 timestamp)
 {
     // NOTE: no internal state to update.
+    if (state_ptr->playback_mode == INPUT_PLAYBACK_RECORDING)
+    {
+        push_record(INPUT_RECORD_MOUSE_WHEEL, 0, z_delta, 0);
+    }
+    push_event(INPUT_EVENT_MOUSE_WHEEL, 0, z_delta, 0, timestamp);
     
     // Fire the event.
     event_context context;
@@ -139,33 +581,159 @@ void input_process_mouse_wheel(i8 z_delta)
     event_fire(EVENT_CODE_MOUSE_WHEEL, 0, context);
 }
 
+// Recomputes key and button edges, then resolves every action against them. Works a word at a
+// time, so there is no per-key branching.
+static void resolve_edges()
+{
+    if (!state_ptr->edges_dirty)
+        return;
+    
+    const u64 *current = state_ptr->keyboard_current.keys;
+    const u64 *previous = state_ptr->keyboard_previous.keys;
+    for (u32 i = 0; i < KEY_WORD_COUNT; ++i)
+    {
+        state_ptr->keys_pressed.keys[i] = current[i] & ~previous[i];
+        state_ptr->keys_released.keys[i] = ~current[i] & previous[i];
+    }
+    state_ptr->buttons_pressed = state_ptr->mouse_current.buttons & ~state_ptr->mouse_previous.buttons;
+    state_ptr->buttons_released = ~state_ptr->mouse_current.buttons & state_ptr->mouse_previous.buttons;
+    
+    u64 down = 0;
+    u64 previous_down = 0;
+    for (u32 action = 0; action < INPUT_MAX_ACTIONS; ++action)
+    {
+        const input_action_binding *binding = &state_ptr->action_bindings[action];
+        u64 any_down = binding->buttons & state_ptr->mouse_current.buttons;
+        u64 any_previous_down = binding->buttons & state_ptr->mouse_previous.buttons;
+        for (u32 i = 0; i < KEY_WORD_COUNT; ++i)
+        {
+            any_down |= binding->keys.keys[i] & current[i];
+            any_previous_down |= binding->keys.keys[i] & previous[i];
+        }
+        down |= (u64)(any_down != 0) << action;
+        previous_down |= (u64)(any_previous_down != 0) << action;
+    }
+    
+    // Actions only change state when the first bound input goes down or the last one comes up.
+    state_ptr->actions_down = down;
+    state_ptr->actions_pressed = down & ~previous_down;
+    state_ptr->actions_released = ~down & previous_down;
+    state_ptr->edges_dirty = false;
+}
+
+b8 input_is_key_pressed(keys key)
+{
+    if (!state_ptr)
+        return false;
+    resolve_edges();
+    return (state_ptr->keys_pressed.keys[KEY_WORD(key)] & KEY_BIT(key)) != 0;
+}
+
+b8 input_is_key_released(keys key)
+{
+    if (!state_ptr)
+        return false;
+    resolve_edges();
+    return (state_ptr->keys_released.keys[KEY_WORD(key)] & KEY_BIT(key)) != 0;
+}
+
+b8 input_is_button_pressed(buttons button)
+{
+    if (!state_ptr)
+        return false;
+    resolve_edges();
+    return (state_ptr->buttons_pressed & BUTTON_BIT(button)) != 0;
+}
+
+b8 input_is_button_released(buttons button)
+{
+    if (!state_ptr)
+        return false;
+    resolve_edges();
+    return (state_ptr->buttons_released & BUTTON_BIT(button)) != 0;
+}
+
+// Actions.
+b8 input_action_bind_key(u32 action, keys key)
+{
+    if (!state_ptr || action >= INPUT_MAX_ACTIONS || (u32)key >= 256)
+        return false;
+    
+    state_ptr->action_bindings[action].keys.keys[KEY_WORD(key)] |= KEY_BIT(key);
+    state_ptr->edges_dirty = true;
+    return true;
+}
+
+b8 input_action_bind_button(u32 action, buttons button)
+{
+    if (!state_ptr || action >= INPUT_MAX_ACTIONS || button >= BUTTON_MAX_BUTTONS)
+        return false;
+    
+    state_ptr->action_bindings[action].buttons |= BUTTON_BIT(button);
+    state_ptr->edges_dirty = true;
+    return true;
+}
+
+void input_action_unbind(u32 action)
+{
+    if (!state_ptr || action >= INPUT_MAX_ACTIONS)
+        return;
+    
+    mzero_memory(&state_ptr->action_bindings[action], sizeof(input_action_binding));
+    state_ptr->edges_dirty = true;
+}
+
+u64 input_get_actions_down()
+{
+    if (!state_ptr)
+        return 0;
+    resolve_edges();
+    return state_ptr->actions_down;
+}
+
+u64 input_get_actions_pressed()
+{
+    if (!state_ptr)
+        return 0;
+    resolve_edges();
+    return state_ptr->actions_pressed;
+}
+
+u64 input_get_actions_released()
+{
+    if (!state_ptr)
+        return 0;
+    resolve_edges();
+    return state_ptr->actions_released;
+}
+
 // Keyboard input.
 b8 input_is_key_down(keys key)
 {
     if (!state_ptr)
         return false;
-    return state_ptr->keyboard_current.keys[key] == true;
+    return (state_ptr->keyboard_current.keys[KEY_WORD(key)] & KEY_BIT(key)) != 0;
 }
 
 b8 input_is_key_up(keys key)
 {
     if (!state_ptr)
         return true;
-    return state_ptr->keyboard_current.keys[key] == false;
+    return (state_ptr->keyboard_current.keys[KEY_WORD(key)] & KEY_BIT(key)) == 0;
 }
 
 b8 input_was_key_down(keys key)
 {
     if (!state_ptr)
         return false;
-    return state_ptr->keyboard_previous.keys[key] == true;
+    return (state_ptr->keyboard_previous.keys[KEY_WORD(key)] & KEY_BIT(key)) != 0;
 }
 
 b8 input_was_key_up(keys key)
 {
     if (!state_ptr)
         return true;
-    return state_ptr->keyboard_previous.keys[key] == false;
+    return (state_ptr->keyboard_previous.keys[KEY_WORD(key)] & KEY_BIT(key)) == 0;
 }
 
 // Mouse input.
@@ -173,28 +741,28 @@ b8 input_is_button_down(buttons button)
 {
     if (!state_ptr)
         return false;
-    return state_ptr->mouse_current.buttons[button] == true;
+    return (state_ptr->mouse_current.buttons & BUTTON_BIT(button)) != 0;
 }
 
 b8 input_is_button_up(buttons button)
 {
     if (!state_ptr)
         return true;
-    return state_ptr->mouse_current.buttons[button] == false;
+    return (state_ptr->mouse_current.buttons & BUTTON_BIT(button)) == 0;
 }
 
 b8 input_was_button_down(buttons button)
 {
     if (!state_ptr)
         return false;
-    return state_ptr->mouse_previous.buttons[button] == true;
+    return (state_ptr->mouse_previous.buttons & BUTTON_BIT(button)) != 0;
 }
 
 b8 input_was_button_up(buttons button)
 {
     if (!state_ptr)
         return true;
-    return state_ptr->mouse_previous.buttons[button] == false;
+    return (state_ptr->mouse_previous.buttons & BUTTON_BIT(button)) == 0;
 }
 
 void input_get_mouse_position(i32 *x, i32 *y)
@@ -222,3 +790,59 @@ void input_get_previous_mouse_position(i32 *x, i32 *y)
     *x = state_ptr->mouse_previous.x;
     *y = state_ptr->mouse_previous.y;
 }
+
+const input_event *input_get_frame_events(u32 *out_count)
+{
+    if (!state_ptr)
+    {
+        *out_count = 0;
+        return 0;
+    }
+    
+    *out_count = state_ptr->frame_event_count;
+    return state_ptr->frame_events;
+}
+
+void input_get_mouse_position_at(f64 timestamp, f32 *x, f32 *y)
+{
+    if (!state_ptr)
+    {
+        *x = 0;
+        *y = 0;
+        return;
+    }
+    
+    // Walk the frame's moves, starting from where the mouse was at the end of the last frame.
+    f64 from_time = state_ptr->previous_mouse_timestamp;
+    f32 from_x = state_ptr->mouse_previous.x;
+    f32 from_y = state_ptr->mouse_previous.y;
+    for (u32 i = 0; i < state_ptr->frame_event_count; ++i)
+    {
+        const input_event *event = &state_ptr->frame_events[i];
+        if (event->type != INPUT_EVENT_MOUSE_MOVE)
+        {
+            continue;
+        }
+        
+        if (event->timestamp >= timestamp)
+        {
+            f64 span = event->timestamp - from_time;
+            f32 t = span > 0 ? (f32)((timestamp - from_time) / span) : 1.0f;
+            if (t < 0)
+            {
+                t = 0;
+            }
+            *x = from_x + ((f32)event->x - from_x) * t;
+            *y = from_y + ((f32)event->y - from_y) * t;
+            return;
+        }
+        
+        from_time = event->timestamp;
+        from_x = event->x;
+        from_y = event->y;
+    }
+    
+    // Past the last move, so the mouse is wherever that left it.
+    *x = from_x;
+    *y = from_y;
+}
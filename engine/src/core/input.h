@@ -144,26 +144,166 @@ typedef enum keys
     KEYS_MAX_KEYS
 } keys;
 
-void input_system_initialise(u64 *memory_requirements, void *state);
-void input_system_shutdown(void *state);
-void input_update(f64 delta_time);
+// Maximum number of actions that can be bound. Actions are resolved into a u64 bitset.
+#define INPUT_MAX_ACTIONS 64
+
+// Maximum number of input events buffered between calls to input_update.
+#define INPUT_MAX_FRAME_EVENTS 1024
+
+typedef enum input_event_type
+{
+    INPUT_EVENT_KEY,
+    INPUT_EVENT_BUTTON,
+    INPUT_EVENT_MOUSE_MOVE,
+    INPUT_EVENT_MOUSE_WHEEL,
+} input_event_type;
+
+/**
+ * @brief A single timestamped input state transition.
+ */
+typedef struct input_event
+{
+    // Absolute time the event happened at, in the same timebase as platform_get_absolute_time.
+    f64 timestamp;
+    input_event_type type;
+    // The key or button, for key and button events.
+    u8 code;
+    // Pressed state for key and button events, position for mouse moves, delta for the wheel.
+    i16 x;
+    i16 y;
+} input_event;
+
+MAPI void input_system_initialise(u64 *memory_requirements, void *state);
+MAPI void input_system_shutdown(void *state);
+MAPI void input_update(f64 delta_time);
 
 // Keyboard input
 MAPI b8 input_is_key_down(keys key);
 MAPI b8 input_is_key_up(keys key);
 MAPI b8 input_was_key_down(keys key);
 MAPI b8 input_was_key_up(keys key);
+// True only on the frame the key went down/up.
+MAPI b8 input_is_key_pressed(keys key);
+MAPI b8 input_is_key_released(keys key);
 
-void input_process_key(keys key, b8 pressed);
+MAPI void input_process_key(keys key, b8 pressed, f64 timestamp);
 
 // Mouse input
 MAPI b8 input_is_button_down(buttons button);
 MAPI b8 input_is_button_up(buttons button);
 MAPI b8 input_was_button_down(buttons button);
 MAPI b8 input_was_button_up(buttons button);
+MAPI b8 input_is_button_pressed(buttons button);
+MAPI b8 input_is_button_released(buttons button);
 MAPI void input_get_mouse_position(i32 *x, i32 *y);
 MAPI void input_get_previous_mouse_position(i32 *x, i32 *y);
 
-void input_process_button(buttons button, b8 pressed);
-void input_process_mouse_move(i16 x, i16 y);
-void input_process_mouse_wheel(i8 z_delta);
\ No newline at end of file
+MAPI void input_process_button(buttons button, b8 pressed, f64 timestamp);
+MAPI void input_process_mouse_move(i16 x, i16 y, f64 timestamp);
+void input_process_mouse_wheel(i8 z_delta, f64 timestamp);
+
+/**
+ * @brief Gets every input event since the last frame, ordered by timestamp. Unlike the polled state,
+ * this includes every intermediate mouse position and the exact time each transition happened.
+ *
+ * @param out_count A pointer to hold the number of events.
+ * @return A pointer to the first event. Only valid until the next input_update.
+ */
+MAPI const input_event *input_get_frame_events(u32 *out_count);
+
+/**
+ * @brief Gets the mouse position at a point in time within the current frame, interpolating
+ * linearly between the buffered mouse moves either side of it.
+ *
+ * @param timestamp The absolute time to sample at.
+ * @param x A pointer to hold the x position.
+ * @param y A pointer to hold the y position.
+ */
+MAPI void input_get_mouse_position_at(f64 timestamp, f32 *x, f32 *y);
+
+// Action mapping
+
+/**
+ * @brief Binds a key to an action. An action can have any number of keys and buttons bound to it,
+ * and is down while any of them are held.
+ *
+ * @param action The action, from 0 to INPUT_MAX_ACTIONS - 1. Actions are defined by the game.
+ * @param key The key to bind.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 input_action_bind_key(u32 action, keys key);
+
+/**
+ * @brief Binds a mouse button to an action.
+ *
+ * @param action The action, from 0 to INPUT_MAX_ACTIONS - 1.
+ * @param button The button to bind.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 input_action_bind_button(u32 action, buttons button);
+
+/**
+ * @brief Removes every key and button bound to an action.
+ */
+MAPI void input_action_unbind(u32 action);
+
+/**
+ * @brief Gets a bitset of the actions currently down; bit n is set if action n is down.
+ * All actions are resolved in a single pass, once per change in input state.
+ */
+MAPI u64 input_get_actions_down();
+
+/**
+ * @brief Gets a bitset of the actions which went down this frame.
+ */
+MAPI u64 input_get_actions_pressed();
+
+/**
+ * @brief Gets a bitset of the actions which were released this frame.
+ */
+MAPI u64 input_get_actions_released();
+
+// Checks whether an action is set in a bitset returned by input_get_actions_*.
+#define INPUT_ACTION_SET(actions, action) (((actions) >> (action)) & 1)
+
+// Recording and replay
+
+/**
+ * @brief Starts recording every input state transition, tagged with its frame number. The recording
+ * is written to path when input_recording_stop is called. While recording, the application runs
+ * with a fixed timestep so the recording replays identically.
+ *
+ * @param path The path to write the recording to.
+ * @param timestep The fixed timestep, in seconds, to record and replay with.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 input_recording_start(const char *path, f64 timestep);
+
+/**
+ * @brief Stops recording and writes the recording out.
+ */
+MAPI void input_recording_stop();
+
+/**
+ * @brief Replays a recording made with input_recording_start, driving the input state from it at
+ * its fixed timestep. Live input is ignored until the replay ends; pressing escape aborts it.
+ *
+ * @param path The path of the recording.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 input_replay_start(const char *path);
+
+/**
+ * @brief Stops any replay in progress.
+ */
+MAPI void input_replay_stop();
+
+MAPI b8 input_is_recording();
+MAPI b8 input_is_replaying();
+
+/**
+ * @brief Gets the fixed timestep in use while recording or replaying.
+ *
+ * @return The timestep in seconds, or 0 when neither recording nor replaying.
+ */
+MAPI f64 input_playback_timestep();
\ No newline at end of file
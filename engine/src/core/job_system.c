@@ -0,0 +1,913 @@
+#include "job_system.h"
+
+#include "core/logger.h"
+#include "core/mmemory.h"
+#include "core/mstring.h"
+#include "platform/platform.h"
+
+#define JOB_QUEUE_MASK (JOB_QUEUE_CAPACITY - 1)
+
+// Jobs waiting for a dependency to finish.
+#define JOB_MAX_WAITING 4096
+
+#define CACHE_LINE_SIZE 64
+
+// How many times an idle worker looks for work before going to sleep.
+#define JOB_IDLE_SPIN_COUNT 64
+
+#define JOB_DEFAULT_FIBER_STACK_SIZE (256 * 1024)
+
+typedef struct job
+{
+    PFN_job_entry entry;
+    void *params;
+    job_counter *counter;
+    job_counter *dependency;
+    job_flags flags;
+    // Set while queued; the slot can be reused once the job starts.
+    matomic_i32 in_use;
+} job;
+
+/**
+ * A Chase-Lev work-stealing deque. The owning thread pushes and pops at the bottom without
+ * locking; other threads steal from the top, only contending with each other (and with the
+ * owner over the last job) through a compare-and-swap on top.
+ */
+typedef struct job_queue
+{
+    matomic_i64 top;
+    u8 top_padding[CACHE_LINE_SIZE - sizeof(matomic_i64)];
+    matomic_i64 bottom;
+    u8 bottom_padding[CACHE_LINE_SIZE - sizeof(matomic_i64)];
+    matomic_ptr slots[JOB_QUEUE_CAPACITY];
+} job_queue;
+
+typedef struct job_fiber
+{
+    mfiber fiber;
+    // The counter this fiber is suspended on, if it is waiting.
+    job_counter *waiting_on;
+} job_fiber;
+
+// A queue any thread can push to, for when a deque cannot be used.
+typedef struct locked_queue
+{
+    mmutex mutex;
+    u32 head;
+    matomic_i32 count;
+    job *jobs[JOB_QUEUE_CAPACITY];
+} locked_queue;
+
+typedef struct job_thread
+{
+    job_queue queue;
+    // Jobs submitted from this thread are allocated here, so allocation needs no locking.
+    job pool[JOB_QUEUE_CAPACITY];
+    u32 next_job;
+    // For picking which thread to steal from first.
+    u32 random_state;
+    mthread thread;
+
+    // Workers using fibers: the thread's own fiber, which is switched back to at shutdown, and the
+    // pooled fiber it is running now.
+    mfiber thread_fiber;
+    job_fiber *fiber;
+    // The fiber last switched away from. It can't be reused or resumed until it has stopped
+    // running, so whichever fiber runs next on this thread deals with it.
+    job_fiber *previous_fiber;
+} job_thread;
+
+typedef struct job_system_state
+{
+    u32 worker_count;
+    // Workers, plus the main thread at index 0.
+    u32 thread_count;
+    job_thread *threads;
+    matomic_i32 running;
+
+    // Idle workers sleep on this.
+    msemaphore wake;
+    matomic_i32 sleeping_count;
+
+    // JOB_FLAG_MAIN_THREAD jobs.
+    locked_queue main_queue;
+
+    // Jobs submitted from threads outside the job system, allocated from shared_pool under its lock.
+    locked_queue shared_queue;
+    job shared_pool[JOB_QUEUE_CAPACITY];
+    u32 shared_next_job;
+
+    mmutex waiting_mutex;
+    u32 waiting_count;
+    job *waiting[JOB_MAX_WAITING];
+    // Also under waiting_mutex.
+    u32 waiting_fiber_count;
+    job_fiber **waiting_fibers;
+
+    u32 fiber_count;
+    job_fiber *fibers;
+    mmutex fiber_mutex;
+    u32 free_fiber_count;
+    job_fiber **free_fibers;
+    // Fibers whose counter has reached zero, waiting for a worker to pick them back up.
+    u32 ready_fiber_head;
+    matomic_i32 ready_fiber_count;
+    job_fiber **ready_fibers;
+} job_system_state;
+
+static job_system_state *state_ptr;
+
+// The job system thread this thread is, or 0 for threads outside of it.
+static _Thread_local job_thread *current_thread;
+
+// Fibers move between threads, so a fiber must look its thread up again after every switch. Not
+// inlined, so the compiler can't keep the address of the thread local from before a switch.
+static MNOINLINE job_thread *get_current_thread()
+{
+    return current_thread;
+}
+
+static b8 queue_push(job_queue *queue, job *j)
+{
+    i64 bottom = platform_atomic_load_i64(&queue->bottom, MATOMIC_RELAXED);
+    i64 top = platform_atomic_load_i64(&queue->top, MATOMIC_ACQUIRE);
+    if (bottom - top >= JOB_QUEUE_CAPACITY)
+    {
+        return false;
+    }
+    platform_atomic_store_ptr(&queue->slots[bottom & JOB_QUEUE_MASK], j, MATOMIC_RELAXED);
+    platform_atomic_store_i64(&queue->bottom, bottom + 1, MATOMIC_RELEASE);
+    return true;
+}
+
+static job *queue_pop(job_queue *queue)
+{
+    i64 bottom = platform_atomic_load_i64(&queue->bottom, MATOMIC_RELAXED) - 1;
+    platform_atomic_store_i64(&queue->bottom, bottom, MATOMIC_RELAXED);
+    platform_atomic_fence(MATOMIC_SEQ_CST);
+    i64 top = platform_atomic_load_i64(&queue->top, MATOMIC_RELAXED);
+    if (top > bottom)
+    {
+        // Empty.
+        platform_atomic_store_i64(&queue->bottom, bottom + 1, MATOMIC_RELAXED);
+        return 0;
+    }
+
+    job *j = platform_atomic_load_ptr(&queue->slots[bottom & JOB_QUEUE_MASK], MATOMIC_RELAXED);
+    if (top == bottom)
+    {
+        // The last job, so race any thieves for it.
+        if (!platform_atomic_compare_exchange_i64(&queue->top, &top, top + 1, MATOMIC_SEQ_CST))
+        {
+            j = 0;
+        }
+        platform_atomic_store_i64(&queue->bottom, bottom + 1, MATOMIC_RELAXED);
+    }
+    return j;
+}
+
+static job *queue_steal(job_queue *queue)
+{
+    i64 top = platform_atomic_load_i64(&queue->top, MATOMIC_ACQUIRE);
+    platform_atomic_fence(MATOMIC_SEQ_CST);
+    i64 bottom = platform_atomic_load_i64(&queue->bottom, MATOMIC_ACQUIRE);
+    if (top >= bottom)
+    {
+        return 0;
+    }
+
+    job *j = platform_atomic_load_ptr(&queue->slots[top & JOB_QUEUE_MASK], MATOMIC_RELAXED);
+    if (!platform_atomic_compare_exchange_i64(&queue->top, &top, top + 1, MATOMIC_SEQ_CST))
+    {
+        // Lost to another thief or the owner.
+        return 0;
+    }
+    return j;
+}
+
+static b8 locked_queue_push(locked_queue *queue, job *j)
+{
+    platform_mutex_lock(&queue->mutex);
+    u32 count = (u32)platform_atomic_load_i32(&queue->count, MATOMIC_RELAXED);
+    if (count == JOB_QUEUE_CAPACITY)
+    {
+        platform_mutex_unlock(&queue->mutex);
+        return false;
+    }
+    queue->jobs[(queue->head + count) & JOB_QUEUE_MASK] = j;
+    platform_atomic_add_i32(&queue->count, 1, MATOMIC_RELEASE);
+    platform_mutex_unlock(&queue->mutex);
+    return true;
+}
+
+static job *locked_queue_pop(locked_queue *queue)
+{
+    // Avoid taking the lock when there is obviously nothing there.
+    if (platform_atomic_load_i32(&queue->count, MATOMIC_ACQUIRE) == 0)
+    {
+        return 0;
+    }
+
+    job *j = 0;
+    platform_mutex_lock(&queue->mutex);
+    if (platform_atomic_load_i32(&queue->count, MATOMIC_RELAXED) > 0)
+    {
+        j = queue->jobs[queue->head];
+        queue->head = (queue->head + 1) & JOB_QUEUE_MASK;
+        platform_atomic_add_i32(&queue->count, -1, MATOMIC_RELEASE);
+    }
+    platform_mutex_unlock(&queue->mutex);
+    return j;
+}
+
+static void wake_workers(u32 count)
+{
+    // Pairs with the fence in worker_thread, so either the worker sees the new job or this sees the worker sleeping.
+    platform_atomic_fence(MATOMIC_SEQ_CST);
+    i32 sleeping = platform_atomic_load_i32(&state_ptr->sleeping_count, MATOMIC_RELAXED);
+    for (i32 i = 0; i < sleeping && i < (i32)count; ++i)
+    {
+        platform_semaphore_signal(&state_ptr->wake);
+    }
+}
+
+static job_fiber *take_free_fiber()
+{
+    job_fiber *fiber = 0;
+    platform_mutex_lock(&state_ptr->fiber_mutex);
+    if (state_ptr->free_fiber_count > 0)
+    {
+        fiber = state_ptr->free_fibers[--state_ptr->free_fiber_count];
+    }
+    platform_mutex_unlock(&state_ptr->fiber_mutex);
+    return fiber;
+}
+
+static job_fiber *take_ready_fiber()
+{
+    if (platform_atomic_load_i32(&state_ptr->ready_fiber_count, MATOMIC_SEQ_CST) == 0)
+    {
+        return 0;
+    }
+
+    job_fiber *fiber = 0;
+    platform_mutex_lock(&state_ptr->fiber_mutex);
+    if (platform_atomic_load_i32(&state_ptr->ready_fiber_count, MATOMIC_RELAXED) > 0)
+    {
+        fiber = state_ptr->ready_fibers[state_ptr->ready_fiber_head];
+        state_ptr->ready_fiber_head = (state_ptr->ready_fiber_head + 1) % state_ptr->fiber_count;
+        platform_atomic_add_i32(&state_ptr->ready_fiber_count, -1, MATOMIC_RELEASE);
+    }
+    platform_mutex_unlock(&state_ptr->fiber_mutex);
+    return fiber;
+}
+
+static void push_ready_fiber(job_fiber *fiber)
+{
+    fiber->waiting_on = 0;
+    platform_mutex_lock(&state_ptr->fiber_mutex);
+    // Can't overflow, as there are only fiber_count fibers.
+    u32 count = (u32)platform_atomic_load_i32(&state_ptr->ready_fiber_count, MATOMIC_RELAXED);
+    state_ptr->ready_fibers[(state_ptr->ready_fiber_head + count) % state_ptr->fiber_count] = fiber;
+    platform_atomic_add_i32(&state_ptr->ready_fiber_count, 1, MATOMIC_SEQ_CST);
+    platform_mutex_unlock(&state_ptr->fiber_mutex);
+    wake_workers(1);
+}
+
+// Called on a fiber after every switch to it, to file away the fiber that was switched from.
+static void finish_fiber_switch()
+{
+    job_thread *self = get_current_thread();
+    job_fiber *previous = self->previous_fiber;
+    if (!previous)
+    {
+        return;
+    }
+    self->previous_fiber = 0;
+
+    job_counter *counter = previous->waiting_on;
+    if (!counter)
+    {
+        platform_mutex_lock(&state_ptr->fiber_mutex);
+        state_ptr->free_fibers[state_ptr->free_fiber_count++] = previous;
+        platform_mutex_unlock(&state_ptr->fiber_mutex);
+        return;
+    }
+
+    // Checked under the lock, like jobs waiting on a dependency.
+    platform_mutex_lock(&state_ptr->waiting_mutex);
+    b8 done = platform_atomic_load_i32(&counter->value, MATOMIC_ACQUIRE) == 0;
+    if (!done)
+    {
+        state_ptr->waiting_fibers[state_ptr->waiting_fiber_count++] = previous;
+    }
+    platform_mutex_unlock(&state_ptr->waiting_mutex);
+    if (done)
+    {
+        push_ready_fiber(previous);
+    }
+}
+
+// Switches the calling thread from its current fiber to another. Set the current fiber's
+// waiting_on first to suspend it, or leave it 0 to release it back to the pool.
+static void switch_to_fiber(job_fiber *to)
+{
+    job_thread *self = get_current_thread();
+    job_fiber *from = self->fiber;
+    self->previous_fiber = from;
+    self->fiber = to;
+    platform_fiber_switch(&from->fiber, &to->fiber);
+
+    // Resumed, maybe on a different thread.
+    finish_fiber_switch();
+}
+
+static job *find_job(job_thread *self)
+{
+    job *j = 0;
+    if (self)
+    {
+        j = queue_pop(&self->queue);
+        if (j)
+        {
+            return j;
+        }
+    }
+
+    if (self == &state_ptr->threads[0])
+    {
+        j = locked_queue_pop(&state_ptr->main_queue);
+        if (j)
+        {
+            return j;
+        }
+    }
+
+    j = locked_queue_pop(&state_ptr->shared_queue);
+    if (j)
+    {
+        return j;
+    }
+
+    // Steal, starting from a random thread so thieves spread out.
+    u32 start = 0;
+    if (self)
+    {
+        self->random_state = self->random_state * 1664525 + 1013904223;
+        start = self->random_state >> 16;
+    }
+    for (u32 i = 0; i < state_ptr->thread_count; ++i)
+    {
+        job_thread *victim = &state_ptr->threads[(start + i) % state_ptr->thread_count];
+        if (victim != self)
+        {
+            j = queue_steal(&victim->queue);
+            if (j)
+            {
+                return j;
+            }
+        }
+    }
+    return 0;
+}
+
+static void schedule(job *j);
+
+// Lets go of the one the last job of counter held, and if that takes it to zero, queues the jobs and
+// resumes the fibers which were waiting on it. Jobs added to the counter since then keep it above
+// zero, and the last of those releases the waiters instead. It is all done in one hold of the lock,
+// so anything checking the counter before it starts waiting either sees it above zero and is found
+// here, or sees zero, and the counter's owner can't reuse its address while waiters are matched.
+static void release_waiting(job_counter *counter)
+{
+    job *ready_storage[64];
+    job_fiber *ready_fiber_storage[64];
+    job **ready = ready_storage;
+    job_fiber **ready_fibers = ready_fiber_storage;
+    u32 ready_count = 0;
+    u32 ready_fiber_count = 0;
+
+    platform_mutex_lock(&state_ptr->waiting_mutex);
+    if (platform_atomic_add_i32(&counter->value, -1, MATOMIC_ACQ_REL) != 1)
+    {
+        platform_mutex_unlock(&state_ptr->waiting_mutex);
+        return;
+    }
+
+    // The counter must not be touched after this.
+    for (u32 i = 0; i < state_ptr->waiting_fiber_count; ++i)
+    {
+        ready_fiber_count += state_ptr->waiting_fibers[i]->waiting_on == counter;
+    }
+    for (u32 i = 0; i < state_ptr->waiting_count; ++i)
+    {
+        ready_count += state_ptr->waiting[i]->dependency == counter;
+    }
+    if (ready_fiber_count > 64)
+    {
+        ready_fibers = mallocate(sizeof(job_fiber *) * ready_fiber_count, MEMORY_TAG_JOB);
+    }
+    if (ready_count > 64)
+    {
+        ready = mallocate(sizeof(job *) * ready_count, MEMORY_TAG_JOB);
+    }
+
+    u32 found = 0;
+    for (u32 i = 0; i < state_ptr->waiting_fiber_count;)
+    {
+        if (state_ptr->waiting_fibers[i]->waiting_on != counter)
+        {
+            ++i;
+            continue;
+        }
+        ready_fibers[found++] = state_ptr->waiting_fibers[i];
+        state_ptr->waiting_fibers[i] = state_ptr->waiting_fibers[--state_ptr->waiting_fiber_count];
+    }
+    found = 0;
+    for (u32 i = 0; i < state_ptr->waiting_count;)
+    {
+        if (state_ptr->waiting[i]->dependency != counter)
+        {
+            ++i;
+            continue;
+        }
+        ready[found++] = state_ptr->waiting[i];
+        state_ptr->waiting[i] = state_ptr->waiting[--state_ptr->waiting_count];
+    }
+    platform_mutex_unlock(&state_ptr->waiting_mutex);
+
+    for (u32 i = 0; i < ready_fiber_count; ++i)
+    {
+        push_ready_fiber(ready_fibers[i]);
+    }
+    for (u32 i = 0; i < ready_count; ++i)
+    {
+        ready[i]->dependency = 0;
+        schedule(ready[i]);
+    }
+
+    if (ready_fibers != ready_fiber_storage)
+    {
+        mfree(ready_fibers, sizeof(job_fiber *) * ready_fiber_count, MEMORY_TAG_JOB);
+    }
+    if (ready != ready_storage)
+    {
+        mfree(ready, sizeof(job *) * ready_count, MEMORY_TAG_JOB);
+    }
+}
+
+static void execute(job *j)
+{
+    // Copy it out and free the slot before running, so a job which queues more jobs can't end up
+    // waiting on its own slot.
+    PFN_job_entry entry = j->entry;
+    void *params = j->params;
+    job_counter *counter = j->counter;
+    platform_atomic_store_i32(&j->in_use, 0, MATOMIC_RELEASE);
+
+    entry(params);
+
+    if (!counter)
+    {
+        return;
+    }
+
+    // The last job leaves the counter at one for release_waiting to take to zero.
+    i32 value = platform_atomic_load_i32(&counter->value, MATOMIC_ACQUIRE);
+    while (value > 1)
+    {
+        if (platform_atomic_compare_exchange_i32(&counter->value, &value, value - 1, MATOMIC_ACQ_REL))
+        {
+            return;
+        }
+    }
+    release_waiting(counter);
+}
+
+static void enqueue(job *j)
+{
+    if (j->flags & JOB_FLAG_MAIN_THREAD)
+    {
+        while (!locked_queue_push(&state_ptr->main_queue, j))
+        {
+            // Full, so help out until there is room.
+            job *other = find_job(get_current_thread());
+            if (other)
+            {
+                execute(other);
+            }
+            else
+            {
+                platform_cpu_relax();
+            }
+        }
+        return;
+    }
+
+    job_thread *self = get_current_thread();
+    if ((self && queue_push(&self->queue, j)) || locked_queue_push(&state_ptr->shared_queue, j))
+    {
+        wake_workers(1);
+        return;
+    }
+
+    // Every queue is full; run it now rather than drop it.
+    execute(j);
+}
+
+static void schedule(job *j)
+{
+    job_counter *dependency = j->dependency;
+    if (dependency && platform_atomic_load_i32(&dependency->value, MATOMIC_ACQUIRE) != 0)
+    {
+        // Checked again under the lock, since release_waiting scans under it after the counter reaches zero.
+        platform_mutex_lock(&state_ptr->waiting_mutex);
+        if (platform_atomic_load_i32(&dependency->value, MATOMIC_ACQUIRE) != 0 && state_ptr->waiting_count < JOB_MAX_WAITING)
+        {
+            state_ptr->waiting[state_ptr->waiting_count++] = j;
+            platform_mutex_unlock(&state_ptr->waiting_mutex);
+            return;
+        }
+        platform_mutex_unlock(&state_ptr->waiting_mutex);
+
+        // Too many jobs waiting, so wait for this one's dependency here instead.
+        job_system_wait(dependency);
+    }
+    enqueue(j);
+}
+
+// Takes the first free slot from next onwards, or 0 if every slot holds a queued job.
+static job *take_free_job(job *pool, u32 *next)
+{
+    for (u32 i = 0; i < JOB_QUEUE_CAPACITY; ++i)
+    {
+        job *j = &pool[(*next + i) & JOB_QUEUE_MASK];
+        if (!platform_atomic_load_i32(&j->in_use, MATOMIC_ACQUIRE))
+        {
+            *next += i + 1;
+            platform_atomic_store_i32(&j->in_use, 1, MATOMIC_RELAXED);
+            return j;
+        }
+    }
+    return 0;
+}
+
+static job *allocate_job()
+{
+    job_thread *self = get_current_thread();
+    if (self)
+    {
+        return take_free_job(self->pool, &self->next_job);
+    }
+
+    platform_mutex_lock(&state_ptr->shared_queue.mutex);
+    job *j = take_free_job(state_ptr->shared_pool, &state_ptr->shared_next_job);
+    platform_mutex_unlock(&state_ptr->shared_queue.mutex);
+    return j;
+}
+
+// Runs jobs, and resumes fibers whose wait is over, until the system shuts down.
+static void run_jobs()
+{
+    u32 idle_spins = 0;
+    while (platform_atomic_load_i32(&state_ptr->running, MATOMIC_ACQUIRE))
+    {
+        job_thread *self = get_current_thread();
+        if (self->fiber)
+        {
+            job_fiber *ready = take_ready_fiber();
+            if (ready)
+            {
+                // Nothing on this fiber's stack, so it goes back to the pool.
+                self->fiber->waiting_on = 0;
+                switch_to_fiber(ready);
+                idle_spins = 0;
+                continue;
+            }
+        }
+
+        job *j = find_job(self);
+        if (j)
+        {
+            execute(j);
+            idle_spins = 0;
+            continue;
+        }
+
+        if (++idle_spins < JOB_IDLE_SPIN_COUNT)
+        {
+            platform_cpu_relax();
+            continue;
+        }
+        idle_spins = 0;
+
+        // Announce going to sleep, then look once more so work queued in between is not missed.
+        platform_atomic_add_i32(&state_ptr->sleeping_count, 1, MATOMIC_SEQ_CST);
+        if (platform_atomic_load_i32(&state_ptr->ready_fiber_count, MATOMIC_SEQ_CST) > 0)
+        {
+            platform_atomic_add_i32(&state_ptr->sleeping_count, -1, MATOMIC_SEQ_CST);
+            continue;
+        }
+        j = find_job(self);
+        if (j)
+        {
+            platform_atomic_add_i32(&state_ptr->sleeping_count, -1, MATOMIC_SEQ_CST);
+            execute(j);
+            continue;
+        }
+        platform_semaphore_wait(&state_ptr->wake);
+        platform_atomic_add_i32(&state_ptr->sleeping_count, -1, MATOMIC_SEQ_CST);
+    }
+}
+
+static void fiber_entry(void *params)
+{
+    // Started by a switch like any other, so there may be a fiber to file away.
+    finish_fiber_switch();
+    run_jobs();
+
+    // Shutting down; give the thread back to worker_thread. This fiber is never resumed.
+    job_thread *self = get_current_thread();
+    platform_fiber_switch(&self->fiber->fiber, &self->thread_fiber);
+}
+
+static u32 worker_thread(void *params)
+{
+    job_thread *self = params;
+    current_thread = self;
+
+    job_fiber *fiber = state_ptr->fiber_count ? take_free_fiber() : 0;
+    if (fiber && platform_fiber_convert_thread(&self->thread_fiber))
+    {
+        // Jobs run on pooled fibers, so a job that waits can be put aside while this thread
+        // carries on with other work.
+        self->fiber = fiber;
+        platform_fiber_switch(&self->thread_fiber, &fiber->fiber);
+        platform_fiber_convert_back(&self->thread_fiber);
+    }
+    else
+    {
+        if (fiber)
+        {
+            platform_mutex_lock(&state_ptr->fiber_mutex);
+            state_ptr->free_fibers[state_ptr->free_fiber_count++] = fiber;
+            platform_mutex_unlock(&state_ptr->fiber_mutex);
+        }
+        run_jobs();
+    }
+
+    current_thread = 0;
+    return 0;
+}
+
+b8 job_system_initialise(u64 *memory_requirement, void *state, job_system_config config)
+{
+    *memory_requirement = sizeof(job_system_state);
+    if (state == 0)
+        return true;
+
+    state_ptr = state;
+    mzero_memory(state_ptr, sizeof(job_system_state));
+
+    u32 worker_count = config.worker_count;
+    b8 pin_workers = false;
+    if (worker_count == 0)
+    {
+        pin_workers = true;
+        i32 processor_count = platform_get_processor_count();
+        worker_count = processor_count > 1 ? (u32)(processor_count - 1) : 0;
+    }
+    if (worker_count > JOB_SYSTEM_MAX_WORKERS)
+    {
+        worker_count = JOB_SYSTEM_MAX_WORKERS;
+    }
+
+    if (!platform_semaphore_create(0, &state_ptr->wake) ||
+        !platform_mutex_create(&state_ptr->main_queue.mutex) ||
+        !platform_mutex_create(&state_ptr->shared_queue.mutex) ||
+        !platform_mutex_create(&state_ptr->waiting_mutex) ||
+        !platform_mutex_create(&state_ptr->fiber_mutex))
+    {
+        MERROR("job_system_initialise - failed to create synchronisation objects.");
+        return false;
+    }
+
+    u32 fibers_created = 0;
+    if (config.fiber_count > 0 && worker_count > 0)
+    {
+        // At least one each for the workers to start on, plus one to switch to when a job waits.
+        u32 fiber_count = config.fiber_count > worker_count + 1 ? config.fiber_count : worker_count + 1;
+        u64 stack_size = config.fiber_stack_size ? config.fiber_stack_size : JOB_DEFAULT_FIBER_STACK_SIZE;
+        state_ptr->fibers = mallocate(sizeof(job_fiber) * fiber_count, MEMORY_TAG_JOB);
+        state_ptr->free_fibers = mallocate(sizeof(job_fiber *) * fiber_count, MEMORY_TAG_JOB);
+        state_ptr->ready_fibers = mallocate(sizeof(job_fiber *) * fiber_count, MEMORY_TAG_JOB);
+        state_ptr->waiting_fibers = mallocate(sizeof(job_fiber *) * fiber_count, MEMORY_TAG_JOB);
+        state_ptr->fiber_count = fiber_count;
+        for (u32 i = 0; i < fiber_count; ++i)
+        {
+            if (!platform_fiber_create(stack_size, fiber_entry, &state_ptr->fibers[i], &state_ptr->fibers[i].fiber))
+            {
+                MWARN("job_system_initialise - failed to create fiber %u; continuing with %u.", i, i);
+                break;
+            }
+            state_ptr->free_fibers[state_ptr->free_fiber_count++] = &state_ptr->fibers[i];
+        }
+        fibers_created = state_ptr->free_fiber_count;
+    }
+
+    state_ptr->threads = mallocate(sizeof(job_thread) * (worker_count + 1), MEMORY_TAG_JOB);
+    for (u32 i = 0; i <= worker_count; ++i)
+    {
+        state_ptr->threads[i].random_state = i * 2654435761U + 1;
+    }
+
+    // The main thread takes part too. Threads which fail to start just leave an empty queue behind.
+    state_ptr->thread_count = worker_count + 1;
+    current_thread = &state_ptr->threads[0];
+    platform_atomic_store_i32(&state_ptr->running, true, MATOMIC_RELAXED);
+
+    for (u32 i = 1; i <= worker_count; ++i)
+    {
+        if (!platform_thread_create(worker_thread, &state_ptr->threads[i], &state_ptr->threads[i].thread))
+        {
+            MWARN("job_system_initialise - failed to start worker %u; continuing with %u.", i, i - 1);
+            break;
+        }
+        state_ptr->worker_count++;
+
+        char name[32];
+        string_format(name, "Job worker %u", i);
+        platform_thread_set_name(&state_ptr->threads[i].thread, name);
+        // One worker per processor, leaving processor 0 to the main thread, so workers don't get
+        // moved around between cores and lose their caches.
+        if (pin_workers)
+        {
+            platform_thread_set_affinity(&state_ptr->threads[i].thread, i);
+        }
+    }
+
+    MINFO("Job system initialised with %u workers and %u fibers.", state_ptr->worker_count, fibers_created);
+    return true;
+}
+
+void job_system_shutdown(void *state)
+{
+    if (!state_ptr)
+        return;
+
+    platform_atomic_store_i32(&state_ptr->running, false, MATOMIC_RELEASE);
+    for (u32 i = 0; i < state_ptr->worker_count; ++i)
+    {
+        platform_semaphore_signal(&state_ptr->wake);
+    }
+    for (u32 i = 1; i <= state_ptr->worker_count; ++i)
+    {
+        platform_thread_join(&state_ptr->threads[i].thread);
+    }
+
+    if (state_ptr->fiber_count > 0)
+    {
+        // Fibers still waiting are dropped along with their jobs.
+        for (u32 i = 0; i < state_ptr->fiber_count; ++i)
+        {
+            platform_fiber_destroy(&state_ptr->fibers[i].fiber);
+        }
+        mfree(state_ptr->fibers, sizeof(job_fiber) * state_ptr->fiber_count, MEMORY_TAG_JOB);
+        mfree(state_ptr->free_fibers, sizeof(job_fiber *) * state_ptr->fiber_count, MEMORY_TAG_JOB);
+        mfree(state_ptr->ready_fibers, sizeof(job_fiber *) * state_ptr->fiber_count, MEMORY_TAG_JOB);
+        mfree(state_ptr->waiting_fibers, sizeof(job_fiber *) * state_ptr->fiber_count, MEMORY_TAG_JOB);
+    }
+
+    mfree(state_ptr->threads, sizeof(job_thread) * state_ptr->thread_count, MEMORY_TAG_JOB);
+    platform_mutex_destroy(&state_ptr->fiber_mutex);
+    platform_mutex_destroy(&state_ptr->waiting_mutex);
+    platform_mutex_destroy(&state_ptr->shared_queue.mutex);
+    platform_mutex_destroy(&state_ptr->main_queue.mutex);
+    platform_semaphore_destroy(&state_ptr->wake);
+
+    current_thread = 0;
+    state_ptr = 0;
+}
+
+void job_system_update()
+{
+    if (!state_ptr)
+        return;
+
+    // Only the jobs queued so far, so a main thread job that queues another can't keep this going forever.
+    u32 count = platform_atomic_load_i32(&state_ptr->main_queue.count, MATOMIC_ACQUIRE);
+    for (u32 i = 0; i < count; ++i)
+    {
+        job *j = locked_queue_pop(&state_ptr->main_queue);
+        if (!j)
+        {
+            break;
+        }
+        execute(j);
+    }
+
+    // With no workers nothing else will run queued jobs.
+    if (state_ptr->worker_count == 0)
+    {
+        job *j;
+        while ((j = find_job(get_current_thread())))
+        {
+            execute(j);
+        }
+    }
+}
+
+void job_system_run_after(const job_desc *jobs, u32 count, job_counter *dependency, job_counter *counter)
+{
+    if (!state_ptr)
+    {
+        MERROR("job_system_run called before the job system was initialised.");
+        return;
+    }
+
+    if (counter)
+    {
+        platform_atomic_add_i32(&counter->value, (i32)count, MATOMIC_ACQ_REL);
+    }
+
+    for (u32 i = 0; i < count; ++i)
+    {
+        job *j = allocate_job();
+        while (!j)
+        {
+            // Out of job slots; help finish some off.
+            job *other = find_job(get_current_thread());
+            if (other)
+            {
+                execute(other);
+            }
+            else
+            {
+                platform_cpu_relax();
+            }
+            j = allocate_job();
+        }
+
+        j->entry = jobs[i].entry;
+        j->params = jobs[i].params;
+        j->flags = jobs[i].flags;
+        j->counter = counter;
+        j->dependency = dependency;
+        schedule(j);
+    }
+}
+
+void job_system_run(const job_desc *jobs, u32 count, job_counter *counter)
+{
+    job_system_run_after(jobs, count, 0, counter);
+}
+
+void job_system_wait(job_counter *counter)
+{
+    if (platform_atomic_load_i32(&counter->value, MATOMIC_ACQUIRE) == 0)
+    {
+        return;
+    }
+
+    job_thread *self = state_ptr ? get_current_thread() : 0;
+    if (self && self->fiber)
+    {
+        // Put this fiber aside until the counter reaches zero, and have the thread carry on with
+        // a fiber that is ready to continue, or a fresh one to run jobs on.
+        job_fiber *next = take_ready_fiber();
+        if (!next)
+        {
+            next = take_free_fiber();
+        }
+        if (next)
+        {
+            self->fiber->waiting_on = counter;
+            switch_to_fiber(next);
+            return;
+        }
+    }
+
+    // No fiber to switch to, i.e. on the main thread; run jobs here until it's done.
+    while (platform_atomic_load_i32(&counter->value, MATOMIC_ACQUIRE) != 0)
+    {
+        job *j = state_ptr ? find_job(get_current_thread()) : 0;
+        if (j)
+        {
+            execute(j);
+        }
+        else
+        {
+            platform_cpu_relax();
+        }
+    }
+}
+
+b8 job_counter_is_done(job_counter *counter)
+{
+    return platform_atomic_load_i32(&counter->value, MATOMIC_ACQUIRE) == 0;
+}
+
+u32 job_system_worker_count()
+{
+    return state_ptr ? state_ptr->worker_count : 0;
+}
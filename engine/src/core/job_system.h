@@ -0,0 +1,120 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/platform.h"
+
+// Maximum number of worker threads, not counting the main thread.
+#define JOB_SYSTEM_MAX_WORKERS 31
+
+// Maximum number of jobs each thread can have queued at once. Must be a power of two.
+#define JOB_QUEUE_CAPACITY 1024
+
+/**
+ * @brief The entry point of a job.
+ *
+ * @param params The params from the job's job_desc.
+ */
+typedef void (*PFN_job_entry)(void *params);
+
+typedef enum job_flags
+{
+    JOB_FLAG_NONE = 0x0,
+    // Only run on the main thread, from job_system_update or a main thread job_system_wait.
+    // For work that has to happen there, i.e. talking to the renderer.
+    JOB_FLAG_MAIN_THREAD = 0x1,
+} job_flags;
+
+typedef struct job_desc
+{
+    PFN_job_entry entry;
+    void *params;
+    job_flags flags;
+} job_desc;
+
+/**
+ * Counts outstanding jobs. Zero-initialise, pass to job_system_run, then either wait on it
+ * or pass it as the dependency of later jobs. Must stay alive until it reaches zero, which it only
+ * does once everything waiting on it has been released.
+ */
+typedef struct job_counter
+{
+    matomic_i32 value;
+} job_counter;
+
+typedef struct job_system_config
+{
+    // Number of worker threads. 0 uses one per processor, less one for the main thread, and pins
+    // each worker to its own processor.
+    u32 worker_count;
+    // Number of fibers for workers to run jobs on. A job which waits on a counter has its fiber put
+    // aside, and the worker carries on with other jobs on another fiber. 0 disables fibers, so
+    // waiting jobs run other jobs on top of themselves instead.
+    u32 fiber_count;
+    // Stack size of each fiber in bytes. 0 uses 256KiB.
+    u64 fiber_stack_size;
+} job_system_config;
+
+/**
+ * @brief Initialises the job system. Call twice; once with a null state to get required memory
+ * size, then a second time passing allocated memory to state.
+ *
+ * Each worker owns a queue it pushes to and pops from at the back, and steals from the front of
+ * other workers' queues when its own is empty, so threads only contend when they run out of work.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state Allocated block of memory.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 job_system_initialise(u64 *memory_requirement, void *state, job_system_config config);
+
+/**
+ * @brief Shuts the job system down, waiting for workers to finish the jobs they are running.
+ * Queued jobs which have not started are dropped.
+ */
+MAPI void job_system_shutdown(void *state);
+
+/**
+ * @brief Runs any jobs flagged JOB_FLAG_MAIN_THREAD which have been queued. Called once per frame
+ * by the application.
+ */
+MAPI void job_system_update();
+
+/**
+ * @brief Queues jobs to run. Can be called from jobs, as well as from any thread.
+ *
+ * @param jobs An array of job descriptions.
+ * @param count The number of jobs.
+ * @param counter Optional. Incremented by count now, and decremented as each job finishes.
+ */
+MAPI void job_system_run(const job_desc *jobs, u32 count, job_counter *counter);
+
+/**
+ * @brief Queues jobs which will not start until dependency reaches zero.
+ *
+ * @param jobs An array of job descriptions.
+ * @param count The number of jobs.
+ * @param dependency The counter to wait for, i.e. the counter of the jobs these depend on.
+ * @param counter Optional. Incremented by count now, and decremented as each job finishes.
+ */
+MAPI void job_system_run_after(const job_desc *jobs, u32 count, job_counter *dependency, job_counter *counter);
+
+/**
+ * @brief Waits for a counter to reach zero. Rather than blocking, the calling thread runs other
+ * jobs in the meantime. From a job on a worker with fibers, the job is suspended until the counter
+ * reaches zero, and may resume on a different worker; anywhere else, i.e. on the main thread, jobs
+ * are run on top of the caller until it is done.
+ *
+ * @param counter The counter to wait on.
+ */
+MAPI void job_system_wait(job_counter *counter);
+
+/**
+ * @brief Checks, without waiting, whether all of a counter's jobs have finished.
+ */
+MAPI b8 job_counter_is_done(job_counter *counter);
+
+/**
+ * @brief Gets the number of worker threads, not counting the main thread.
+ */
+MAPI u32 job_system_worker_count();
@@ -2,6 +2,7 @@
 #include "asserts.h"
 #include "mstring.h"
 #include "mmemory.h"
+#include "binary_log.h"
 
 #include "platform/platform.h"
 #include "platform/filesystem.h"
@@ -12,6 +13,12 @@
 typedef struct logger_system_state
 {
     file_handle log_file_handle;
+    b8 binary_mode;
+    // Opened lazily, the first time binary mode is enabled.
+    file_handle binary_file_handle;
+    binary_log_state binary;
+    // Jobs log from worker threads, so writes to the console and log files are serialised.
+    mmutex lock;
 } logger_system_state;
 
 static logger_system_state *state_ptr;
@@ -37,6 +44,7 @@ b8 logging_system_initialise(u64 *memory_requirement, void *state)
         return true;
     
     state_ptr = (logger_system_state *)state;
+    platform_mutex_create(&state_ptr->lock);
     
     // Create new / wipe existing console log file, then open it.
     if (!filesystem_open("console.log", FILE_MODE_WRITE, false, &state_ptr->log_file_handle))
@@ -45,34 +53,131 @@ b8 logging_system_initialise(u64 *memory_requirement, void *state)
         return false;
     }
     
+    state_ptr->binary_mode = false;
+    state_ptr->binary_file_handle.handle = 0;
+    state_ptr->binary_file_handle.is_valid = false;
+    logging_set_binary_mode(LOG_BINARY_ENABLED);
+    
     return true;
 }
 
 void shutdown_logging(void *state)
 {
-    // TODO(satvik): cleanup logging/write up queued entries.
+    if (state_ptr)
+    {
+        if (state_ptr->binary_file_handle.is_valid)
+        {
+            binary_log_flush(&state_ptr->binary);
+            filesystem_close(&state_ptr->binary_file_handle);
+        }
+        filesystem_close(&state_ptr->log_file_handle);
+        platform_mutex_destroy(&state_ptr->lock);
+    }
     
     state_ptr = 0;
 }
 
-void log_output(log_level level, const char *message, ...)
+void logging_set_binary_mode(b8 enabled)
+{
+    if (!state_ptr)
+        return;
+    
+    if (enabled && !state_ptr->binary_file_handle.is_valid)
+    {
+        // Create new / wipe existing binary log file, then open it.
+        if (!filesystem_open("console.mlog", FILE_MODE_WRITE, true, &state_ptr->binary_file_handle))
+        {
+            platform_console_write_error("ERROR: Unable to open console.mlog for writing.", LOG_LEVEL_ERROR);
+            return;
+        }
+        binary_log_begin(&state_ptr->binary, &state_ptr->binary_file_handle);
+    }
+    else if (!enabled && state_ptr->binary_file_handle.is_valid)
+    {
+        // Make sure nothing logged so far is lost when switching back to text.
+        binary_log_flush(&state_ptr->binary);
+    }
+    
+    state_ptr->binary_mode = enabled;
+}
+
+static const char *channel_names[LOG_CHANNEL_MAX] = {"GENERAL", "RENDERER", "TEXTURE", "MATERIAL", "PLATFORM", "EVENT"};
+
+// Renderer, texture and material logging is the noisiest, so only goes up to debug unless raised.
+u8 log_channel_levels[LOG_CHANNEL_MAX] = {
+    LOG_COMPILE_LEVEL,
+    LOG_COMPILE_LEVEL < LOG_LEVEL_DEBUG ? LOG_COMPILE_LEVEL : LOG_LEVEL_DEBUG,
+    LOG_COMPILE_LEVEL < LOG_LEVEL_DEBUG ? LOG_COMPILE_LEVEL : LOG_LEVEL_DEBUG,
+    LOG_COMPILE_LEVEL < LOG_LEVEL_DEBUG ? LOG_COMPILE_LEVEL : LOG_LEVEL_DEBUG,
+    LOG_COMPILE_LEVEL,
+    LOG_COMPILE_LEVEL,
+};
+
+void logging_set_channel_level(log_channel channel, log_level level)
+{
+    if (channel >= LOG_CHANNEL_MAX)
+        return;
+    
+    log_channel_levels[channel] = (u8)level;
+}
+
+const char *logging_channel_name(log_channel channel)
+{
+    if (channel >= LOG_CHANNEL_MAX)
+        return "UNKNOWN";
+    
+    return channel_names[channel];
+}
+
+static void log_output_v(log_channel channel, log_level level, const char *message, __builtin_va_list args)
 {
     const char *level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
     b8 is_error = level < LOG_LEVEL_WARN;
     
+    if (state_ptr && state_ptr->binary_mode)
+    {
+        // Store the raw arguments; formatting happens offline in the decodelog tool.
+        __builtin_va_list binary_args;
+        va_copy(binary_args, args);
+        platform_mutex_lock(&state_ptr->lock);
+        binary_log_write(&state_ptr->binary, channel, level, message, binary_args);
+        
+        if (level <= LOG_LEVEL_ERROR)
+        {
+            // Don't lose the entries leading up to an error if the application goes down.
+            binary_log_flush(&state_ptr->binary);
+        }
+        platform_mutex_unlock(&state_ptr->lock);
+        va_end(binary_args);
+        
+        if (level > LOG_LEVEL_WARN)
+        {
+            return;
+        }
+    }
+    
     // Technically imposes a 32k character limit on a single entry, but...
     // DON'T DO THAT
     char out_message[32000];
     mzero_memory(out_message, sizeof(out_message));
     
     // Format original message.
-    __builtin_va_list arg_ptr;
-    va_start(arg_ptr, message);
-    string_format_v(out_message, message, arg_ptr);
-    va_end(arg_ptr);
+    string_format_v(out_message, message, args);
+    
+    // Prepend log level and channel to message.
+    if (channel == LOG_CHANNEL_GENERAL)
+    {
+        string_format(out_message, "%s%s\n", level_strings[level], out_message);
+    }
+    else
+    {
+        string_format(out_message, "%s[%s] %s\n", level_strings[level], logging_channel_name(channel), out_message);
+    }
     
-    // Prepend log level to message.
-    string_format(out_message, "%s%s\n", level_strings[level], out_message);
+    if (state_ptr)
+    {
+        platform_mutex_lock(&state_ptr->lock);
+    }
     
     // Platform-specific output
     if (is_error)
@@ -84,8 +189,32 @@ void log_output(log_level level, const char *message, ...)
         platform_console_write(out_message, level);
     }
     
-    // Queue a copy to be written out to the log file.
-    append_to_log_file(out_message);
+    // Queue a copy to be written out to the log file. In binary mode it is already in console.mlog.
+    if (!state_ptr || !state_ptr->binary_mode)
+    {
+        append_to_log_file(out_message);
+    }
+    
+    if (state_ptr)
+    {
+        platform_mutex_unlock(&state_ptr->lock);
+    }
+}
+
+void log_output(log_level level, const char *message, ...)
+{
+    __builtin_va_list arg_ptr;
+    va_start(arg_ptr, message);
+    log_output_v(LOG_CHANNEL_GENERAL, level, message, arg_ptr);
+    va_end(arg_ptr);
+}
+
+void log_output_channel(log_channel channel, log_level level, const char *message, ...)
+{
+    __builtin_va_list arg_ptr;
+    va_start(arg_ptr, message);
+    log_output_v(channel, level, message, arg_ptr);
+    va_end(arg_ptr);
 }
 
 void report_assertion_failure(const char *expression, const char *message, const char *file, i32 line)
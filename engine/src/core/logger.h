@@ -2,15 +2,30 @@
 
 #include "defines.h"
 
-#define LOG_WARN_ENABLED 1
-#define LOG_INFO_ENABLED 1
-#define LOG_DEBUG_ENABLED 1
-#define LOG_TRACE_ENABLED 1
+// Entries above this level are compiled out entirely. Defaults to DEBUG (4) in release builds,
+// where binary logging keeps it cheap, and TRACE (5) otherwise.
+// Levels: FATAL = 0, ERROR = 1, WARN = 2, INFO = 3, DEBUG = 4, TRACE = 5.
+#ifndef LOG_COMPILE_LEVEL
+#if MRELEASE == 1
+#define LOG_COMPILE_LEVEL 4
+#else
+#define LOG_COMPILE_LEVEL 5
+#endif
+#endif
+
+#define LOG_WARN_ENABLED (LOG_COMPILE_LEVEL >= 2)
+#define LOG_INFO_ENABLED (LOG_COMPILE_LEVEL >= 3)
+#define LOG_DEBUG_ENABLED (LOG_COMPILE_LEVEL >= 4)
+#define LOG_TRACE_ENABLED (LOG_COMPILE_LEVEL >= 5)
 
-// Disable debug and trace logging for release builds.
+// Whether entries are written to console.mlog in binary form by default, deferring formatting
+// to the decodelog tool. Warnings and above are still formatted and written to the console.
+#ifndef LOG_BINARY_ENABLED
 #if MRELEASE == 1
-#define LOG_DEBUG_ENABLED 0
-#define LOG_TRACE_ENABLED 0
+#define LOG_BINARY_ENABLED 1
+#else
+#define LOG_BINARY_ENABLED 0
+#endif
 #endif
 
 typedef enum log_level
@@ -23,6 +38,22 @@ typedef enum log_level
     LOG_LEVEL_TRACE = 5,
 } log_level;
 
+typedef enum log_channel
+{
+    LOG_CHANNEL_GENERAL = 0,
+    LOG_CHANNEL_RENDERER = 1,
+    LOG_CHANNEL_TEXTURE = 2,
+    LOG_CHANNEL_MATERIAL = 3,
+    LOG_CHANNEL_PLATFORM = 4,
+    LOG_CHANNEL_EVENT = 5,
+    
+    LOG_CHANNEL_MAX
+} log_channel;
+
+// The runtime level of each channel. Entries above their channel's level are skipped before
+// their arguments are evaluated. Use logging_set_channel_level to change these.
+MAPI extern u8 log_channel_levels[LOG_CHANNEL_MAX];
+
 /**
  * @brief Initialises logging system. Call twice; once with a null state to get required memory size,
  * then a second time passing allocated memory to state.
@@ -35,43 +66,94 @@ b8 logging_system_initialise(u64 *memory_requirement, void *state);
 void shutdown_logging(void *state);
 
 MAPI void log_output(log_level level, const char *message, ...);
+MAPI void log_output_channel(log_channel channel, log_level level, const char *message, ...);
 
-// Logs a fatal-level message
-#define MFATAL(message, ...) log_output(LOG_LEVEL_FATAL, message, ##__VA_ARGS__);
+/**
+ * @brief Sets the most verbose level logged on the provided channel at runtime. Levels compiled
+ * out with LOG_COMPILE_LEVEL cannot be re-enabled.
+ *
+ * @param channel The channel to adjust.
+ * @param level The most verbose level to log.
+ */
+MAPI void logging_set_channel_level(log_channel channel, log_level level);
 
-#ifndef MERROR
-// Logs an error-level message
-#define MERROR(message, ...) log_output(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
-#endif
+/**
+ * @brief Gets the name of the provided channel, i.e. "RENDERER".
+ */
+MAPI const char *logging_channel_name(log_channel channel);
+
+/**
+ * @brief Switches between binary logging to console.mlog and text logging to console.log.
+ * In binary mode, only warnings and above are formatted and written to the console.
+ *
+ * @param enabled True to enable binary logging; false to disable it.
+ */
+MAPI void logging_set_binary_mode(b8 enabled);
+
+// Logs on the provided channel if its runtime level allows. Arguments are not evaluated otherwise.
+#define MLOG_CHANNEL(channel, level, message, ...)                      \
+    do                                                                  \
+    {                                                                   \
+        if ((level) <= log_channel_levels[channel])                     \
+        {                                                               \
+            log_output_channel(channel, level, message, ##__VA_ARGS__); \
+        }                                                               \
+    } while (0)
+
+// Logs a fatal-level message on the provided channel
+#define MFATAL_CH(channel, message, ...) MLOG_CHANNEL(channel, LOG_LEVEL_FATAL, message, ##__VA_ARGS__)
+
+// Logs an error-level message on the provided channel
+#define MERROR_CH(channel, message, ...) MLOG_CHANNEL(channel, LOG_LEVEL_ERROR, message, ##__VA_ARGS__)
 
 #if LOG_WARN_ENABLED == 1
-// Logs an warning-level message
-#define MWARN(message, ...) log_output(LOG_LEVEL_WARN, message, ##__VA_ARGS__);
+// Logs an warning-level message on the provided channel
+#define MWARN_CH(channel, message, ...) MLOG_CHANNEL(channel, LOG_LEVEL_WARN, message, ##__VA_ARGS__)
 #else
 // Does nothing when LOG_WARN_ENABLED != 1
-#define MWARN(message, ...)
+#define MWARN_CH(channel, message, ...)
 #endif
 
 #if LOG_INFO_ENABLED == 1
-// Logs an info-level message
-#define MINFO(message, ...) log_output(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
+// Logs an info-level message on the provided channel
+#define MINFO_CH(channel, message, ...) MLOG_CHANNEL(channel, LOG_LEVEL_INFO, message, ##__VA_ARGS__)
 #else
 // Does nothing when LOG_INFO_ENABLED != 1
-#define MINFO(message, ...)
+#define MINFO_CH(channel, message, ...)
 #endif
 
 #if LOG_DEBUG_ENABLED == 1
-// Logs an debug-level message
-#define MDEBUG(message, ...) log_output(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+// Logs an debug-level message on the provided channel
+#define MDEBUG_CH(channel, message, ...) MLOG_CHANNEL(channel, LOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
 #else
 // Does nothing when LOG_DEBUG_ENABLED != 1
-#define MDEBUG(message, ...)
+#define MDEBUG_CH(channel, message, ...)
 #endif
 
 #if LOG_TRACE_ENABLED == 1
-// Logs an trace-level message
-#define MTRACE(message, ...) log_output(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+// Logs an trace-level message on the provided channel
+#define MTRACE_CH(channel, message, ...) MLOG_CHANNEL(channel, LOG_LEVEL_TRACE, message, ##__VA_ARGS__)
 #else
 // Does nothing when LOG_TRACE_ENABLED != 1
-#define MTRACE(message, ...)
+#define MTRACE_CH(channel, message, ...)
 #endif
+
+// Logs a fatal-level message
+#define MFATAL(message, ...) MFATAL_CH(LOG_CHANNEL_GENERAL, message, ##__VA_ARGS__)
+
+#ifndef MERROR
+// Logs an error-level message
+#define MERROR(message, ...) MERROR_CH(LOG_CHANNEL_GENERAL, message, ##__VA_ARGS__)
+#endif
+
+// Logs an warning-level message
+#define MWARN(message, ...) MWARN_CH(LOG_CHANNEL_GENERAL, message, ##__VA_ARGS__)
+
+// Logs an info-level message
+#define MINFO(message, ...) MINFO_CH(LOG_CHANNEL_GENERAL, message, ##__VA_ARGS__)
+
+// Logs an debug-level message
+#define MDEBUG(message, ...) MDEBUG_CH(LOG_CHANNEL_GENERAL, message, ##__VA_ARGS__)
+
+// Logs an trace-level message
+#define MTRACE(message, ...) MTRACE_CH(LOG_CHANNEL_GENERAL, message, ##__VA_ARGS__)
@@ -8,16 +8,17 @@
 #include <string.h>
 #include <stdio.h>
 
+// Atomic, since jobs allocate from worker threads.
 struct memory_stats
 {
-    u64 total_allocated;
-    u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];
+    matomic_i64 total_allocated;
+    matomic_i64 tagged_allocations[MEMORY_TAG_MAX_TAGS];
 } memory_stats;
 
 typedef struct memory_system_state
 {
     struct memory_stats stats;
-    u64 alloc_count;
+    matomic_i64 alloc_count;
 } memory_system_state;
 
 static memory_system_state *state_ptr;
@@ -41,6 +42,7 @@ static const char *memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "ENTITY     ",
     "ENTITY_NODE",
     "SCENE      ",
+    "RESOURCE   ",
 };
 
 void memory_system_initialise(u64 *memory_requirements, void *state)
@@ -50,8 +52,7 @@ void memory_system_initialise(u64 *memory_requirements, void *state)
         return;
     
     state_ptr = state;
-    state_ptr->alloc_count = 0;
-    platform_zero_memory(&state_ptr->stats, sizeof(state_ptr->stats));
+    platform_zero_memory(state_ptr, sizeof(memory_system_state));
 }
 
 void memory_system_shutdown(void *state)
@@ -68,9 +69,9 @@ void *mallocate(u64 size, memory_tag tag)
     
     if (state_ptr)
     {
-        state_ptr->stats.total_allocated += size;
-        state_ptr->stats.tagged_allocations[tag] += size;
-        state_ptr->alloc_count++;
+        platform_atomic_add_i64(&state_ptr->stats.total_allocated, (i64)size, MATOMIC_RELAXED);
+        platform_atomic_add_i64(&state_ptr->stats.tagged_allocations[tag], (i64)size, MATOMIC_RELAXED);
+        platform_atomic_add_i64(&state_ptr->alloc_count, 1, MATOMIC_RELAXED);
     }
     
     // TODO(satvik): memory alignment.
@@ -88,8 +89,8 @@ void mfree(void *block, u64 size, memory_tag tag)
     
     if (state_ptr)
     {
-        state_ptr->stats.total_allocated -= size;
-        state_ptr->stats.tagged_allocations[tag] -= size;
+        platform_atomic_add_i64(&state_ptr->stats.total_allocated, -(i64)size, MATOMIC_RELAXED);
+        platform_atomic_add_i64(&state_ptr->stats.tagged_allocations[tag], -(i64)size, MATOMIC_RELAXED);
     }
     
     // TODO(satvik): memory alignment.
@@ -121,28 +122,29 @@ char *get_memory_use_str()
     u64 offset = string_length(buffer);
     for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i)
     {
+        u64 allocated = (u64)platform_atomic_load_i64(&state_ptr->stats.tagged_allocations[i], MATOMIC_RELAXED);
         char unit[4] = "Xib";
         float amount = 1.0f;
-        if (state_ptr->stats.tagged_allocations[i] >= gib)
+        if (allocated >= gib)
         {
             unit[0] = 'G';
-            amount = state_ptr->stats.tagged_allocations[i] / (float)gib;
+            amount = allocated / (float)gib;
         }
-        else if (state_ptr->stats.tagged_allocations[i] >= mib)
+        else if (allocated >= mib)
         {
             unit[0] = 'M';
-            amount = state_ptr->stats.tagged_allocations[i] / (float)mib;
+            amount = allocated / (float)mib;
         }
-        else if (state_ptr->stats.tagged_allocations[i] >= kib)
+        else if (allocated >= kib)
         {
             unit[0] = 'K';
-            amount = state_ptr->stats.tagged_allocations[i] / (float)kib;
+            amount = allocated / (float)kib;
         }
         else
         {
             unit[0] = 'B';
             unit[1] = 0;
-            amount = (float)state_ptr->stats.tagged_allocations[i];
+            amount = (float)allocated;
         }
         
         i32 length = snprintf(buffer + offset, 8000, " %s: %.2f%s\n", memory_tag_strings[i], amount, unit);
@@ -155,7 +157,7 @@ char *get_memory_use_str()
 u64 get_memory_alloc_count()
 {
     if (state_ptr)
-        return state_ptr->alloc_count;
+        return (u64)platform_atomic_load_i64(&state_ptr->alloc_count, MATOMIC_RELAXED);
     
     return 0;
 }
\ No newline at end of file
@@ -274,4 +274,26 @@ b8 string_to_bool(char *str, b8 *b)
     if (!str) return false;
     
     return strings_equal(str, "1") || strings_equali(str, "true");
-}
\ No newline at end of file
+}
+
+b8 string_view_equali(string_view view, const char *str)
+{
+    for (u64 i = 0; i < view.length; ++i)
+    {
+        if (!str[i] || tolower((unsigned char)view.str[i]) != tolower((unsigned char)str[i]))
+        {
+            return false;
+        }
+    }
+    return str[view.length] == 0;
+}
+
+u64 string_view_copy(char *dest, string_view view, u64 dest_size)
+{
+    if (dest_size == 0) return 0;
+    
+    u64 length = view.length < dest_size - 1 ? view.length : dest_size - 1;
+    mcopy_memory(dest, view.str, length);
+    dest[length] = 0;
+    return length;
+}
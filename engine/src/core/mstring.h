@@ -56,4 +56,24 @@ MAPI b8 string_to_u16(char *str, u16 *u);
 MAPI b8 string_to_u32(char *str, u32 *u);
 MAPI b8 string_to_u64(char *str, u64 *u);
 
-MAPI b8 string_to_bool(char *str, b8 *b);
\ No newline at end of file
+MAPI b8 string_to_bool(char *str, b8 *b);
+
+// A non-owning view of a run of characters. Not null-terminated.
+typedef struct string_view
+{
+    const char *str;
+    u64 length;
+} string_view;
+
+// Case-insensitive comparison of a view against a null-terminated string. True if the same, otherwise false.
+MAPI b8 string_view_equali(string_view view, const char *str);
+
+/**
+ * @brief Copies a view into dest as a null-terminated string, truncating it if it doesn't fit.
+ * 
+ * @param dest The destination buffer.
+ * @param view The view to copy.
+ * @param dest_size The size of dest in bytes, including room for the terminator.
+ * @return The number of characters copied, excluding the terminator.
+ */
+MAPI u64 string_view_copy(char *dest, string_view view, u64 dest_size);
@@ -113,5 +113,5 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #define MNOINLINE __declspec(noinline)
 #else
 #define MINLINE static inline
-#define MNOINLINE 
+#define MNOINLINE __attribute__((noinline))
 #endif
\ No newline at end of file
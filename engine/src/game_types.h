@@ -14,11 +14,13 @@ typedef struct game
     // Function pointer to game's initialise function.
     b8 (*initialise)(struct game *game_inst);
     
-    // Function pointer to game's update function.
+    // Function pointer to game's update function. With an update_rate this is called that many times
+    // a second, however many frames that takes, and delta_time is always one step long.
     b8 (*update)(struct game *game_inst, f32 delta_time);
     
-    // Function pointer to game's render function.
-    b8 (*render)(struct game *game_inst, f32 delta_time);
+    // Function pointer to game's render function, called once per frame. alpha is how far the frame is
+    // between the last update and the next, from 0 to 1, for blending the previous and current states.
+    b8 (*render)(struct game *game_inst, f32 delta_time, f32 alpha);
     
     // Function pointer to handle resizes, if applicable.
     void (*on_resize)(struct game *game_inst, u32 width, u32 height);
@@ -570,6 +570,22 @@ MINLINE f32 vec3_distance(vec3 vector_0, vec3 vector_1)
     return vec3_length(d);
 }
 
+/**
+ * @brief Linearly interpolates between vector_0 and vector_1.
+ * 
+ * @param vector_0 The vector at t = 0.
+ * @param vector_1 The vector at t = 1.
+ * @param t How far from vector_0 to vector_1.
+ * @return The interpolated vector.
+ */
+MINLINE vec3 vec3_lerp(vec3 vector_0, vec3 vector_1, f32 t)
+{
+    return (vec3){
+        vector_0.x + (vector_1.x - vector_0.x) * t,
+        vector_0.y + (vector_1.y - vector_0.y) * t,
+        vector_0.z + (vector_1.z - vector_0.z) * t};
+}
+
 // ------------------------------------------
 // Vector 4
 // ------------------------------------------
@@ -0,0 +1,686 @@
+#include "async_io.h"
+
+#include "core/logger.h"
+#include "core/mmemory.h"
+#include "core/mstring.h"
+#include "platform/platform.h"
+
+#include <stdio.h>
+
+#if MPLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define ASYNC_IO_URING_AVAILABLE 1
+#endif
+#endif
+
+#define ASYNC_IO_MAX_WORKERS 8
+
+typedef enum async_io_request_status
+{
+    ASYNC_IO_REQUEST_FREE,
+    // Waiting for the next async_io_update to submit it.
+    ASYNC_IO_REQUEST_QUEUED,
+    ASYNC_IO_REQUEST_IN_FLIGHT,
+    ASYNC_IO_REQUEST_COMPLETE,
+} async_io_request_status;
+
+typedef struct async_io_request
+{
+    async_io_request_status status;
+    char path[ASYNC_IO_MAX_PATH_LENGTH];
+    PFN_async_io_on_complete on_complete;
+    void *user_data;
+
+    b8 success;
+    // Allocated with platform_allocate, since workers fill it in off the main thread.
+    u8 *data;
+    u64 size;
+
+#if ASYNC_IO_URING_AVAILABLE
+    int fd;
+    u64 bytes_read;
+    struct iovec iov;
+#endif
+} async_io_request;
+
+// A fixed-size ring of request indices.
+typedef struct request_queue
+{
+    u32 head;
+    u32 count;
+    u32 indices[ASYNC_IO_MAX_REQUESTS];
+} request_queue;
+
+#if ASYNC_IO_URING_AVAILABLE
+typedef struct io_uring_state
+{
+    int fd;
+    void *sq_ring;
+    u64 sq_ring_size;
+    void *cq_ring;
+    u64 cq_ring_size;
+    struct io_uring_sqe *sqes;
+    u64 sqes_size;
+
+    u32 *sq_head;
+    u32 *sq_tail;
+    u32 sq_mask;
+    u32 sq_entries;
+    u32 *sq_array;
+
+    u32 *cq_head;
+    u32 *cq_tail;
+    u32 cq_mask;
+    struct io_uring_cqe *cqes;
+} io_uring_state;
+#endif
+
+typedef struct async_io_state
+{
+    async_io_config config;
+    u32 pending_count;
+    async_io_request requests[ASYNC_IO_MAX_REQUESTS];
+
+    // Main thread only.
+    request_queue submit_queue;
+
+    b8 use_uring;
+#if ASYNC_IO_URING_AVAILABLE
+    io_uring_state uring;
+#endif
+
+    // Thread pool fallback.
+    u32 worker_count;
+    mthread workers[ASYNC_IO_MAX_WORKERS];
+    b8 shutting_down;
+    mmutex queue_mutex;
+    msemaphore work_semaphore;
+    request_queue work_queue;
+    request_queue complete_queue;
+} async_io_state;
+
+static async_io_state *state_ptr;
+
+static void queue_push(request_queue *queue, u32 index)
+{
+    queue->indices[(queue->head + queue->count) % ASYNC_IO_MAX_REQUESTS] = index;
+    queue->count++;
+}
+
+static u32 queue_pop(request_queue *queue)
+{
+    u32 index = queue->indices[queue->head];
+    queue->head = (queue->head + 1) % ASYNC_IO_MAX_REQUESTS;
+    queue->count--;
+    return index;
+}
+
+// Reads a whole file with stdio. Runs on worker threads, so must not log or use the tracked allocator.
+static void read_file_blocking(async_io_request *request)
+{
+    request->success = false;
+    request->data = 0;
+    request->size = 0;
+
+    FILE *file = fopen(request->path, "rb");
+    if (!file)
+    {
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    if (size < 0)
+    {
+        fclose(file);
+        return;
+    }
+
+    if (size > 0)
+    {
+        request->data = platform_allocate((u64)size, false);
+        if (fread(request->data, 1, (u64)size, file) != (u64)size)
+        {
+            platform_free(request->data, false);
+            request->data = 0;
+            fclose(file);
+            return;
+        }
+    }
+    request->size = (u64)size;
+    request->success = true;
+    fclose(file);
+}
+
+static u32 worker_thread(void *params)
+{
+    async_io_state *state = params;
+    while (true)
+    {
+        platform_semaphore_wait(&state->work_semaphore);
+
+        platform_mutex_lock(&state->queue_mutex);
+        if (state->work_queue.count == 0)
+        {
+            // Only woken without work when shutting down.
+            b8 exit = state->shutting_down;
+            platform_mutex_unlock(&state->queue_mutex);
+            if (exit)
+            {
+                return 0;
+            }
+            continue;
+        }
+        u32 index = queue_pop(&state->work_queue);
+        platform_mutex_unlock(&state->queue_mutex);
+
+        read_file_blocking(&state->requests[index]);
+
+        platform_mutex_lock(&state->queue_mutex);
+        queue_push(&state->complete_queue, index);
+        platform_mutex_unlock(&state->queue_mutex);
+    }
+}
+
+static b8 thread_pool_initialise(async_io_state *state)
+{
+    u32 worker_count = state->config.worker_count;
+    if (worker_count == 0)
+    {
+        // Reads spend most of their time blocked, so a few threads go a long way.
+        i32 processors = platform_get_processor_count();
+        worker_count = processors > 2 ? (u32)(processors / 2) : 1;
+    }
+    if (worker_count > ASYNC_IO_MAX_WORKERS)
+    {
+        worker_count = ASYNC_IO_MAX_WORKERS;
+    }
+
+    if (!platform_mutex_create(&state->queue_mutex) || !platform_semaphore_create(0, &state->work_semaphore))
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "async_io: failed to create thread pool synchronisation objects.");
+        return false;
+    }
+
+    state->shutting_down = false;
+    state->worker_count = 0;
+    for (u32 i = 0; i < worker_count; ++i)
+    {
+        if (!platform_thread_create(worker_thread, state, &state->workers[i]))
+        {
+            MERROR_CH(LOG_CHANNEL_PLATFORM, "async_io: failed to create worker thread %u.", i);
+            break;
+        }
+        state->worker_count++;
+        platform_thread_set_name(&state->workers[i], "Async I/O worker");
+    }
+
+    if (state->worker_count == 0)
+    {
+        platform_semaphore_destroy(&state->work_semaphore);
+        platform_mutex_destroy(&state->queue_mutex);
+        return false;
+    }
+
+    MINFO_CH(LOG_CHANNEL_PLATFORM, "async_io: using thread pool with %u workers.", state->worker_count);
+    return true;
+}
+
+static void thread_pool_shutdown(async_io_state *state)
+{
+    platform_mutex_lock(&state->queue_mutex);
+    state->shutting_down = true;
+    platform_mutex_unlock(&state->queue_mutex);
+
+    // Wake every worker. Each exits once the queue is drained.
+    for (u32 i = 0; i < state->worker_count; ++i)
+    {
+        platform_semaphore_signal(&state->work_semaphore);
+    }
+    for (u32 i = 0; i < state->worker_count; ++i)
+    {
+        platform_thread_join(&state->workers[i]);
+    }
+    state->worker_count = 0;
+
+    platform_semaphore_destroy(&state->work_semaphore);
+    platform_mutex_destroy(&state->queue_mutex);
+}
+
+#if ASYNC_IO_URING_AVAILABLE
+static b8 uring_initialise(io_uring_state *uring)
+{
+    struct io_uring_params params;
+    mzero_memory(&params, sizeof(params));
+
+    uring->fd = (int)syscall(__NR_io_uring_setup, ASYNC_IO_MAX_REQUESTS, &params);
+    if (uring->fd < 0)
+    {
+        // Not supported by this kernel, or blocked by a sandbox.
+        return false;
+    }
+
+    uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+    uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    b8 single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap)
+    {
+        if (uring->cq_ring_size > uring->sq_ring_size)
+        {
+            uring->sq_ring_size = uring->cq_ring_size;
+        }
+        uring->cq_ring_size = uring->sq_ring_size;
+    }
+
+    uring->sq_ring = mmap(0, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+    if (uring->sq_ring == MAP_FAILED)
+    {
+        close(uring->fd);
+        return false;
+    }
+
+    if (single_mmap)
+    {
+        uring->cq_ring = uring->sq_ring;
+    }
+    else
+    {
+        uring->cq_ring = mmap(0, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+        if (uring->cq_ring == MAP_FAILED)
+        {
+            munmap(uring->sq_ring, uring->sq_ring_size);
+            close(uring->fd);
+            return false;
+        }
+    }
+
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(0, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED)
+    {
+        if (!single_mmap)
+        {
+            munmap(uring->cq_ring, uring->cq_ring_size);
+        }
+        munmap(uring->sq_ring, uring->sq_ring_size);
+        close(uring->fd);
+        return false;
+    }
+
+    u8 *sq = uring->sq_ring;
+    uring->sq_head = (u32 *)(sq + params.sq_off.head);
+    uring->sq_tail = (u32 *)(sq + params.sq_off.tail);
+    uring->sq_mask = *(u32 *)(sq + params.sq_off.ring_mask);
+    uring->sq_entries = *(u32 *)(sq + params.sq_off.ring_entries);
+    uring->sq_array = (u32 *)(sq + params.sq_off.array);
+
+    u8 *cq = uring->cq_ring;
+    uring->cq_head = (u32 *)(cq + params.cq_off.head);
+    uring->cq_tail = (u32 *)(cq + params.cq_off.tail);
+    uring->cq_mask = *(u32 *)(cq + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    MINFO_CH(LOG_CHANNEL_PLATFORM, "async_io: using io_uring with %u entries.", uring->sq_entries);
+    return true;
+}
+
+static void uring_shutdown(io_uring_state *uring)
+{
+    munmap(uring->sqes, uring->sqes_size);
+    if (uring->cq_ring != uring->sq_ring)
+    {
+        munmap(uring->cq_ring, uring->cq_ring_size);
+    }
+    munmap(uring->sq_ring, uring->sq_ring_size);
+    close(uring->fd);
+}
+
+// Queues a read of the rest of the request's file. Returns false if the submission queue is full.
+static b8 uring_queue_read(io_uring_state *uring, u32 index, async_io_request *request)
+{
+    u32 tail = *uring->sq_tail;
+    u32 head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= uring->sq_entries)
+    {
+        return false;
+    }
+
+    request->iov.iov_base = request->data + request->bytes_read;
+    request->iov.iov_len = request->size - request->bytes_read;
+
+    u32 slot = tail & uring->sq_mask;
+    struct io_uring_sqe *sqe = &uring->sqes[slot];
+    mzero_memory(sqe, sizeof(struct io_uring_sqe));
+    // READV rather than READ, as it is supported back to the first io_uring kernels.
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = request->fd;
+    sqe->off = request->bytes_read;
+    sqe->addr = (u64)&request->iov;
+    sqe->len = 1;
+    sqe->user_data = index;
+
+    uring->sq_array[slot] = slot;
+    __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void uring_submit(io_uring_state *uring)
+{
+    u32 to_submit = *uring->sq_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+    while (to_submit > 0)
+    {
+        int submitted = (int)syscall(__NR_io_uring_enter, uring->fd, to_submit, 0, 0, 0, 0);
+        if (submitted < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // Try again next update.
+            return;
+        }
+        to_submit -= (u32)submitted;
+    }
+}
+
+static void complete_request(async_io_request *request, b8 success)
+{
+    if (request->fd >= 0)
+    {
+        close(request->fd);
+        request->fd = -1;
+    }
+    if (!success && request->data)
+    {
+        platform_free(request->data, false);
+        request->data = 0;
+        request->size = 0;
+    }
+    request->success = success;
+    request->status = ASYNC_IO_REQUEST_COMPLETE;
+}
+
+// Opens the file and queues the first read. Returns false if the submission queue is full.
+static b8 uring_start_request(io_uring_state *uring, u32 index, async_io_request *request)
+{
+    request->fd = open(request->path, O_RDONLY | O_CLOEXEC);
+    request->data = 0;
+    request->size = 0;
+    request->bytes_read = 0;
+    if (request->fd < 0)
+    {
+        complete_request(request, false);
+        return true;
+    }
+
+    struct stat info;
+    if (fstat(request->fd, &info) != 0)
+    {
+        complete_request(request, false);
+        return true;
+    }
+
+    request->size = (u64)info.st_size;
+    if (request->size == 0)
+    {
+        complete_request(request, true);
+        return true;
+    }
+
+    request->data = platform_allocate(request->size, false);
+    if (!uring_queue_read(uring, index, request))
+    {
+        platform_free(request->data, false);
+        request->data = 0;
+        close(request->fd);
+        request->fd = -1;
+        return false;
+    }
+    request->status = ASYNC_IO_REQUEST_IN_FLIGHT;
+    return true;
+}
+
+static void uring_reap(io_uring_state *uring, async_io_request *requests)
+{
+    u32 head = *uring->cq_head;
+    u32 tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail)
+    {
+        struct io_uring_cqe *cqe = &uring->cqes[head & uring->cq_mask];
+        u32 index = (u32)cqe->user_data;
+        i32 result = cqe->res;
+        head++;
+
+        async_io_request *request = &requests[index];
+        if (result <= 0)
+        {
+            // An error, or the file shrank underneath us.
+            complete_request(request, false);
+            continue;
+        }
+
+        request->bytes_read += (u64)result;
+        if (request->bytes_read >= request->size)
+        {
+            complete_request(request, true);
+        }
+        else if (!uring_queue_read(uring, index, request))
+        {
+            // Short read with no room to continue it; fail rather than stall.
+            complete_request(request, false);
+        }
+    }
+    __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+}
+#endif
+
+b8 async_io_initialise(u64 *memory_requirement, void *state, async_io_config config)
+{
+    *memory_requirement = sizeof(async_io_state);
+    if (state == 0)
+        return true;
+
+    state_ptr = state;
+    mzero_memory(state_ptr, sizeof(async_io_state));
+    state_ptr->config = config;
+
+    state_ptr->use_uring = false;
+#if ASYNC_IO_URING_AVAILABLE
+    state_ptr->use_uring = uring_initialise(&state_ptr->uring);
+#endif
+
+    if (!state_ptr->use_uring && !thread_pool_initialise(state_ptr))
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "async_io: no backend available.");
+        state_ptr = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void async_io_shutdown(void *state)
+{
+    if (!state_ptr)
+        return;
+
+#if ASYNC_IO_URING_AVAILABLE
+    if (state_ptr->use_uring)
+    {
+        // Wait for everything in flight, so the kernel is not left writing into freed buffers.
+        while (true)
+        {
+            b8 in_flight = false;
+            for (u32 i = 0; i < ASYNC_IO_MAX_REQUESTS; ++i)
+            {
+                if (state_ptr->requests[i].status == ASYNC_IO_REQUEST_IN_FLIGHT)
+                {
+                    in_flight = true;
+                    break;
+                }
+            }
+            if (!in_flight)
+            {
+                break;
+            }
+            syscall(__NR_io_uring_enter, state_ptr->uring.fd, 0, 1, IORING_ENTER_GETEVENTS, 0, 0);
+            uring_reap(&state_ptr->uring, state_ptr->requests);
+        }
+        uring_shutdown(&state_ptr->uring);
+    }
+    else
+#endif
+    {
+        thread_pool_shutdown(state_ptr);
+    }
+
+    for (u32 i = 0; i < ASYNC_IO_MAX_REQUESTS; ++i)
+    {
+        if (state_ptr->requests[i].data)
+        {
+            platform_free(state_ptr->requests[i].data, false);
+        }
+    }
+
+    state_ptr = 0;
+}
+
+b8 async_io_read_file(const char *path, PFN_async_io_on_complete on_complete, void *user_data)
+{
+    if (!state_ptr || !path || !on_complete)
+        return false;
+
+    if (string_length(path) >= ASYNC_IO_MAX_PATH_LENGTH)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "async_io_read_file: path too long: '%s'.", path);
+        return false;
+    }
+
+    for (u32 i = 0; i < ASYNC_IO_MAX_REQUESTS; ++i)
+    {
+        async_io_request *request = &state_ptr->requests[i];
+        if (request->status == ASYNC_IO_REQUEST_FREE)
+        {
+            request->status = ASYNC_IO_REQUEST_QUEUED;
+            string_ncopy(request->path, path, ASYNC_IO_MAX_PATH_LENGTH);
+            request->on_complete = on_complete;
+            request->user_data = user_data;
+            request->success = false;
+            request->data = 0;
+            request->size = 0;
+            queue_push(&state_ptr->submit_queue, i);
+            state_ptr->pending_count++;
+            return true;
+        }
+    }
+
+    MWARN_CH(LOG_CHANNEL_PLATFORM, "async_io_read_file: too many reads in flight, '%s' was not queued.", path);
+    return false;
+}
+
+static void dispatch_completion(async_io_request *request)
+{
+    async_io_result result;
+    result.path = request->path;
+    result.success = request->success;
+    result.data = request->data;
+    result.size = request->size;
+
+    request->on_complete(&result, request->user_data);
+
+    if (request->data)
+    {
+        platform_free(request->data, false);
+    }
+    request->data = 0;
+    request->size = 0;
+    request->status = ASYNC_IO_REQUEST_FREE;
+    state_ptr->pending_count--;
+}
+
+void async_io_update()
+{
+    if (!state_ptr)
+        return;
+
+#if ASYNC_IO_URING_AVAILABLE
+    if (state_ptr->use_uring)
+    {
+        io_uring_state *uring = &state_ptr->uring;
+
+        // Queue as many as fit, then submit them all with a single syscall.
+        while (state_ptr->submit_queue.count > 0)
+        {
+            u32 index = state_ptr->submit_queue.indices[state_ptr->submit_queue.head];
+            if (!uring_start_request(uring, index, &state_ptr->requests[index]))
+            {
+                break;
+            }
+            queue_pop(&state_ptr->submit_queue);
+        }
+        uring_submit(uring);
+        uring_reap(uring, state_ptr->requests);
+        // Short reads may have queued continuations.
+        uring_submit(uring);
+
+        for (u32 i = 0; i < ASYNC_IO_MAX_REQUESTS; ++i)
+        {
+            if (state_ptr->requests[i].status == ASYNC_IO_REQUEST_COMPLETE)
+            {
+                dispatch_completion(&state_ptr->requests[i]);
+            }
+        }
+        return;
+    }
+#endif
+
+    // Hand queued reads over to the workers.
+    if (state_ptr->submit_queue.count > 0)
+    {
+        u32 submitted = 0;
+        platform_mutex_lock(&state_ptr->queue_mutex);
+        while (state_ptr->submit_queue.count > 0)
+        {
+            u32 index = queue_pop(&state_ptr->submit_queue);
+            state_ptr->requests[index].status = ASYNC_IO_REQUEST_IN_FLIGHT;
+            queue_push(&state_ptr->work_queue, index);
+            submitted++;
+        }
+        platform_mutex_unlock(&state_ptr->queue_mutex);
+
+        for (u32 i = 0; i < submitted; ++i)
+        {
+            platform_semaphore_signal(&state_ptr->work_semaphore);
+        }
+    }
+
+    // Take whatever has completed, then invoke callbacks without holding the lock.
+    request_queue completed;
+    platform_mutex_lock(&state_ptr->queue_mutex);
+    completed = state_ptr->complete_queue;
+    state_ptr->complete_queue.head = 0;
+    state_ptr->complete_queue.count = 0;
+    platform_mutex_unlock(&state_ptr->queue_mutex);
+
+    while (completed.count > 0)
+    {
+        dispatch_completion(&state_ptr->requests[queue_pop(&completed)]);
+    }
+}
+
+u32 async_io_pending_count()
+{
+    if (!state_ptr)
+        return 0;
+    return state_ptr->pending_count;
+}
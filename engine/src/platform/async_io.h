@@ -0,0 +1,73 @@
+#pragma once
+
+#include "defines.h"
+
+// Maximum number of reads in flight at once.
+#define ASYNC_IO_MAX_REQUESTS 256
+
+// Maximum length of a path passed to async_io_read_file.
+#define ASYNC_IO_MAX_PATH_LENGTH 512
+
+typedef struct async_io_config
+{
+    // Number of worker threads used by the thread pool backend. 0 picks one based on the processor count.
+    u32 worker_count;
+} async_io_config;
+
+typedef struct async_io_result
+{
+    // The path passed to async_io_read_file.
+    const char *path;
+    b8 success;
+    // The contents of the file. Only valid for the duration of the callback; copy it to keep it.
+    const u8 *data;
+    u64 size;
+} async_io_result;
+
+/**
+ * @brief Invoked on the main thread, from async_io_update, when a read has completed.
+ *
+ * @param result The result of the read.
+ * @param user_data The user data passed to async_io_read_file.
+ */
+typedef void (*PFN_async_io_on_complete)(const async_io_result *result, void *user_data);
+
+/**
+ * @brief Initialises the async I/O system. Call twice; once with a null state to get required memory
+ * size, then a second time passing allocated memory to state.
+ *
+ * Uses io_uring where available, otherwise falls back to a pool of threads doing blocking reads.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state Allocated block of memory.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise false.
+ */
+b8 async_io_initialise(u64 *memory_requirement, void *state, async_io_config config);
+
+/**
+ * @brief Shuts the async I/O system down. Outstanding reads are waited on, but their callbacks are not invoked.
+ */
+void async_io_shutdown(void *state);
+
+/**
+ * @brief Submits any queued reads, then invokes the callbacks of any that have completed.
+ * Called once per frame by the application.
+ */
+void async_io_update();
+
+/**
+ * @brief Queues an asynchronous read of an entire file. Reads queued during a frame are submitted
+ * together at the next async_io_update.
+ *
+ * @param path The path of the file to read.
+ * @param on_complete Invoked on the main thread once the read completes, successfully or not.
+ * @param user_data Passed through to on_complete.
+ * @return True if the read was queued; false if too many reads are in flight.
+ */
+MAPI b8 async_io_read_file(const char *path, PFN_async_io_on_complete on_complete, void *user_data);
+
+/**
+ * @brief Gets the number of reads which have been queued but whose callbacks have not yet been invoked.
+ */
+MAPI u32 async_io_pending_count();
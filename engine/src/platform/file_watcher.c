@@ -0,0 +1,440 @@
+#include "file_watcher.h"
+
+#include "core/logger.h"
+#include "core/mmemory.h"
+#include "core/mstring.h"
+
+#if MPLATFORM_WINDOWS
+#include <windows.h>
+#elif MPLATFORM_LINUX
+#include <dirent.h>
+#include <errno.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// inotify watches are not recursive, so every directory under the root needs its own.
+#define FILE_WATCHER_MAX_DIRECTORIES 256
+#endif
+
+typedef struct pending_change
+{
+    char path[FILE_WATCHER_MAX_PATH_LENGTH];
+    f64 last_change_time;
+} pending_change;
+
+#if MPLATFORM_LINUX
+typedef struct watched_directory
+{
+    int descriptor;
+    // Relative to the root; empty for the root itself.
+    char path[FILE_WATCHER_MAX_PATH_LENGTH];
+} watched_directory;
+#endif
+
+typedef struct file_watcher_state
+{
+    file_watcher_config config;
+    char root_path[FILE_WATCHER_MAX_PATH_LENGTH];
+    b8 is_watching;
+    
+    u32 pending_count;
+    pending_change pending[FILE_WATCHER_MAX_PENDING];
+    b8 overflow_warned;
+    
+#if MPLATFORM_WINDOWS
+    HANDLE directory;
+    OVERLAPPED overlapped;
+    // Must be DWORD aligned.
+    DWORD buffer[16384];
+#elif MPLATFORM_LINUX
+    int inotify;
+    u32 directory_count;
+    watched_directory directories[FILE_WATCHER_MAX_DIRECTORIES];
+    // Aligned for struct inotify_event.
+    u64 buffer[8192];
+#endif
+} file_watcher_state;
+
+static file_watcher_state *state_ptr;
+
+// Records a change, restarting the debounce period if the file is already pending.
+static void queue_change(const char *path, f64 time)
+{
+    if (string_length(path) >= FILE_WATCHER_MAX_PATH_LENGTH)
+    {
+        return;
+    }
+    
+    for (u32 i = 0; i < state_ptr->pending_count; ++i)
+    {
+        if (strings_equal(state_ptr->pending[i].path, path))
+        {
+            state_ptr->pending[i].last_change_time = time;
+            return;
+        }
+    }
+    
+    if (state_ptr->pending_count == FILE_WATCHER_MAX_PENDING)
+    {
+        if (!state_ptr->overflow_warned)
+        {
+            MWARN_CH(LOG_CHANNEL_PLATFORM, "file_watcher: too many changes at once; some will be missed.");
+            state_ptr->overflow_warned = true;
+        }
+        return;
+    }
+    
+    pending_change *change = &state_ptr->pending[state_ptr->pending_count++];
+    string_copy(change->path, path);
+    change->last_change_time = time;
+}
+
+#if MPLATFORM_WINDOWS
+static b8 begin_read()
+{
+    DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+    return ReadDirectoryChangesW(state_ptr->directory, state_ptr->buffer, sizeof(state_ptr->buffer), TRUE,
+                                 filter, 0, &state_ptr->overlapped, 0) != 0;
+}
+
+static b8 begin_watching()
+{
+    state_ptr->directory = CreateFileA(state_ptr->root_path, FILE_LIST_DIRECTORY,
+                                       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING,
+                                       FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, 0);
+    if (state_ptr->directory == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    
+    state_ptr->overlapped.hEvent = CreateEventA(0, TRUE, FALSE, 0);
+    if (!state_ptr->overlapped.hEvent || !begin_read())
+    {
+        if (state_ptr->overlapped.hEvent)
+        {
+            CloseHandle(state_ptr->overlapped.hEvent);
+        }
+        CloseHandle(state_ptr->directory);
+        return false;
+    }
+    return true;
+}
+
+static void end_watching()
+{
+    CancelIo(state_ptr->directory);
+    // Wait for the cancellation, so the buffer is not written to after the state goes away.
+    DWORD bytes;
+    GetOverlappedResult(state_ptr->directory, &state_ptr->overlapped, &bytes, TRUE);
+    CloseHandle(state_ptr->overlapped.hEvent);
+    CloseHandle(state_ptr->directory);
+}
+
+static void poll_changes(f64 time)
+{
+    DWORD bytes;
+    while (GetOverlappedResult(state_ptr->directory, &state_ptr->overlapped, &bytes, FALSE))
+    {
+        if (bytes == 0)
+        {
+            // The buffer overflowed, and the individual changes were lost.
+            MWARN_CH(LOG_CHANNEL_PLATFORM, "file_watcher: change buffer overflowed; some changes were missed.");
+        }
+        
+        u8 *cursor = (u8 *)state_ptr->buffer;
+        while (bytes > 0)
+        {
+            FILE_NOTIFY_INFORMATION *info = (FILE_NOTIFY_INFORMATION *)cursor;
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED ||
+                info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+            {
+                char path[FILE_WATCHER_MAX_PATH_LENGTH];
+                i32 length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, (i32)(info->FileNameLength / sizeof(WCHAR)),
+                                                 path, FILE_WATCHER_MAX_PATH_LENGTH - 1, 0, 0);
+                if (length > 0)
+                {
+                    path[length] = 0;
+                    for (i32 i = 0; i < length; ++i)
+                    {
+                        if (path[i] == '\\')
+                        {
+                            path[i] = '/';
+                        }
+                    }
+                    queue_change(path, time);
+                }
+            }
+            
+            if (info->NextEntryOffset == 0)
+            {
+                break;
+            }
+            cursor += info->NextEntryOffset;
+        }
+        
+        ResetEvent(state_ptr->overlapped.hEvent);
+        if (!begin_read())
+        {
+            MERROR_CH(LOG_CHANNEL_PLATFORM, "file_watcher: unable to continue watching '%s'.", state_ptr->root_path);
+            end_watching();
+            state_ptr->is_watching = false;
+            return;
+        }
+    }
+}
+#elif MPLATFORM_LINUX
+static void watch_directory(const char *relative)
+{
+    if (state_ptr->directory_count == FILE_WATCHER_MAX_DIRECTORIES)
+    {
+        MWARN_CH(LOG_CHANNEL_PLATFORM, "file_watcher: too many directories; '%s' will not be watched.", relative);
+        return;
+    }
+    
+    char full_path[FILE_WATCHER_MAX_PATH_LENGTH * 2];
+    if (relative[0])
+    {
+        string_format(full_path, "%s/%s", state_ptr->root_path, relative);
+    }
+    else
+    {
+        string_copy(full_path, state_ptr->root_path);
+    }
+    
+    // CLOSE_WRITE rather than MODIFY, so a file is not picked up half written.
+    u32 mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+    int descriptor = inotify_add_watch(state_ptr->inotify, full_path, mask);
+    if (descriptor < 0)
+    {
+        MWARN_CH(LOG_CHANNEL_PLATFORM, "file_watcher: unable to watch '%s'.", full_path);
+        return;
+    }
+    
+    watched_directory *directory = &state_ptr->directories[state_ptr->directory_count++];
+    directory->descriptor = descriptor;
+    string_copy(directory->path, relative);
+    
+    DIR *dir = opendir(full_path);
+    if (!dir)
+    {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)))
+    {
+        if (strings_equal(entry->d_name, ".") || strings_equal(entry->d_name, ".."))
+        {
+            continue;
+        }
+        
+        char child[FILE_WATCHER_MAX_PATH_LENGTH * 2];
+        if (relative[0])
+        {
+            string_format(child, "%s/%s", relative, entry->d_name);
+        }
+        else
+        {
+            string_copy(child, entry->d_name);
+        }
+        if (string_length(child) >= FILE_WATCHER_MAX_PATH_LENGTH)
+        {
+            continue;
+        }
+        
+        b8 is_directory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN)
+        {
+            // Not all filesystems fill in d_type.
+            char child_full_path[FILE_WATCHER_MAX_PATH_LENGTH * 2];
+            string_format(child_full_path, "%s/%s", full_path, entry->d_name);
+            struct stat info;
+            is_directory = stat(child_full_path, &info) == 0 && S_ISDIR(info.st_mode);
+        }
+        if (is_directory)
+        {
+            watch_directory(child);
+        }
+    }
+    closedir(dir);
+}
+
+static b8 begin_watching()
+{
+    state_ptr->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (state_ptr->inotify < 0)
+    {
+        return false;
+    }
+    
+    state_ptr->directory_count = 0;
+    watch_directory("");
+    if (state_ptr->directory_count == 0)
+    {
+        close(state_ptr->inotify);
+        return false;
+    }
+    return true;
+}
+
+static void end_watching()
+{
+    // Closing the instance removes all of its watches.
+    close(state_ptr->inotify);
+    state_ptr->directory_count = 0;
+}
+
+static const watched_directory *find_directory(int descriptor)
+{
+    for (u32 i = 0; i < state_ptr->directory_count; ++i)
+    {
+        if (state_ptr->directories[i].descriptor == descriptor)
+        {
+            return &state_ptr->directories[i];
+        }
+    }
+    return 0;
+}
+
+static void poll_changes(f64 time)
+{
+    while (true)
+    {
+        ssize_t length = read(state_ptr->inotify, state_ptr->buffer, sizeof(state_ptr->buffer));
+        if (length <= 0)
+        {
+            // EAGAIN once everything has been read.
+            if (length < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        
+        u8 *cursor = (u8 *)state_ptr->buffer;
+        u8 *end = cursor + length;
+        while (cursor < end)
+        {
+            struct inotify_event *event = (struct inotify_event *)cursor;
+            cursor += sizeof(struct inotify_event) + event->len;
+            
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                MWARN_CH(LOG_CHANNEL_PLATFORM, "file_watcher: event queue overflowed; some changes were missed.");
+                continue;
+            }
+            
+            const watched_directory *directory = find_directory(event->wd);
+            if (!directory || event->len == 0)
+            {
+                continue;
+            }
+            
+            char path[FILE_WATCHER_MAX_PATH_LENGTH * 2];
+            if (directory->path[0])
+            {
+                string_format(path, "%s/%s", directory->path, event->name);
+            }
+            else
+            {
+                string_copy(path, event->name);
+            }
+            
+            if (event->mask & IN_ISDIR)
+            {
+                // Pick up new subdirectories as they appear.
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && string_length(path) < FILE_WATCHER_MAX_PATH_LENGTH)
+                {
+                    watch_directory(path);
+                }
+                continue;
+            }
+            
+            // A created file is reported again by IN_CLOSE_WRITE once it has been written.
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+            {
+                queue_change(path, time);
+            }
+        }
+    }
+}
+#else
+static b8 begin_watching()
+{
+    return false;
+}
+
+static void end_watching()
+{
+}
+
+static void poll_changes(f64 time)
+{
+}
+#endif
+
+b8 file_watcher_initialise(u64 *memory_requirement, void *state, file_watcher_config config)
+{
+    *memory_requirement = sizeof(file_watcher_state);
+    if (state == 0)
+        return true;
+    
+    if (!config.root_path || string_length(config.root_path) >= FILE_WATCHER_MAX_PATH_LENGTH || !config.on_change)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "file_watcher_initialise - invalid configuration.");
+        return false;
+    }
+    
+    state_ptr = state;
+    mzero_memory(state_ptr, sizeof(file_watcher_state));
+    state_ptr->config = config;
+    string_copy(state_ptr->root_path, config.root_path);
+    
+    state_ptr->is_watching = begin_watching();
+    if (!state_ptr->is_watching)
+    {
+        // Not fatal; files just won't be reloaded when they change.
+        MWARN_CH(LOG_CHANNEL_PLATFORM, "file_watcher: unable to watch '%s'; changes will not be picked up.", state_ptr->root_path);
+        return true;
+    }
+    
+    MINFO_CH(LOG_CHANNEL_PLATFORM, "file_watcher: watching '%s' for changes.", state_ptr->root_path);
+    return true;
+}
+
+void file_watcher_shutdown(void *state)
+{
+    if (state_ptr && state_ptr->is_watching)
+    {
+        end_watching();
+    }
+    state_ptr = 0;
+}
+
+void file_watcher_update(f64 time)
+{
+    if (!state_ptr || !state_ptr->is_watching)
+        return;
+    
+    poll_changes(time);
+    
+    // Report everything that has settled, in one go.
+    u32 i = 0;
+    while (i < state_ptr->pending_count)
+    {
+        pending_change *change = &state_ptr->pending[i];
+        if (time - change->last_change_time < state_ptr->config.debounce_seconds)
+        {
+            i++;
+            continue;
+        }
+        
+        char path[FILE_WATCHER_MAX_PATH_LENGTH];
+        string_copy(path, change->path);
+        
+        // Swap the last pending change into this slot before invoking the callback.
+        state_ptr->pending[i] = state_ptr->pending[--state_ptr->pending_count];
+        state_ptr->config.on_change(path, state_ptr->config.user_data);
+    }
+    state_ptr->overflow_warned = false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "defines.h"
+
+// Maximum number of changed files waiting out the debounce period at once.
+#define FILE_WATCHER_MAX_PENDING 128
+
+// Maximum length of a path reported by the watcher.
+#define FILE_WATCHER_MAX_PATH_LENGTH 256
+
+/**
+ * @brief Invoked from file_watcher_update for each changed file once it has settled.
+ * 
+ * @param path The path of the file relative to the watched root, using '/' separators, i.e. "textures/paving.png".
+ * @param user_data The user data from the config.
+ */
+typedef void (*PFN_file_watcher_on_change)(const char *path, void *user_data);
+
+typedef struct file_watcher_config
+{
+    // The directory to watch, including all subdirectories.
+    const char *root_path;
+    // How long a file must go unchanged before it is reported. Editors often save in several
+    // steps (truncate, write, rename), and each of those would otherwise trigger a reload.
+    f64 debounce_seconds;
+    PFN_file_watcher_on_change on_change;
+    void *user_data;
+} file_watcher_config;
+
+/**
+ * @brief Initialises the file watcher. Call twice; once with a null state to get required memory
+ * size, then a second time passing allocated memory to state.
+ * 
+ * Uses inotify on Linux and ReadDirectoryChangesW on Windows.
+ * 
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state Allocated block of memory.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise false.
+ */
+b8 file_watcher_initialise(u64 *memory_requirement, void *state, file_watcher_config config);
+
+void file_watcher_shutdown(void *state);
+
+/**
+ * @brief Collects changes from the OS without blocking, then reports every file which has settled
+ * in a single batch. Called once per frame by the application.
+ * 
+ * @param time The current absolute time, in seconds.
+ */
+void file_watcher_update(f64 time);
@@ -7,17 +7,73 @@
 #include <string.h>
 #include <sys/stat.h>
 
+#if MPLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 b8 filesystem_exists(const char *path)
 {
 #ifdef _MSC_VER
     struct _stat buffer;
-    return _stat(path, &buffer);
+    return _stat(path, &buffer) == 0;
 #else
     struct stat buffer;
     return stat(path, &buffer) == 0;
 #endif
 }
 
+b8 filesystem_create_directory(const char *path)
+{
+    char directory[512];
+    u64 length = strlen(path);
+    if (length == 0 || length >= sizeof(directory))
+    {
+        return false;
+    }
+    memcpy(directory, path, length + 1);
+
+    // Create each parent in turn, ignoring failures for those which already exist.
+    for (char *c = directory + 1; *c; ++c)
+    {
+        if (*c != '/' && *c != '\\')
+        {
+            continue;
+        }
+        char separator = *c;
+        *c = 0;
+#if MPLATFORM_WINDOWS
+        CreateDirectoryA(directory, 0);
+#else
+        mkdir(directory, 0755);
+#endif
+        *c = separator;
+    }
+#if MPLATFORM_WINDOWS
+    CreateDirectoryA(directory, 0);
+#else
+    mkdir(directory, 0755);
+#endif
+    return filesystem_exists(directory);
+}
+
+b8 filesystem_rename(const char *from, const char *to)
+{
+#if MPLATFORM_WINDOWS
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+b8 filesystem_delete(const char *path)
+{
+    return remove(path) == 0;
+}
+
 b8 filesystem_open(const char *path, file_modes mode, b8 binary, file_handle *out_handle)
 {
     out_handle->is_valid = false;
@@ -38,7 +94,7 @@ b8 filesystem_open(const char *path, file_modes mode, b8 binary, file_handle *ou
     }
     else
     {
-        MERROR("Invalid mode passed while trying to open file: '%s'", path);
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Invalid mode passed while trying to open file: '%s'", path);
         return false;
     }
     
@@ -46,7 +102,7 @@ b8 filesystem_open(const char *path, file_modes mode, b8 binary, file_handle *ou
     FILE *file = fopen(path, mode_str);
     if (!file)
     {
-        MERROR("Error opening file: '%s'", path);
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Error opening file: '%s'", path);
         return false;
     }
     
@@ -143,4 +199,147 @@ b8 filesystem_write(file_handle *handle, u64 data_size, const void *data, u64 *o
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+#if MPLATFORM_WINDOWS
+b8 filesystem_map(const char *path, file_access_hint hint, file_mapping *out_mapping)
+{
+    out_mapping->data = 0;
+    out_mapping->size = 0;
+    
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (hint == FILE_ACCESS_SEQUENTIAL)
+    {
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    }
+    else if (hint == FILE_ACCESS_RANDOM)
+    {
+        flags |= FILE_FLAG_RANDOM_ACCESS;
+    }
+    
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, flags, 0);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Error opening file for mapping: '%s'", path);
+        return false;
+    }
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Unable to get the size of file: '%s'", path);
+        CloseHandle(file);
+        return false;
+    }
+    
+    if (size.QuadPart == 0)
+    {
+        // Empty files cannot be mapped, but there is nothing to read anyway.
+        CloseHandle(file);
+        return true;
+    }
+    
+    // The view keeps both the mapping and the file alive, so the handles can be closed straight away.
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(file);
+    if (!mapping)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Unable to create a mapping of file: '%s'", path);
+        return false;
+    }
+    
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Unable to map file: '%s'", path);
+        return false;
+    }
+    
+    out_mapping->data = data;
+    out_mapping->size = (u64)size.QuadPart;
+    return true;
+}
+
+void filesystem_unmap(file_mapping *mapping)
+{
+    if (mapping->data)
+    {
+        UnmapViewOfFile(mapping->data);
+    }
+    mapping->data = 0;
+    mapping->size = 0;
+}
+#else
+b8 filesystem_map(const char *path, file_access_hint hint, file_mapping *out_mapping)
+{
+    out_mapping->data = 0;
+    out_mapping->size = 0;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Error opening file for mapping: '%s'", path);
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Unable to get the size of file: '%s'", path);
+        close(fd);
+        return false;
+    }
+    
+    if (info.st_size == 0)
+    {
+        // Empty files cannot be mapped, but there is nothing to read anyway.
+        close(fd);
+        return true;
+    }
+    
+    // The mapping keeps the file referenced, so the descriptor can be closed straight away.
+    void *data = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "Unable to map file: '%s'", path);
+        return false;
+    }
+    
+    int advice = MADV_NORMAL;
+    switch (hint)
+    {
+        case FILE_ACCESS_SEQUENTIAL:
+        advice = MADV_SEQUENTIAL;
+        break;
+        case FILE_ACCESS_RANDOM:
+        advice = MADV_RANDOM;
+        break;
+        case FILE_ACCESS_WILL_NEED:
+        advice = MADV_WILLNEED;
+        break;
+        default:
+        break;
+    }
+    if (advice != MADV_NORMAL)
+    {
+        // Only a hint, so failure is not an error.
+        madvise(data, (size_t)info.st_size, advice);
+    }
+    
+    out_mapping->data = data;
+    out_mapping->size = (u64)info.st_size;
+    return true;
+}
+
+void filesystem_unmap(file_mapping *mapping)
+{
+    if (mapping->data)
+    {
+        munmap((void *)mapping->data, (size_t)mapping->size);
+    }
+    mapping->data = 0;
+    mapping->size = 0;
+}
+#endif
@@ -10,6 +10,26 @@ typedef struct file_handle
     b8 is_valid;
 } file_handle;
 
+// A read-only view of a whole file, mapped into memory.
+typedef struct file_mapping
+{
+    // The contents of the file. 0 if the file is empty.
+    const void *data;
+    u64 size;
+} file_mapping;
+
+// How a mapping will be accessed, so the OS can read ahead (or not) appropriately.
+typedef enum file_access_hint
+{
+    FILE_ACCESS_NORMAL,
+    // Read front to back once, i.e. decoding an image.
+    FILE_ACCESS_SEQUENTIAL,
+    // Read in no particular order, i.e. looking entries up in an archive.
+    FILE_ACCESS_RANDOM,
+    // Will all be needed shortly, so start reading it in now.
+    FILE_ACCESS_WILL_NEED,
+} file_access_hint;
+
 typedef enum file_modes
 {
     FILE_MODE_READ = 0x1,
@@ -24,6 +44,32 @@ typedef enum file_modes
  */
 MAPI b8 filesystem_exists(const char *path);
 
+/**
+ * @brief Creates a directory, along with any of its parents which don't exist yet.
+ * 
+ * @param path The path of the directory to create.
+ * @return True if the directory exists afterwards; otherwise false.
+ */
+MAPI b8 filesystem_create_directory(const char *path);
+
+/**
+ * @brief Moves a file, replacing any file already at the destination. Within a directory this is
+ * atomic, so anything opening the destination sees either the old file or the new one, never a mix.
+ * 
+ * @param from The path of the file to move.
+ * @param to The path to move it to.
+ * @return True if the file was moved; otherwise false.
+ */
+MAPI b8 filesystem_rename(const char *from, const char *to);
+
+/**
+ * @brief Deletes a file.
+ * 
+ * @param path The path of the file to delete.
+ * @return True if the file was deleted; otherwise false.
+ */
+MAPI b8 filesystem_delete(const char *path);
+
 /**
  * @brief Attempts to open file located at path.
  * 
@@ -93,4 +139,22 @@ MAPI b8 filesystem_read_all_bytes(file_handle *handle, u8 **out_bytes, u64 *out_
  * @param out_bytes_written A pointer to a number which will be populated by the number of bytes written.
  * @return True if successful; otherwise false.
  */
-MAPI b8 filesystem_write(file_handle *handle, u64 data_size, const void *data, u64 *out_bytes_written);
\ No newline at end of file
+MAPI b8 filesystem_write(file_handle *handle, u64 data_size, const void *data, u64 *out_bytes_written);
+
+/**
+ * @brief Maps an entire file into memory as read-only, without copying it. Pages are shared with
+ * the OS page cache, so mapping the same file from several processes costs no extra memory.
+ * 
+ * @param path The path of the file to map.
+ * @param hint How the mapping will be accessed.
+ * @param out_mapping A pointer to hold the mapping.
+ * @return True if successful; otherwise false.
+ */
+MAPI b8 filesystem_map(const char *path, file_access_hint hint, file_mapping *out_mapping);
+
+/**
+ * @brief Unmaps a mapping created with filesystem_map. Its data must not be used afterwards.
+ * 
+ * @param mapping A pointer to the mapping to unmap.
+ */
+MAPI void filesystem_unmap(file_mapping *mapping);
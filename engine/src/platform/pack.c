@@ -0,0 +1,149 @@
+#include "pack.h"
+
+#include "core/logger.h"
+#include "core/mmemory.h"
+
+static char normalise_char(char c)
+{
+    if (c == '\\')
+    {
+        return '/';
+    }
+    if (c >= 'A' && c <= 'Z')
+    {
+        return c + ('a' - 'A');
+    }
+    return c;
+}
+
+static b8 names_equal(const char *stored, const char *name)
+{
+    while (*stored && normalise_char(*stored) == normalise_char(*name))
+    {
+        stored++;
+        name++;
+    }
+    return *stored == 0 && *name == 0;
+}
+
+u64 pack_hash_name(const char *name)
+{
+    // 64-bit FNV-1a.
+    u64 hash = 14695981039346656037ULL;
+    for (const char *c = name; *c; ++c)
+    {
+        hash ^= (u8)normalise_char(*c);
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;
+}
+
+u32 pack_slot_count(u32 entry_count)
+{
+    // Keep the load factor at or under a half, so probes stay short.
+    u32 count = 16;
+    while (count < entry_count * 2)
+    {
+        count <<= 1;
+    }
+    return count;
+}
+
+b8 pack_open(const char *path, pack_archive *out_archive)
+{
+    mzero_memory(out_archive, sizeof(pack_archive));
+    // Not FILE_ACCESS_RANDOM: entries are looked up randomly, but each is then read front to back.
+    if (!filesystem_map(path, FILE_ACCESS_NORMAL, &out_archive->mapping))
+    {
+        return false;
+    }
+    
+    const u8 *base = out_archive->mapping.data;
+    u64 size = out_archive->mapping.size;
+    const pack_header *header = (const pack_header *)base;
+    if (size < sizeof(pack_header) || header->magic != PACK_MAGIC)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "pack_open - '%s' is not a pack archive.", path);
+        pack_close(out_archive);
+        return false;
+    }
+    if (header->version != PACK_VERSION)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "pack_open - '%s' has version %u, expected %u.", path, header->version, PACK_VERSION);
+        pack_close(out_archive);
+        return false;
+    }
+    
+    u64 directory_size = (u64)header->slot_count * sizeof(pack_entry);
+    b8 valid = header->slot_count != 0 && (header->slot_count & (header->slot_count - 1)) == 0 &&
+               header->directory_offset <= size && directory_size <= size - header->directory_offset &&
+               header->names_offset <= size && header->names_size <= size - header->names_offset &&
+               header->names_size > 0 && base[header->names_offset + header->names_size - 1] == 0;
+    if (!valid)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "pack_open - '%s' is corrupt.", path);
+        pack_close(out_archive);
+        return false;
+    }
+    
+    out_archive->header = header;
+    out_archive->slots = (const pack_entry *)(base + header->directory_offset);
+    out_archive->names = (const char *)(base + header->names_offset);
+    
+    // Check every entry up front, so lookups can trust the directory.
+    for (u32 i = 0; i < header->slot_count; ++i)
+    {
+        const pack_entry *entry = &out_archive->slots[i];
+        if (entry->hash == 0)
+        {
+            continue;
+        }
+        if (entry->offset > size || entry->size > size - entry->offset || entry->name_offset >= header->names_size ||
+            (!(entry->flags & PACK_ENTRY_FLAG_COMPRESSED) && entry->size != entry->uncompressed_size))
+        {
+            MERROR_CH(LOG_CHANNEL_PLATFORM, "pack_open - '%s' has a corrupt directory entry.", path);
+            pack_close(out_archive);
+            return false;
+        }
+    }
+    
+    MINFO_CH(LOG_CHANNEL_PLATFORM, "Opened pack archive '%s' with %u entries.", path, header->entry_count);
+    return true;
+}
+
+void pack_close(pack_archive *archive)
+{
+    filesystem_unmap(&archive->mapping);
+    archive->header = 0;
+    archive->slots = 0;
+    archive->names = 0;
+}
+
+const pack_entry *pack_find(const pack_archive *archive, const char *name)
+{
+    if (!archive->header)
+    {
+        return 0;
+    }
+    
+    u64 hash = pack_hash_name(name);
+    u32 mask = archive->header->slot_count - 1;
+    for (u32 probe = 0; probe <= mask; ++probe)
+    {
+        const pack_entry *entry = &archive->slots[(hash + probe) & mask];
+        if (entry->hash == 0)
+        {
+            return 0;
+        }
+        if (entry->hash == hash && names_equal(archive->names + entry->name_offset, name))
+        {
+            return entry;
+        }
+    }
+    return 0;
+}
+
+const void *pack_entry_data(const pack_archive *archive, const pack_entry *entry)
+{
+    return (const u8 *)archive->mapping.data + entry->offset;
+}
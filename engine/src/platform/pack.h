@@ -0,0 +1,103 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/filesystem.h"
+
+/**
+ * Pack archives (.mpk) hold many assets in a single file, so they can be opened with one mapping
+ * instead of one open per asset. Layout:
+ * 
+ *   pack_header
+ *   entry data, each entry starting on a PACK_ALIGNMENT boundary
+ *   directory: pack_header.slot_count pack_entry slots, an open-addressed hash table
+ *   names: the null-terminated name of every entry
+ * 
+ * Names are paths relative to the asset root using '/' separators, i.e. "textures/cobblestone.png",
+ * and are matched case-insensitively.
+ */
+
+#define PACK_MAGIC 0x4B50414DU // 'MAPK'
+#define PACK_VERSION 1
+
+// Entries are aligned so uncompressed data can be used in place, straight out of the mapping.
+#define PACK_ALIGNMENT 64
+
+typedef enum pack_entry_flags
+{
+    PACK_ENTRY_FLAG_NONE = 0x0,
+    // Stored with compression_compress. size is the compressed size.
+    PACK_ENTRY_FLAG_COMPRESSED = 0x1,
+} pack_entry_flags;
+
+typedef struct pack_header
+{
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    // The number of directory slots. Always a power of two.
+    u32 slot_count;
+    u64 directory_offset;
+    u64 names_offset;
+    u64 names_size;
+} pack_header;
+
+typedef struct pack_entry
+{
+    // pack_hash_name of the entry's name. 0 marks an empty slot.
+    u64 hash;
+    // Offset of the data from the start of the archive.
+    u64 offset;
+    // The stored size of the data.
+    u64 size;
+    u64 uncompressed_size;
+    // Offset of the entry's name within the names block.
+    u32 name_offset;
+    // pack_entry_flags.
+    u32 flags;
+} pack_entry;
+
+typedef struct pack_archive
+{
+    file_mapping mapping;
+    const pack_header *header;
+    const pack_entry *slots;
+    const char *names;
+} pack_archive;
+
+/**
+ * @brief Hashes an entry name. Case-insensitive, and treats '\\' as '/'. Never returns 0.
+ */
+MAPI u64 pack_hash_name(const char *name);
+
+/**
+ * @brief Gets the number of directory slots to use for the given number of entries.
+ */
+MAPI u32 pack_slot_count(u32 entry_count);
+
+/**
+ * @brief Maps and validates a pack archive.
+ * 
+ * @param path The path of the archive.
+ * @param out_archive A pointer to hold the archive.
+ * @return True if successful; otherwise false.
+ */
+MAPI b8 pack_open(const char *path, pack_archive *out_archive);
+
+/**
+ * @brief Unmaps an archive opened with pack_open. Pointers into it must not be used afterwards.
+ */
+MAPI void pack_close(pack_archive *archive);
+
+/**
+ * @brief Looks up an entry by name.
+ * 
+ * @param archive A pointer to the archive.
+ * @param name The name of the entry.
+ * @return A pointer to the entry if found; otherwise 0.
+ */
+MAPI const pack_entry *pack_find(const pack_archive *archive, const char *name);
+
+/**
+ * @brief Gets a pointer to an entry's stored data within the mapping.
+ */
+MAPI const void *pack_entry_data(const pack_archive *archive, const pack_entry *entry);
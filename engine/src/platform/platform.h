@@ -2,6 +2,8 @@
 
 #include "defines.h"
 
+#include <stdatomic.h>
+
 b8 platfrom_system_startup(u64 *memory_requirements, void *state, const char *application_name, i32 x, i32 y, i32 width, i32 height);
 
 void platform_system_shutdown(void *state);
@@ -17,9 +19,267 @@ void *platform_set_memory(void *dest, i32 value, u64 size);
 void platform_console_write(const char *message, u8 colour);
 void platform_console_write_error(const char *message, u8 colour);
 
-f64 platform_get_absolute_time();
+MAPI f64 platform_get_absolute_time();
 
 // Sleep on the thread for the provided ms. This blocks the main thread.
 // Should only be used for giving time back to the OS for unused update power.
 // Therefore it is not exported.
-void platform_sleep(u64 ms);
\ No newline at end of file
+void platform_sleep(u64 ms);
+
+// Sleep on the thread until platform_get_absolute_time() reaches time, using the most precise
+// timer the OS has. The OS may still wake the thread a little late. Main thread only.
+void platform_sleep_until(f64 time);
+
+// Threading
+
+typedef u32 (*PFN_thread_start)(void *params);
+
+typedef struct mthread
+{
+    void *internal_data;
+    u64 thread_id;
+} mthread;
+
+typedef struct mmutex
+{
+    void *internal_data;
+} mmutex;
+
+typedef struct msemaphore
+{
+    void *internal_data;
+} msemaphore;
+
+typedef struct mcondition
+{
+    void *internal_data;
+} mcondition;
+
+/**
+ * @brief Gets the number of logical processors available.
+ */
+MAPI i32 platform_get_processor_count();
+
+/**
+ * @brief Starts a new thread running start_function.
+ * 
+ * @param start_function The function the thread runs. The thread exits when it returns.
+ * @param params Passed through to start_function.
+ * @param out_thread A pointer to hold the thread.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 platform_thread_create(PFN_thread_start start_function, void *params, mthread *out_thread);
+
+/**
+ * @brief Waits for a thread to exit, then releases its resources.
+ */
+MAPI void platform_thread_join(mthread *thread);
+
+/**
+ * @brief Names a thread, so debuggers and profilers can tell threads apart. Names longer than
+ * 15 characters may be cut short.
+ */
+MAPI void platform_thread_set_name(mthread *thread, const char *name);
+
+/**
+ * @brief Restricts a thread to running on a single logical processor.
+ * 
+ * @param thread The thread.
+ * @param processor_index The processor, from 0 to platform_get_processor_count() - 1.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 platform_thread_set_affinity(mthread *thread, u32 processor_index);
+
+MAPI b8 platform_mutex_create(mmutex *out_mutex);
+MAPI void platform_mutex_destroy(mmutex *mutex);
+MAPI void platform_mutex_lock(mmutex *mutex);
+MAPI void platform_mutex_unlock(mmutex *mutex);
+
+/**
+ * @brief Creates a counting semaphore.
+ * 
+ * @param initial_count The count the semaphore starts with.
+ * @param out_semaphore A pointer to hold the semaphore.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 platform_semaphore_create(u32 initial_count, msemaphore *out_semaphore);
+MAPI void platform_semaphore_destroy(msemaphore *semaphore);
+// Increments the count, waking a waiting thread if there is one.
+MAPI void platform_semaphore_signal(msemaphore *semaphore);
+// Waits until the count is above zero, then decrements it.
+MAPI void platform_semaphore_wait(msemaphore *semaphore);
+
+/**
+ * @brief Creates a condition variable, for waiting on a condition protected by a mutex.
+ */
+MAPI b8 platform_condition_create(mcondition *out_condition);
+MAPI void platform_condition_destroy(mcondition *condition);
+// Unlocks mutex and sleeps until signalled, then locks it again before returning. Can wake
+// spuriously, so always check the condition in a loop.
+MAPI void platform_condition_wait(mcondition *condition, mmutex *mutex);
+// Wakes one waiting thread.
+MAPI void platform_condition_signal(mcondition *condition);
+// Wakes every waiting thread.
+MAPI void platform_condition_broadcast(mcondition *condition);
+
+// Fibers. Cooperatively scheduled stacks; a thread runs one fiber at a time, and only changes
+// fiber when told to. A fiber can be switched to from any thread, but only while it isn't running.
+
+typedef void (*PFN_fiber_start)(void *params);
+
+typedef struct mfiber
+{
+    void *internal_data;
+} mfiber;
+
+/**
+ * @brief Turns the calling thread into a fiber, so it can switch to others. Must be called on a
+ * thread before any fiber is switched to from it.
+ * 
+ * @param out_fiber A pointer to hold the thread's fiber, for switching back to it.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 platform_fiber_convert_thread(mfiber *out_fiber);
+
+/**
+ * @brief Undoes platform_fiber_convert_thread. Must be called on the same thread, while it is
+ * running its own fiber.
+ */
+MAPI void platform_fiber_convert_back(mfiber *fiber);
+
+/**
+ * @brief Creates a fiber. It does not run until switched to.
+ * 
+ * @param stack_size The size of the fiber's stack in bytes.
+ * @param start_function The function the fiber runs. It must never return; switch away instead.
+ * @param params Passed through to start_function.
+ * @param out_fiber A pointer to hold the fiber.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 platform_fiber_create(u64 stack_size, PFN_fiber_start start_function, void *params, mfiber *out_fiber);
+
+/**
+ * @brief Destroys a fiber which isn't running.
+ */
+MAPI void platform_fiber_destroy(mfiber *fiber);
+
+/**
+ * @brief Saves the running fiber to from and starts running to. Returns when something switches
+ * back to from, which may be on a different thread.
+ */
+MAPI void platform_fiber_switch(mfiber *from, mfiber *to);
+
+// Atomics. These are C11 atomics, inlined rather than going through the platform layer since
+// they are used in the hottest loops.
+
+typedef enum matomic_order
+{
+    MATOMIC_RELAXED = memory_order_relaxed,
+    MATOMIC_ACQUIRE = memory_order_acquire,
+    MATOMIC_RELEASE = memory_order_release,
+    MATOMIC_ACQ_REL = memory_order_acq_rel,
+    MATOMIC_SEQ_CST = memory_order_seq_cst,
+} matomic_order;
+
+typedef struct matomic_i32
+{
+    _Atomic i32 value;
+} matomic_i32;
+
+typedef struct matomic_i64
+{
+    _Atomic i64 value;
+} matomic_i64;
+
+typedef struct matomic_ptr
+{
+    _Atomic(void *) value;
+} matomic_ptr;
+
+MINLINE i32 platform_atomic_load_i32(matomic_i32 *atomic, matomic_order order)
+{
+    return atomic_load_explicit(&atomic->value, (memory_order)order);
+}
+
+MINLINE void platform_atomic_store_i32(matomic_i32 *atomic, i32 value, matomic_order order)
+{
+    atomic_store_explicit(&atomic->value, value, (memory_order)order);
+}
+
+// Returns the value from before the add.
+MINLINE i32 platform_atomic_add_i32(matomic_i32 *atomic, i32 value, matomic_order order)
+{
+    return atomic_fetch_add_explicit(&atomic->value, value, (memory_order)order);
+}
+
+// Returns the value from before the exchange.
+MINLINE i32 platform_atomic_exchange_i32(matomic_i32 *atomic, i32 value, matomic_order order)
+{
+    return atomic_exchange_explicit(&atomic->value, value, (memory_order)order);
+}
+
+// Stores desired if the value is *expected, returning true. Otherwise loads the value into *expected and returns false.
+MINLINE b8 platform_atomic_compare_exchange_i32(matomic_i32 *atomic, i32 *expected, i32 desired, matomic_order order)
+{
+    return atomic_compare_exchange_strong_explicit(&atomic->value, expected, desired, (memory_order)order, memory_order_relaxed);
+}
+
+MINLINE i64 platform_atomic_load_i64(matomic_i64 *atomic, matomic_order order)
+{
+    return atomic_load_explicit(&atomic->value, (memory_order)order);
+}
+
+MINLINE void platform_atomic_store_i64(matomic_i64 *atomic, i64 value, matomic_order order)
+{
+    atomic_store_explicit(&atomic->value, value, (memory_order)order);
+}
+
+MINLINE i64 platform_atomic_add_i64(matomic_i64 *atomic, i64 value, matomic_order order)
+{
+    return atomic_fetch_add_explicit(&atomic->value, value, (memory_order)order);
+}
+
+MINLINE i64 platform_atomic_exchange_i64(matomic_i64 *atomic, i64 value, matomic_order order)
+{
+    return atomic_exchange_explicit(&atomic->value, value, (memory_order)order);
+}
+
+MINLINE b8 platform_atomic_compare_exchange_i64(matomic_i64 *atomic, i64 *expected, i64 desired, matomic_order order)
+{
+    return atomic_compare_exchange_strong_explicit(&atomic->value, expected, desired, (memory_order)order, memory_order_relaxed);
+}
+
+MINLINE void *platform_atomic_load_ptr(matomic_ptr *atomic, matomic_order order)
+{
+    return atomic_load_explicit(&atomic->value, (memory_order)order);
+}
+
+MINLINE void platform_atomic_store_ptr(matomic_ptr *atomic, void *value, matomic_order order)
+{
+    atomic_store_explicit(&atomic->value, value, (memory_order)order);
+}
+
+MINLINE void *platform_atomic_exchange_ptr(matomic_ptr *atomic, void *value, matomic_order order)
+{
+    return atomic_exchange_explicit(&atomic->value, value, (memory_order)order);
+}
+
+MINLINE b8 platform_atomic_compare_exchange_ptr(matomic_ptr *atomic, void **expected, void *desired, matomic_order order)
+{
+    return atomic_compare_exchange_strong_explicit(&atomic->value, expected, desired, (memory_order)order, memory_order_relaxed);
+}
+
+MINLINE void platform_atomic_fence(matomic_order order)
+{
+    atomic_thread_fence((memory_order)order);
+}
+
+// Tells the processor this is a spin-wait loop, so it can ease off and let a sibling hyperthread run.
+MINLINE void platform_cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
@@ -1,3 +1,6 @@
+// For pthread_setaffinity_np and pthread_setname_np.
+#define _GNU_SOURCE
+
 #include "platform.h"
 
 #if MPLATFORM_LINUX
@@ -15,6 +18,12 @@
 #include <X11/Xlib.h>
 #include <X11/Xlib-xcb.h>
 #include <sys/time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h> // cpu_set_t
+#include <semaphore.h>
+#include <ucontext.h>
+#include <unistd.h> // sysconf
 
 #if _POSIX_C_SOURCE >= 199309L
 #include <time.h> // nanosleep
@@ -40,6 +49,13 @@ typedef struct internal_state
     xcb_atom_t wm_protocols;
     xcb_atom_t wm_delete_win;
     VkSurfaceKHR surface;
+    
+    // For converting X server event times into the platform_get_absolute_time timebase.
+    b8 event_time_known;
+    f64 event_time_offset;
+    xcb_timestamp_t last_event_time;
+    // The server's millisecond clock, extended past where it wraps.
+    i64 event_time_ms;
 } internal_state;
 
 // Key translation
@@ -50,6 +66,7 @@ b8 platfrom_system_startup(platform_state *plat_state, const char *application_n
     // Create the internal state.
     plat_state->internal_state = malloc(sizeof(internal_state));
     internal_state *state = (internal_state *)plat_state->internal_state;
+    state->event_time_known = false;
     
     // Connect to X
     state->display = XOpenDisplay(NULL);
@@ -62,7 +79,7 @@ b8 platfrom_system_startup(platform_state *plat_state, const char *application_n
     
     if (xcb_connection_has_error(state->connection))
     {
-        MFATAL("Failed to connect to X server via XCB.");
+        MFATAL_CH(LOG_CHANNEL_PLATFORM, "Failed to connect to X server via XCB.");
         return false;
     }
     
@@ -163,7 +180,7 @@ b8 platfrom_system_startup(platform_state *plat_state, const char *application_n
     i32 stream_result = xcb_flush(state->connection);
     if (stream_result <= 0)
     {
-        MFATAL("An error occurred when flushing the stream: %d", stream_result);
+        MFATAL_CH(LOG_CHANNEL_PLATFORM, "An error occurred when flushing the stream: %d", stream_result);
         return false;
     }
     
@@ -181,6 +198,34 @@ void platform_system_shutdown(platform_state *plat_state)
     xcb_destroy_window(state->connection, state->window);
 }
 
+// Converts the time of an X event, in milliseconds on the server's clock, into the
+// platform_get_absolute_time timebase.
+static f64 linux_event_time(internal_state *state, xcb_timestamp_t time)
+{
+    f64 now = platform_get_absolute_time();
+    if (!state->event_time_known)
+    {
+        state->event_time_known = true;
+        state->last_event_time = time;
+        state->event_time_ms = time;
+        state->event_time_offset = now - (f64)time * 0.001;
+    }
+    
+    // Signed, so the 32 bit clock wrapping is just another step forward.
+    state->event_time_ms += (i32)(time - state->last_event_time);
+    state->last_event_time = time;
+    
+    // The offset is found from an event which had already waited in the queue, so it can be late. An
+    // event which arrives sooner shows by how much, and the offset is brought forward to match.
+    f64 event_time = state->event_time_offset + (f64)state->event_time_ms * 0.001;
+    if (event_time > now)
+    {
+        state->event_time_offset -= event_time - now;
+        event_time = now;
+    }
+    return event_time;
+}
+
 b8 platform_pump_messages(platform_state *plat_state)
 {
     // Simply cold-cast to the known type.
@@ -219,7 +264,7 @@ b8 platform_pump_messages(platform_state *plat_state)
                 keys key = translate_keycode(key_sym);
                 
                 // Pass to the input subsystem for processing.
-                input_process_key(key, pressed);
+                input_process_key(key, pressed, linux_event_time(state, kb_event->time));
             }
             break;
             case XCB_BUTTON_PRESS:
@@ -243,15 +288,16 @@ b8 platform_pump_messages(platform_state *plat_state)
                 
                 // Pass over to the input subsystem.
                 if (mouse_button != BUTTON_MAX_BUTTONS)
-                    input_process_button(mouse_button, pressed);
+                    input_process_button(mouse_button, pressed, linux_event_time(state, mouse_event->time));
             }
+            break;
             case XCB_MOTION_NOTIFY:
             {
                 // Mouse move
                 xcb_motion_notify_event_t *move_event = (xcb_motion_notify_event_t *)event;
                 
                 // Pass over to the input subsystem.
-                input_process_mouse_move(move_event->event_x, move_event->event_y);
+                input_process_mouse_move(move_event->event_x, move_event->event_y, linux_event_time(state, move_event->time));
             }
             break;
             
@@ -336,7 +382,7 @@ f64 platform_get_absolute_time()
 
 void platform_sleep(u64 ms)
 {
-#if _POSIC_C_SOURCE >= 199309L
+#if _POSIX_C_SOURCE >= 199309L
     struct timespec ts;
     ts.tv_sec = ms / 1000;
     ts.tv_nsec = (ms % 1000) * 1000 * 1000;
@@ -350,6 +396,280 @@ void platform_sleep(u64 ms)
 #endif
 }
 
+void platform_sleep_until(f64 time)
+{
+    // An absolute deadline on the same clock as platform_get_absolute_time, so being interrupted
+    // and retrying can't extend the sleep.
+    struct timespec ts;
+    ts.tv_sec = (time_t)time;
+    ts.tv_nsec = (long)((time - (f64)ts.tv_sec) * 1000000000.0);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR)
+    {
+    }
+}
+
+// Threading
+
+typedef struct linux_thread_start
+{
+    PFN_thread_start start_function;
+    void *params;
+} linux_thread_start;
+
+static void *linux_thread_proc(void *param)
+{
+    linux_thread_start start = *(linux_thread_start *)param;
+    platform_free(param, false);
+    return (void *)(u64)start.start_function(start.params);
+}
+
+i32 platform_get_processor_count()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (i32)count : 1;
+}
+
+b8 platform_thread_create(PFN_thread_start start_function, void *params, mthread *out_thread)
+{
+    if (!start_function)
+        return false;
+    
+    linux_thread_start *start = platform_allocate(sizeof(linux_thread_start), false);
+    start->start_function = start_function;
+    start->params = params;
+    
+    pthread_t thread;
+    if (pthread_create(&thread, 0, linux_thread_proc, start) != 0)
+    {
+        platform_free(start, false);
+        return false;
+    }
+    out_thread->thread_id = (u64)thread;
+    out_thread->internal_data = (void *)1;
+    return true;
+}
+
+void platform_thread_join(mthread *thread)
+{
+    if (thread->internal_data)
+    {
+        pthread_join((pthread_t)thread->thread_id, 0);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+void platform_thread_set_name(mthread *thread, const char *name)
+{
+    if (!thread->internal_data)
+        return;
+    
+    // Linux thread names are limited to 16 bytes, including the terminator.
+    char short_name[16];
+    string_ncopy(short_name, name, 15);
+    short_name[15] = 0;
+    pthread_setname_np((pthread_t)thread->thread_id, short_name);
+}
+
+b8 platform_thread_set_affinity(mthread *thread, u32 processor_index)
+{
+    if (!thread->internal_data || processor_index >= CPU_SETSIZE)
+        return false;
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(processor_index, &set);
+    return pthread_setaffinity_np((pthread_t)thread->thread_id, sizeof(cpu_set_t), &set) == 0;
+}
+
+b8 platform_mutex_create(mmutex *out_mutex)
+{
+    pthread_mutex_t *mutex = platform_allocate(sizeof(pthread_mutex_t), false);
+    if (pthread_mutex_init(mutex, 0) != 0)
+    {
+        platform_free(mutex, false);
+        out_mutex->internal_data = 0;
+        return false;
+    }
+    out_mutex->internal_data = mutex;
+    return true;
+}
+
+void platform_mutex_destroy(mmutex *mutex)
+{
+    if (mutex->internal_data)
+    {
+        pthread_mutex_destroy(mutex->internal_data);
+        platform_free(mutex->internal_data, false);
+        mutex->internal_data = 0;
+    }
+}
+
+void platform_mutex_lock(mmutex *mutex)
+{
+    pthread_mutex_lock(mutex->internal_data);
+}
+
+void platform_mutex_unlock(mmutex *mutex)
+{
+    pthread_mutex_unlock(mutex->internal_data);
+}
+
+b8 platform_semaphore_create(u32 initial_count, msemaphore *out_semaphore)
+{
+    sem_t *semaphore = platform_allocate(sizeof(sem_t), false);
+    if (sem_init(semaphore, 0, initial_count) != 0)
+    {
+        platform_free(semaphore, false);
+        out_semaphore->internal_data = 0;
+        return false;
+    }
+    out_semaphore->internal_data = semaphore;
+    return true;
+}
+
+void platform_semaphore_destroy(msemaphore *semaphore)
+{
+    if (semaphore->internal_data)
+    {
+        sem_destroy(semaphore->internal_data);
+        platform_free(semaphore->internal_data, false);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platform_semaphore_signal(msemaphore *semaphore)
+{
+    sem_post(semaphore->internal_data);
+}
+
+void platform_semaphore_wait(msemaphore *semaphore)
+{
+    // Retry if interrupted by a signal.
+    while (sem_wait(semaphore->internal_data) != 0)
+    {
+    }
+}
+
+b8 platform_condition_create(mcondition *out_condition)
+{
+    pthread_cond_t *condition = platform_allocate(sizeof(pthread_cond_t), false);
+    if (pthread_cond_init(condition, 0) != 0)
+    {
+        platform_free(condition, false);
+        out_condition->internal_data = 0;
+        return false;
+    }
+    out_condition->internal_data = condition;
+    return true;
+}
+
+void platform_condition_destroy(mcondition *condition)
+{
+    if (condition->internal_data)
+    {
+        pthread_cond_destroy(condition->internal_data);
+        platform_free(condition->internal_data, false);
+        condition->internal_data = 0;
+    }
+}
+
+void platform_condition_wait(mcondition *condition, mmutex *mutex)
+{
+    pthread_cond_wait(condition->internal_data, mutex->internal_data);
+}
+
+void platform_condition_signal(mcondition *condition)
+{
+    pthread_cond_signal(condition->internal_data);
+}
+
+void platform_condition_broadcast(mcondition *condition)
+{
+    pthread_cond_broadcast(condition->internal_data);
+}
+
+// Fibers
+
+typedef struct linux_fiber
+{
+    ucontext_t context;
+    void *stack;
+    PFN_fiber_start start_function;
+    void *params;
+} linux_fiber;
+
+// makecontext only passes int arguments, so the fiber pointer is split in two.
+static void linux_fiber_proc(u32 high, u32 low)
+{
+    linux_fiber *fiber = (linux_fiber *)(((u64)high << 32) | (u64)low);
+    fiber->start_function(fiber->params);
+    // Returning would end the thread.
+    MFATAL("Fiber start function returned.");
+    abort();
+}
+
+b8 platform_fiber_convert_thread(mfiber *out_fiber)
+{
+    // The context is filled in when the thread first switches away.
+    linux_fiber *fiber = platform_allocate(sizeof(linux_fiber), false);
+    platform_zero_memory(fiber, sizeof(linux_fiber));
+    out_fiber->internal_data = fiber;
+    return true;
+}
+
+void platform_fiber_convert_back(mfiber *fiber)
+{
+    if (fiber->internal_data)
+    {
+        platform_free(fiber->internal_data, false);
+        fiber->internal_data = 0;
+    }
+}
+
+b8 platform_fiber_create(u64 stack_size, PFN_fiber_start start_function, void *params, mfiber *out_fiber)
+{
+    linux_fiber *fiber = platform_allocate(sizeof(linux_fiber), false);
+    platform_zero_memory(fiber, sizeof(linux_fiber));
+    fiber->stack = platform_allocate(stack_size, false);
+    fiber->start_function = start_function;
+    fiber->params = params;
+    
+    if (getcontext(&fiber->context) != 0)
+    {
+        platform_free(fiber->stack, false);
+        platform_free(fiber, false);
+        out_fiber->internal_data = 0;
+        return false;
+    }
+    fiber->context.uc_stack.ss_sp = fiber->stack;
+    fiber->context.uc_stack.ss_size = stack_size;
+    fiber->context.uc_link = 0;
+    u64 address = (u64)fiber;
+    makecontext(&fiber->context, (void (*)(void))linux_fiber_proc, 2, (u32)(address >> 32), (u32)address);
+    
+    out_fiber->internal_data = fiber;
+    return true;
+}
+
+void platform_fiber_destroy(mfiber *fiber)
+{
+    linux_fiber *internal = fiber->internal_data;
+    if (internal)
+    {
+        platform_free(internal->stack, false);
+        platform_free(internal, false);
+        fiber->internal_data = 0;
+    }
+}
+
+void platform_fiber_switch(mfiber *from, mfiber *to)
+{
+    linux_fiber *from_fiber = from->internal_data;
+    linux_fiber *to_fiber = to->internal_data;
+    swapcontext(&from_fiber->context, &to_fiber->context);
+}
+
 void platform_get_required_extension_names(const char ***names_darray)
 {
     darray_push(*names_darray, &"VK_KHR_xcb_surface"); // VK_KHR_xlib_surface?
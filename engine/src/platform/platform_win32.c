@@ -12,6 +12,10 @@
 #include <windows.h>
 #include <windowsx.h> // param input extraction
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 // For surface creation
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_win32.h>
@@ -22,6 +26,10 @@ typedef struct platform_state
     HINSTANCE h_instance;
     HWND hwnd;
     VkSurfaceKHR surface;
+    // Tick time of the last mouse move passed to the input system, for GetMouseMovePointsEx.
+    DWORD last_mouse_move_time;
+    // For platform_sleep_until.
+    HANDLE sleep_timer;
 } platform_state;
 
 static platform_state *state_ptr;
@@ -52,6 +60,7 @@ b8 platfrom_system_startup(
         return true;
     state_ptr = state;
     state_ptr->h_instance = GetModuleHandleA(0);
+    state_ptr->last_mouse_move_time = 0;
     
     // Setup and register window class.
     HICON icon = LoadIcon(state_ptr->h_instance, IDI_APPLICATION);
@@ -112,7 +121,7 @@ b8 platfrom_system_startup(
     {
         MessageBoxA(NULL, "Window creation failed!", "Error!", MB_ICONEXCLAMATION | MB_OK);
         
-        MFATAL("Window creation failed!");
+        MFATAL_CH(LOG_CHANNEL_PLATFORM, "Window creation failed!");
         return false;
     }
     else
@@ -130,11 +139,24 @@ b8 platfrom_system_startup(
     // Clock setup
     clock_setup();
     
+    // Sleep() only wakes on the scheduler tick, which is ~15.6ms unless raised system-wide. High
+    // resolution timers (Windows 10 1803 and later) don't have that problem.
+    state_ptr->sleep_timer = CreateWaitableTimerExW(0, 0, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!state_ptr->sleep_timer)
+    {
+        MWARN_CH(LOG_CHANNEL_PLATFORM, "High resolution timers are unavailable; frame pacing will spin for longer.");
+    }
+    
     return true;
 }
 
 void platform_system_shutdown(void *state)
 {
+    if (state_ptr->sleep_timer)
+    {
+        CloseHandle(state_ptr->sleep_timer);
+        state_ptr->sleep_timer = 0;
+    }
     if (state_ptr->hwnd)
     {
         DestroyWindow(state_ptr->hwnd);
@@ -223,6 +245,245 @@ void platform_sleep(u64 ms)
     Sleep(ms);
 }
 
+void platform_sleep_until(f64 time)
+{
+    f64 remaining = time - platform_get_absolute_time();
+    if (remaining <= 0)
+    {
+        return;
+    }
+    
+    if (state_ptr && state_ptr->sleep_timer)
+    {
+        // Negative due times are relative, in 100ns units.
+        LARGE_INTEGER due_time;
+        due_time.QuadPart = -(LONGLONG)(remaining * 10000000.0);
+        if (SetWaitableTimerEx(state_ptr->sleep_timer, &due_time, 0, 0, 0, 0, 0))
+        {
+            WaitForSingleObject(state_ptr->sleep_timer, INFINITE);
+            return;
+        }
+    }
+    
+    // Sleep() can wake up to a scheduler tick late, so stop a tick short and leave the caller to
+    // spin out the rest.
+    const f64 tick = 0.016;
+    if (remaining > tick)
+    {
+        Sleep((DWORD)((remaining - tick) * 1000.0));
+    }
+}
+
+// Threading
+
+typedef struct win32_thread_start
+{
+    PFN_thread_start start_function;
+    void *params;
+} win32_thread_start;
+
+static DWORD WINAPI win32_thread_proc(LPVOID param)
+{
+    win32_thread_start start = *(win32_thread_start *)param;
+    platform_free(param, false);
+    return (DWORD)start.start_function(start.params);
+}
+
+i32 platform_get_processor_count()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (i32)info.dwNumberOfProcessors;
+}
+
+b8 platform_thread_create(PFN_thread_start start_function, void *params, mthread *out_thread)
+{
+    if (!start_function)
+        return false;
+    
+    win32_thread_start *start = platform_allocate(sizeof(win32_thread_start), false);
+    start->start_function = start_function;
+    start->params = params;
+    
+    DWORD thread_id = 0;
+    out_thread->internal_data = CreateThread(0, 0, win32_thread_proc, start, 0, &thread_id);
+    if (!out_thread->internal_data)
+    {
+        platform_free(start, false);
+        return false;
+    }
+    out_thread->thread_id = thread_id;
+    return true;
+}
+
+void platform_thread_join(mthread *thread)
+{
+    if (thread->internal_data)
+    {
+        WaitForSingleObject(thread->internal_data, INFINITE);
+        CloseHandle(thread->internal_data);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+typedef HRESULT(WINAPI *PFN_SetThreadDescription)(HANDLE thread, PCWSTR description);
+
+void platform_thread_set_name(mthread *thread, const char *name)
+{
+    if (!thread->internal_data)
+        return;
+    
+    // Only on Windows 10 1607 and later, so look it up rather than link against it.
+    static PFN_SetThreadDescription set_thread_description;
+    static b8 looked_up;
+    if (!looked_up)
+    {
+        set_thread_description = (PFN_SetThreadDescription)(void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+        looked_up = true;
+    }
+    if (!set_thread_description)
+        return;
+    
+    WCHAR wide_name[64];
+    if (MultiByteToWideChar(CP_UTF8, 0, name, -1, wide_name, 64) != 0)
+    {
+        set_thread_description(thread->internal_data, wide_name);
+    }
+}
+
+b8 platform_thread_set_affinity(mthread *thread, u32 processor_index)
+{
+    if (!thread->internal_data || processor_index >= sizeof(DWORD_PTR) * 8)
+        return false;
+    
+    return SetThreadAffinityMask(thread->internal_data, (DWORD_PTR)1 << processor_index) != 0;
+}
+
+b8 platform_mutex_create(mmutex *out_mutex)
+{
+    SRWLOCK *lock = platform_allocate(sizeof(SRWLOCK), false);
+    InitializeSRWLock(lock);
+    out_mutex->internal_data = lock;
+    return true;
+}
+
+void platform_mutex_destroy(mmutex *mutex)
+{
+    if (mutex->internal_data)
+    {
+        platform_free(mutex->internal_data, false);
+        mutex->internal_data = 0;
+    }
+}
+
+void platform_mutex_lock(mmutex *mutex)
+{
+    AcquireSRWLockExclusive((SRWLOCK *)mutex->internal_data);
+}
+
+void platform_mutex_unlock(mmutex *mutex)
+{
+    ReleaseSRWLockExclusive((SRWLOCK *)mutex->internal_data);
+}
+
+b8 platform_semaphore_create(u32 initial_count, msemaphore *out_semaphore)
+{
+    out_semaphore->internal_data = CreateSemaphoreA(0, (LONG)initial_count, 0x7FFFFFFF, 0);
+    return out_semaphore->internal_data != 0;
+}
+
+void platform_semaphore_destroy(msemaphore *semaphore)
+{
+    if (semaphore->internal_data)
+    {
+        CloseHandle(semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platform_semaphore_signal(msemaphore *semaphore)
+{
+    ReleaseSemaphore(semaphore->internal_data, 1, 0);
+}
+
+void platform_semaphore_wait(msemaphore *semaphore)
+{
+    WaitForSingleObject(semaphore->internal_data, INFINITE);
+}
+
+b8 platform_condition_create(mcondition *out_condition)
+{
+    CONDITION_VARIABLE *condition = platform_allocate(sizeof(CONDITION_VARIABLE), false);
+    InitializeConditionVariable(condition);
+    out_condition->internal_data = condition;
+    return true;
+}
+
+void platform_condition_destroy(mcondition *condition)
+{
+    if (condition->internal_data)
+    {
+        platform_free(condition->internal_data, false);
+        condition->internal_data = 0;
+    }
+}
+
+void platform_condition_wait(mcondition *condition, mmutex *mutex)
+{
+    // Mutexes are SRW locks, taken exclusively.
+    SleepConditionVariableSRW(condition->internal_data, mutex->internal_data, INFINITE, 0);
+}
+
+void platform_condition_signal(mcondition *condition)
+{
+    WakeConditionVariable(condition->internal_data);
+}
+
+void platform_condition_broadcast(mcondition *condition)
+{
+    WakeAllConditionVariable(condition->internal_data);
+}
+
+// Fibers
+
+b8 platform_fiber_convert_thread(mfiber *out_fiber)
+{
+    out_fiber->internal_data = ConvertThreadToFiber(0);
+    return out_fiber->internal_data != 0;
+}
+
+void platform_fiber_convert_back(mfiber *fiber)
+{
+    if (fiber->internal_data)
+    {
+        ConvertFiberToThread();
+        fiber->internal_data = 0;
+    }
+}
+
+b8 platform_fiber_create(u64 stack_size, PFN_fiber_start start_function, void *params, mfiber *out_fiber)
+{
+    // On x64 there is only one calling convention, so the start function can be used as is.
+    out_fiber->internal_data = CreateFiber((SIZE_T)stack_size, (LPFIBER_START_ROUTINE)start_function, params);
+    return out_fiber->internal_data != 0;
+}
+
+void platform_fiber_destroy(mfiber *fiber)
+{
+    if (fiber->internal_data)
+    {
+        DeleteFiber(fiber->internal_data);
+        fiber->internal_data = 0;
+    }
+}
+
+void platform_fiber_switch(mfiber *from, mfiber *to)
+{
+    // Windows keeps track of the running fiber itself.
+    SwitchToFiber(to->internal_data);
+}
+
 void platform_get_required_extension_names(const char ***names_darray)
 {
     darray_push(*names_darray, &"VK_KHR_win32_surface");
@@ -241,6 +502,52 @@ b8 platform_create_vulkan_surface(struct vulkan_context *context)
     return true;
 }
 
+// Converts a tick time (i.e. from GetMessageTime) into the platform_get_absolute_time timebase.
+static f64 win32_tick_to_absolute_time(DWORD tick)
+{
+    // Unsigned subtraction handles the tick count wrapping.
+    DWORD age_ms = GetTickCount() - tick;
+    return platform_get_absolute_time() - (f64)age_ms * 0.001;
+}
+
+// Passes on any mouse positions Windows coalesced since the last move, so fast movement at low frame
+// rates isn't reduced to one sample per message.
+static void win32_process_intermediate_mouse_moves(HWND hwnd, i32 x, i32 y, DWORD message_time)
+{
+    POINT point = {x, y};
+    ClientToScreen(hwnd, &point);
+    
+    MOUSEMOVEPOINT current = {0};
+    current.x = point.x & 0xFFFF;
+    current.y = point.y & 0xFFFF;
+    current.time = message_time;
+    
+    // Returned newest first, starting with the current point.
+    MOUSEMOVEPOINT points[64];
+    i32 count = GetMouseMovePointsEx(sizeof(MOUSEMOVEPOINT), &current, points, 64, GMMP_USE_DISPLAY_POINTS);
+    if (count <= 1 || state_ptr->last_mouse_move_time == 0)
+    {
+        return;
+    }
+    
+    // Find how many are newer than the last move already passed on.
+    i32 first_new = 1;
+    while (first_new < count && (i32)(points[first_new].time - state_ptr->last_mouse_move_time) > 0)
+    {
+        first_new++;
+    }
+    
+    // Pass them on oldest first.
+    for (i32 i = first_new - 1; i >= 1; --i)
+    {
+        // Coordinates are 16-bit, and negative on monitors left of or above the primary.
+        POINT intermediate = {points[i].x > 32767 ? points[i].x - 65536 : points[i].x,
+            points[i].y > 32767 ? points[i].y - 65536 : points[i].y};
+        ScreenToClient(hwnd, &intermediate);
+        input_process_mouse_move(intermediate.x, intermediate.y, win32_tick_to_absolute_time(points[i].time));
+    }
+}
+
 LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARAM l_param)
 {
     switch (msg)
@@ -298,7 +605,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
             }
             
             // Pass to the input subsystem for processing.
-            input_process_key(key, pressed);
+            input_process_key(key, pressed, win32_tick_to_absolute_time(GetMessageTime()));
         }
         break;
         case WM_MOUSEMOVE:
@@ -307,8 +614,15 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
             i32 x_position = GET_X_LPARAM(l_param);
             i32 y_position = GET_Y_LPARAM(l_param);
             
+            DWORD message_time = GetMessageTime();
+            if (state_ptr)
+            {
+                win32_process_intermediate_mouse_moves(hwnd, x_position, y_position, message_time);
+                state_ptr->last_mouse_move_time = message_time;
+            }
+            
             // Pass over to the input subsystem for processing.
-            input_process_mouse_move(x_position, y_position);
+            input_process_mouse_move(x_position, y_position, win32_tick_to_absolute_time(message_time));
         }
         break;
         case WM_MOUSEWHEEL:
@@ -318,7 +632,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
             {
                 // Flatten the input to an OS-independent (-1, 1)
                 z_delta = (z_delta < 0) ? -1 : 1;
-                input_process_mouse_wheel(z_delta);
+                input_process_mouse_wheel(z_delta, win32_tick_to_absolute_time(GetMessageTime()));
             }
         }
         break;
@@ -350,7 +664,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
             // Pass over to the input subsystem.
             if (mouse_button != BUTTON_MAX_BUTTONS)
             {
-                input_process_button(mouse_button, pressed);
+                input_process_button(mouse_button, pressed, win32_tick_to_absolute_time(GetMessageTime()));
             }
         }
         break;
@@ -0,0 +1,158 @@
+#include "vfs.h"
+
+#include "core/logger.h"
+#include "core/mmemory.h"
+#include "core/mstring.h"
+#include "core/compression.h"
+#include "platform/pack.h"
+
+typedef struct vfs_state
+{
+    char root_path[VFS_MAX_PATH_LENGTH];
+    b8 has_archive;
+    pack_archive archive;
+} vfs_state;
+
+static vfs_state *state_ptr;
+
+static b8 build_loose_path(char *out_path, const char *name)
+{
+    u64 root_length = state_ptr ? string_length(state_ptr->root_path) : 0;
+    if (root_length + 1 + string_length(name) >= VFS_MAX_PATH_LENGTH)
+    {
+        MERROR_CH(LOG_CHANNEL_PLATFORM, "vfs - path of '%s' is too long.", name);
+        return false;
+    }
+    
+    if (root_length)
+    {
+        string_format(out_path, "%s/%s", state_ptr->root_path, name);
+    }
+    else
+    {
+        string_copy(out_path, name);
+    }
+    return true;
+}
+
+b8 vfs_initialise(u64 *memory_requirement, void *state, vfs_config config)
+{
+    *memory_requirement = sizeof(vfs_state);
+    if (state == 0)
+        return true;
+    
+    state_ptr = state;
+    mzero_memory(state_ptr, sizeof(vfs_state));
+    
+    if (config.root_path)
+    {
+        if (string_length(config.root_path) >= VFS_MAX_PATH_LENGTH)
+        {
+            MERROR_CH(LOG_CHANNEL_PLATFORM, "vfs_initialise - root path is too long.");
+            return false;
+        }
+        string_copy(state_ptr->root_path, config.root_path);
+    }
+    
+    // The archive is optional, i.e. during development everything can be loose.
+    if (config.archive_path && filesystem_exists(config.archive_path))
+    {
+        state_ptr->has_archive = pack_open(config.archive_path, &state_ptr->archive);
+    }
+    if (!state_ptr->has_archive)
+    {
+        MINFO_CH(LOG_CHANNEL_PLATFORM, "No pack archive loaded; files will be read from '%s'.", state_ptr->root_path);
+    }
+    
+    return true;
+}
+
+void vfs_shutdown(void *state)
+{
+    if (state_ptr && state_ptr->has_archive)
+    {
+        pack_close(&state_ptr->archive);
+    }
+    state_ptr = 0;
+}
+
+b8 vfs_open(const char *name, file_access_hint hint, vfs_file *out_file)
+{
+    mzero_memory(out_file, sizeof(vfs_file));
+    
+    if (state_ptr && state_ptr->has_archive)
+    {
+        const pack_entry *entry = pack_find(&state_ptr->archive, name);
+        if (entry)
+        {
+            const void *stored = pack_entry_data(&state_ptr->archive, entry);
+            if (!(entry->flags & PACK_ENTRY_FLAG_COMPRESSED))
+            {
+                out_file->data = entry->size ? stored : 0;
+                out_file->size = entry->size;
+                out_file->source = VFS_SOURCE_ARCHIVE;
+                return true;
+            }
+            
+            void *buffer = mallocate(entry->uncompressed_size, MEMORY_TAG_RESOURCE);
+            if (!compression_decompress(stored, entry->size, buffer, entry->uncompressed_size))
+            {
+                MERROR_CH(LOG_CHANNEL_PLATFORM, "vfs_open - archive entry '%s' failed to decompress.", name);
+                mfree(buffer, entry->uncompressed_size, MEMORY_TAG_RESOURCE);
+                return false;
+            }
+            out_file->data = buffer;
+            out_file->size = entry->uncompressed_size;
+            out_file->source = VFS_SOURCE_DECOMPRESSED;
+            return true;
+        }
+    }
+    
+    return vfs_open_loose(name, hint, out_file);
+}
+
+b8 vfs_open_loose(const char *name, file_access_hint hint, vfs_file *out_file)
+{
+    mzero_memory(out_file, sizeof(vfs_file));
+    char path[VFS_MAX_PATH_LENGTH];
+    if (!build_loose_path(path, name) || !filesystem_map(path, hint, &out_file->mapping))
+    {
+        return false;
+    }
+    out_file->data = out_file->mapping.data;
+    out_file->size = out_file->mapping.size;
+    out_file->source = VFS_SOURCE_LOOSE;
+    return true;
+}
+
+void vfs_close(vfs_file *file)
+{
+    switch (file->source)
+    {
+        case VFS_SOURCE_LOOSE:
+        filesystem_unmap(&file->mapping);
+        break;
+        case VFS_SOURCE_DECOMPRESSED:
+        mfree((void *)file->data, file->size, MEMORY_TAG_RESOURCE);
+        break;
+        default:
+        break;
+    }
+    mzero_memory(file, sizeof(vfs_file));
+}
+
+b8 vfs_exists(const char *name)
+{
+    if (state_ptr && state_ptr->has_archive && pack_find(&state_ptr->archive, name))
+    {
+        return true;
+    }
+    
+    char path[VFS_MAX_PATH_LENGTH];
+    return build_loose_path(path, name) && filesystem_exists(path);
+}
+
+b8 vfs_loose_path(const char *name, char *out_path)
+{
+    return build_loose_path(out_path, name);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/filesystem.h"
+
+// Maximum length of a resolved loose file path.
+#define VFS_MAX_PATH_LENGTH 512
+
+typedef struct vfs_config
+{
+    // Path of the pack archive to resolve names through first. Optional; it is fine for it not to exist.
+    const char *archive_path;
+    // Directory loose files are resolved relative to, i.e. "assets".
+    const char *root_path;
+} vfs_config;
+
+typedef enum vfs_source
+{
+    VFS_SOURCE_NONE,
+    // A mapping of a loose file.
+    VFS_SOURCE_LOOSE,
+    // Points straight into the archive mapping.
+    VFS_SOURCE_ARCHIVE,
+    // Decompressed out of the archive into an allocation.
+    VFS_SOURCE_DECOMPRESSED,
+} vfs_source;
+
+typedef struct vfs_file
+{
+    // The contents of the file. 0 if the file is empty.
+    const void *data;
+    u64 size;
+    
+    // Internal.
+    vfs_source source;
+    file_mapping mapping;
+} vfs_file;
+
+/**
+ * @brief Initialises the virtual filesystem. Call twice; once with a null state to get required memory
+ * size, then a second time passing allocated memory to state.
+ * 
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state Allocated block of memory.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise false.
+ */
+MAPI b8 vfs_initialise(u64 *memory_requirement, void *state, vfs_config config);
+
+MAPI void vfs_shutdown(void *state);
+
+/**
+ * @brief Opens a file by name, i.e. "textures/cobblestone.png", for reading. Looks in the pack archive
+ * first, then for a loose file under the root path. Uncompressed archive entries and loose files are
+ * mapped rather than copied.
+ * 
+ * @param name The name of the file, relative to the asset root.
+ * @param hint How the file will be accessed. Only applies to loose files.
+ * @param out_file A pointer to hold the file. Must be closed with vfs_close.
+ * @return True if successful; otherwise false.
+ */
+MAPI b8 vfs_open(const char *name, file_access_hint hint, vfs_file *out_file);
+
+/**
+ * @brief Opens a loose file under the root path, even if the archive has an entry of the same name.
+ * Used to read files as they are being edited.
+ * 
+ * @param name The name of the file, relative to the asset root.
+ * @param hint How the file will be accessed.
+ * @param out_file A pointer to hold the file. Must be closed with vfs_close.
+ * @return True if successful; otherwise false.
+ */
+MAPI b8 vfs_open_loose(const char *name, file_access_hint hint, vfs_file *out_file);
+
+/**
+ * @brief Closes a file opened with vfs_open. Its data must not be used afterwards.
+ */
+MAPI void vfs_close(vfs_file *file);
+
+/**
+ * @brief Checks if a file exists, either in the archive or loose.
+ */
+MAPI b8 vfs_exists(const char *name);
+
+/**
+ * @brief Resolves the path of a loose file, i.e. for watching or rewriting it, ignoring the archive.
+ * 
+ * @param name The name of the file, relative to the asset root.
+ * @param out_path A buffer of at least VFS_MAX_PATH_LENGTH characters to hold the path.
+ * @return True if successful; false if the path is too long.
+ */
+MAPI b8 vfs_loose_path(const char *name, char *out_path);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "renderer/renderer_backend.h"
+#include "resources/resource_types.h"
+
+/**
+ * A backend which draws nothing and holds no GPU resources, so the systems built on the renderer can
+ * run without a window or a device, i.e. in tools and benchmarks.
+ */
+
+b8 null_renderer_backend_initialise(renderer_backend *backend, const char *application_name);
+void null_renderer_backend_shutdown(renderer_backend *backend);
+
+void null_renderer_backend_on_resized(renderer_backend *backend, u16 width, u16 height);
+
+b8 null_renderer_backend_begin_frame(renderer_backend *backend, f32 delta_time);
+void null_renderer_update_global_state(mat4 projection, mat4 view, vec3 view_position, vec4 ambient_colour, i32 mode);
+b8 null_renderer_backend_end_frame(renderer_backend *backend, f32 delta_time);
+
+void null_backend_update_object(geometry_render_data data);
+
+void null_renderer_create_texture(const u8 *pixels, texture *texture);
+void null_renderer_create_textures(const u8 *const *pixels, texture **textures, u32 count);
+void null_renderer_update_texture(texture *texture, const u8 *pixels, u32 region_count, const texture_region *regions);
+void null_renderer_destroy_texture(texture *texture);
+
+b8 null_renderer_create_material(struct material *material);
+void null_renderer_destroy_material(struct material *material);
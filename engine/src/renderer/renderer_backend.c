@@ -1,6 +1,7 @@
 #include "renderer_backend.h"
 
 #include "vulkan/vulkan_backend.h"
+#include "null/null_backend.h"
 
 b8 renderer_backend_create(renderer_backend_type type, renderer_backend *out_renderer_backend)
 {
@@ -14,6 +15,8 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend *out_ren
         out_renderer_backend->resized = vulkan_renderer_backend_on_resized;
         out_renderer_backend->update_object = vulkan_backend_update_object;
         out_renderer_backend->create_texture = vulkan_renderer_create_texture;
+        out_renderer_backend->create_textures = vulkan_renderer_create_textures;
+        out_renderer_backend->update_texture = vulkan_renderer_update_texture;
         out_renderer_backend->destroy_texture = vulkan_renderer_destroy_texture;
         out_renderer_backend->create_material = vulkan_renderer_create_material;
         out_renderer_backend->destroy_material = vulkan_renderer_destroy_material;
@@ -21,6 +24,25 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend *out_ren
         return true;
     }
     
+    if (type == RENDERER_BACKEND_TYPE_NULL)
+    {
+        out_renderer_backend->initialise = null_renderer_backend_initialise;
+        out_renderer_backend->shutdown = null_renderer_backend_shutdown;
+        out_renderer_backend->begin_frame = null_renderer_backend_begin_frame;
+        out_renderer_backend->update_global_state = null_renderer_update_global_state;
+        out_renderer_backend->end_frame = null_renderer_backend_end_frame;
+        out_renderer_backend->resized = null_renderer_backend_on_resized;
+        out_renderer_backend->update_object = null_backend_update_object;
+        out_renderer_backend->create_texture = null_renderer_create_texture;
+        out_renderer_backend->create_textures = null_renderer_create_textures;
+        out_renderer_backend->update_texture = null_renderer_update_texture;
+        out_renderer_backend->destroy_texture = null_renderer_destroy_texture;
+        out_renderer_backend->create_material = null_renderer_create_material;
+        out_renderer_backend->destroy_material = null_renderer_destroy_material;
+        
+        return true;
+    }
+    
     return false;
 }
 
@@ -34,6 +56,8 @@ void renderer_backend_destroy(renderer_backend *renderer_backend)
     renderer_backend->resized = 0;
     renderer_backend->update_object = 0;
     renderer_backend->create_texture = 0;
+    renderer_backend->create_textures = 0;
+    renderer_backend->update_texture = 0;
     renderer_backend->destroy_texture = 0;
     renderer_backend->create_material = 0;
     renderer_backend->destroy_material = 0;
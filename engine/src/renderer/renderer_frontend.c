@@ -13,6 +13,10 @@
 // TODO(satvik): temporary
 #include "core/mstring.h"
 #include "core/event.h"
+#include "core/application.h"
+
+// The size of the test geometry the backend creates.
+#define TEST_GEOMETRY_SIZE 10.0f
 // TODO(satvik): end temporary
 
 typedef struct renderer_system_state
@@ -22,6 +26,7 @@ typedef struct renderer_system_state
     mat4 view;
     f32 near_clip;
     f32 far_clip;
+    u32 framebuffer_height;
     
     // TODO(satvik): temporary
     material *test_material;
@@ -46,10 +51,10 @@ b8 event_on_debug_event(u16 code, void *sender, void *listener_inst, event_conte
     choice %= 3;
     
     // Acquire the new texture.
-    state_ptr->test_material->diffuse_map.texture = texture_system_acquire(names[choice], true);
+    state_ptr->test_material->diffuse_map.texture = texture_system_acquire_async(names[choice], true);
     if (!state_ptr->test_material->diffuse_map.texture)
     {
-        MWARN("event_on_debug_event no texture, using default!");
+        MWARN_CH(LOG_CHANNEL_RENDERER, "event_on_debug_event no texture, using default!");
         state_ptr->test_material->diffuse_map.texture = texture_system_get_default_texture();
     }
     
@@ -60,7 +65,7 @@ b8 event_on_debug_event(u16 code, void *sender, void *listener_inst, event_conte
 }
 // TODO(satvik): end temp
 
-b8 renderer_system_initialise(u64 *memory_requirement, void *state, const char *application_name)
+b8 renderer_system_initialise(u64 *memory_requirement, void *state, const char *application_name, renderer_backend_type backend_type)
 {
     *memory_requirement = sizeof(renderer_system_state);
     if (state == 0)
@@ -73,16 +78,26 @@ b8 renderer_system_initialise(u64 *memory_requirement, void *state, const char *
     event_register(EVENT_CODE_DEBUG0, state_ptr, event_on_debug_event);
     // TODO(satvik): end temp
     
-    // TODO(satvik): make this configurable.
-    renderer_backend_create(RENDERER_BACKEND_TYPE_VULKAN, &state_ptr->backend);
+    if (!renderer_backend_create(backend_type, &state_ptr->backend))
+    {
+        MFATAL_CH(LOG_CHANNEL_RENDERER, "Renderer backend type %d is not supported. Shutting down.", backend_type);
+        return false;
+    }
     state_ptr->backend.frame_number = 0;
     
     if (!state_ptr->backend.initialise(&state_ptr->backend, application_name))
     {
-        MFATAL("Renderer backend failed to initialise. Shutting down.");
+        MFATAL_CH(LOG_CHANNEL_RENDERER, "Renderer backend failed to initialise. Shutting down.");
         return false;
     }
     
+    u32 framebuffer_width = 0;
+    application_get_framebuffer_size(&framebuffer_width, &state_ptr->framebuffer_height);
+    if (state_ptr->framebuffer_height == 0)
+    {
+        state_ptr->framebuffer_height = 720;
+    }
+    
     state_ptr->near_clip = 0.1f;
     state_ptr->far_clip = 1000.0f;
     state_ptr->projection = mat4_perspective(
@@ -139,12 +154,31 @@ void renderer_on_resized(u16 width, u16 height)
                                                  width / (f32)height,
                                                  state_ptr->near_clip,
                                                  state_ptr->far_clip);
+        state_ptr->framebuffer_height = height;
         state_ptr->backend.resized(&state_ptr->backend, width, height);
     }
     else
     {
-        MWARN("renderer backend does not exist to accept resize: %i %i", width, height);
+        MWARN_CH(LOG_CHANNEL_RENDERER, "renderer backend does not exist to accept resize: %i %i", width, height);
+    }
+}
+
+// Estimates how many pixels across an object of the given size appears, from its distance to the camera.
+static f32 screen_size(mat4 model, f32 size)
+{
+    // Depth of the object's origin in view space, which looks down -z.
+    f32 x = model.data[12];
+    f32 y = model.data[13];
+    f32 z = model.data[14];
+    const f32 *v = state_ptr->view.data;
+    f32 distance = -(v[2] * x + v[6] * y + v[10] * z + v[14]);
+    if (distance <= state_ptr->near_clip)
+    {
+        distance = state_ptr->near_clip;
     }
+    
+    // projection[5] scales height in view space, over depth, to device coordinates, which are 2 across the screen.
+    return size * state_ptr->projection.data[5] / distance * state_ptr->framebuffer_height * 0.5f;
 }
 
 b8 renderer_draw_frame(render_packet *packet)
@@ -174,10 +208,11 @@ b8 renderer_draw_frame(render_packet *packet)
             state_ptr->test_material = material_system_acquire("test_material");
             if (!state_ptr->test_material)
             {
-                MWARN("Automatic material load failed, falling back to manual default material.");
+                MWARN_CH(LOG_CHANNEL_RENDERER, "Automatic material load failed, falling back to manual default material.");
                 
                 // Manual config
                 material_config config;
+                mzero_memory(&config, sizeof(material_config));
                 string_ncopy(config.name, "test_material", MATERIAL_NAME_MAX_LENGTH);
                 config.auto_release = false;
                 config.diffuse_colour = vec4_one();
@@ -189,12 +224,18 @@ b8 renderer_draw_frame(render_packet *packet)
         data.material = state_ptr->test_material;
         state_ptr->backend.update_object(data);
         
+        // Let texture streaming know how much detail the material's textures need.
+        if (data.material && data.material->diffuse_map.texture)
+        {
+            texture_system_report_usage(data.material->diffuse_map.texture, screen_size(data.model, TEST_GEOMETRY_SIZE));
+        }
+        
         // End the frame. If this fails, it is likely unrecoverable.
         b8 result = renderer_end_frame(packet->delta_time);
         
         if (!result)
         {
-            MERROR("renderer_end_frame failed. Application shutting down...");
+            MERROR_CH(LOG_CHANNEL_RENDERER, "renderer_end_frame failed. Application shutting down...");
             return false;
         }
     }
@@ -212,6 +253,16 @@ void renderer_create_texture(const u8 *pixels, struct texture *texture)
     state_ptr->backend.create_texture(pixels, texture);
 }
 
+void renderer_create_textures(const u8 *const *pixels, struct texture **textures, u32 count)
+{
+    state_ptr->backend.create_textures(pixels, textures, count);
+}
+
+void renderer_update_texture(struct texture *texture, const u8 *pixels, u32 region_count, const texture_region *regions)
+{
+    state_ptr->backend.update_texture(texture, pixels, region_count, regions);
+}
+
 void renderer_destroy_texture(struct texture *texture)
 {
     state_ptr->backend.destroy_texture(texture);
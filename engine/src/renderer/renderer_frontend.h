@@ -2,8 +2,8 @@
 
 #include "renderer_types.h"
 
-b8 renderer_system_initialise(u64 *memory_requirement, void *state, const char *application_name);
-void renderer_system_shutdown(void *state);
+MAPI b8 renderer_system_initialise(u64 *memory_requirement, void *state, const char *application_name, renderer_backend_type backend_type);
+MAPI void renderer_system_shutdown(void *state);
 
 void renderer_on_resized(u16 width, u16 height);
 
@@ -13,6 +13,11 @@ b8 renderer_draw_frame(render_packet *packet);
 MAPI void renderer_set_view(mat4 view);
 
 void renderer_create_texture(const u8 *pixels, struct texture *texture);
+// Creates several textures, uploading them together. pixels[i] holds the pixels of textures[i].
+void renderer_create_textures(const u8 *const *pixels, struct texture **textures, u32 count);
+// Copies regions of an RGBA8 texture's top level from pixels, which hold the whole level, and
+// regenerates the levels below them. The texture keeps its image, so it needs no new descriptors.
+void renderer_update_texture(struct texture *texture, const u8 *pixels, u32 region_count, const texture_region *regions);
 void renderer_destroy_texture(struct texture *texture);
 
 b8 renderer_create_material(struct material *material);
@@ -8,7 +8,9 @@ typedef enum renderer_backend_type
 {
     RENDERER_BACKEND_TYPE_VULKAN,
     RENDERER_BACKEND_TYPE_OPENGL,
-    RENDERER_BACKEND_TYPE_DIRECTX
+    RENDERER_BACKEND_TYPE_DIRECTX,
+    // Draws nothing, for running without a window or a GPU.
+    RENDERER_BACKEND_TYPE_NULL
 } renderer_backend_type;
 
 typedef struct global_uniform_object
@@ -22,8 +24,8 @@ typedef struct global_uniform_object
 typedef struct material_uniform_object
 {
     vec4 diffuse_colour; // 16 bytes
-    vec4 v_reserved0;   // 16 bytes, reserved for future use
-    vec4 v_reserved1;   // 16 bytes, reserved for future use
+    vec4 diffuse_uv_transform; // 16 bytes, scale in x and y, offset in z and w, into an atlas
+    vec4 diffuse_layer; // 16 bytes, the array layer of the diffuse map in x, for an atlas entry its repeat modes in y and z and 1 in w
     vec4 v_reserved2;   // 16 bytes, reserved for future use
 } material_uniform_object;
 
@@ -50,6 +52,8 @@ typedef struct renderer_backend
     void (*update_object)(geometry_render_data data);
     
     void (*create_texture)(const u8 *pixels, struct texture *texture);
+    void (*create_textures)(const u8 *const *pixels, struct texture **textures, u32 count);
+    void (*update_texture)(struct texture *texture, const u8 *pixels, u32 region_count, const texture_region *regions);
     void (*destroy_texture)(struct texture *texture);
     
     b8(*create_material)(material *material);
@@ -10,6 +10,7 @@
 #include "renderer/vulkan/vulkan_shader_utils.h"
 #include "renderer/vulkan/vulkan_pipeline.h"
 #include "renderer/vulkan/vulkan_buffer.h"
+#include "renderer/vulkan/vulkan_sampler.h"
 
 #define BUILTIN_SHADER_NAME_OBJECT "Builtin.MaterialShader"
 
@@ -23,7 +24,7 @@ b8 vulkan_material_shader_create(vulkan_context *context, vulkan_material_shader
     {
         if (!create_shader_module(context, BUILTIN_SHADER_NAME_OBJECT, stage_type_strs[i], stage_types[i], i, out_shader->stages))
         {
-            MERROR("Unable to create %s shader module for '%s'.", stage_type_strs[i], BUILTIN_SHADER_NAME_OBJECT);
+            MERROR_CH(LOG_CHANNEL_RENDERER, "Unable to create %s shader module for '%s'.", stage_type_strs[i], BUILTIN_SHADER_NAME_OBJECT);
             return false;
         }
     }
@@ -158,7 +159,7 @@ b8 vulkan_material_shader_create(vulkan_context *context, vulkan_material_shader
                                          false,
                                          &out_shader->pipeline))
     {
-        MERROR("Failed to load graphics pipeline for object shader.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Failed to load graphics pipeline for object shader.");
         return false;
     }
     
@@ -172,7 +173,7 @@ b8 vulkan_material_shader_create(vulkan_context *context, vulkan_material_shader
                               true,
                               &out_shader->global_uniform_buffer))
     {
-        MERROR("Vulkan buffer creation failed for object shader.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Vulkan buffer creation failed for object shader.");
         return false;
     }
     
@@ -197,7 +198,7 @@ b8 vulkan_material_shader_create(vulkan_context *context, vulkan_material_shader
                               true,
                               &out_shader->object_uniform_buffer))
     {
-        MERROR("Material instance buffer creation failed for shader.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Material instance buffer creation failed for shader.");
         return false;
     }
     
@@ -312,6 +313,21 @@ void vulkan_material_shader_update_object(vulkan_context *context, struct
     
     obo.diffuse_colour = data.material->diffuse_colour;
     
+    // A diffuse map packed into an atlas is sampled from its part of the atlas. The sampler would wrap
+    // the whole atlas, so the shader wraps within the entry the way the map's sampler would have.
+    texture *diffuse = data.material->diffuse_map.texture;
+    if (diffuse && diffuse->atlas && diffuse->generation != INVALID_ID && diffuse->atlas->generation != INVALID_ID)
+    {
+        const texture_sampler_config *sampler = &data.material->diffuse_map.sampler;
+        obo.diffuse_uv_transform = diffuse->atlas_uv_transform;
+        obo.diffuse_layer = vec4_create((f32)diffuse->atlas_layer, (f32)sampler->repeat_u, (f32)sampler->repeat_v, 1.0f);
+    }
+    else
+    {
+        obo.diffuse_uv_transform = vec4_create(1.0f, 1.0f, 0.0f, 0.0f);
+        obo.diffuse_layer = vec4_zero();
+    }
+    
     // Load the data into the buffer.
     vulkan_buffer_load_data(context, &shader->object_uniform_buffer, offset, range, 0, &obo);
     
@@ -345,22 +361,30 @@ void vulkan_material_shader_update_object(vulkan_context *context, struct
     for (u32 sampler_index = 0; sampler_index < sampler_count; ++sampler_index)
     {
         texture_use use = shader->sampler_uses[sampler_index];
-        texture *t = 0;
+        texture_map *map = 0;
         switch(use)
         {
             case TEXTURE_USE_MAP_DIFFUSE:
             {
-                t = data.material->diffuse_map.texture;
+                map = &data.material->diffuse_map;
             } break;
             
             default:
             {
-                MFATAL("Unable to bind sampler to unknown use.");
+                MFATAL_CH(LOG_CHANNEL_RENDERER, "Unable to bind sampler to unknown use.");
             } return;
         }
         
         u32 *descriptor_generation = &object_state->descriptor_states[descriptor_index].generations[image_index];
         u32 *descriptor_id = &object_state->descriptor_states[descriptor_index].ids[image_index];
+        VkSampler *descriptor_sampler = &object_state->descriptor_states[descriptor_index].samplers[image_index];
+        texture *t = map->texture;
+        
+        // A texture packed into an atlas is drawn from the atlas.
+        if (t->atlas && t->generation != INVALID_ID)
+        {
+            t = t->atlas;
+        }
         
         // If the texture hasn't been loaded yet, use the default.
         if (t->generation == INVALID_ID)
@@ -371,15 +395,18 @@ void vulkan_material_shader_update_object(vulkan_context *context, struct
             *descriptor_generation = INVALID_ID;
         }
         
+        // The sampler is shared with every other map sampled the same way.
+        VkSampler sampler = vulkan_sampler_acquire(context, &map->sampler);
+        
         // Check if the descriptor needs updating first.
-        if (t && (*descriptor_id != t->id || *descriptor_generation != t->generation || *descriptor_generation == INVALID_ID))
+        if (t && sampler && (*descriptor_id != t->id || *descriptor_generation != t->generation || *descriptor_sampler != sampler || *descriptor_generation == INVALID_ID))
         {
             vulkan_texture_data *internal_data = (vulkan_texture_data *)t->internal_data;
             
             // Assign view and sampler.
             image_infos[sampler_index].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
             image_infos[sampler_index].imageView = internal_data->image.view;
-            image_infos[sampler_index].sampler = internal_data->sampler;
+            image_infos[sampler_index].sampler = sampler;
             
             VkWriteDescriptorSet descriptor = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
             descriptor.dstSet = object_descriptor_set;
@@ -396,6 +423,7 @@ void vulkan_material_shader_update_object(vulkan_context *context, struct
             {
                 *descriptor_generation = t->generation;
                 *descriptor_id = t->id;
+                *descriptor_sampler = sampler;
             }
             descriptor_index++;
         }
@@ -423,6 +451,7 @@ b8 vulkan_material_shader_acquire_resources(vulkan_context *context, struct vulk
         {
             instance_state->descriptor_states[i].generations[j] = INVALID_ID;
             instance_state->descriptor_states[i].ids[j] = INVALID_ID;
+            instance_state->descriptor_states[i].samplers[j] = 0;
         }
     }
     
@@ -439,7 +468,7 @@ b8 vulkan_material_shader_acquire_resources(vulkan_context *context, struct vulk
     VkResult result = vkAllocateDescriptorSets(context->device.logical_device, &alloc_info, instance_state->descriptor_sets);
     if (result != VK_SUCCESS)
     {
-        MERROR("Error allocating descriptor sets in shader!");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Error allocating descriptor sets in shader!");
         return false;
     }
     
@@ -460,7 +489,7 @@ void vulkan_material_shader_release_resources(vulkan_context *context,
                                            instance_state->descriptor_sets);
     if (result != VK_SUCCESS)
     {
-        MERROR("Error freeing object shader descriptor sets!");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Error freeing object shader descriptor sets!");
     }
     
     for (u32 i = 0; i < VULKAN_MATERIAL_SHADER_DESCRIPTOR_COUNT; ++i)
@@ -469,6 +498,7 @@ void vulkan_material_shader_release_resources(vulkan_context *context,
         {
             instance_state->descriptor_states[i].generations[j] = INVALID_ID;
             instance_state->descriptor_states[i].ids[j] = INVALID_ID;
+            instance_state->descriptor_states[i].samplers[j] = 0;
         }
     }
     
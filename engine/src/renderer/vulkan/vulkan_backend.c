@@ -11,6 +11,7 @@
 #include "vulkan_utils.h"
 #include "vulkan_buffer.h"
 #include "vulkan_image.h"
+#include "vulkan_sampler.h"
 
 #include "core/logger.h"
 #include "core/mstring.h"
@@ -23,6 +24,8 @@
 
 #include "platform/platform.h"
 
+#include "resources/block_compression.h"
+
 // Shaders
 #include "shaders/vulkan_material_shader.h"
 
@@ -44,6 +47,10 @@ void create_command_buffers(renderer_backend *backend);
 void regenerate_framebuffers(renderer_backend *backend, vulkan_swapchain *swapchain, vulkan_renderpass *renderpass);
 b8 recreate_swapchain(renderer_backend *backend);
 
+void discard_texture_updates(const vulkan_image *image);
+void record_texture_updates(vulkan_command_buffer *command_buffer);
+void destroy_deferred(u64 finished_frame_count);
+
 void upload_data_range(vulkan_context *context, VkCommandPool pool, VkFence fence, VkQueue queue, vulkan_buffer *buffer, u64 offset, u64 size, void *data)
 {
     // Create a host-visible staging buffer to upload to. Mark it as the source of the transfer.
@@ -93,11 +100,11 @@ b8 vulkan_renderer_backend_initialise(renderer_backend *backend, const char *app
 #if defined(_DEBUG)
     darray_push(required_extensions, &VK_EXT_DEBUG_UTILS_EXTENSION_NAME); // debug utilities
     
-    MDEBUG("Required extensions:");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Required extensions:");
     u32 length = darray_length(required_extensions);
     for (u32 i = 0; i < length; ++i)
     {
-        MDEBUG(required_extensions[i]);
+        MDEBUG_CH(LOG_CHANNEL_RENDERER, "%s", required_extensions[i]);
     }
 #endif
     
@@ -111,7 +118,7 @@ b8 vulkan_renderer_backend_initialise(renderer_backend *backend, const char *app
     // If validation should be done, get a list of the required validation layert names
     // and make sure they exist. Validation layers should only be enabled on non-release builds.
 #if defined(_DEBUG)
-    MINFO("Validation layers enabled. Enumerating...");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Validation layers enabled. Enumerating...");
     
     // The list of validation layers required.
     required_validation_layer_names = darray_create(const char *);
@@ -127,36 +134,36 @@ b8 vulkan_renderer_backend_initialise(renderer_backend *backend, const char *app
     // Verify all required layers are available.
     for (u32 i = 0; i < required_validation_layer_count; ++i)
     {
-        MINFO("Searching for layer: %s...", required_validation_layer_names[i]);
+        MINFO_CH(LOG_CHANNEL_RENDERER, "Searching for layer: %s...", required_validation_layer_names[i]);
         b8 found = false;
         for (u32 j = 0; j < available_layer_count; ++j)
         {
             if (strings_equal(required_validation_layer_names[i], available_layers[j].layerName))
             {
                 found = true;
-                MINFO("Found.");
+                MINFO_CH(LOG_CHANNEL_RENDERER, "Found.");
                 break;
             }
         }
         
         if (!found)
         {
-            MFATAL("Required validation layer is missing: %s", required_validation_layer_names[i]);
+            MFATAL_CH(LOG_CHANNEL_RENDERER, "Required validation layer is missing: %s", required_validation_layer_names[i]);
             return false;
         }
     }
-    MINFO("All required validation layers are present.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "All required validation layers are present.");
 #endif
     
     create_info.enabledLayerCount = required_validation_layer_count;
     create_info.ppEnabledLayerNames = required_validation_layer_names;
     
     VK_CHECK(vkCreateInstance(&create_info, context.allocator, &context.instance));
-    MINFO("Vulkan Instance created.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Vulkan Instance created.");
     
     // Debugger
 #if defined(_DEBUG)
-    MDEBUG("Creating Vulkan debugger...");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Creating Vulkan debugger...");
     u32 log_severity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT |
         VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
         VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT; //|
@@ -171,22 +178,22 @@ b8 vulkan_renderer_backend_initialise(renderer_backend *backend, const char *app
     (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(context.instance, "vkCreateDebugUtilsMessengerEXT");
     MASSERT_MSG(func, "Failed to create debug messenger!");
     VK_CHECK(func(context.instance, &debug_create_info, context.allocator, &context.debug_messenger));
-    MDEBUG("Vulkan debugger created.");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Vulkan debugger created.");
 #endif
     
     // Surface
-    MDEBUG("Creating Vulkan surface...");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Creating Vulkan surface...");
     if (!platform_create_vulkan_surface(&context))
     {
-        MERROR("Failed to create platform surface!");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Failed to create platform surface!");
         return false;
     }
-    MDEBUG("Vulkan surface created.");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Vulkan surface created.");
     
     // Device creation
     if (!vulkan_device_create(&context))
     {
-        MERROR("Failed to create device!");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Failed to create device!");
         return false;
     }
     
@@ -216,9 +223,12 @@ b8 vulkan_renderer_backend_initialise(renderer_backend *backend, const char *app
     context.image_available_semaphores = darray_reserve(VkSemaphore, context.swapchain.max_frames_in_flight);
     context.queue_complete_semaphores = darray_reserve(VkSemaphore, context.swapchain.max_frames_in_flight);
     context.in_flight_fences = darray_reserve(vulkan_fence, context.swapchain.max_frames_in_flight);
+    context.in_flight_frame_counts = darray_reserve(u64, context.swapchain.max_frames_in_flight);
     
     for (u8 i = 0; i < context.swapchain.max_frames_in_flight; ++i)
     {
+        context.in_flight_frame_counts[i] = 0;
+        
         VkSemaphoreCreateInfo semaphore_create_info = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
         vkCreateSemaphore(context.device.logical_device, &semaphore_create_info, context.allocator, &context.image_available_semaphores[i]);
         vkCreateSemaphore(context.device.logical_device, &semaphore_create_info, context.allocator, &context.queue_complete_semaphores[i]);
@@ -238,10 +248,14 @@ b8 vulkan_renderer_backend_initialise(renderer_backend *backend, const char *app
         context.images_in_flight[i] = 0;
     }
     
+    context.submitted_frame_count = 0;
+    context.texture_updates = darray_create(vulkan_texture_update);
+    context.deferred_destroys = darray_create(vulkan_deferred_destroy);
+    
     // Create builtin shaders
     if (!vulkan_material_shader_create(&context, &context.material_shader))
     {
-        MERROR("Error loading built-in basic_lighting shader.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Error loading built-in basic_lighting shader.");
         return false;
     }
     
@@ -281,7 +295,7 @@ b8 vulkan_renderer_backend_initialise(renderer_backend *backend, const char *app
     upload_data_range(&context, context.device.graphics_command_pool, 0, context.device.graphics_queue, &context.object_index_buffer, 0, sizeof(u32) * index_count, indices);
     // TODO(satvik): end temp code
     
-    MINFO("Vulkan renderer initialised successfully.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Vulkan renderer initialised successfully.");
     return true;
 }
 
@@ -289,6 +303,14 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend)
 {
     vkDeviceWaitIdle(context.device.logical_device);
     
+    // Nothing is in flight any more, so everything waiting to be destroyed can go.
+    discard_texture_updates(0);
+    darray_destroy(context.texture_updates);
+    context.texture_updates = 0;
+    destroy_deferred(UINT64_MAX);
+    darray_destroy(context.deferred_destroys);
+    context.deferred_destroys = 0;
+    
     // Destroy in the opposite order of creation.
     // Destroy buffers
     vulkan_buffer_destroy(&context, &context.object_vertex_buffer);
@@ -296,6 +318,8 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend)
     
     vulkan_material_shader_destroy(&context, &context.material_shader);
     
+    vulkan_sampler_cache_destroy(&context);
+    
     // Sync objects
     for (u8 i = 0; i < context.swapchain.max_frames_in_flight; ++i)
     {
@@ -326,6 +350,9 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend)
     darray_destroy(context.in_flight_fences);
     context.in_flight_fences = 0;
     
+    darray_destroy(context.in_flight_frame_counts);
+    context.in_flight_frame_counts = 0;
+    
     darray_destroy(context.images_in_flight);
     context.images_in_flight = 0;
     
@@ -356,10 +383,10 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend)
     // Swapchain
     vulkan_swapchain_destroy(&context, &context.swapchain);
     
-    MDEBUG("Destroying Vulkan device...");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Destroying Vulkan device...");
     vulkan_device_destroy(&context);
     
-    MDEBUG("Destroying Vulkan surface...");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Destroying Vulkan surface...");
     if (context.surface)
     {
         vkDestroySurfaceKHR(context.instance, context.surface, context.allocator);
@@ -367,7 +394,7 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend)
     }
     
 #if defined(_DEBUG)
-    MDEBUG("Destroying Vulkan debugger...");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Destroying Vulkan debugger...");
     if (context.debug_messenger)
     {
         PFN_vkDestroyDebugUtilsMessengerEXT func =
@@ -376,7 +403,7 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend)
     }
 #endif
     
-    MDEBUG("Destroying Vulkan instance...");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Destroying Vulkan instance...");
     vkDestroyInstance(context.instance, context.allocator);
 }
 
@@ -388,7 +415,7 @@ void vulkan_renderer_backend_on_resized(renderer_backend *backend, u16 width, u1
     cached_framebuffer_height = height;
     context.framebuffer_size_generation++;
     
-    MINFO("Vulkan renderer backend->resized: w/h/gen: %i/%i/%llu", width, height, context.framebuffer_size_generation);
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Vulkan renderer backend->resized: w/h/gen: %i/%i/%llu", width, height, context.framebuffer_size_generation);
 }
 
 b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend, f32 delta_time)
@@ -402,10 +429,10 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend, f32 delta_time
         VkResult result = vkDeviceWaitIdle(device->logical_device);
         if (!vulkan_result_is_success(result))
         {
-            MERROR("vulkan_renderer_backend_begin_frame vkDeviceWaitIdle (1) failed: '%s'", vulkan_result_string(result, true));
+            MERROR_CH(LOG_CHANNEL_RENDERER, "vulkan_renderer_backend_begin_frame vkDeviceWaitIdle (1) failed: '%s'", vulkan_result_string(result, true));
             return false;
         }
-        MINFO("Recreating swapchain, booting.");
+        MINFO_CH(LOG_CHANNEL_RENDERER, "Recreating swapchain, booting.");
         return false;
     }
     
@@ -415,7 +442,7 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend, f32 delta_time
         VkResult result = vkDeviceWaitIdle(device->logical_device);
         if (!vulkan_result_is_success(result))
         {
-            MERROR("vulkan_renderer_backend_begin_frame vkDeviceWaitIdle (2) failed: '%s'", vulkan_result_string(result, true));
+            MERROR_CH(LOG_CHANNEL_RENDERER, "vulkan_renderer_backend_begin_frame vkDeviceWaitIdle (2) failed: '%s'", vulkan_result_string(result, true));
             return false;
         }
         
@@ -426,7 +453,7 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend, f32 delta_time
             return false;
         }
         
-        MINFO("Resized, booting.");
+        MINFO_CH(LOG_CHANNEL_RENDERER, "Resized, booting.");
         return false;
     }
     
@@ -436,10 +463,13 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend, f32 delta_time
                            &context.in_flight_fences[context.current_frame],
                            UINT64_MAX))
     {
-        MWARN("In-flight fence wait failure!");
+        MWARN_CH(LOG_CHANNEL_RENDERER, "In-flight fence wait failure!");
         return false;
     }
     
+    // Every frame up to the one which last used this fence has finished with what it used.
+    destroy_deferred(context.in_flight_frame_counts[context.current_frame]);
+    
     // Acquire the next image from the swap chain. Pass along the semaphore that should signaled when this completes.
     // This same semaphore will later be waited on by the queue submission to ensure this image is available.
     if (!vulkan_swapchain_acquire_next_image_index(
@@ -458,6 +488,9 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend, f32 delta_time
     vulkan_command_buffer_reset(command_buffer);
     vulkan_command_buffer_begin(command_buffer, false, false, false);
     
+    // Texture writes go in before the render pass which samples them.
+    record_texture_updates(command_buffer);
+    
     // Dynamic state
     VkViewport viewport;
     viewport.x = 0.0f;
@@ -555,11 +588,12 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend *backend, f32 delta_time)
                                     context.in_flight_fences[context.current_frame].handle);
     if (result != VK_SUCCESS)
     {
-        MERROR("vkQueueSubmit failed with result: %s", vulkan_result_string(result, true));
+        MERROR_CH(LOG_CHANNEL_RENDERER, "vkQueueSubmit failed with result: %s", vulkan_result_string(result, true));
         return false;
     }
     
     vulkan_command_buffer_update_submitted(command_buffer);
+    context.in_flight_frame_counts[context.current_frame] = ++context.submitted_frame_count;
     // End queue submission
     
     // Give the image back to the swapchain.
@@ -605,16 +639,16 @@ VKAPI_ATTR VkBool32 VKAPI_CALL vk_debug_callback(
     {
         default:
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-        MERROR(callback_data->pMessage);
+        MERROR_CH(LOG_CHANNEL_RENDERER, "%s", callback_data->pMessage);
         break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-        MWARN(callback_data->pMessage);
+        MWARN_CH(LOG_CHANNEL_RENDERER, "%s", callback_data->pMessage);
         break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-        MINFO(callback_data->pMessage);
+        MINFO_CH(LOG_CHANNEL_RENDERER, "%s", callback_data->pMessage);
         break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-        MTRACE(callback_data->pMessage);
+        MTRACE_CH(LOG_CHANNEL_RENDERER, "%s", callback_data->pMessage);
         break;
     }
     return VK_FALSE;
@@ -634,7 +668,7 @@ i32 find_memory_index(u32 type_filter, u32 property_flags)
         }
     }
     
-    MWARN("Unable to find suitable memory type!");
+    MWARN_CH(LOG_CHANNEL_RENDERER, "Unable to find suitable memory type!");
     return -1;
 }
 
@@ -666,7 +700,7 @@ void create_command_buffers(renderer_backend *backend)
                                        &context.graphics_command_buffers[i]);
     }
     
-    MDEBUG("Vulkan command buffers created.");
+    MDEBUG_CH(LOG_CHANNEL_RENDERER, "Vulkan command buffers created.");
 }
 
 void regenerate_framebuffers(renderer_backend *backend, vulkan_swapchain *swapchain, vulkan_renderpass *renderpass)
@@ -695,14 +729,14 @@ b8 recreate_swapchain(renderer_backend *backend)
     // If already being recreated, do not try again.
     if (context.recreating_swapchain)
     {
-        MDEBUG("recreate_swapchain called when already recreating. Booting.");
+        MDEBUG_CH(LOG_CHANNEL_RENDERER, "recreate_swapchain called when already recreating. Booting.");
         return false;
     }
     
     // Detect if the window is too small to be drawn to
     if (context.framebuffer_width == 0 || context.framebuffer_height == 0)
     {
-        MDEBUG("recreate_swapchain called when window is < 1 in a dimension. Booting.");
+        MDEBUG_CH(LOG_CHANNEL_RENDERER, "recreate_swapchain called when window is < 1 in a dimension. Booting.");
         return false;
     }
     
@@ -782,7 +816,7 @@ b8 create_buffers(vulkan_context *context)
                               true,
                               &context->object_vertex_buffer))
     {
-        MERROR("Error creating vertex buffer.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Error creating vertex buffer.");
         return false;
     }
     context->geometry_vertex_offset = 0;
@@ -796,7 +830,7 @@ b8 create_buffers(vulkan_context *context)
                               true,
                               &context->object_index_buffer))
     {
-        MERROR("Error creating vertex buffer.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Error creating vertex buffer.");
         return false;
     }
     context->geometry_index_offset = 0;
@@ -804,111 +838,433 @@ b8 create_buffers(vulkan_context *context)
     return true;
 }
 
-void vulkan_renderer_create_texture(const u8 *pixels, texture *texture)
+// Textures uploaded together share one staging buffer of up to this size. A texture larger than this
+// is uploaded on its own.
+#define VULKAN_TEXTURE_UPLOAD_BATCH_SIZE (64 * 1024 * 1024)
+
+// Copy offsets into the staging buffer have to be a multiple of the texel size, and some drivers copy
+// faster from more aligned offsets.
+#define VULKAN_TEXTURE_UPLOAD_ALIGNMENT 16
+
+static VkFormat vulkan_texture_format(texture_format format)
 {
-    // Internal data creation.
-    // TODO(satvik): Use an allocator for this.
-    texture->internal_data = (vulkan_texture_data *)mallocate(sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
-    vulkan_texture_data *data = (vulkan_texture_data *)texture->internal_data;
-    VkDeviceSize image_size = texture->width * texture->height * texture->channel_count;
-    
-    // NOTE: Assumes 8 bits per channel.
-    VkFormat image_format = VK_FORMAT_R8G8B8A8_UNORM;
-    
-    // Create a staging buffer and load data into it.
+    switch (format)
+    {
+        case TEXTURE_FORMAT_BC1:
+        return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case TEXTURE_FORMAT_BC3:
+        return VK_FORMAT_BC3_UNORM_BLOCK;
+        case TEXTURE_FORMAT_BC7:
+        return VK_FORMAT_BC7_UNORM_BLOCK;
+        default:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+// Mip levels can be generated by blitting down from the level above if the format supports linear
+// filtered blits. Block compressed formats never do.
+static b8 can_generate_mipmaps(VkFormat format)
+{
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(context.device.physical_device, format, &properties);
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+static u32 texture_layer_count(const texture *t)
+{
+    return t->layer_count > 1 ? t->layer_count : 1;
+}
+
+// The size of a mip level of a texture's pixels, across all of its layers.
+static VkDeviceSize texture_level_size(const texture *t, u32 level)
+{
+    return texture_format_level_size(t->format, t->width, t->height, level) * texture_layer_count(t);
+}
+
+// The size of the first level_count mip levels of a texture's pixels.
+static VkDeviceSize texture_data_size(const texture *t, u32 level_count)
+{
+    VkDeviceSize size = 0;
+    for (u32 level = 0; level < level_count; ++level)
+    {
+        size += texture_level_size(t, level);
+    }
+    return size;
+}
+
+static VkDeviceSize texture_upload_size(const texture *t, u32 level_count)
+{
+    VkDeviceSize image_size = texture_data_size(t, level_count);
+    return (image_size + VULKAN_TEXTURE_UPLOAD_ALIGNMENT - 1) & ~(VkDeviceSize)(VULKAN_TEXTURE_UPLOAD_ALIGNMENT - 1);
+}
+
+// Copies the textures' pixels through one staging buffer and command buffer, and waits on a single
+// fence for the lot, rather than waiting for the queue to go idle after each texture. level_counts are
+// the number of levels in each texture's pixels; any further levels of the image are generated.
+static void upload_textures(const u8 *const *pixels, texture **textures, const u32 *level_counts, u32 count, VkDeviceSize staging_size)
+{
+    // Create a staging buffer and load everything into it.
     VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
     VkMemoryPropertyFlags memory_prop_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
     vulkan_buffer staging;
-    vulkan_buffer_create(&context, image_size, usage, memory_prop_flags, true, &staging);
-    
-    vulkan_buffer_load_data(&context, &staging, 0, image_size, 0, pixels);
-    
-    // NOTE: Lots of assumptions here, different texture types will require
-    // different options here.
-    vulkan_image_create(
-                        &context,
-                        VK_IMAGE_TYPE_2D,
-                        texture->width,
-                        texture->height,
-                        image_format,
-                        VK_IMAGE_TILING_OPTIMAL,
-                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                        true,
-                        VK_IMAGE_ASPECT_COLOR_BIT,
-                        &data->image);
+    vulkan_buffer_create(&context, staging_size, usage, memory_prop_flags, true, &staging);
+    
+    u8 *staging_data = vulkan_buffer_lock_memory(&context, &staging, 0, staging_size, 0);
+    VkDeviceSize offset = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        texture *t = textures[i];
+        mcopy_memory(staging_data + offset, pixels[i], texture_data_size(t, level_counts[i]));
+        offset += texture_upload_size(t, level_counts[i]);
+    }
+    vulkan_buffer_unlock_memory(&context, &staging);
     
     vulkan_command_buffer temp_buffer;
     VkCommandPool pool = context.device.graphics_command_pool;
     VkQueue queue = context.device.graphics_queue;
     vulkan_command_buffer_allocate_and_begin_single_use(&context, pool, &temp_buffer);
     
-    // Transition the layout from whatever it is currently to optimal for recieving data.
-    vulkan_image_transition_layout(
-                                   &context,
-                                   &temp_buffer,
-                                   &data->image,
-                                   image_format,
-                                   VK_IMAGE_LAYOUT_UNDEFINED,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    
-    // Copy the data from the buffer.
-    vulkan_image_copy_from_buffer(&context, &data->image, staging.handle, &temp_buffer);
-    
-    // Transition from optimal for data reciept to shader-read-only optimal layout.
-    vulkan_image_transition_layout(
-                                   &context,
-                                   &temp_buffer,
-                                   &data->image,
-                                   image_format,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    
-    vulkan_command_buffer_end_single_use(&context, pool, &temp_buffer, queue);
+    offset = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        vulkan_texture_data *data = (vulkan_texture_data *)textures[i]->internal_data;
+        VkFormat image_format = vulkan_texture_format(textures[i]->format);
+        
+        // Transition the layout from whatever it is currently to optimal for recieving data.
+        vulkan_image_transition_layout(
+                                       &context,
+                                       &temp_buffer,
+                                       &data->image,
+                                       image_format,
+                                       VK_IMAGE_LAYOUT_UNDEFINED,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        
+        // Copy the data from the buffer, a level at a time.
+        VkDeviceSize level_offset = offset;
+        for (u32 level = 0; level < level_counts[i]; ++level)
+        {
+            vulkan_image_copy_from_buffer(&context, &data->image, staging.handle, level_offset, level, &temp_buffer);
+            level_offset += texture_level_size(textures[i], level);
+        }
+        offset += texture_upload_size(textures[i], level_counts[i]);
+        
+        if (data->image.mip_levels > level_counts[i])
+        {
+            // Blit the rest of the chain down from the top level. Leaves every level shader-read-only.
+            vulkan_image_generate_mipmaps(&context, &temp_buffer, &data->image);
+        }
+        else
+        {
+            // Transition from optimal for data reciept to shader-read-only optimal layout.
+            vulkan_image_transition_layout(
+                                           &context,
+                                           &temp_buffer,
+                                           &data->image,
+                                           image_format,
+                                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+    }
     
+    vulkan_command_buffer_end(&temp_buffer);
+    
+    // Submit, and wait on a fence rather than the whole queue, so rendering work already queued
+    // doesn't have to drain first.
+    vulkan_fence upload_fence;
+    vulkan_fence_create(&context, false, &upload_fence);
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &temp_buffer.handle;
+    VK_CHECK(vkQueueSubmit(queue, 1, &submit_info, upload_fence.handle));
+    vulkan_fence_wait(&context, &upload_fence, UINT64_MAX);
+    vulkan_fence_destroy(&context, &upload_fence);
+    
+    vulkan_command_buffer_free(&context, pool, &temp_buffer);
     vulkan_buffer_destroy(&context, &staging);
+}
+
+void vulkan_renderer_create_textures(const u8 *const *pixels, texture **textures, u32 count)
+{
+    // Block compressed textures the device can't sample are decoded to RGBA8 here. Those pixels
+    // replace the caller's for the upload.
+    const u8 **upload_pixels = mallocate(sizeof(u8 *) * count, MEMORY_TAG_RENDERER);
+    u8 **decompressed = mallocate(sizeof(u8 *) * count, MEMORY_TAG_RENDERER);
+    u32 *level_counts = mallocate(sizeof(u32) * count, MEMORY_TAG_RENDERER);
+    for (u32 i = 0; i < count; ++i)
+    {
+        texture *t = textures[i];
+        upload_pixels[i] = pixels[i];
+        level_counts[i] = t->mip_levels ? t->mip_levels : 1;
+        if (!texture_format_is_compressed(t->format) || context.device.features.textureCompressionBC)
+        {
+            continue;
+        }
+        
+        // Only the top level is decoded; the rest are generated from it like any RGBA8 texture.
+        decompressed[i] = mallocate(texture_format_size(TEXTURE_FORMAT_RGBA8, t->width, t->height), MEMORY_TAG_TEXTURE);
+        if (!block_decompress_image(pixels[i], t->width, t->height, t->format, decompressed[i]))
+        {
+            MERROR_CH(LOG_CHANNEL_RENDERER, "Texture '%s' is in a format this device can't sample, and which can't be decoded. It will be white.", t->name);
+            mset_memory(decompressed[i], 255, texture_format_size(TEXTURE_FORMAT_RGBA8, t->width, t->height));
+            t->has_transparency = false;
+        }
+        t->format = TEXTURE_FORMAT_RGBA8;
+        upload_pixels[i] = decompressed[i];
+        level_counts[i] = 1;
+    }
+    
+    for (u32 i = 0; i < count; ++i)
+    {
+        texture *t = textures[i];
+        VkFormat image_format = vulkan_texture_format(t->format);
+        
+        // Use the levels provided, or generate a full chain from a single one where possible.
+        t->mip_levels = level_counts[i];
+        if (t->mip_levels == 1 && can_generate_mipmaps(image_format))
+        {
+            t->mip_levels = texture_mip_count(t->width, t->height);
+            if (t->max_mip_levels && t->mip_levels > t->max_mip_levels)
+            {
+                t->mip_levels = t->max_mip_levels;
+            }
+        }
+        
+        // Compressed formats can't be rendered to.
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (!texture_format_is_compressed(t->format))
+        {
+            usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        }
+        
+        // Internal data creation.
+        // TODO(satvik): Use an allocator for this.
+        t->internal_data = (vulkan_texture_data *)mallocate(sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
+        vulkan_texture_data *data = (vulkan_texture_data *)t->internal_data;
+        
+        // NOTE: Lots of assumptions here, different texture types will require
+        // different options here. Every texture is viewed as an array, since that is how the
+        // material shader samples them.
+        vulkan_image_create(
+                            &context,
+                            VK_IMAGE_TYPE_2D,
+                            VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                            t->width,
+                            t->height,
+                            t->mip_levels,
+                            texture_layer_count(t),
+                            image_format,
+                            VK_IMAGE_TILING_OPTIMAL,
+                            usage,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            true,
+                            VK_IMAGE_ASPECT_COLOR_BIT,
+                            &data->image);
+        
+        t->generation++;
+    }
     
-    // Create a sampler for the texture
-    VkSamplerCreateInfo sampler_info = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
-    // TODO(satvik): These filters should be configurable.
-    sampler_info.magFilter = VK_FILTER_LINEAR;
-    sampler_info.minFilter = VK_FILTER_LINEAR;
-    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.anisotropyEnable = VK_TRUE;
-    sampler_info.maxAnisotropy = 16;
-    sampler_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    sampler_info.unnormalizedCoordinates = VK_FALSE;
-    sampler_info.compareEnable = VK_FALSE;
-    sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
-    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    sampler_info.mipLodBias = 0.0f;
-    sampler_info.minLod = 0.0f;
-    sampler_info.maxLod = 0.0f;
-    
-    VkResult result = vkCreateSampler(context.device.logical_device, &sampler_info, context.allocator, &data->sampler);
-    if (!vulkan_result_is_success(VK_SUCCESS))
-    {
-        MERROR("Error creating texture sampler: %s", vulkan_result_string(result, true));
+    // Upload in batches which fit the staging size.
+    u32 batch_start = 0;
+    VkDeviceSize batch_size = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        VkDeviceSize size = texture_upload_size(textures[i], level_counts[i]);
+        if (i > batch_start && batch_size + size > VULKAN_TEXTURE_UPLOAD_BATCH_SIZE)
+        {
+            upload_textures(upload_pixels + batch_start, textures + batch_start, level_counts + batch_start, i - batch_start, batch_size);
+            batch_start = i;
+            batch_size = 0;
+        }
+        batch_size += size;
+    }
+    if (count > batch_start)
+    {
+        upload_textures(upload_pixels + batch_start, textures + batch_start, level_counts + batch_start, count - batch_start, batch_size);
+    }
+    
+    for (u32 i = 0; i < count; ++i)
+    {
+        if (decompressed[i])
+        {
+            mfree(decompressed[i], texture_format_size(TEXTURE_FORMAT_RGBA8, textures[i]->width, textures[i]->height), MEMORY_TAG_TEXTURE);
+        }
+    }
+    mfree(level_counts, sizeof(u32) * count, MEMORY_TAG_RENDERER);
+    mfree(decompressed, sizeof(u8 *) * count, MEMORY_TAG_RENDERER);
+    mfree(upload_pixels, sizeof(u8 *) * count, MEMORY_TAG_RENDERER);
+}
+
+void vulkan_renderer_create_texture(const u8 *pixels, texture *texture)
+{
+    vulkan_renderer_create_textures(&pixels, &texture, 1);
+}
+
+void vulkan_renderer_update_texture(texture *texture, const u8 *pixels, u32 region_count, const texture_region *regions)
+{
+    vulkan_texture_data *data = (vulkan_texture_data *)texture->internal_data;
+    if (!data || region_count == 0)
+    {
         return;
     }
+    if (texture->format != TEXTURE_FORMAT_RGBA8)
+    {
+        MERROR_CH(LOG_CHANNEL_RENDERER, "vulkan_renderer_update_texture - Texture '%s' is not RGBA8, so its regions can't be updated.", texture->name);
+        return;
+    }
+    
+    vulkan_texture_update update;
+    mzero_memory(&update, sizeof(vulkan_texture_update));
+    update.image = &data->image;
+    update.region_count = region_count;
+    update.copies = mallocate(sizeof(VkBufferImageCopy) * region_count, MEMORY_TAG_RENDERER);
+    
+    // Each region's texels follow the last's in the staging buffer, tightly packed.
+    VkDeviceSize staging_size = 0;
+    for (u32 i = 0; i < region_count; ++i)
+    {
+        staging_size += (VkDeviceSize)regions[i].width * regions[i].height * 4;
+    }
+    VkMemoryPropertyFlags memory_prop_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    vulkan_buffer_create(&context, staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, memory_prop_flags, true, &update.staging);
+    
+    u8 *staging_data = vulkan_buffer_lock_memory(&context, &update.staging, 0, staging_size, 0);
+    u64 layer_size = (u64)texture->width * texture->height * 4;
+    VkDeviceSize offset = 0;
+    for (u32 i = 0; i < region_count; ++i)
+    {
+        const texture_region *region = &regions[i];
+        u64 row_size = (u64)region->width * 4;
+        const u8 *source = pixels + layer_size * region->layer + ((u64)region->y * texture->width + region->x) * 4;
+        for (u32 row = 0; row < region->height; ++row)
+        {
+            mcopy_memory(staging_data + offset + row_size * row, source + (u64)texture->width * 4 * row, row_size);
+        }
+        
+        VkBufferImageCopy *copy = &update.copies[i];
+        copy->bufferOffset = offset;
+        copy->imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy->imageSubresource.mipLevel = 0;
+        copy->imageSubresource.baseArrayLayer = region->layer;
+        copy->imageSubresource.layerCount = 1;
+        copy->imageOffset.x = (i32)region->x;
+        copy->imageOffset.y = (i32)region->y;
+        copy->imageExtent.width = region->width;
+        copy->imageExtent.height = region->height;
+        copy->imageExtent.depth = 1;
+        offset += row_size * region->height;
+    }
+    vulkan_buffer_unlock_memory(&context, &update.staging);
     
-    texture->generation++;
+    darray_push(context.texture_updates, update);
+}
+
+// Frees updates which haven't been recorded yet: all of them, or those of one image. The rest keep
+// their order, since later updates may overwrite earlier ones.
+void discard_texture_updates(const vulkan_image *image)
+{
+    u64 kept = 0;
+    u64 update_count = darray_length(context.texture_updates);
+    for (u64 i = 0; i < update_count; ++i)
+    {
+        vulkan_texture_update *update = &context.texture_updates[i];
+        if (image && update->image != image)
+        {
+            context.texture_updates[kept++] = *update;
+            continue;
+        }
+        vulkan_buffer_destroy(&context, &update->staging);
+        mfree(update->copies, sizeof(VkBufferImageCopy) * update->region_count, MEMORY_TAG_RENDERER);
+    }
+    darray_length_set(context.texture_updates, kept);
+}
+
+// Copies staged texels into their images and regenerates the levels below them. Each staging buffer
+// is destroyed once the frame being recorded has finished.
+void record_texture_updates(vulkan_command_buffer *command_buffer)
+{
+    u64 update_count = darray_length(context.texture_updates);
+    for (u64 i = 0; i < update_count; ++i)
+    {
+        vulkan_texture_update *update = &context.texture_updates[i];
+        vulkan_image *image = update->image;
+        
+        // Earlier frames may still be sampling the image, and the write waits for them.
+        vulkan_image_transition_layout(
+                                       &context,
+                                       command_buffer,
+                                       image,
+                                       VK_FORMAT_R8G8B8A8_UNORM,
+                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        vkCmdCopyBufferToImage(
+                               command_buffer->handle,
+                               update->staging.handle,
+                               image->handle,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               update->region_count,
+                               update->copies);
+        if (image->mip_levels > 1)
+        {
+            vulkan_image_generate_mipmap_regions(&context, command_buffer, image, update->region_count, update->copies);
+        }
+        else
+        {
+            vulkan_image_transition_layout(
+                                           &context,
+                                           command_buffer,
+                                           image,
+                                           VK_FORMAT_R8G8B8A8_UNORM,
+                                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+        
+        vulkan_deferred_destroy entry;
+        mzero_memory(&entry, sizeof(vulkan_deferred_destroy));
+        entry.frame_count = context.submitted_frame_count + 1;
+        entry.buffer = update->staging;
+        darray_push(context.deferred_destroys, entry);
+        mfree(update->copies, sizeof(VkBufferImageCopy) * update->region_count, MEMORY_TAG_RENDERER);
+    }
+    darray_length_set(context.texture_updates, 0);
+}
+
+// Destroys the resources which only frames that have finished could have used.
+void destroy_deferred(u64 finished_frame_count)
+{
+    u64 i = 0;
+    while (i < darray_length(context.deferred_destroys))
+    {
+        vulkan_deferred_destroy *entry = &context.deferred_destroys[i];
+        if (entry->frame_count > finished_frame_count)
+        {
+            ++i;
+            continue;
+        }
+        vulkan_image_destroy(&context, &entry->image);
+        vulkan_buffer_destroy(&context, &entry->buffer);
+        
+        u64 last = darray_length(context.deferred_destroys) - 1;
+        context.deferred_destroys[i] = context.deferred_destroys[last];
+        darray_length_set(context.deferred_destroys, last);
+    }
 }
 
 void vulkan_renderer_destroy_texture(struct texture *texture)
 {
-    vkDeviceWaitIdle(context.device.logical_device);
-    
     vulkan_texture_data *data = (vulkan_texture_data *)texture->internal_data;
     
     if (data)
     {
-        vulkan_image_destroy(&context, &data->image);
-        mzero_memory(&data->image, sizeof(vulkan_image));
-        vkDestroySampler(context.device.logical_device, data->sampler, context.allocator);
-        data->sampler = 0;
+        discard_texture_updates(&data->image);
+        
+        // Frames in flight, and the one being recorded, may still sample the image, so it is
+        // destroyed once they have finished rather than waiting for the device to go idle.
+        vulkan_deferred_destroy entry;
+        mzero_memory(&entry, sizeof(vulkan_deferred_destroy));
+        entry.frame_count = context.submitted_frame_count + 1;
+        entry.image = data->image;
+        darray_push(context.deferred_destroys, entry);
         
         mfree(texture->internal_data, sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
     }
@@ -923,15 +1279,15 @@ b8 vulkan_renderer_create_material(struct material *material)
     {
         if (!vulkan_material_shader_acquire_resources(&context, &context.material_shader, material))
         {
-            MERROR("vulkan_renderer_create_material - Failed to acquire shader resoureces.");
+            MERROR_CH(LOG_CHANNEL_RENDERER, "vulkan_renderer_create_material - Failed to acquire shader resoureces.");
             return false;
         }
         
-        MTRACE("Renderer: Material created.");
+        MTRACE_CH(LOG_CHANNEL_RENDERER, "Renderer: Material created.");
         return true;
     }
     
-    MERROR("vulkan_renderer_create_material called with nullptr. Creation failed.");
+    MERROR_CH(LOG_CHANNEL_RENDERER, "vulkan_renderer_create_material called with nullptr. Creation failed.");
     return false;
 }
 
@@ -946,11 +1302,11 @@ void vulkan_renderer_destroy_material(struct material *material)
         }
         else
         {
-            MWARN("vulkan_renderer_destroy_material called with material->internal_id=INVALID_ID. Nothing was done.");
+            MWARN_CH(LOG_CHANNEL_RENDERER, "vulkan_renderer_destroy_material called with material->internal_id=INVALID_ID. Nothing was done.");
         }
     }
     else
     {
-        MWARN("vulkan_renderer_destroy_material called with nullptr. Nothing was done.");
+        MWARN_CH(LOG_CHANNEL_RENDERER, "vulkan_renderer_destroy_material called with nullptr. Nothing was done.");
     }
 }
\ No newline at end of file
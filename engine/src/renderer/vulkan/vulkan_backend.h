@@ -15,6 +15,8 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend *backend, f32 delta_time);
 void vulkan_backend_update_object(geometry_render_data data);
 
 void vulkan_renderer_create_texture(const u8 *pixels, texture *texture);
+void vulkan_renderer_create_textures(const u8 *const *pixels, texture **textures, u32 count);
+void vulkan_renderer_update_texture(texture *texture, const u8 *pixels, u32 region_count, const texture_region *regions);
 void vulkan_renderer_destroy_texture(texture *texture);
 
 b8 vulkan_renderer_create_material(struct material *material);
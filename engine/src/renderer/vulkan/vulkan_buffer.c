@@ -33,7 +33,7 @@ b8 vulkan_buffer_create(
     out_buffer->memory_index = context->find_memory_index(requirements.memoryTypeBits, out_buffer->memory_property_flags);
     if (out_buffer->memory_index == -1)
     {
-        MERROR("Unable to create vulkan buffer because the required memory type index was not found.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Unable to create vulkan buffer because the required memory type index was not found.");
         return false;
     }
 
@@ -51,7 +51,7 @@ b8 vulkan_buffer_create(
 
     if (result != VK_SUCCESS)
     {
-        MERROR("Unable to create vulkan buffer because the required memory allocation failed. Error: %i", result);
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Unable to create vulkan buffer because the required memory allocation failed. Error: %i", result);
         return false;
     }
 
@@ -110,7 +110,7 @@ b8 vulkan_buffer_resize(
     VkResult result = vkAllocateMemory(context->device.logical_device, &allocate_info, context->allocator, &new_memory);
     if (result != VK_SUCCESS)
     {
-        MERROR("Unable to resize vulkan buffer because the required memory allocation failed. Error: %i", result);
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Unable to resize vulkan buffer because the required memory allocation failed. Error: %i", result);
         return false;
     }
 
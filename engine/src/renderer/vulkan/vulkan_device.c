@@ -41,7 +41,7 @@ b8 vulkan_device_create(vulkan_context *context)
         return false;
     }
     
-    MINFO("Creating logical device...");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Creating logical device...");
     // NOTE: Do not create additional queues for shared indices.
     b8 present_shares_graphics_queue = context->device.graphics_queue_index == context->device.present_queue_index;
     b8 transfer_shares_graphics_queue = context->device.graphics_queue_index == context->device.transfer_queue_index;
@@ -87,6 +87,8 @@ b8 vulkan_device_create(vulkan_context *context)
     // TODO(satvik): should be config driven
     VkPhysicalDeviceFeatures device_features = {};
     device_features.samplerAnisotropy = VK_TRUE; // Request anistrophy
+    // Cooked textures are block compressed. Where it isn't supported they are decoded when created.
+    device_features.textureCompressionBC = context->device.features.textureCompressionBC;
     
     b8 portability_required = false;
     u32 available_extension_count = 0;
@@ -100,7 +102,7 @@ b8 vulkan_device_create(vulkan_context *context)
         {
             if (strings_equal(available_extensions[i].extensionName, "VK_KHR_portability_subset"))
             {
-                MINFO("Adding required extension 'VK_KHR_portability_subset'.");
+                MINFO_CH(LOG_CHANNEL_RENDERER, "Adding required extension 'VK_KHR_portability_subset'.");
                 portability_required = true;
                 break;
             }
@@ -130,7 +132,7 @@ b8 vulkan_device_create(vulkan_context *context)
                             context->allocator,
                             &context->device.logical_device));
     
-    MINFO("Logical device created.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Logical device created.");
     
     // Get queues.
     vkGetDeviceQueue(
@@ -150,7 +152,7 @@ b8 vulkan_device_create(vulkan_context *context)
                      context->device.transfer_queue_index,
                      0,
                      &context->device.transfer_queue);
-    MINFO("Queues obtained.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Queues obtained.");
     
     // Create command pool for graphics queue.
     VkCommandPoolCreateInfo pool_create_info = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
@@ -161,7 +163,7 @@ b8 vulkan_device_create(vulkan_context *context)
                                  &pool_create_info,
                                  context->allocator,
                                  &context->device.graphics_command_pool));
-    MINFO("Graphics command pool created.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Graphics command pool created.");
     
     return true;
 }
@@ -174,14 +176,14 @@ void vulkan_device_destroy(vulkan_context *context)
     context->device.present_queue = 0;
     context->device.transfer_queue = 0;
     
-    MINFO("Destroying command pools...");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Destroying command pools...");
     vkDestroyCommandPool(
                          context->device.logical_device,
                          context->device.graphics_command_pool,
                          context->allocator);
     
     // Destroy logical device
-    MINFO("Destroying logical device...");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Destroying logical device...");
     if (context->device.logical_device)
     {
         vkDestroyDevice(context->device.logical_device, context->allocator);
@@ -189,7 +191,7 @@ void vulkan_device_destroy(vulkan_context *context)
     }
     
     // Physical devices are not destroyed.
-    MINFO("Releasing physical device resources...");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Releasing physical device resources...");
     context->device.physical_device = 0;
     
     if (context->device.swapchain_support.formats)
@@ -308,7 +310,7 @@ b8 select_physical_device(vulkan_context *context)
     VK_CHECK(vkEnumeratePhysicalDevices(context->instance, &physical_device_count, 0));
     if (physical_device_count == 0)
     {
-        MFATAL("No devices which support Vulkan were found.");
+        MFATAL_CH(LOG_CHANNEL_RENDERER, "No devices which support Vulkan were found.");
         return false;
     }
     const u32 max_device_count = 32;
@@ -368,36 +370,36 @@ b8 select_physical_device(vulkan_context *context)
         
         if (result)
         {
-            MINFO("Selected device: '%s'.", properties.deviceName);
+            MINFO_CH(LOG_CHANNEL_RENDERER, "Selected device: '%s'.", properties.deviceName);
             // GPU type, etc.
             switch (properties.deviceType)
             {
                 default:
                 case VK_PHYSICAL_DEVICE_TYPE_OTHER:
-                MINFO("GPU type is Unknown.");
+                MINFO_CH(LOG_CHANNEL_RENDERER, "GPU type is Unknown.");
                 break;
                 case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
-                MINFO("GPU type is Integrated.");
+                MINFO_CH(LOG_CHANNEL_RENDERER, "GPU type is Integrated.");
                 break;
                 case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
-                MINFO("GPU type is Descrete.");
+                MINFO_CH(LOG_CHANNEL_RENDERER, "GPU type is Descrete.");
                 break;
                 case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
-                MINFO("GPU type is Virtual.");
+                MINFO_CH(LOG_CHANNEL_RENDERER, "GPU type is Virtual.");
                 break;
                 case VK_PHYSICAL_DEVICE_TYPE_CPU:
-                MINFO("GPU type is CPU.");
+                MINFO_CH(LOG_CHANNEL_RENDERER, "GPU type is CPU.");
                 break;
             }
             
-            MINFO(
+            MINFO_CH(LOG_CHANNEL_RENDERER, 
                   "GPU Driver version: %d.%d.%d",
                   VK_VERSION_MAJOR(properties.driverVersion),
                   VK_VERSION_MINOR(properties.driverVersion),
                   VK_VERSION_PATCH(properties.driverVersion));
             
             // Vulkan API version.
-            MINFO(
+            MINFO_CH(LOG_CHANNEL_RENDERER, 
                   "Vulkan API version: %d.%d.%d",
                   VK_VERSION_MAJOR(properties.apiVersion),
                   VK_VERSION_MINOR(properties.apiVersion),
@@ -409,11 +411,11 @@ b8 select_physical_device(vulkan_context *context)
                 f32 memory_size_gib = (((f32)memory.memoryHeaps[j].size) / 1024.0f / 1024.0f / 1024.0f);
                 if (memory.memoryHeaps[j].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
                 {
-                    MINFO("Local GPU memory: %.2f GiB", memory_size_gib);
+                    MINFO_CH(LOG_CHANNEL_RENDERER, "Local GPU memory: %.2f GiB", memory_size_gib);
                 }
                 else
                 {
-                    MINFO("Shared System memory: %.2f GiB", memory_size_gib);
+                    MINFO_CH(LOG_CHANNEL_RENDERER, "Shared System memory: %.2f GiB", memory_size_gib);
                 }
             }
             
@@ -435,11 +437,11 @@ b8 select_physical_device(vulkan_context *context)
     // Ensure a device was selected
     if (!context->device.physical_device)
     {
-        MERROR("No physical devices were found which meet the requirements.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "No physical devices were found which meet the requirements.");
         return false;
     }
     
-    MINFO("Physical device selected.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Physical device selected.");
     return true;
 }
 
@@ -463,7 +465,7 @@ b8 physical_device_meets_requirements(
     {
         if (properties->deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
         {
-            MINFO("Device is not a discrete GPU, and one is required. Skipping.");
+            MINFO_CH(LOG_CHANNEL_RENDERER, "Device is not a discrete GPU, and one is required. Skipping.");
             return false;
         }
     }
@@ -474,7 +476,7 @@ b8 physical_device_meets_requirements(
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families);
     
     // Look at each queue and see what queues it supports
-    MINFO("Graphics | Present | Compute | Transfer | Name");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Graphics | Present | Compute | Transfer | Name");
     u8 min_transfer_score = 255;
     for (u32 i = 0; i < queue_family_count; ++i)
     {
@@ -516,7 +518,7 @@ b8 physical_device_meets_requirements(
     }
     
     // Print out some info about the device
-    MINFO("       %d |       %d |       %d |        %d | %s",
+    MINFO_CH(LOG_CHANNEL_RENDERER, "       %d |       %d |       %d |        %d | %s",
           out_queue_info->graphics_family_index != -1,
           out_queue_info->present_family_index != -1,
           out_queue_info->compute_family_index != -1,
@@ -529,11 +531,11 @@ b8 physical_device_meets_requirements(
         (!requirements->compute || (requirements->compute && out_queue_info->compute_family_index != -1)) &&
         (!requirements->transfer || (requirements->transfer && out_queue_info->transfer_family_index != -1)))
     {
-        MINFO("Device meets queue requirements.");
-        MTRACE("Graphics Family Index: %i", out_queue_info->graphics_family_index);
-        MTRACE("Present Family Index:  %i", out_queue_info->present_family_index);
-        MTRACE("Transfer Family Index: %i", out_queue_info->transfer_family_index);
-        MTRACE("Compute Family Index:  %i", out_queue_info->compute_family_index);
+        MINFO_CH(LOG_CHANNEL_RENDERER, "Device meets queue requirements.");
+        MTRACE_CH(LOG_CHANNEL_RENDERER, "Graphics Family Index: %i", out_queue_info->graphics_family_index);
+        MTRACE_CH(LOG_CHANNEL_RENDERER, "Present Family Index:  %i", out_queue_info->present_family_index);
+        MTRACE_CH(LOG_CHANNEL_RENDERER, "Transfer Family Index: %i", out_queue_info->transfer_family_index);
+        MTRACE_CH(LOG_CHANNEL_RENDERER, "Compute Family Index:  %i", out_queue_info->compute_family_index);
         
         // Query swapchain support.
         vulkan_device_query_swapchain_support(
@@ -551,7 +553,7 @@ b8 physical_device_meets_requirements(
             {
                 mfree(out_swapchain_support->present_modes, sizeof(VkPresentModeKHR) * out_swapchain_support->present_mode_count, MEMORY_TAG_RENDERER);
             }
-            MINFO("Required swapchain support not present, skipping device.");
+            MINFO_CH(LOG_CHANNEL_RENDERER, "Required swapchain support not present, skipping device.");
             return false;
         }
         
@@ -589,7 +591,7 @@ b8 physical_device_meets_requirements(
                     
                     if (!found)
                     {
-                        MINFO("Required extension not found: '%s', skipping device.", requirements->device_extension_names[i]);
+                        MINFO_CH(LOG_CHANNEL_RENDERER, "Required extension not found: '%s', skipping device.", requirements->device_extension_names[i]);
                         mfree(available_extensions, sizeof(VkExtensionProperties) * available_extension_count, MEMORY_TAG_RENDERER);
                         return false;
                     }
@@ -601,7 +603,7 @@ b8 physical_device_meets_requirements(
         // Sampler anisotropy
         if (requirements->sampler_anisotropy && !features->samplerAnisotropy)
         {
-            MINFO("Device does not support samplerAnisotropy, skipping.");
+            MINFO_CH(LOG_CHANNEL_RENDERER, "Device does not support samplerAnisotropy, skipping.");
             return false;
         }
         
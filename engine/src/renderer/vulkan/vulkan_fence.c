@@ -52,19 +52,19 @@ b8 vulkan_fence_wait(vulkan_context *context, vulkan_fence *fence, u64 timeout_n
             fence->is_signaled = true;
             return true;
         case VK_TIMEOUT:
-            MWARN("vk_fence_wait - Timed out");
+            MWARN_CH(LOG_CHANNEL_RENDERER, "vk_fence_wait - Timed out");
             break;
         case VK_ERROR_DEVICE_LOST:
-            MERROR("vk_fence_wait - VK_ERROR_DEVICE_LOST.");
+            MERROR_CH(LOG_CHANNEL_RENDERER, "vk_fence_wait - VK_ERROR_DEVICE_LOST.");
             break;
         case VK_ERROR_OUT_OF_HOST_MEMORY:
-            MERROR("vk_fence_wait - VK_ERROR_OUT_OF_HOST_MEMORY.");
+            MERROR_CH(LOG_CHANNEL_RENDERER, "vk_fence_wait - VK_ERROR_OUT_OF_HOST_MEMORY.");
             break;
         case VK_ERROR_OUT_OF_DEVICE_MEMORY:
-            MERROR("vk_fence_wait - VK_ERROR_OUT_OF_DEVICE_MEMORY.");
+            MERROR_CH(LOG_CHANNEL_RENDERER, "vk_fence_wait - VK_ERROR_OUT_OF_DEVICE_MEMORY.");
             break;
         default:
-            MERROR("vk_fence_wait - An unknown error has occurred.");
+            MERROR_CH(LOG_CHANNEL_RENDERER, "vk_fence_wait - An unknown error has occurred.");
             break;
         }
     }
@@ -8,8 +8,11 @@
 void vulkan_image_create(
                          vulkan_context *context,
                          VkImageType image_type,
+                         VkImageViewType view_type,
                          u32 width,
                          u32 height,
+                         u32 mip_levels,
+                         u32 layer_count,
                          VkFormat format,
                          VkImageTiling tiling,
                          VkImageUsageFlags usage,
@@ -22,6 +25,9 @@ void vulkan_image_create(
     // Copy params
     out_image->width = width;
     out_image->height = height;
+    out_image->mip_levels = mip_levels;
+    out_image->layer_count = layer_count;
+    out_image->view_type = view_type;
     
     // Creation info.
     VkImageCreateInfo image_create_info = {VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
@@ -29,8 +35,8 @@ void vulkan_image_create(
     image_create_info.extent.width = width;
     image_create_info.extent.height = height;
     image_create_info.extent.depth = 1; // TODO(satvik): Support configurable depth.
-    image_create_info.mipLevels = 4;    // TODO(satvik): Support mip mapping
-    image_create_info.arrayLayers = 1;  // TODO(satvik): Support number of layers in the image.
+    image_create_info.mipLevels = mip_levels;
+    image_create_info.arrayLayers = layer_count;
     image_create_info.format = format;
     image_create_info.tiling = tiling;
     image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -47,7 +53,7 @@ void vulkan_image_create(
     i32 memory_type = context->find_memory_index(memory_requirements.memoryTypeBits, memory_flags);
     if (memory_type == -1)
     {
-        MERROR("Required memory type not found. Image not valid.");
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Required memory type not found. Image not valid.");
     }
     
     // Allocate memory
@@ -75,15 +81,15 @@ void vulkan_image_view_create(
 {
     VkImageViewCreateInfo view_create_info = {VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
     view_create_info.image = image->handle;
-    view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D; // TODO(satvik): Make configurable.
+    view_create_info.viewType = image->view_type;
     view_create_info.format = format;
     view_create_info.subresourceRange.aspectMask = aspect_flags;
     
     // TODO(satvik): Make configurable
     view_create_info.subresourceRange.baseMipLevel = 0;
-    view_create_info.subresourceRange.levelCount = 1;
+    view_create_info.subresourceRange.levelCount = image->mip_levels;
     view_create_info.subresourceRange.baseArrayLayer = 0;
-    view_create_info.subresourceRange.layerCount = 1;
+    view_create_info.subresourceRange.layerCount = image->layer_count;
     
     VK_CHECK(vkCreateImageView(context->device.logical_device, &view_create_info, context->allocator, &image->view));
 }
@@ -104,9 +110,9 @@ void vulkan_image_transition_layout(
     barrier.image = image->handle;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = image->mip_levels;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.layerCount = image->layer_count;
     
     VkPipelineStageFlags source_stage;
     VkPipelineStageFlags dest_stage;
@@ -123,6 +129,16 @@ void vulkan_image_transition_layout(
         // Used for copying
         dest_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     }
+    else if (old_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    {
+        // Rewriting part of an image which has been sampled. Its contents are kept, and the write
+        // waits for reads by work submitted before it.
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        
+        source_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dest_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
     else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
     {
         // Transitioning from a transfer destination layout to a shader-readonly layout.
@@ -137,7 +153,7 @@ void vulkan_image_transition_layout(
     }
     else
     {
-        MFATAL("unsupported layout transition!");
+        MFATAL_CH(LOG_CHANNEL_RENDERER, "unsupported layout transition!");
         return;
     }
     
@@ -154,22 +170,24 @@ void vulkan_image_copy_from_buffer(
                                    vulkan_context *context,
                                    vulkan_image *image,
                                    VkBuffer buffer,
+                                   u64 buffer_offset,
+                                   u32 mip_level,
                                    vulkan_command_buffer *command_buffer)
 {
     // Region to copy
     VkBufferImageCopy region;
     mzero_memory(&region, sizeof(VkBufferImageCopy));
-    region.bufferOffset = 0;
+    region.bufferOffset = buffer_offset;
     region.bufferRowLength = 0;
     region.bufferImageHeight = 0;
     
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.mipLevel = mip_level;
     region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
+    region.imageSubresource.layerCount = image->layer_count;
     
-    region.imageExtent.width = image->width;
-    region.imageExtent.height = image->height;
+    region.imageExtent.width = image->width >> mip_level ? image->width >> mip_level : 1;
+    region.imageExtent.height = image->height >> mip_level ? image->height >> mip_level : 1;
     region.imageExtent.depth = 1;
     
     vkCmdCopyBufferToImage(
@@ -181,6 +199,126 @@ void vulkan_image_copy_from_buffer(
                            &region);
 }
 
+// Blits each region of a level down to the next one. With no regions, the whole level is blitted.
+static void blit_level(
+                       vulkan_command_buffer *command_buffer,
+                       vulkan_image *image,
+                       u32 level,
+                       u32 region_count,
+                       const VkBufferImageCopy *regions)
+{
+    u32 blit_count = region_count ? region_count : 1;
+    VkImageBlit *blits = mallocate(sizeof(VkImageBlit) * blit_count, MEMORY_TAG_RENDERER);
+    for (u32 i = 0; i < blit_count; ++i)
+    {
+        // Regions cover the whole of every layer, or part of one.
+        i32 x = 0;
+        i32 y = 0;
+        i32 right = (i32)image->width;
+        i32 bottom = (i32)image->height;
+        u32 layer = 0;
+        u32 layer_count = image->layer_count;
+        if (region_count)
+        {
+            x = regions[i].imageOffset.x;
+            y = regions[i].imageOffset.y;
+            right = x + (i32)regions[i].imageExtent.width;
+            bottom = y + (i32)regions[i].imageExtent.height;
+            layer = regions[i].imageSubresource.baseArrayLayer;
+            layer_count = 1;
+        }
+        
+        VkImageBlit *blit = &blits[i];
+        blit->srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit->srcSubresource.mipLevel = level - 1;
+        blit->srcSubresource.baseArrayLayer = layer;
+        blit->srcSubresource.layerCount = layer_count;
+        blit->srcOffsets[0].x = x >> (level - 1);
+        blit->srcOffsets[0].y = y >> (level - 1);
+        blit->srcOffsets[1].x = right >> (level - 1) > blit->srcOffsets[0].x ? right >> (level - 1) : blit->srcOffsets[0].x + 1;
+        blit->srcOffsets[1].y = bottom >> (level - 1) > blit->srcOffsets[0].y ? bottom >> (level - 1) : blit->srcOffsets[0].y + 1;
+        blit->srcOffsets[1].z = 1;
+        blit->dstSubresource = blit->srcSubresource;
+        blit->dstSubresource.mipLevel = level;
+        blit->dstOffsets[0].x = x >> level;
+        blit->dstOffsets[0].y = y >> level;
+        blit->dstOffsets[1].x = right >> level > blit->dstOffsets[0].x ? right >> level : blit->dstOffsets[0].x + 1;
+        blit->dstOffsets[1].y = bottom >> level > blit->dstOffsets[0].y ? bottom >> level : blit->dstOffsets[0].y + 1;
+        blit->dstOffsets[1].z = 1;
+    }
+    
+    vkCmdBlitImage(
+                   command_buffer->handle,
+                   image->handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   image->handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   blit_count, blits,
+                   VK_FILTER_LINEAR);
+    mfree(blits, sizeof(VkImageBlit) * blit_count, MEMORY_TAG_RENDERER);
+}
+
+static void generate_mipmaps(
+                             vulkan_context *context,
+                             vulkan_command_buffer *command_buffer,
+                             vulkan_image *image,
+                             u32 region_count,
+                             const VkBufferImageCopy *regions)
+{
+    VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcQueueFamilyIndex = context->device.graphics_queue_index;
+    barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+    barrier.image = image->handle;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = image->layer_count;
+    
+    for (u32 level = 1; level < image->mip_levels; ++level)
+    {
+        // Wait for the level above to be written, and make it the blit source.
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer->handle, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+        
+        blit_level(command_buffer, image, level, region_count, regions);
+        
+        // The level above is finished with.
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer->handle, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+    }
+    
+    // The last level was only ever written to.
+    barrier.subresourceRange.baseMipLevel = image->mip_levels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer->handle, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+}
+
+void vulkan_image_generate_mipmaps(
+                                   vulkan_context *context,
+                                   vulkan_command_buffer *command_buffer,
+                                   vulkan_image *image)
+{
+    generate_mipmaps(context, command_buffer, image, 0, 0);
+}
+
+void vulkan_image_generate_mipmap_regions(
+                                          vulkan_context *context,
+                                          vulkan_command_buffer *command_buffer,
+                                          vulkan_image *image,
+                                          u32 region_count,
+                                          const VkBufferImageCopy *regions)
+{
+    generate_mipmaps(context, command_buffer, image, region_count, regions);
+}
+
 void vulkan_image_destroy(vulkan_context *context, vulkan_image *image)
 {
     if (image->view)
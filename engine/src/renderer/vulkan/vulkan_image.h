@@ -5,8 +5,11 @@
 void vulkan_image_create(
                          vulkan_context *context,
                          VkImageType image_type,
+                         VkImageViewType view_type,
                          u32 width,
                          u32 height,
+                         u32 mip_levels,
+                         u32 layer_count,
                          VkFormat format,
                          VkImageTiling tiling,
                          VkImageUsageFlags usage,
@@ -22,7 +25,7 @@ void vulkan_image_view_create(
                               VkImageAspectFlags aspect_flags);
 
 /**
- * Transitions the provided image from old_layout to new_layout.
+ * Transitions all mip levels and layers of the provided image from old_layout to new_layout.
  */
 void vulkan_image_transition_layout(
                                     vulkan_context *context,
@@ -33,15 +36,41 @@ void vulkan_image_transition_layout(
                                     VkImageLayout new_layout);
 
 /**
- * Copies data in buffer to provided image.
+ * Copies data in buffer to a mip level of every layer of the provided image. The layers follow
+ * each other in the buffer.
  * @param context The Vulkan context.
  * @param image The image to copy the buffer's data to.
  * @param buffer The buffer whose data will be copied.
+ * @param buffer_offset Where in the buffer the image's data starts.
+ * @param mip_level The mip level to copy to.
  */
 void vulkan_image_copy_from_buffer(
                                    vulkan_context *context,
                                    vulkan_image *image,
                                    VkBuffer buffer,
+                                   u64 buffer_offset,
+                                   u32 mip_level,
                                    vulkan_command_buffer *command_buffer);
 
+/**
+ * Fills mip levels 1 and up of every layer by repeatedly blitting each level down from the one above it, then
+ * transitions every level to shader-read-only optimal. All levels must be in the transfer destination
+ * layout, with level 0 written. The format must support linear filtered blits.
+ */
+void vulkan_image_generate_mipmaps(
+                                   vulkan_context *context,
+                                   vulkan_command_buffer *command_buffer,
+                                   vulkan_image *image);
+
+/**
+ * Like vulkan_image_generate_mipmaps, but only blits down the parts of each level below the given
+ * regions of level 0, as written by vkCmdCopyBufferToImage. The rest of every level is kept.
+ */
+void vulkan_image_generate_mipmap_regions(
+                                          vulkan_context *context,
+                                          vulkan_command_buffer *command_buffer,
+                                          vulkan_image *image,
+                                          u32 region_count,
+                                          const VkBufferImageCopy *regions);
+
 void vulkan_image_destroy(vulkan_context *context, vulkan_image *image);
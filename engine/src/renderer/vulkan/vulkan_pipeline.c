@@ -159,11 +159,11 @@ b8 vulkan_graphics_pipeline_create(
 
     if (vulkan_result_is_success(result))
     {
-        MDEBUG("Graphics pipeline created!");
+        MDEBUG_CH(LOG_CHANNEL_RENDERER, "Graphics pipeline created!");
         return true;
     }
 
-    MERROR("vkCreateGraphicsPipelines failed with %s.", vulkan_result_string(result, true));
+    MERROR_CH(LOG_CHANNEL_RENDERER, "vkCreateGraphicsPipelines failed with %s.", vulkan_result_string(result, true));
     return false;
 }
 
@@ -0,0 +1,108 @@
+#include "vulkan_sampler.h"
+
+#include "vulkan_utils.h"
+
+#include "core/logger.h"
+
+static b8 sampler_config_equal(const texture_sampler_config *a, const texture_sampler_config *b)
+{
+    return a->minify == b->minify && a->magnify == b->magnify && a->mip_filter == b->mip_filter &&
+        a->repeat_u == b->repeat_u && a->repeat_v == b->repeat_v && a->repeat_w == b->repeat_w &&
+        a->max_anisotropy == b->max_anisotropy && a->mip_lod_bias == b->mip_lod_bias &&
+        a->min_lod == b->min_lod && a->clamp_max_lod == b->clamp_max_lod &&
+        (!a->clamp_max_lod || a->max_lod == b->max_lod);
+}
+
+static VkFilter vulkan_filter(texture_filter filter)
+{
+    return filter == TEXTURE_FILTER_NEAREST ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+}
+
+static VkSamplerAddressMode vulkan_address_mode(texture_repeat repeat)
+{
+    switch (repeat)
+    {
+        case TEXTURE_REPEAT_MIRRORED_REPEAT:
+            return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+        case TEXTURE_REPEAT_CLAMP_TO_EDGE:
+            return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        default:
+            return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    }
+}
+
+VkSampler vulkan_sampler_acquire(vulkan_context *context, const texture_sampler_config *config)
+{
+    vulkan_sampler_cache *cache = &context->sampler_cache;
+    for (u32 i = 0; i < cache->count; ++i)
+    {
+        if (sampler_config_equal(&cache->entries[i].config, config))
+        {
+            return cache->entries[i].handle;
+        }
+    }
+    
+    if (cache->count == VULKAN_MAX_SAMPLER_COUNT)
+    {
+        MERROR_CH(LOG_CHANNEL_RENDERER, "vulkan_sampler_acquire - the sampler cache is full. Increase VULKAN_MAX_SAMPLER_COUNT.");
+        return 0;
+    }
+    
+    // Anisotropy is limited to what the device supports.
+    f32 max_anisotropy = context->device.properties.limits.maxSamplerAnisotropy;
+    if (config->max_anisotropy > 0.0f && config->max_anisotropy < max_anisotropy)
+    {
+        max_anisotropy = config->max_anisotropy;
+    }
+    
+    VkSamplerCreateInfo sampler_info = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    sampler_info.magFilter = vulkan_filter(config->magnify);
+    sampler_info.minFilter = vulkan_filter(config->minify);
+    sampler_info.addressModeU = vulkan_address_mode(config->repeat_u);
+    sampler_info.addressModeV = vulkan_address_mode(config->repeat_v);
+    sampler_info.addressModeW = vulkan_address_mode(config->repeat_w);
+    sampler_info.anisotropyEnable = max_anisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+    sampler_info.maxAnisotropy = max_anisotropy;
+    sampler_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    sampler_info.unnormalizedCoordinates = VK_FALSE;
+    sampler_info.compareEnable = VK_FALSE;
+    sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
+    sampler_info.mipmapMode = config->mip_filter == TEXTURE_FILTER_NEAREST ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.mipLodBias = config->mip_lod_bias;
+    sampler_info.minLod = config->min_lod;
+    // Unclamped, each texture's view already limits it to the levels it has, so one sampler suits any
+    // texture. Clamped, Vulkan needs maxLod no lower than minLod.
+    if (config->clamp_max_lod)
+    {
+        sampler_info.maxLod = config->max_lod > config->min_lod ? config->max_lod : config->min_lod;
+    }
+    else
+    {
+        sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+    }
+    
+    VkSampler sampler = 0;
+    VkResult result = vkCreateSampler(context->device.logical_device, &sampler_info, context->allocator, &sampler);
+    if (!vulkan_result_is_success(result))
+    {
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Error creating texture sampler: %s", vulkan_result_string(result, true));
+        return 0;
+    }
+    
+    vulkan_sampler_entry *entry = &cache->entries[cache->count++];
+    entry->config = *config;
+    entry->handle = sampler;
+    MTRACE_CH(LOG_CHANNEL_RENDERER, "Created sampler %u of %u.", cache->count, VULKAN_MAX_SAMPLER_COUNT);
+    return sampler;
+}
+
+void vulkan_sampler_cache_destroy(vulkan_context *context)
+{
+    vulkan_sampler_cache *cache = &context->sampler_cache;
+    for (u32 i = 0; i < cache->count; ++i)
+    {
+        vkDestroySampler(context->device.logical_device, cache->entries[i].handle, context->allocator);
+        cache->entries[i].handle = 0;
+    }
+    cache->count = 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "vulkan_types.h"
+
+/**
+ * @brief Gets the sampler for a configuration, creating it the first time the configuration is used.
+ * Samplers are shared, and live until the cache is destroyed.
+ * 
+ * @param context The Vulkan context.
+ * @param config The sampler configuration.
+ * @return The sampler, or 0 if it could not be created.
+ */
+VkSampler vulkan_sampler_acquire(vulkan_context *context, const texture_sampler_config *config);
+
+/**
+ * @brief Destroys every sampler in the cache.
+ * 
+ * @param context The Vulkan context.
+ */
+void vulkan_sampler_cache_destroy(vulkan_context *context);
@@ -4,7 +4,7 @@
 #include "core/logger.h"
 #include "core/mmemory.h"
 
-#include "platform/filesystem.h"
+#include "platform/vfs.h"
 
 b8 create_shader_module(
     vulkan_context *context,
@@ -16,32 +16,20 @@ b8 create_shader_module(
 {
     // Build file name.
     char file_name[512];
-    string_format(file_name, "assets/shaders/%s.%s.spv", name, type_str);
+    string_format(file_name, "shaders/%s.%s.spv", name, type_str);
 
     mzero_memory(&shader_stages[stage_index].create_info, sizeof(VkShaderModuleCreateInfo));
     shader_stages[stage_index].create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 
-    // Obtain file handle.
-    file_handle handle;
-    if (!filesystem_open(file_name, FILE_MODE_READ, true, &handle))
+    // Map the file rather than copying it; the driver takes its own copy of the code.
+    vfs_file file;
+    if (!vfs_open(file_name, FILE_ACCESS_SEQUENTIAL, &file) || file.size == 0)
     {
-        MERROR("Unable to read shader module: %s.", file_name);
+        MERROR_CH(LOG_CHANNEL_RENDERER, "Unable to read shader module: %s.", file_name);
         return false;
     }
-
-    // Read the entire file as binary.
-    u64 size = 0;
-    u8 *file_buffer = 0;
-    if (!filesystem_read_all_bytes(&handle, &file_buffer, &size))
-    {
-        MERROR("Unable to binary read shader module: %s.", file_name);
-        return false;
-    }
-    shader_stages[stage_index].create_info.codeSize = size;
-    shader_stages[stage_index].create_info.pCode = (u32 *)file_buffer;
-
-    // Close the file.
-    filesystem_close(&handle);
+    shader_stages[stage_index].create_info.codeSize = file.size;
+    shader_stages[stage_index].create_info.pCode = (const u32 *)file.data;
 
     VK_CHECK(vkCreateShaderModule(
         context->device.logical_device,
@@ -49,6 +37,9 @@ b8 create_shader_module(
         context->allocator,
         &shader_stages[stage_index].handle));
 
+    vfs_close(&file);
+    shader_stages[stage_index].create_info.pCode = 0;
+
     // Shader stage info
     mzero_memory(&shader_stages[stage_index].shader_stage_create_info, sizeof(VkPipelineShaderStageCreateInfo));
     shader_stages[stage_index].shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -60,7 +60,7 @@ b8 vulkan_swapchain_acquire_next_image_index(
     }
     else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
     {
-        MFATAL("Failed to acquire swapchain image!");
+        MFATAL_CH(LOG_CHANNEL_RENDERER, "Failed to acquire swapchain image!");
         return false;
     }
 
@@ -92,7 +92,7 @@ void vulkan_swapchain_present(
     }
     else if (result != VK_SUCCESS)
     {
-        MFATAL("Failed to present swap chain image!");
+        MFATAL_CH(LOG_CHANNEL_RENDERER, "Failed to present swap chain image!");
     }
 
     // Increment (and loop) the index.
@@ -231,15 +231,18 @@ void create(vulkan_context *context, u32 width, u32 height, vulkan_swapchain *sw
     if (!vulkan_device_detect_depth_format(&context->device))
     {
         context->device.depth_format = VK_FORMAT_UNDEFINED;
-        MFATAL("Failed to find a supported format!");
+        MFATAL_CH(LOG_CHANNEL_RENDERER, "Failed to find a supported format!");
     }
 
     // Create depth image and its view.
     vulkan_image_create(
         context,
         VK_IMAGE_TYPE_2D,
+        VK_IMAGE_VIEW_TYPE_2D,
         swapchain_extent.width,
         swapchain_extent.height,
+        1,
+        1,
         context->device.depth_format,
         VK_IMAGE_TILING_OPTIMAL,
         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
@@ -248,7 +251,7 @@ void create(vulkan_context *context, u32 width, u32 height, vulkan_swapchain *sw
         VK_IMAGE_ASPECT_DEPTH_BIT,
         &swapchain->depth_attachment);
 
-    MINFO("Swapchain created successfully.");
+    MINFO_CH(LOG_CHANNEL_RENDERER, "Swapchain created successfully.");
 }
 
 void destroy(vulkan_context *context, vulkan_swapchain *swapchain)
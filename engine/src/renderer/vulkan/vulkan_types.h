@@ -62,6 +62,9 @@ typedef struct vulkan_image
     VkImageView view;
     u32 width;
     u32 height;
+    u32 mip_levels;
+    u32 layer_count;
+    VkImageViewType view_type;
 } vulkan_image;
 
 typedef enum vulkan_render_pass_state
@@ -153,6 +156,8 @@ typedef struct vulkan_descriptor_state
     // One per frame
     u32 generations[3];
     u32 ids[3];
+    // For image samplers, the sampler last written.
+    VkSampler samplers[3];
 } vulkan_descriptor_state;
 
 #define VULKAN_MATERIAL_SHADER_DESCRIPTOR_COUNT 2
@@ -166,6 +171,22 @@ typedef struct vulkan_material_shader_instance_state
     vulkan_descriptor_state descriptor_states[VULKAN_MATERIAL_SHADER_DESCRIPTOR_COUNT];
 } vulkan_material_shader_instance_state;
 
+// Max number of distinct sampler configurations. Devices only have to allow 4000 samplers, so they are
+// shared between textures rather than created for each.
+#define VULKAN_MAX_SAMPLER_COUNT 64
+
+typedef struct vulkan_sampler_entry
+{
+    texture_sampler_config config;
+    VkSampler handle;
+} vulkan_sampler_entry;
+
+typedef struct vulkan_sampler_cache
+{
+    u32 count;
+    vulkan_sampler_entry entries[VULKAN_MAX_SAMPLER_COUNT];
+} vulkan_sampler_cache;
+
 // Max number of material instances.
 #define VULKAN_MAX_MATERIAL_COUNT 1024
 
@@ -217,6 +238,25 @@ typedef struct vulkan_material_shader
     
 } vulkan_material_shader;
 
+// Texels staged for regions of a texture's image, copied in when the next frame is recorded.
+typedef struct vulkan_texture_update
+{
+    vulkan_image *image;
+    vulkan_buffer staging;
+    u32 region_count;
+    // Where each region's texels are in the staging buffer, and where they go in the image.
+    VkBufferImageCopy *copies;
+} vulkan_texture_update;
+
+// Resources which frames in flight may still be using, destroyed once they have finished.
+typedef struct vulkan_deferred_destroy
+{
+    // How many frames must have finished before it can go.
+    u64 frame_count;
+    vulkan_image image;
+    vulkan_buffer buffer;
+} vulkan_deferred_destroy;
+
 typedef struct vulkan_context
 {
     f32 frame_delta_time;
@@ -266,6 +306,17 @@ typedef struct vulkan_context
     // Holds pointers to fences which exist and are owned elsewhere.
     vulkan_fence **images_in_flight;
     
+    // The number of frames submitted.
+    u64 submitted_frame_count;
+    // darray. Per in-flight fence, how many frames will have finished once it signals.
+    u64 *in_flight_frame_counts;
+    
+    // darray. Written by the renderer between frames, and recorded at the start of the next one.
+    vulkan_texture_update *texture_updates;
+    
+    // darray
+    vulkan_deferred_destroy *deferred_destroys;
+    
     u32 image_index;
     u32 current_frame;
     
@@ -279,6 +330,9 @@ typedef struct vulkan_context
     // TODO(satvik): Make dynamic.
     vulkan_geometry_data geometries[VULKAN_MAX_GEOMETRY_COUNT];
     
+    // Samplers, shared by every texture map sampled the same way.
+    vulkan_sampler_cache sampler_cache;
+    
     i32 (*find_memory_index)(u32 type_filter, u32 property_flags);
     
 } vulkan_context;
@@ -286,5 +340,4 @@ typedef struct vulkan_context
 typedef struct vulkan_texture_data
 {
     vulkan_image image;
-    VkSampler sampler;
 } vulkan_texture_data;
@@ -0,0 +1,392 @@
+#include "block_compression.h"
+
+#include "core/mmemory.h"
+#include "math/mmath.h"
+
+u64 texture_format_size(texture_format format, u32 width, u32 height)
+{
+    u64 blocks = (u64)((width + 3) / 4) * ((height + 3) / 4);
+    switch (format)
+    {
+        case TEXTURE_FORMAT_RGBA8:
+        return (u64)width * height * 4;
+        case TEXTURE_FORMAT_BC1:
+        return blocks * 8;
+        case TEXTURE_FORMAT_BC3:
+        case TEXTURE_FORMAT_BC7:
+        return blocks * 16;
+        default:
+        return 0;
+    }
+}
+
+u64 texture_format_level_size(texture_format format, u32 width, u32 height, u32 level)
+{
+    u32 level_width = width >> level;
+    u32 level_height = height >> level;
+    return texture_format_size(format, level_width ? level_width : 1, level_height ? level_height : 1);
+}
+
+u32 texture_mip_count(u32 width, u32 height)
+{
+    u32 largest = width > height ? width : height;
+    u32 count = 1;
+    while (largest > 1)
+    {
+        largest >>= 1;
+        count++;
+    }
+    return count;
+}
+
+b8 texture_format_is_compressed(texture_format format)
+{
+    return format == TEXTURE_FORMAT_BC1 || format == TEXTURE_FORMAT_BC3 || format == TEXTURE_FORMAT_BC7;
+}
+
+static i32 quantise(f32 value, f32 max)
+{
+    value = value < 0.0f ? 0.0f : value > 255.0f ? 255.0f : value;
+    return (i32)(value * max / 255.0f + 0.5f);
+}
+
+static u16 pack_565(const f32 *rgb)
+{
+    i32 r = quantise(rgb[0], 31.0f);
+    i32 g = quantise(rgb[1], 63.0f);
+    i32 b = quantise(rgb[2], 31.0f);
+    return (u16)((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(u16 colour, u8 *out_rgb)
+{
+    u8 r = (colour >> 11) & 0x1F;
+    u8 g = (colour >> 5) & 0x3F;
+    u8 b = colour & 0x1F;
+    out_rgb[0] = (r << 3) | (r >> 2);
+    out_rgb[1] = (g << 2) | (g >> 4);
+    out_rgb[2] = (b << 3) | (b >> 2);
+}
+
+// The colours a BC1 block's indices choose between, the same way the GPU works them out.
+static void bc1_palette(u16 colour0, u16 colour1, u8 *out_palette)
+{
+    unpack_565(colour0, &out_palette[0]);
+    out_palette[3] = 255;
+    unpack_565(colour1, &out_palette[4]);
+    out_palette[7] = 255;
+    for (u32 c = 0; c < 3; ++c)
+    {
+        if (colour0 > colour1)
+        {
+            out_palette[8 + c] = (2 * out_palette[c] + out_palette[4 + c]) / 3;
+            out_palette[12 + c] = (out_palette[c] + 2 * out_palette[4 + c]) / 3;
+        }
+        else
+        {
+            // Three colours and transparent black.
+            out_palette[8 + c] = (out_palette[c] + out_palette[4 + c]) / 2;
+            out_palette[12 + c] = 0;
+        }
+    }
+    out_palette[11] = 255;
+    out_palette[15] = colour0 > colour1 ? 255 : 0;
+}
+
+static void write_u16(u8 *out, u16 value)
+{
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void bc1_encode_block(const u8 *rgba, u8 *out_block)
+{
+    // Fit a line through the colours, along the direction they vary most, and put the endpoints at
+    // either end of it.
+    f32 mean[3] = {0};
+    for (u32 i = 0; i < 16; ++i)
+    {
+        for (u32 c = 0; c < 3; ++c)
+        {
+            mean[c] += rgba[i * 4 + c] / 16.0f;
+        }
+    }
+
+    f32 covariance[6] = {0};
+    for (u32 i = 0; i < 16; ++i)
+    {
+        f32 r = rgba[i * 4 + 0] - mean[0];
+        f32 g = rgba[i * 4 + 1] - mean[1];
+        f32 b = rgba[i * 4 + 2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    // Power iteration for the principal axis.
+    f32 axis[3] = {1.0f, 1.0f, 1.0f};
+    for (u32 iteration = 0; iteration < 8; ++iteration)
+    {
+        f32 x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        f32 y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        f32 z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        f32 length = msqrt(x * x + y * y + z * z);
+        if (length < 1e-6f)
+        {
+            break;
+        }
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    f32 min_t = 0.0f;
+    f32 max_t = 0.0f;
+    for (u32 i = 0; i < 16; ++i)
+    {
+        f32 t = (rgba[i * 4 + 0] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2];
+        min_t = t < min_t ? t : min_t;
+        max_t = t > max_t ? t : max_t;
+    }
+
+    f32 end0[3];
+    f32 end1[3];
+    for (u32 c = 0; c < 3; ++c)
+    {
+        end0[c] = mean[c] + axis[c] * max_t;
+        end1[c] = mean[c] + axis[c] * min_t;
+    }
+    u16 colour0 = pack_565(end0);
+    u16 colour1 = pack_565(end1);
+
+    // colour0 > colour1 selects four colours rather than three and transparent black.
+    if (colour0 < colour1)
+    {
+        u16 temp = colour0;
+        colour0 = colour1;
+        colour1 = temp;
+    }
+
+    u8 palette[16];
+    bc1_palette(colour0, colour1, palette);
+
+    u32 indices = 0;
+    if (colour0 != colour1)
+    {
+        for (u32 i = 0; i < 16; ++i)
+        {
+            u32 best = 0;
+            i32 best_error = 0x7FFFFFFF;
+            for (u32 p = 0; p < 4; ++p)
+            {
+                i32 dr = rgba[i * 4 + 0] - palette[p * 4 + 0];
+                i32 dg = rgba[i * 4 + 1] - palette[p * 4 + 1];
+                i32 db = rgba[i * 4 + 2] - palette[p * 4 + 2];
+                i32 error = dr * dr + dg * dg + db * db;
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    write_u16(out_block, colour0);
+    write_u16(out_block + 2, colour1);
+    out_block[4] = indices & 0xFF;
+    out_block[5] = (indices >> 8) & 0xFF;
+    out_block[6] = (indices >> 16) & 0xFF;
+    out_block[7] = indices >> 24;
+}
+
+static void bc3_alpha_palette(u8 alpha0, u8 alpha1, u8 *out_palette)
+{
+    out_palette[0] = alpha0;
+    out_palette[1] = alpha1;
+    if (alpha0 > alpha1)
+    {
+        for (u32 i = 1; i < 7; ++i)
+        {
+            out_palette[i + 1] = (u8)(((7 - i) * alpha0 + i * alpha1) / 7);
+        }
+    }
+    else
+    {
+        for (u32 i = 1; i < 5; ++i)
+        {
+            out_palette[i + 1] = (u8)(((5 - i) * alpha0 + i * alpha1) / 5);
+        }
+        out_palette[6] = 0;
+        out_palette[7] = 255;
+    }
+}
+
+void bc3_encode_block(const u8 *rgba, u8 *out_block)
+{
+    u8 alpha0 = 0;
+    u8 alpha1 = 255;
+    for (u32 i = 0; i < 16; ++i)
+    {
+        u8 a = rgba[i * 4 + 3];
+        alpha0 = a > alpha0 ? a : alpha0;
+        alpha1 = a < alpha1 ? a : alpha1;
+    }
+
+    u8 palette[8];
+    bc3_alpha_palette(alpha0, alpha1, palette);
+
+    u64 indices = 0;
+    if (alpha0 != alpha1)
+    {
+        for (u32 i = 0; i < 16; ++i)
+        {
+            u64 best = 0;
+            i32 best_error = 256;
+            for (u32 p = 0; p < 8; ++p)
+            {
+                i32 error = rgba[i * 4 + 3] - palette[p];
+                error = error < 0 ? -error : error;
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 3);
+        }
+    }
+
+    out_block[0] = alpha0;
+    out_block[1] = alpha1;
+    for (u32 i = 0; i < 6; ++i)
+    {
+        out_block[2 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+    bc1_encode_block(rgba, out_block + 8);
+}
+
+void bc1_decode_block(const u8 *block, u8 *out_rgba)
+{
+    u16 colour0 = block[0] | (block[1] << 8);
+    u16 colour1 = block[2] | (block[3] << 8);
+    u32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((u32)block[7] << 24);
+
+    u8 palette[16];
+    bc1_palette(colour0, colour1, palette);
+    for (u32 i = 0; i < 16; ++i)
+    {
+        u32 index = (indices >> (i * 2)) & 0x3;
+        mcopy_memory(&out_rgba[i * 4], &palette[index * 4], 4);
+    }
+}
+
+void bc3_decode_block(const u8 *block, u8 *out_rgba)
+{
+    // BC3's colour block always uses four colours.
+    u16 colour0 = block[8] | (block[9] << 8);
+    u16 colour1 = block[10] | (block[11] << 8);
+    u32 colour_indices = block[12] | (block[13] << 8) | (block[14] << 16) | ((u32)block[15] << 24);
+    u8 palette[16];
+    unpack_565(colour0, &palette[0]);
+    unpack_565(colour1, &palette[4]);
+    for (u32 c = 0; c < 3; ++c)
+    {
+        palette[8 + c] = (2 * palette[c] + palette[4 + c]) / 3;
+        palette[12 + c] = (palette[c] + 2 * palette[4 + c]) / 3;
+    }
+
+    u8 alpha_palette[8];
+    bc3_alpha_palette(block[0], block[1], alpha_palette);
+    u64 alpha_indices = 0;
+    for (u32 i = 0; i < 6; ++i)
+    {
+        alpha_indices |= (u64)block[2 + i] << (i * 8);
+    }
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        u32 index = (colour_indices >> (i * 2)) & 0x3;
+        out_rgba[i * 4 + 0] = palette[index * 4 + 0];
+        out_rgba[i * 4 + 1] = palette[index * 4 + 1];
+        out_rgba[i * 4 + 2] = palette[index * 4 + 2];
+        out_rgba[i * 4 + 3] = alpha_palette[(alpha_indices >> (i * 3)) & 0x7];
+    }
+}
+
+b8 block_compress_image(const u8 *rgba, u32 width, u32 height, texture_format format, u8 *out_data)
+{
+    if (format != TEXTURE_FORMAT_BC1 && format != TEXTURE_FORMAT_BC3)
+    {
+        return false;
+    }
+
+    u32 block_size = format == TEXTURE_FORMAT_BC1 ? 8 : 16;
+    u8 block_pixels[64];
+    for (u32 block_y = 0; block_y < height; block_y += 4)
+    {
+        for (u32 block_x = 0; block_x < width; block_x += 4)
+        {
+            for (u32 y = 0; y < 4; ++y)
+            {
+                for (u32 x = 0; x < 4; ++x)
+                {
+                    u32 source_x = block_x + x < width ? block_x + x : width - 1;
+                    u32 source_y = block_y + y < height ? block_y + y : height - 1;
+                    mcopy_memory(&block_pixels[(y * 4 + x) * 4], &rgba[((u64)source_y * width + source_x) * 4], 4);
+                }
+            }
+
+            if (format == TEXTURE_FORMAT_BC1)
+            {
+                bc1_encode_block(block_pixels, out_data);
+            }
+            else
+            {
+                bc3_encode_block(block_pixels, out_data);
+            }
+            out_data += block_size;
+        }
+    }
+    return true;
+}
+
+b8 block_decompress_image(const u8 *data, u32 width, u32 height, texture_format format, u8 *out_rgba)
+{
+    if (format != TEXTURE_FORMAT_BC1 && format != TEXTURE_FORMAT_BC3)
+    {
+        return false;
+    }
+
+    u32 block_size = format == TEXTURE_FORMAT_BC1 ? 8 : 16;
+    u8 block_pixels[64];
+    for (u32 block_y = 0; block_y < height; block_y += 4)
+    {
+        for (u32 block_x = 0; block_x < width; block_x += 4)
+        {
+            if (format == TEXTURE_FORMAT_BC1)
+            {
+                bc1_decode_block(data, block_pixels);
+            }
+            else
+            {
+                bc3_decode_block(data, block_pixels);
+            }
+            data += block_size;
+
+            // Drop the pixels past the edge of the image.
+            for (u32 y = 0; y < 4 && block_y + y < height; ++y)
+            {
+                for (u32 x = 0; x < 4 && block_x + x < width; ++x)
+                {
+                    mcopy_memory(&out_rgba[((u64)(block_y + y) * width + block_x + x) * 4], &block_pixels[(y * 4 + x) * 4], 4);
+                }
+            }
+        }
+    }
+    return true;
+}
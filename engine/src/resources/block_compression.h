@@ -0,0 +1,80 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/resource_types.h"
+
+/**
+ * Block compression (BC1 and BC3) of RGBA8 images. GPUs sample these formats directly, at a quarter
+ * (BC3) or an eighth (BC1) of the memory and upload bandwidth of RGBA8. Images are split into 4x4
+ * blocks, each storing two endpoint colours and a 2 bit index per pixel choosing between them and two
+ * colours interpolated from them. BC3 adds a separate block for alpha, with 8 levels.
+ * 
+ * Encoding is done offline by the cooker. Decoding is for devices which can't sample BC formats.
+ */
+
+/**
+ * @brief Gets the number of bytes an image of the given size takes in a format. Block compressed
+ * formats round the size up to whole blocks.
+ */
+MAPI u64 texture_format_size(texture_format format, u32 width, u32 height);
+
+/**
+ * @brief Gets the size in bytes of a mip level of an image. Level i is max(width >> i, 1) by
+ * max(height >> i, 1) pixels.
+ */
+MAPI u64 texture_format_level_size(texture_format format, u32 width, u32 height, u32 level);
+
+/**
+ * @brief Gets the number of levels in a full mip chain, down to 1x1, for an image of the given size.
+ */
+MAPI u32 texture_mip_count(u32 width, u32 height);
+
+/**
+ * @brief Checks if a format is block compressed.
+ */
+MAPI b8 texture_format_is_compressed(texture_format format);
+
+/**
+ * @brief Encodes a 4x4 block of RGBA8 pixels, in rows, to BC1. Alpha is ignored.
+ */
+MAPI void bc1_encode_block(const u8 *rgba, u8 *out_block);
+
+/**
+ * @brief Encodes a 4x4 block of RGBA8 pixels, in rows, to BC3.
+ */
+MAPI void bc3_encode_block(const u8 *rgba, u8 *out_block);
+
+/**
+ * @brief Decodes a BC1 block to 4x4 RGBA8 pixels, in rows.
+ */
+MAPI void bc1_decode_block(const u8 *block, u8 *out_rgba);
+
+/**
+ * @brief Decodes a BC3 block to 4x4 RGBA8 pixels, in rows.
+ */
+MAPI void bc3_decode_block(const u8 *block, u8 *out_rgba);
+
+/**
+ * @brief Encodes an RGBA8 image. Pixels past the edge of an image which isn't a multiple of 4 in size
+ * repeat the edge.
+ * 
+ * @param rgba The image's pixels.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param format TEXTURE_FORMAT_BC1 or TEXTURE_FORMAT_BC3.
+ * @param out_data A buffer of at least texture_format_size(format, width, height) bytes.
+ * @return True on success; false if the format can't be encoded.
+ */
+MAPI b8 block_compress_image(const u8 *rgba, u32 width, u32 height, texture_format format, u8 *out_data);
+
+/**
+ * @brief Decodes a block compressed image to RGBA8.
+ * 
+ * @param data The compressed image.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param format TEXTURE_FORMAT_BC1 or TEXTURE_FORMAT_BC3.
+ * @param out_rgba A buffer of width * height * 4 bytes.
+ * @return True on success; false if the format can't be decoded.
+ */
+MAPI b8 block_decompress_image(const u8 *data, u32 width, u32 height, texture_format format, u8 *out_rgba);
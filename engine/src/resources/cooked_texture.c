@@ -0,0 +1,94 @@
+#include "cooked_texture.h"
+
+#include "core/mmemory.h"
+#include "resources/block_compression.h"
+#include "resources/image.h"
+
+b8 cooked_texture_parse(const void *data, u64 size, cooked_texture *out_texture)
+{
+    mzero_memory(out_texture, sizeof(cooked_texture));
+    const cooked_texture_header *header = data;
+    if (!data || size < sizeof(cooked_texture_header) || header->magic != COOKED_TEXTURE_MAGIC ||
+        header->version != COOKED_TEXTURE_VERSION || header->format >= TEXTURE_FORMAT_MAX ||
+        header->width == 0 || header->height == 0 || header->width > COOKED_TEXTURE_MAX_SIZE ||
+        header->height > COOKED_TEXTURE_MAX_SIZE || header->level_count == 0 ||
+        header->level_count > COOKED_TEXTURE_MAX_LEVELS)
+    {
+        return false;
+    }
+    
+    // Levels past 1x1 make no sense.
+    if (header->level_count > texture_mip_count(header->width, header->height))
+    {
+        return false;
+    }
+    
+    u64 offset = sizeof(cooked_texture_header);
+    for (u32 i = 0; i < header->level_count; ++i)
+    {
+        u64 level_size = texture_format_level_size(header->format, header->width, header->height, i);
+        if (level_size > size - offset)
+        {
+            return false;
+        }
+        out_texture->levels[i] = (const u8 *)data + offset;
+        offset += level_size;
+    }
+    
+    out_texture->header = header;
+    return true;
+}
+
+u8 *cooked_texture_cache_entry_create(const u8 *pixels, u32 width, u32 height, b8 has_transparency, u64 source_hash, u64 *out_size)
+{
+    if (width == 0 || height == 0 || width > COOKED_TEXTURE_MAX_SIZE || height > COOKED_TEXTURE_MAX_SIZE)
+    {
+        return 0;
+    }
+
+    cooked_texture_header header = {0};
+    header.magic = COOKED_TEXTURE_MAGIC;
+    header.version = COOKED_TEXTURE_VERSION;
+    header.format = TEXTURE_FORMAT_RGBA8;
+    header.width = width;
+    header.height = height;
+    header.level_count = texture_mip_count(width, height);
+    header.flags = has_transparency ? COOKED_TEXTURE_FLAG_TRANSPARENCY : COOKED_TEXTURE_FLAG_NONE;
+
+    u64 size = sizeof(cooked_texture_header);
+    for (u32 level = 0; level < header.level_count; ++level)
+    {
+        size += texture_format_level_size(TEXTURE_FORMAT_RGBA8, width, height, level);
+    }
+    u64 entry_size = size + sizeof(u64);
+    u8 *data = mallocate(entry_size, MEMORY_TAG_TEXTURE);
+    mcopy_memory(data, &header, sizeof(cooked_texture_header));
+    u8 *level_pixels = data + sizeof(cooked_texture_header);
+    mcopy_memory(level_pixels, pixels, (u64)width * height * 4);
+    for (u32 level = 0; level + 1 < header.level_count; ++level)
+    {
+        u32 level_width = width >> level ? width >> level : 1;
+        u32 level_height = height >> level ? height >> level : 1;
+        u8 *next_pixels = level_pixels + texture_format_level_size(TEXTURE_FORMAT_RGBA8, width, height, level);
+        image_downsample_rgba8(level_pixels, level_width, level_height, next_pixels);
+        level_pixels = next_pixels;
+    }
+
+    mcopy_memory(data + size, &source_hash, sizeof(u64));
+    *out_size = entry_size;
+    return data;
+}
+
+b8 cooked_texture_cache_entry_parse(const void *data, u64 size, u64 source_hash, cooked_texture *out_texture)
+{
+    mzero_memory(out_texture, sizeof(cooked_texture));
+    if (!data || size < sizeof(u64))
+    {
+        return false;
+    }
+
+    // The hash of the image file the entry was made from follows the cooked texture.
+    u64 entry_hash;
+    mcopy_memory(&entry_hash, (const u8 *)data + size - sizeof(u64), sizeof(u64));
+    return entry_hash == source_hash && cooked_texture_parse(data, size - sizeof(u64), out_texture);
+}
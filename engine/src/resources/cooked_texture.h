@@ -0,0 +1,86 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/resource_types.h"
+
+/**
+ * Cooked textures (.mtex) are stored in the format the GPU samples, so loading one is a copy into a
+ * staging buffer rather than a decode. They are written by the tools' cooktex command. Layout:
+ * 
+ *   cooked_texture_header
+ *   level data: header.level_count mip levels, largest first, each texture_format_level_size bytes
+ *   and directly following the last
+ */
+
+#define COOKED_TEXTURE_MAGIC 0x5845544DU // 'MTEX'
+#define COOKED_TEXTURE_VERSION 1
+
+// The largest width or height, which is more than any renderer supports.
+#define COOKED_TEXTURE_MAX_SIZE (1 << 15)
+
+// Enough levels for a COOKED_TEXTURE_MAX_SIZE square texture.
+#define COOKED_TEXTURE_MAX_LEVELS 16
+
+typedef enum cooked_texture_flags
+{
+    COOKED_TEXTURE_FLAG_NONE = 0x0,
+    // The texture has pixels with alpha below 255.
+    COOKED_TEXTURE_FLAG_TRANSPARENCY = 0x1,
+} cooked_texture_flags;
+
+typedef struct cooked_texture_header
+{
+    u32 magic;
+    u32 version;
+    // texture_format.
+    u32 format;
+    u32 width;
+    u32 height;
+    u32 level_count;
+    // cooked_texture_flags.
+    u32 flags;
+    u32 reserved;
+} cooked_texture_header;
+
+typedef struct cooked_texture
+{
+    const cooked_texture_header *header;
+    // Pointers to each level's data, within the data passed to cooked_texture_parse.
+    const u8 *levels[COOKED_TEXTURE_MAX_LEVELS];
+} cooked_texture;
+
+/**
+ * @brief Validates a cooked texture and finds its levels.
+ * 
+ * @param data The contents of the file.
+ * @param size The size of the file.
+ * @param out_texture A pointer to hold the texture. Points into data.
+ * @return True if valid; otherwise false.
+ */
+MAPI b8 cooked_texture_parse(const void *data, u64 size, cooked_texture *out_texture);
+
+/**
+ * @brief Cooks RGBA8 pixels into a cache entry: a cooked texture holding their full mip chain, each level
+ * filtered from the one above the same as the cooker, followed by the hash of the image file it was
+ * made from.
+ * 
+ * @param pixels The RGBA8 pixels of the image.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param has_transparency Indicates if the image has pixels with alpha below 255.
+ * @param source_hash The hash of the image file.
+ * @param out_size A pointer to hold the size of the entry.
+ * @return The entry, allocated with MEMORY_TAG_TEXTURE, or 0 if the image is too large to cook.
+ */
+MAPI u8 *cooked_texture_cache_entry_create(const u8 *pixels, u32 width, u32 height, b8 has_transparency, u64 source_hash, u64 *out_size);
+
+/**
+ * @brief Validates a cache entry made by cooked_texture_cache_entry_create and finds its levels.
+ * 
+ * @param data The contents of the entry.
+ * @param size The size of the entry.
+ * @param source_hash The hash of the image file the entry should have been made from.
+ * @param out_texture A pointer to hold the texture. Points into data.
+ * @return True if valid and made from the same image file; otherwise false.
+ */
+MAPI b8 cooked_texture_cache_entry_parse(const void *data, u64 size, u64 source_hash, cooked_texture *out_texture);
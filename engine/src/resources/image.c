@@ -0,0 +1,262 @@
+#include "image.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define IMAGE_SSE2
+#include <emmintrin.h>
+#endif
+
+static b8 simd_enabled = true;
+
+// Maps 8 bit sRGB to 8 bit linear.
+static const u8 srgb_to_linear[256] = {
+      0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,   3,   3,
+      4,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,   6,   7,   7,   7,
+      8,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  12,  12,  12,  13,
+     13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  17,  18,  18,  19,  19,  20,
+     20,  21,  22,  22,  23,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+     30,  30,  31,  32,  32,  33,  34,  35,  35,  36,  37,  37,  38,  39,  40,  41,
+     41,  42,  43,  44,  45,  45,  46,  47,  48,  49,  50,  51,  51,  52,  53,  54,
+     55,  56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,
+     71,  72,  73,  74,  76,  77,  78,  79,  80,  81,  82,  84,  85,  86,  87,  88,
+     90,  91,  92,  93,  95,  96,  97,  99, 100, 101, 103, 104, 105, 107, 108, 109,
+    111, 112, 114, 115, 116, 118, 119, 121, 122, 124, 125, 127, 128, 130, 131, 133,
+    134, 136, 138, 139, 141, 142, 144, 146, 147, 149, 151, 152, 154, 156, 157, 159,
+    161, 163, 164, 166, 168, 170, 171, 173, 175, 177, 179, 181, 183, 184, 186, 188,
+    190, 192, 194, 196, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218, 220,
+    222, 224, 226, 229, 231, 233, 235, 237, 239, 242, 244, 246, 248, 250, 253, 255,
+};
+
+// Maps 8 bit linear to 8 bit sRGB.
+static const u8 linear_to_srgb[256] = {
+      0,  13,  22,  28,  34,  38,  42,  46,  50,  53,  56,  59,  61,  64,  66,  69,
+     71,  73,  75,  77,  79,  81,  83,  85,  86,  88,  90,  92,  93,  95,  96,  98,
+     99, 101, 102, 104, 105, 106, 108, 109, 110, 112, 113, 114, 115, 117, 118, 119,
+    120, 121, 122, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135, 136,
+    137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 148, 149, 150, 151,
+    152, 153, 154, 155, 155, 156, 157, 158, 159, 159, 160, 161, 162, 163, 163, 164,
+    165, 166, 167, 167, 168, 169, 170, 170, 171, 172, 173, 173, 174, 175, 175, 176,
+    177, 178, 178, 179, 180, 180, 181, 182, 182, 183, 184, 185, 185, 186, 187, 187,
+    188, 189, 189, 190, 190, 191, 192, 192, 193, 194, 194, 195, 196, 196, 197, 197,
+    198, 199, 199, 200, 200, 201, 202, 202, 203, 203, 204, 205, 205, 206, 206, 207,
+    208, 208, 209, 209, 210, 210, 211, 212, 212, 213, 213, 214, 214, 215, 215, 216,
+    216, 217, 218, 218, 219, 219, 220, 220, 221, 221, 222, 222, 223, 223, 224, 224,
+    225, 226, 226, 227, 227, 228, 228, 229, 229, 230, 230, 231, 231, 232, 232, 233,
+    233, 234, 234, 235, 235, 236, 236, 237, 237, 238, 238, 238, 239, 239, 240, 240,
+    241, 241, 242, 242, 243, 243, 244, 244, 245, 245, 246, 246, 246, 247, 247, 248,
+    248, 249, 249, 250, 250, 251, 251, 251, 252, 252, 253, 253, 254, 254, 255, 255,
+};
+
+b8 image_simd_supported()
+{
+#ifdef IMAGE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void image_set_simd_enabled(b8 enabled)
+{
+    simd_enabled = enabled;
+}
+
+static b8 has_transparency_scalar(const u8 *pixels, u64 pixel_count)
+{
+    // Combine the alpha of a run of pixels before testing it, rather than branching on every pixel.
+    u64 i = 0;
+    while (i < pixel_count)
+    {
+        u64 end = pixel_count - i > 64 ? i + 64 : pixel_count;
+        u8 alpha = 255;
+        for (; i < end; ++i)
+        {
+            alpha &= pixels[i * 4 + 3];
+        }
+        if (alpha != 255)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void premultiply_alpha_scalar(u8 *pixels, u64 pixel_count)
+{
+    for (u64 i = 0; i < pixel_count; ++i)
+    {
+        u8 *p = pixels + i * 4;
+        u32 alpha = p[3];
+        for (u32 c = 0; c < 3; ++c)
+        {
+            // Rounds p[c] * alpha / 255 to nearest, the same way as the SIMD version.
+            u32 x = p[c] * alpha + 128;
+            p[c] = (u8)((x + (x >> 8)) >> 8);
+        }
+    }
+}
+
+static void swizzle_scalar(u8 *pixels, u64 pixel_count, const u8 order[4])
+{
+    for (u64 i = 0; i < pixel_count; ++i)
+    {
+        u8 *p = pixels + i * 4;
+        u8 source[4] = {p[0], p[1], p[2], p[3]};
+        p[0] = source[order[0]];
+        p[1] = source[order[1]];
+        p[2] = source[order[2]];
+        p[3] = source[order[3]];
+    }
+}
+
+#ifdef IMAGE_SSE2
+static b8 has_transparency_sse2(const u8 *pixels, u64 pixel_count)
+{
+    const __m128i opaque = _mm_set1_epi32((i32)0xFF000000);
+    u64 i = 0;
+    for (; i + 16 <= pixel_count; i += 16)
+    {
+        const __m128i *p = (const __m128i *)(pixels + i * 4);
+        __m128i combined = _mm_and_si128(_mm_and_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                         _mm_and_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        __m128i alpha = _mm_and_si128(combined, opaque);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, opaque)) != 0xFFFF)
+        {
+            return true;
+        }
+    }
+    return has_transparency_scalar(pixels + i * 4, pixel_count - i);
+}
+
+// Premultiplies two pixels widened to 16 bit lanes.
+static __m128i premultiply_pair_sse2(__m128i channels)
+{
+    // Broadcast each pixel's alpha across its lanes, then multiply alpha by 255 so it is kept.
+    const __m128i colour_lanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_or_si128(_mm_and_si128(alpha, colour_lanes), alpha_lanes);
+
+    // x / 255 rounded as (x + 128 + ((x + 128) >> 8)) >> 8, which fits in 16 bits.
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static void premultiply_alpha_sse2(u8 *pixels, u64 pixel_count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    u64 i = 0;
+    for (; i + 4 <= pixel_count; i += 4)
+    {
+        __m128i *p = (__m128i *)(pixels + i * 4);
+        __m128i v = _mm_loadu_si128(p);
+        __m128i low = premultiply_pair_sse2(_mm_unpacklo_epi8(v, zero));
+        __m128i high = premultiply_pair_sse2(_mm_unpackhi_epi8(v, zero));
+        _mm_storeu_si128(p, _mm_packus_epi16(low, high));
+    }
+    premultiply_alpha_scalar(pixels + i * 4, pixel_count - i);
+}
+
+static void swizzle_sse2(u8 *pixels, u64 pixel_count, const u8 order[4])
+{
+    // Each pixel is a little endian u32, so channel c is at bit 8 * c. Shift each source channel
+    // down, mask it, and shift it up into place.
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i shift0 = _mm_cvtsi32_si128(order[0] * 8);
+    const __m128i shift1 = _mm_cvtsi32_si128(order[1] * 8);
+    const __m128i shift2 = _mm_cvtsi32_si128(order[2] * 8);
+    const __m128i shift3 = _mm_cvtsi32_si128(order[3] * 8);
+    u64 i = 0;
+    for (; i + 4 <= pixel_count; i += 4)
+    {
+        __m128i *p = (__m128i *)(pixels + i * 4);
+        __m128i v = _mm_loadu_si128(p);
+        __m128i c0 = _mm_and_si128(_mm_srl_epi32(v, shift0), mask);
+        __m128i c1 = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(v, shift1), mask), 8);
+        __m128i c2 = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(v, shift2), mask), 16);
+        __m128i c3 = _mm_slli_epi32(_mm_srl_epi32(v, shift3), 24);
+        _mm_storeu_si128(p, _mm_or_si128(_mm_or_si128(c0, c1), _mm_or_si128(c2, c3)));
+    }
+    swizzle_scalar(pixels + i * 4, pixel_count - i, order);
+}
+#endif
+
+b8 image_has_transparency_rgba8(const u8 *pixels, u64 pixel_count)
+{
+#ifdef IMAGE_SSE2
+    if (simd_enabled)
+    {
+        return has_transparency_sse2(pixels, pixel_count);
+    }
+#endif
+    return has_transparency_scalar(pixels, pixel_count);
+}
+
+void image_premultiply_alpha_rgba8(u8 *pixels, u64 pixel_count)
+{
+#ifdef IMAGE_SSE2
+    if (simd_enabled)
+    {
+        premultiply_alpha_sse2(pixels, pixel_count);
+        return;
+    }
+#endif
+    premultiply_alpha_scalar(pixels, pixel_count);
+}
+
+void image_swizzle_rgba8(u8 *pixels, u64 pixel_count, const u8 order[4])
+{
+#ifdef IMAGE_SSE2
+    if (simd_enabled)
+    {
+        swizzle_sse2(pixels, pixel_count, order);
+        return;
+    }
+#endif
+    swizzle_scalar(pixels, pixel_count, order);
+}
+
+// SSE2 has no gather, so the conversions are table lookups either way, which are cheaper than
+// evaluating the curve per channel.
+static void convert_colour(u8 *pixels, u64 pixel_count, const u8 table[256])
+{
+    for (u64 i = 0; i < pixel_count; ++i)
+    {
+        u8 *p = pixels + i * 4;
+        p[0] = table[p[0]];
+        p[1] = table[p[1]];
+        p[2] = table[p[2]];
+    }
+}
+
+void image_srgb_to_linear_rgba8(u8 *pixels, u64 pixel_count)
+{
+    convert_colour(pixels, pixel_count, srgb_to_linear);
+}
+
+void image_linear_to_srgb_rgba8(u8 *pixels, u64 pixel_count)
+{
+    convert_colour(pixels, pixel_count, linear_to_srgb);
+}
+
+void image_downsample_rgba8(const u8 *pixels, u32 width, u32 height, u8 *out_pixels)
+{
+    u32 out_width = width > 1 ? width / 2 : 1;
+    u32 out_height = height > 1 ? height / 2 : 1;
+    for (u32 y = 0; y < out_height; ++y)
+    {
+        // Along a dimension of 1 the same row or column is used twice.
+        const u8 *row0 = pixels + (u64)(y * 2) * width * 4;
+        const u8 *row1 = height > 1 ? row0 + (u64)width * 4 : row0;
+        for (u32 x = 0; x < out_width; ++x)
+        {
+            u32 x0 = x * 2;
+            u32 x1 = width > 1 ? x0 + 1 : x0;
+            for (u32 c = 0; c < 4; ++c)
+            {
+                u32 sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+                out_pixels[((u64)y * out_width + x) * 4 + c] = (u8)((sum + 2) / 4);
+            }
+        }
+    }
+}
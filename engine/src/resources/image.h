@@ -0,0 +1,75 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * CPU operations on 8 bit RGBA images, in rows with no padding. Where the target supports it, these
+ * use SSE2, with a scalar fallback which gives identical results.
+ */
+
+/**
+ * @brief Whether the image operations can use SIMD instructions on this target.
+ */
+MAPI b8 image_simd_supported();
+
+/**
+ * @brief Switches the image operations between SIMD and scalar code, for tests and benchmarks. Has
+ * no effect if SIMD isn't supported. Enabled by default.
+ */
+MAPI void image_set_simd_enabled(b8 enabled);
+
+/**
+ * @brief Checks whether any pixel of an image is not fully opaque.
+ * 
+ * @param pixels The image's pixels.
+ * @param pixel_count The number of pixels, not bytes.
+ * @return True if any alpha is below 255.
+ */
+MAPI b8 image_has_transparency_rgba8(const u8 *pixels, u64 pixel_count);
+
+/**
+ * @brief Multiplies the colour of each pixel by its alpha, in place, rounding to nearest.
+ * 
+ * @param pixels The image's pixels.
+ * @param pixel_count The number of pixels, not bytes.
+ */
+MAPI void image_premultiply_alpha_rgba8(u8 *pixels, u64 pixel_count);
+
+/**
+ * @brief Reorders the channels of each pixel in place. Channel i of the result is channel order[i]
+ * of the source, so {2, 1, 0, 3} converts between RGBA and BGRA.
+ * 
+ * @param pixels The image's pixels.
+ * @param pixel_count The number of pixels, not bytes.
+ * @param order The source channel for each channel, each 0 to 3.
+ */
+MAPI void image_swizzle_rgba8(u8 *pixels, u64 pixel_count, const u8 order[4]);
+
+/**
+ * @brief Converts the colour of each pixel from sRGB to linear, in place, with a lookup table. Alpha
+ * is left as it is. Linear values are stored in 8 bits too, so dark colours lose precision.
+ * 
+ * @param pixels The image's pixels.
+ * @param pixel_count The number of pixels, not bytes.
+ */
+MAPI void image_srgb_to_linear_rgba8(u8 *pixels, u64 pixel_count);
+
+/**
+ * @brief Converts the colour of each pixel from linear to sRGB, in place, with a lookup table. Alpha
+ * is left as it is.
+ * 
+ * @param pixels The image's pixels.
+ * @param pixel_count The number of pixels, not bytes.
+ */
+MAPI void image_linear_to_srgb_rgba8(u8 *pixels, u64 pixel_count);
+
+/**
+ * @brief Halves an image with a 2x2 box filter, rounding to nearest. A dimension which is already 1
+ * stays at 1; an odd dimension drops its last row or column.
+ * 
+ * @param pixels The image's pixels.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param out_pixels A buffer of max(width / 2, 1) * max(height / 2, 1) * 4 bytes.
+ */
+MAPI void image_downsample_rgba8(const u8 *pixels, u32 width, u32 height, u8 *out_pixels);
@@ -4,6 +4,20 @@
 
 #define TEXTURE_NAME_MAX_LENGTH 512
 
+// How a texture's pixels are laid out in memory. Stored in cooked texture files, so values must not change.
+typedef enum texture_format
+{
+    // 8 bits per channel, 4 channels.
+    TEXTURE_FORMAT_RGBA8 = 0,
+    // 4x4 blocks of 8 bytes. Opaque colour.
+    TEXTURE_FORMAT_BC1 = 1,
+    // 4x4 blocks of 16 bytes. BC1 colour plus interpolated alpha.
+    TEXTURE_FORMAT_BC3 = 2,
+    // 4x4 blocks of 16 bytes. Higher quality colour and alpha.
+    TEXTURE_FORMAT_BC7 = 3,
+    TEXTURE_FORMAT_MAX
+} texture_format;
+
 typedef struct texture
 {
     u32 id;
@@ -11,21 +25,81 @@ typedef struct texture
     u32 height;
     u8 channel_count;
     b8 has_transparency;
+    texture_format format;
+    // The number of mip levels. When created, the number of levels in the pixels passed to the renderer,
+    // largest first; 1 has the renderer generate the rest of the chain where it can.
+    u32 mip_levels;
+    // The most mip levels the renderer may generate; 0 for a full chain.
+    u32 max_mip_levels;
+    // The number of layers of an array texture; 0 or 1 for a single image. Pixels hold every layer of
+    // a level before the next level.
+    u32 layer_count;
     u32 generation;
     char name[TEXTURE_NAME_MAX_LENGTH];
     void *internal_data;
+    // For a texture packed into an atlas, the atlas texture, which is what gets sampled. This texture
+    // then has no internal data of its own.
+    struct texture *atlas;
+    u32 atlas_layer;
+    // Maps the texture's coordinates to the atlas's: scale in x and y, offset in z and w.
+    vec4 atlas_uv_transform;
 } texture;
 
+// A rectangle of a texture's top level, in one of its layers.
+typedef struct texture_region
+{
+    u32 layer;
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+} texture_region;
+
 typedef enum texture_use
 {
     TEXTURE_USE_UNKNOWN = 0x00,
     TEXTURE_USE_MAP_DIFFUSE = 0x01,
 } texture_use;
 
+typedef enum texture_filter
+{
+    TEXTURE_FILTER_LINEAR = 0x00,
+    TEXTURE_FILTER_NEAREST = 0x01,
+} texture_filter;
+
+typedef enum texture_repeat
+{
+    TEXTURE_REPEAT_REPEAT = 0x00,
+    TEXTURE_REPEAT_MIRRORED_REPEAT = 0x01,
+    TEXTURE_REPEAT_CLAMP_TO_EDGE = 0x02,
+} texture_repeat;
+
+// How a texture map is sampled. Zeroed is trilinear filtering and repeating, with as much anisotropy as
+// the renderer allows, across every mip level. Maps with the same configuration share a sampler.
+typedef struct texture_sampler_config
+{
+    texture_filter minify;
+    texture_filter magnify;
+    // Between mip levels.
+    texture_filter mip_filter;
+    texture_repeat repeat_u;
+    texture_repeat repeat_v;
+    texture_repeat repeat_w;
+    // 0 for as much as the renderer allows; 1 turns anisotropic filtering off.
+    f32 max_anisotropy;
+    f32 mip_lod_bias;
+    // The range of mip levels to sample from. max_lod only applies when clamp_max_lod is set, so that
+    // zeroed is every level from min_lod down, and a max_lod of 0 with it set is level 0 alone.
+    f32 min_lod;
+    f32 max_lod;
+    b8 clamp_max_lod;
+} texture_sampler_config;
+
 typedef struct texture_map
 {
     texture *texture;
     texture_use use;
+    texture_sampler_config sampler;
 } texture_map;
 
 #define MATERIAL_NAME_MAX_LENGTH 256
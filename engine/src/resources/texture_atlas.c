@@ -0,0 +1,280 @@
+#include "texture_atlas.h"
+
+#include "core/mmemory.h"
+
+// The room an entry takes up, with padding on both sides, rounded up to keep the next one aligned.
+static u32 padded_size(u32 size)
+{
+    u32 padded = size + TEXTURE_ATLAS_PADDING * 2;
+    return (padded + TEXTURE_ATLAS_PADDING - 1) / TEXTURE_ATLAS_PADDING * TEXTURE_ATLAS_PADDING;
+}
+
+// Enough shelves per layer for every one to hold the smallest entry.
+static u32 shelves_per_layer(u32 size)
+{
+    return size / padded_size(1);
+}
+
+u64 texture_atlas_memory_requirement(u32 size, u32 layer_count)
+{
+    u32 max_shelves = shelves_per_layer(size) * layer_count;
+    return sizeof(texture_atlas_shelf) * max_shelves + sizeof(texture_atlas_region) * max_shelves * 4 + sizeof(u32) * layer_count * 2;
+}
+
+void texture_atlas_create(u32 size, u32 layer_count, void *memory, texture_atlas *out_atlas)
+{
+    mzero_memory(out_atlas, sizeof(texture_atlas));
+    out_atlas->size = size;
+    out_atlas->layer_count = layer_count;
+    out_atlas->max_shelves = shelves_per_layer(size) * layer_count;
+    // Freed space past this is lost until its layer empties.
+    out_atlas->max_free = out_atlas->max_shelves * 4;
+
+    mzero_memory(memory, texture_atlas_memory_requirement(size, layer_count));
+    out_atlas->shelves = memory;
+    out_atlas->free_regions = (texture_atlas_region *)(out_atlas->shelves + out_atlas->max_shelves);
+    out_atlas->layer_heights = (u32 *)(out_atlas->free_regions + out_atlas->max_free);
+    out_atlas->layer_entry_counts = out_atlas->layer_heights + layer_count;
+}
+
+static void place(texture_atlas *atlas, u32 layer, u32 x, u32 y, u32 width, u32 height, texture_atlas_region *out_region)
+{
+    out_region->layer = layer;
+    out_region->x = x + TEXTURE_ATLAS_PADDING;
+    out_region->y = y + TEXTURE_ATLAS_PADDING;
+    out_region->width = width;
+    out_region->height = height;
+    atlas->layer_entry_counts[layer]++;
+}
+
+// Finds the shelf with room which wastes the least height, or INVALID_ID. Unless any_height is set,
+// shelves more than half as tall again as the entry are skipped, leaving them for taller entries.
+static u32 find_shelf(const texture_atlas *atlas, u32 padded_width, u32 padded_height, b8 any_height)
+{
+    u32 best = INVALID_ID;
+    for (u32 i = 0; i < atlas->shelf_count; ++i)
+    {
+        const texture_atlas_shelf *shelf = &atlas->shelves[i];
+        if (shelf->height < padded_height || atlas->size - shelf->used_width < padded_width ||
+            (!any_height && shelf->height > padded_height + padded_height / 2))
+        {
+            continue;
+        }
+        if (best == INVALID_ID || shelf->height < atlas->shelves[best].height)
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+b8 texture_atlas_allocate(texture_atlas *atlas, u32 width, u32 height, texture_atlas_region *out_region)
+{
+    u32 padded_width = padded_size(width);
+    u32 padded_height = padded_size(height);
+    if (width == 0 || height == 0 || padded_width > atlas->size || padded_height > atlas->size)
+    {
+        return false;
+    }
+
+    // Reuse freed space, taking the smallest which fits.
+    u32 best_free = INVALID_ID;
+    for (u32 i = 0; i < atlas->free_count; ++i)
+    {
+        const texture_atlas_region *r = &atlas->free_regions[i];
+        if (r->width >= padded_width && r->height >= padded_height &&
+            (best_free == INVALID_ID || (u64)r->width * r->height < (u64)atlas->free_regions[best_free].width * atlas->free_regions[best_free].height))
+        {
+            best_free = i;
+        }
+    }
+    if (best_free != INVALID_ID)
+    {
+        texture_atlas_region r = atlas->free_regions[best_free];
+        atlas->free_regions[best_free] = atlas->free_regions[--atlas->free_count];
+        place(atlas, r.layer, r.x, r.y, width, height, out_region);
+        return true;
+    }
+
+    // Then the end of a shelf of about the right height.
+    u32 shelf_index = find_shelf(atlas, padded_width, padded_height, false);
+    if (shelf_index == INVALID_ID)
+    {
+        // Then a new shelf.
+        for (u32 layer = 0; layer < atlas->layer_count && atlas->shelf_count < atlas->max_shelves; ++layer)
+        {
+            if (atlas->size - atlas->layer_heights[layer] >= padded_height)
+            {
+                texture_atlas_shelf *shelf = &atlas->shelves[atlas->shelf_count];
+                shelf_index = atlas->shelf_count++;
+                shelf->layer = layer;
+                shelf->y = atlas->layer_heights[layer];
+                shelf->height = padded_height;
+                shelf->used_width = 0;
+                atlas->layer_heights[layer] += padded_height;
+                break;
+            }
+        }
+    }
+    if (shelf_index == INVALID_ID)
+    {
+        // Finally any shelf tall enough.
+        shelf_index = find_shelf(atlas, padded_width, padded_height, true);
+        if (shelf_index == INVALID_ID)
+        {
+            return false;
+        }
+    }
+
+    texture_atlas_shelf *shelf = &atlas->shelves[shelf_index];
+    place(atlas, shelf->layer, shelf->used_width, shelf->y, width, height, out_region);
+    shelf->used_width += padded_width;
+    return true;
+}
+
+void texture_atlas_free(texture_atlas *atlas, const texture_atlas_region *region)
+{
+    u32 layer = region->layer;
+    if (layer >= atlas->layer_count || atlas->layer_entry_counts[layer] == 0)
+    {
+        return;
+    }
+
+    // An empty layer starts again from scratch.
+    if (--atlas->layer_entry_counts[layer] == 0)
+    {
+        for (u32 i = 0; i < atlas->shelf_count;)
+        {
+            if (atlas->shelves[i].layer == layer)
+            {
+                atlas->shelves[i] = atlas->shelves[--atlas->shelf_count];
+                continue;
+            }
+            ++i;
+        }
+        for (u32 i = 0; i < atlas->free_count;)
+        {
+            if (atlas->free_regions[i].layer == layer)
+            {
+                atlas->free_regions[i] = atlas->free_regions[--atlas->free_count];
+                continue;
+            }
+            ++i;
+        }
+        atlas->layer_heights[layer] = 0;
+        return;
+    }
+
+    texture_atlas_region padded;
+    padded.layer = layer;
+    padded.x = region->x - TEXTURE_ATLAS_PADDING;
+    padded.y = region->y - TEXTURE_ATLAS_PADDING;
+    padded.width = padded_size(region->width);
+    padded.height = padded_size(region->height);
+
+    // The last entry on a shelf just shortens it.
+    for (u32 i = 0; i < atlas->shelf_count; ++i)
+    {
+        texture_atlas_shelf *shelf = &atlas->shelves[i];
+        if (shelf->layer == layer && shelf->y == padded.y && shelf->used_width == padded.x + padded.width)
+        {
+            shelf->used_width = padded.x;
+            return;
+        }
+    }
+
+    if (atlas->free_count < atlas->max_free)
+    {
+        // Reused at the height of its shelf, if it is on one, since nothing else can use the gap.
+        for (u32 i = 0; i < atlas->shelf_count; ++i)
+        {
+            const texture_atlas_shelf *shelf = &atlas->shelves[i];
+            if (shelf->layer == layer && shelf->y == padded.y)
+            {
+                padded.height = shelf->height;
+                break;
+            }
+        }
+        atlas->free_regions[atlas->free_count++] = padded;
+    }
+}
+
+vec4 texture_atlas_uv_transform(const texture_atlas *atlas, const texture_atlas_region *region)
+{
+    f32 size = (f32)atlas->size;
+    vec4 transform;
+    transform.x = (f32)region->width / size;
+    transform.y = (f32)region->height / size;
+    transform.z = (f32)region->x / size;
+    transform.w = (f32)region->y / size;
+    return transform;
+}
+
+static f32 floor_f32(f32 value)
+{
+    f32 whole = (f32)(i64)value;
+    return whole > value ? whole - 1.0f : whole;
+}
+
+f32 texture_atlas_wrap(f32 coordinate, u32 size, texture_repeat repeat, u32 level)
+{
+    switch (repeat)
+    {
+        case TEXTURE_REPEAT_MIRRORED_REPEAT:
+        {
+            // Every other repeat is flipped.
+            f32 period = coordinate - 2.0f * floor_f32(coordinate * 0.5f);
+            coordinate = period > 1.0f ? 2.0f - period : period;
+        } break;
+
+        case TEXTURE_REPEAT_CLAMP_TO_EDGE:
+            break;
+
+        default:
+            // The padding repeats the entry, so filtering across the wrap is already right.
+            return coordinate - floor_f32(coordinate);
+    }
+
+    // Keep half a texel of the coarsest level sampled in from the edges, so filtering doesn't reach into
+    // the padding, which holds the opposite edge. Level 0's half texel isn't enough further down the
+    // chain, where texels are wider.
+    if (level > TEXTURE_ATLAS_MIP_LEVELS - 1)
+    {
+        level = TEXTURE_ATLAS_MIP_LEVELS - 1;
+    }
+    f32 edge = 0.5f * (f32)(1u << level) / (f32)size;
+    if (edge > 0.5f)
+    {
+        return 0.5f;
+    }
+    return coordinate < edge ? edge : coordinate > 1.0f - edge ? 1.0f - edge : coordinate;
+}
+
+void texture_atlas_write(const texture_atlas *atlas, const texture_atlas_region *region, const u8 *pixels, u8 *layer_pixels)
+{
+    i32 width = (i32)region->width;
+    i32 height = (i32)region->height;
+    for (i32 y = -TEXTURE_ATLAS_PADDING; y < height + TEXTURE_ATLAS_PADDING; ++y)
+    {
+        // Padding wraps around to the opposite edge.
+        i32 source_y = ((y % height) + height) % height;
+        u8 *row = layer_pixels + ((u64)(region->y + y) * atlas->size + region->x) * 4;
+        const u8 *source_row = pixels + (u64)source_y * width * 4;
+        for (i32 x = -TEXTURE_ATLAS_PADDING; x < width + TEXTURE_ATLAS_PADDING; ++x)
+        {
+            i32 source_x = ((x % width) + width) % width;
+            mcopy_memory(row + x * 4, source_row + source_x * 4, 4);
+        }
+    }
+}
+
+texture_region texture_atlas_padded_region(const texture_atlas_region *region)
+{
+    texture_region padded;
+    padded.layer = region->layer;
+    padded.x = region->x - TEXTURE_ATLAS_PADDING;
+    padded.y = region->y - TEXTURE_ATLAS_PADDING;
+    padded.width = padded_size(region->width);
+    padded.height = padded_size(region->height);
+    return padded;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "defines.h"
+#include "math/math_types.h"
+#include "resources/resource_types.h"
+
+/**
+ * Packs small textures into the layers of a square 2D array texture, so that many of them share one
+ * image and one descriptor. Layers are filled with shelves: rows as tall as the first entry placed
+ * in them, which later entries of a similar height fill from left to right.
+ * 
+ * Each entry is surrounded by TEXTURE_ATLAS_PADDING texels copied from its opposite edges, so
+ * filtering at its edges wraps around the way a repeating sampler would. Entries are aligned to
+ * the padding, which keeps them apart down to TEXTURE_ATLAS_MIP_LEVELS levels.
+ */
+
+#define TEXTURE_ATLAS_PADDING 4
+
+// Level 2 still has a texel of padding around each entry.
+#define TEXTURE_ATLAS_MIP_LEVELS 3
+
+typedef struct texture_atlas_region
+{
+    u32 layer;
+    // The entry's pixels, excluding padding.
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+} texture_atlas_region;
+
+typedef struct texture_atlas_shelf
+{
+    u32 layer;
+    u32 y;
+    // Including padding.
+    u32 height;
+    // How far along the shelf has been filled.
+    u32 used_width;
+} texture_atlas_shelf;
+
+typedef struct texture_atlas
+{
+    // The width and height of each layer.
+    u32 size;
+    u32 layer_count;
+
+    u32 shelf_count;
+    u32 max_shelves;
+    texture_atlas_shelf *shelves;
+
+    // Space given back by texture_atlas_free, including padding, to be reused by entries which fit.
+    u32 free_count;
+    u32 max_free;
+    texture_atlas_region *free_regions;
+
+    // Per layer: where the next shelf starts, and how many entries are in it.
+    u32 *layer_heights;
+    u32 *layer_entry_counts;
+} texture_atlas;
+
+/**
+ * @brief Gets the memory texture_atlas_create needs.
+ * 
+ * @param size The width and height of each layer. A multiple of TEXTURE_ATLAS_PADDING.
+ * @param layer_count The number of layers.
+ * @return The number of bytes.
+ */
+MAPI u64 texture_atlas_memory_requirement(u32 size, u32 layer_count);
+
+/**
+ * @brief Creates an empty atlas.
+ * 
+ * @param size The width and height of each layer. A multiple of TEXTURE_ATLAS_PADDING.
+ * @param layer_count The number of layers.
+ * @param memory A block of texture_atlas_memory_requirement bytes, which must outlive the atlas.
+ * @param out_atlas A pointer to hold the atlas.
+ */
+MAPI void texture_atlas_create(u32 size, u32 layer_count, void *memory, texture_atlas *out_atlas);
+
+/**
+ * @brief Finds room for an entry.
+ * 
+ * @param atlas The atlas.
+ * @param width The width of the entry.
+ * @param height The height of the entry.
+ * @param out_region A pointer to hold where the entry goes.
+ * @return True if there was room; otherwise false.
+ */
+MAPI b8 texture_atlas_allocate(texture_atlas *atlas, u32 width, u32 height, texture_atlas_region *out_region);
+
+/**
+ * @brief Gives back the room of an entry. Once every entry in a layer has been freed, the whole layer
+ * can be packed again.
+ * 
+ * @param atlas The atlas.
+ * @param region The region texture_atlas_allocate gave the entry.
+ */
+MAPI void texture_atlas_free(texture_atlas *atlas, const texture_atlas_region *region);
+
+/**
+ * @brief Gets the transform from an entry's texture coordinates to the atlas's: scale in x and y,
+ * then offset in z and w.
+ * 
+ * @param atlas The atlas.
+ * @param region The entry's region.
+ * @return The transform.
+ */
+MAPI vec4 texture_atlas_uv_transform(const texture_atlas *atlas, const texture_atlas_region *region);
+
+/**
+ * @brief Copies an entry's RGBA8 pixels into its region of a layer, and fills its padding.
+ * 
+ * @param atlas The atlas.
+ * @param region The entry's region.
+ * @param pixels The entry's pixels, region->width by region->height.
+ * @param layer_pixels The pixels of the layer the region is in, size by size RGBA8.
+ */
+MAPI void texture_atlas_write(const texture_atlas *atlas, const texture_atlas_region *region, const u8 *pixels, u8 *layer_pixels);
+
+/**
+ * @brief Gets the texels texture_atlas_write changes for an entry: its region and its padding. These
+ * stay aligned to TEXTURE_ATLAS_PADDING, so they map to whole texels down to TEXTURE_ATLAS_MIP_LEVELS.
+ * 
+ * @param region The entry's region.
+ * @return The region including its padding.
+ */
+MAPI texture_region texture_atlas_padded_region(const texture_atlas_region *region);
+
+/**
+ * @brief Wraps one of an entry's texture coordinates into the entry, the way a sampler with the given
+ * repeat mode would. A sampler's own repeat mode applies to the whole atlas, so the material shader
+ * does this for entries instead, and must match it.
+ * 
+ * @param coordinate The coordinate, where 0 to 1 spans the entry.
+ * @param size The entry's width or height in texels, along the coordinate.
+ * @param repeat How to wrap.
+ * @param level The coarsest mip level filtering reads from. Clamping and mirroring stay half a texel of
+ * this level in from the edges.
+ * @return The coordinate within the entry, from 0 to 1.
+ */
+MAPI f32 texture_atlas_wrap(f32 coordinate, u32 size, texture_repeat repeat, u32 level);
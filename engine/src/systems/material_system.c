@@ -2,13 +2,16 @@
 
 #include "core/logger.h"
 #include "core/mstring.h"
+#include "core/config_reader.h"
 #include "containers/hashtable.h"
+#include "containers/id_pool.h"
 #include "math/mmath.h"
 #include "renderer/renderer_frontend.h"
 #include "systems/texture_system.h"
 
 // TODO: temp: resource system.
-#include "platform/filesystem.h"
+#include "platform/vfs.h"
+#include "platform/async_io.h"
 // End temp.
 
 typedef struct material_system_state
@@ -22,6 +25,9 @@ typedef struct material_system_state
     
     // Hashtable for material lookups.
     hashtable registered_material_table;
+    
+    // Slots in registered_materials which are not in use.
+    id_pool free_slots;
 } material_system_state;
 
 typedef struct material_reference
@@ -33,24 +39,31 @@ typedef struct material_reference
 
 static material_system_state *state_ptr = 0;
 
+// Find free slots the way they were found before the free list, for benchmarks.
+static b8 slot_scan_enabled = false;
+
 b8 create_default_material(material_system_state *state);
 b8 load_material(material_config config, material *m);
 void destroy_material(material *m);
+void material_file_name(const char *name, char *out_file_name);
 b8 load_configuration_file(const char *path, material_config *out_config);
+void parse_configuration(const char *path, const void *data, u64 size, material_config *out_config);
 
 b8 material_system_initialise(u64 *memory_requirement, void *state, material_system_config config)
 {
     if (config.max_material_count == 0)
     {
-        MFATAL("material_system_initialise - config.max_material_count must be > 0.");
+        MFATAL_CH(LOG_CHANNEL_MATERIAL, "material_system_initialise - config.max_material_count must be > 0.");
         return false;
     }
     
-    // Block of memory will contain state strucutre, then block for array, then block for hashtable.
+    // Block of memory will contain state strucutre, then block for array, then block for hashtable,
+    // then block for the free slots.
     u64 struct_requirement = sizeof(material_system_state);
     u64 array_requirement = sizeof(material) * config.max_material_count;
     u64 hashtable_requirement = sizeof(material_reference) * config.max_material_count;
-    *memory_requirement = struct_requirement + array_requirement + hashtable_requirement;
+    u64 free_slots_requirement = sizeof(u32) * config.max_material_count;
+    *memory_requirement = struct_requirement + array_requirement + hashtable_requirement + free_slots_requirement;
     
     if (!state) return true;
     
@@ -78,6 +91,9 @@ b8 material_system_initialise(u64 *memory_requirement, void *state, material_sys
     invalid_ref.reference_count = 0;
     hashtable_fill(&state_ptr->registered_material_table, &invalid_ref);
     
+    // Free slots are after the hashtable.
+    id_pool_create(config.max_material_count, hashtable_block + hashtable_requirement, &state_ptr->free_slots);
+    
     // Invalidate all entries in material array
     u32 count = state_ptr->config.max_material_count;
     for (u32 i = 0; i < count; ++i)
@@ -89,7 +105,7 @@ b8 material_system_initialise(u64 *memory_requirement, void *state, material_sys
     
     if (!create_default_material(state_ptr))
     {
-        MFATAL("material_system_initialise failed to create default material, booting.");
+        MFATAL_CH(LOG_CHANNEL_MATERIAL, "material_system_initialise failed to create default material, booting.");
         return false;
     }
     
@@ -118,21 +134,52 @@ void material_system_shutdown(void *state)
     state_ptr = 0;
 }
 
+void material_system_set_slot_scan_enabled(b8 enabled)
+{
+    slot_scan_enabled = enabled;
+}
+
+// Takes a slot which holds no material.
+static b8 take_free_slot(u32 *out_handle)
+{
+    if (!slot_scan_enabled)
+    {
+        return id_pool_acquire(&state_ptr->free_slots, out_handle);
+    }
+    
+    for (u32 i = 0; i < state_ptr->config.max_material_count; ++i)
+    {
+        if (state_ptr->registered_materials[i].id == INVALID_ID)
+        {
+            *out_handle = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Gives back a slot from take_free_slot, once its material has been invalidated.
+static void release_slot(u32 handle)
+{
+    if (!slot_scan_enabled)
+    {
+        id_pool_release(&state_ptr->free_slots, handle);
+    }
+}
+
 material *material_system_acquire(const char *name)
 {
-    // Load the given material configuration from disk.
+    // Load the given material configuration from disk. Anything it leaves out, like the sampler, is
+    // left zeroed, which is the default.
     material_config config;
+    mzero_memory(&config, sizeof(material_config));
     
     // Load file from disk.
-    // TODO: Should be able to be located anywhere.
-    char *format_str = "assets/materials/%s.%s";
     char full_file_path[512];
-    
-    // TODO: Try different extensions.
-    string_format(full_file_path, format_str, name, "mmt");
+    material_file_name(name, full_file_path);
     if (!load_configuration_file(full_file_path, &config))
     {
-        MERROR("Failed to load material file: '%s'. Null pointer will be returned", full_file_path);
+        MERROR_CH(LOG_CHANNEL_MATERIAL, "Failed to load material file: '%s'. Null pointer will be returned", full_file_path);
         return 0;
     }
     
@@ -158,31 +205,22 @@ material *material_system_acquire_from_config(material_config config)
         ref.reference_count++;
         if (ref.handle == INVALID_ID)
         {
-            // No material exists here, find free index.
-            u32 count = state_ptr->config.max_material_count;
-            material *m = 0;
-            for (u32 i = 0; i < count; ++i)
+            // No material exists here, take a free slot.
+            if (!take_free_slot(&ref.handle))
             {
-                if (state_ptr->registered_materials[i].id == INVALID_ID)
-                {
-                    // Free slot.
-                    ref.handle = i;
-                    m = &state_ptr->registered_materials[i];
-                    break;
-                }
-            }
-            
-            // Make sure an empty slot was actually found.
-            if (!m || ref.handle == INVALID_ID)
-            {
-                MFATAL("material_system_acquire - Material system cannot hold anymroe materials. Adjust config to allow for more.");
+                MFATAL_CH(LOG_CHANNEL_MATERIAL, "material_system_acquire - Material system cannot hold anymroe materials. Adjust config to allow for more.");
                 return 0;
             }
+            material *m = &state_ptr->registered_materials[ref.handle];
             
             // Create new material
             if (!load_material(config, m))
             {
-                MERROR("Failed to load material: '%s'", config.name);
+                MERROR_CH(LOG_CHANNEL_MATERIAL, "Failed to load material: '%s'", config.name);
+                m->id = INVALID_ID;
+                m->generation = INVALID_ID;
+                m->internal_id = INVALID_ID;
+                release_slot(ref.handle);
                 return 0;
             }
             
@@ -197,11 +235,11 @@ material *material_system_acquire_from_config(material_config config)
             
             // Also use the handle as the material id.
             m->id = ref.handle;
-            MTRACE("Material '%s' does not yet exist. Created, and ref_count is now %i.", config.name, ref.reference_count);
+            MTRACE_CH(LOG_CHANNEL_MATERIAL, "Material '%s' does not yet exist. Created, and ref_count is now %i.", config.name, ref.reference_count);
         }
         else
         {
-            MTRACE("Material '%s' already exists. ref_count increased to %i.", config.name, ref.reference_count);
+            MTRACE_CH(LOG_CHANNEL_MATERIAL, "Material '%s' already exists. ref_count increased to %i.", config.name, ref.reference_count);
         }
         
         // Update the entry
@@ -210,7 +248,7 @@ material *material_system_acquire_from_config(material_config config)
     }
     
     // NOTE(satvik): This would only happen in the event something went wrong with the state.
-    MERROR("material_system_state_acquire_from_config failed to acquire material '%s'. Null pointer will be returned.", 
+    MERROR_CH(LOG_CHANNEL_MATERIAL, "material_system_state_acquire_from_config failed to acquire material '%s'. Null pointer will be returned.", 
            config.name);
     return 0;
 }
@@ -227,23 +265,24 @@ void material_system_release(const char *name)
     {
         if (ref.reference_count == 0)
         {
-            MWARN("Tried to release nonexistent material: '%s'", name);
+            MWARN_CH(LOG_CHANNEL_MATERIAL, "Tried to release nonexistent material: '%s'", name);
         }
         if (--ref.reference_count == 0 && ref.auto_release)
         {
             material *m = &state_ptr->registered_materials[ref.handle];
             
-            // Destroy material
+            // Destroy material, and free up its slot.
             destroy_material(m);
+            release_slot(ref.handle);
             
             // Reset the reference.
             ref.handle = INVALID_ID;
             ref.auto_release = false;
-            MTRACE("Released material '%s'. Material unloaded because reference count=0 and auto_release=true.", name);
+            MTRACE_CH(LOG_CHANNEL_MATERIAL, "Released material '%s'. Material unloaded because reference count=0 and auto_release=true.", name);
         }
         else
         {
-            MTRACE("Released material '%s', now has a reference count of '%i' (auto_release=%s).", 
+            MTRACE_CH(LOG_CHANNEL_MATERIAL, "Released material '%s', now has a reference count of '%i' (auto_release=%s).", 
                    name, 
                    ref.reference_count, 
                    ref.auto_release ? "true" : "false");
@@ -254,7 +293,7 @@ void material_system_release(const char *name)
     }
     else
     {
-        MERROR("material_system_release failed to release material '%s'.", name);
+        MERROR_CH(LOG_CHANNEL_MATERIAL, "material_system_release failed to release material '%s'.", name);
     }
 }
 
@@ -265,10 +304,102 @@ material *material_system_get_default()
         return &state_ptr->default_material;
     }
     
-    MFATAL("material_system_get_default called before system is initialised.");
+    MFATAL_CH(LOG_CHANNEL_MATERIAL, "material_system_get_default called before system is initialised.");
     return 0;
 }
 
+static void on_material_reload_read(const async_io_result *result, void *user_data)
+{
+    if (!state_ptr)
+    {
+        return;
+    }
+    
+    // The material may have been released, and the slot reused, while the file was being read.
+    u32 handle = (u32)(u64)user_data;
+    material *m = &state_ptr->registered_materials[handle];
+    char file_name[512];
+    char path[VFS_MAX_PATH_LENGTH];
+    material_file_name(m->name, file_name);
+    if (m->id != handle || !vfs_loose_path(file_name, path) || !strings_equal(path, result->path))
+    {
+        return;
+    }
+    
+    if (!result->success)
+    {
+        MWARN_CH(LOG_CHANNEL_MATERIAL, "Unable to read '%s' to reload material '%s'.", result->path, m->name);
+        return;
+    }
+    
+    material_config config;
+    mzero_memory(&config, sizeof(material_config));
+    config.diffuse_colour = vec4_one();
+    parse_configuration(result->path, result->data, result->size, &config);
+    
+    // Update in place, so the renderer's resources and everything pointing at the material stay valid.
+    m->diffuse_colour = config.diffuse_colour;
+    m->diffuse_map.sampler = config.diffuse_sampler;
+    
+    const char *current_map_name = m->diffuse_map.texture ? m->diffuse_map.texture->name : "";
+    if (!strings_equali(current_map_name, config.diffuse_map_name))
+    {
+        texture *old_texture = m->diffuse_map.texture;
+        if (string_length(config.diffuse_map_name) > 0)
+        {
+            m->diffuse_map.use = TEXTURE_USE_MAP_DIFFUSE;
+            m->diffuse_map.texture = texture_system_acquire_async(config.diffuse_map_name, true);
+            if (!m->diffuse_map.texture)
+            {
+                MWARN_CH(LOG_CHANNEL_MATERIAL, "Unable to load texture: '%s' for material '%s', using default.", config.diffuse_map_name, m->name);
+                m->diffuse_map.texture = texture_system_get_default_texture();
+            }
+        }
+        else
+        {
+            m->diffuse_map.use = TEXTURE_USE_UNKNOWN;
+            m->diffuse_map.texture = 0;
+        }
+        
+        // Released after acquiring, so a texture shared by both is not unloaded in between.
+        if (old_texture)
+        {
+            texture_system_release(old_texture->name);
+        }
+    }
+    
+    // Bumping the generation makes the renderer refresh the material's uniforms.
+    m->generation++;
+    MINFO_CH(LOG_CHANNEL_MATERIAL, "Reloaded material '%s' (generation %u).", m->name, m->generation);
+}
+
+void material_system_reload(const char *name)
+{
+    material_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_material_table, name, &ref) || ref.handle == INVALID_ID)
+    {
+        // Not loaded, so there is nothing to reload.
+        return;
+    }
+    
+    // Always read the loose file; that is what is being edited, and an archive never changes.
+    char file_name[512];
+    char path[VFS_MAX_PATH_LENGTH];
+    material_file_name(name, file_name);
+    if (vfs_loose_path(file_name, path))
+    {
+        async_io_read_file(path, on_material_reload_read, (void *)(u64)ref.handle);
+    }
+}
+
+// Gets the name of a material's file, relative to the asset root.
+void material_file_name(const char *name, char *out_file_name)
+{
+    // TODO: Should be able to be located anywhere.
+    // TODO: Try different extensions.
+    string_format(out_file_name, "materials/%s.%s", name, "mmt");
+}
+
 b8 load_material(material_config config, material *m)
 {
     mzero_memory(m, sizeof(material));
@@ -283,10 +414,11 @@ b8 load_material(material_config config, material *m)
     if (string_length(config.diffuse_map_name) > 0)
     {
         m->diffuse_map.use = TEXTURE_USE_MAP_DIFFUSE;
-        m->diffuse_map.texture = texture_system_acquire(config.diffuse_map_name, true);
+        m->diffuse_map.sampler = config.diffuse_sampler;
+        m->diffuse_map.texture = texture_system_acquire_async(config.diffuse_map_name, true);
         if (!m->diffuse_map.texture)
         {
-            MWARN("Unable to load texture: '%s' for material '%s', using default.", config.diffuse_map_name, m->name);
+            MWARN_CH(LOG_CHANNEL_MATERIAL, "Unable to load texture: '%s' for material '%s', using default.", config.diffuse_map_name, m->name);
             m->diffuse_map.texture = texture_system_get_default_texture();
         }
     }
@@ -302,7 +434,7 @@ b8 load_material(material_config config, material *m)
     // Send it off to the renderer to acquire resources.
     if (!renderer_create_material(m))
     {
-        MERROR("Failed to acquire renderer resources for material '%s'.", m->name);
+        MERROR_CH(LOG_CHANNEL_MATERIAL, "Failed to acquire renderer resources for material '%s'.", m->name);
         return false;
     }
     
@@ -311,7 +443,7 @@ b8 load_material(material_config config, material *m)
 
 void destroy_material(material *m)
 {
-    MTRACE("Destroying material '%s'...", m->name);
+    MTRACE_CH(LOG_CHANNEL_MATERIAL, "Destroying material '%s'...", m->name);
     
     // Release texture references.
     if (m->diffuse_map.texture)
@@ -341,7 +473,7 @@ b8 create_default_material(material_system_state *state)
     
     if (!renderer_create_material(&state->default_material))
     {
-        MFATAL("Failed to acquire renderer resources for default texture. Application cannot continue.");
+        MFATAL_CH(LOG_CHANNEL_MATERIAL, "Failed to acquire renderer resources for default texture. Application cannot continue.");
     }
     
     return true;
@@ -349,82 +481,100 @@ b8 create_default_material(material_system_state *state)
 
 b8 load_configuration_file(const char *path, material_config *out_config)
 {
-    file_handle f;
-    if (!filesystem_open(path, FILE_MODE_READ, false, &f))
+    vfs_file file;
+    if (!vfs_open(path, FILE_ACCESS_SEQUENTIAL, &file))
     {
-        MERROR("load_configuration_file - unable to open file for reading: '%s'.", path);
+        MERROR_CH(LOG_CHANNEL_MATERIAL, "load_configuration_file - unable to open file for reading: '%s'.", path);
         return false;
     }
     
-    // Read each line of the file.
-    char line_buf[512] = "";
-    char *p = &line_buf[0];
-    u64 line_length = 0;
-    u32 line_number = 1;
-    while(filesystem_read_line(&f, 511, &p, &line_length))
+    parse_configuration(path, file.data, file.size, out_config);
+    vfs_close(&file);
+    
+    return true;
+}
+
+void parse_configuration(const char *path, const void *data, u64 size, material_config *out_config)
+{
+    // Walk the entries in place, only copying out the values that are kept.
+    config_reader reader;
+    config_reader_create(data, size, &reader);
+    config_entry entry;
+    while (config_reader_next(&reader, &entry))
     {
-        // Trim the string.
-        char *trimmed = string_trim(line_buf);
-        
-        // Get the trimmed length.
-        line_length = string_length(trimmed);
-        
-        // Skip blank lines and comments.
-        if (line_length < 1 || trimmed[0] == '#')
+        if (!entry.value.str)
         {
-            line_number++;
+            MWARN_CH(LOG_CHANNEL_MATERIAL, "Potential formatting issue found in file '%s': '=' token not found. Skipping line %u.", path, entry.line_number);
             continue;
         }
         
-        // Split line into var/value
-        i32 equal_index = string_index_of(trimmed, '=');
-        if (equal_index == -1)
-        {
-            MWARN("Potential formatting issue found in file '%s': '=' token not found. Skipping line %ui.", path, line_number);
-            line_number++;
-            continue;
-        }
-        
-        // Assume a max of 64 characters for the variable name.
-        char raw_var_name[64];
-        mzero_memory(raw_var_name, sizeof(char) * 64);
-        string_mid(raw_var_name, trimmed, 0, equal_index);
-        char *trimmed_var_name = string_trim(raw_var_name); 
-        
-        char raw_value[446];
-        mzero_memory(raw_value, sizeof(char) * 446);
-        string_mid(raw_value, trimmed, equal_index + 1, -1);
-        char *trimmed_value = string_trim(raw_value); 
-        
         // Process the variable.
-        if (strings_equali(trimmed_var_name, "version"))
+        if (string_view_equali(entry.key, "version"))
         {
             // TODO(satvik): version.
         }
-        else if (strings_equali(trimmed_var_name, "name"))
+        else if (string_view_equali(entry.key, "name"))
+        {
+            string_view_copy(out_config->name, entry.value, MATERIAL_NAME_MAX_LENGTH);
+        }
+        else if (string_view_equali(entry.key, "diffuse_map_name"))
         {
-            string_ncopy(out_config->name, trimmed_value, MATERIAL_NAME_MAX_LENGTH);
+            string_view_copy(out_config->diffuse_map_name, entry.value, TEXTURE_NAME_MAX_LENGTH);
         }
-        else if (strings_equali(trimmed_var_name, "diffuse_map_name"))
+        else if (string_view_equali(entry.key, "diffuse_filter"))
         {
-            string_ncopy(out_config->diffuse_map_name, trimmed_value, TEXTURE_NAME_MAX_LENGTH);
+            texture_filter filter = TEXTURE_FILTER_LINEAR;
+            if (string_view_equali(entry.value, "nearest"))
+            {
+                filter = TEXTURE_FILTER_NEAREST;
+            }
+            else if (!string_view_equali(entry.value, "linear"))
+            {
+                MWARN_CH(LOG_CHANNEL_MATERIAL, "Unknown diffuse filter in file '%s' on line %u. Using linear instead.", path, entry.line_number);
+            }
+            out_config->diffuse_sampler.minify = filter;
+            out_config->diffuse_sampler.magnify = filter;
+            out_config->diffuse_sampler.mip_filter = filter;
         }
-        else if (strings_equali(trimmed_var_name, "diffuse_colour"))
+        else if (string_view_equali(entry.key, "diffuse_repeat"))
         {
-            // Parse the colour
-            if (!string_to_vec4(trimmed_value, &out_config->diffuse_colour))
+            texture_repeat repeat = TEXTURE_REPEAT_REPEAT;
+            if (string_view_equali(entry.value, "mirrored_repeat"))
             {
-                MWARN("Error parsing diffuse colour in file '%s'. Using default of white instead.", path);
+                repeat = TEXTURE_REPEAT_MIRRORED_REPEAT;
+            }
+            else if (string_view_equali(entry.value, "clamp_to_edge"))
+            {
+                repeat = TEXTURE_REPEAT_CLAMP_TO_EDGE;
+            }
+            else if (!string_view_equali(entry.value, "repeat"))
+            {
+                MWARN_CH(LOG_CHANNEL_MATERIAL, "Unknown diffuse repeat in file '%s' on line %u. Using repeat instead.", path, entry.line_number);
+            }
+            out_config->diffuse_sampler.repeat_u = repeat;
+            out_config->diffuse_sampler.repeat_v = repeat;
+            out_config->diffuse_sampler.repeat_w = repeat;
+        }
+        else if (string_view_equali(entry.key, "diffuse_anisotropy"))
+        {
+            char anisotropy[32];
+            string_view_copy(anisotropy, entry.value, sizeof(anisotropy));
+            if (!string_to_f32(anisotropy, &out_config->diffuse_sampler.max_anisotropy))
+            {
+                MWARN_CH(LOG_CHANNEL_MATERIAL, "Error parsing diffuse anisotropy in file '%s'. Using the most the renderer allows instead.", path);
+                out_config->diffuse_sampler.max_anisotropy = 0.0f;
+            }
+        }
+        else if (string_view_equali(entry.key, "diffuse_colour"))
+        {
+            // Parse the colour. string_to_vec4 needs a terminated string, so copy just this value out.
+            char colour[64];
+            string_view_copy(colour, entry.value, sizeof(colour));
+            if (!string_to_vec4(colour, &out_config->diffuse_colour))
+            {
+                MWARN_CH(LOG_CHANNEL_MATERIAL, "Error parsing diffuse colour in file '%s'. Using default of white instead.", path);
                 out_config->diffuse_colour = vec4_one();
             }
         }
-        
-        // Clear the line buffer.
-        mzero_memory(line_buf, sizeof(char) * 512);
-        line_number++;
     }
-    
-    filesystem_close(&f);
-    
-    return true;
 }
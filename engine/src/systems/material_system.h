@@ -17,13 +17,30 @@ typedef struct material_config
     b8 auto_release;
     vec4 diffuse_colour;
     char diffuse_map_name[TEXTURE_NAME_MAX_LENGTH];
+    texture_sampler_config diffuse_sampler;
 } material_config;
 
-b8 material_system_initialise(u64 *memory_requirement, void *state, material_system_config config);
-void material_system_shutdown(void *state);
+MAPI b8 material_system_initialise(u64 *memory_requirement, void *state, material_system_config config);
+MAPI void material_system_shutdown(void *state);
 
-material *material_system_acquire(const char *name);
+MAPI material *material_system_acquire(const char *name);
 material *material_system_acquire_from_config(material_config config);
-void material_system_release(const char *name);
-
-material *material_system_get_default();
\ No newline at end of file
+MAPI void material_system_release(const char *name);
+
+/**
+ * @brief Switches between taking slots for new materials from the free list, and scanning every slot
+ * for an unused one, for benchmarks. Only change this while the system isn't initialised. Disabled
+ * by default.
+ */
+MAPI void material_system_set_slot_scan_enabled(b8 enabled);
+
+material *material_system_get_default();
+
+/**
+ * @brief Reloads a material from its loose configuration file, i.e. after it has been edited. The file is
+ * read in the background; once it arrives the material is updated in place and its generation bumped.
+ * Does nothing if the material is not loaded.
+ * 
+ * @param name The name of the material.
+ */
+void material_system_reload(const char *name);
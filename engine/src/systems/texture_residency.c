@@ -0,0 +1,200 @@
+#include "texture_residency.h"
+
+#include "resources/block_compression.h"
+
+// The coarsest level a texture is allowed to drop to.
+static u32 floor_level(const texture_residency *residency)
+{
+    u32 largest = residency->width > residency->height ? residency->width : residency->height;
+    u32 level = 0;
+    while (level + 1 < residency->level_count && (largest >> (level + 1)) >= TEXTURE_RESIDENCY_MIN_SIZE)
+    {
+        level++;
+    }
+    return level;
+}
+
+static u32 wanted_level(const texture_residency *residency)
+{
+    u32 wanted = residency->window_level < residency->previous_window_level ? residency->window_level : residency->previous_window_level;
+    u32 floor = floor_level(residency);
+    return wanted < floor ? wanted : floor;
+}
+
+static b8 is_idle(const texture_residency *residency)
+{
+    return residency->level_count != 0 && residency->target_level == residency->resident_level;
+}
+
+// Finds the least recently used idle texture which can drop a level, or INVALID_ID.
+static u32 find_victim(const texture_residency *records, u32 count, u32 exclude, b8 allow_used_this_frame, u64 frame)
+{
+    u32 victim = INVALID_ID;
+    for (u32 i = 0; i < count; ++i)
+    {
+        const texture_residency *r = &records[i];
+        if (i == exclude || !is_idle(r) || r->target_level >= floor_level(r) || (!allow_used_this_frame && r->last_used_frame == frame))
+        {
+            continue;
+        }
+        if (victim == INVALID_ID || r->last_used_frame < records[victim].last_used_frame)
+        {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+void texture_residency_track(texture_residency *residency, texture_format format, u32 width, u32 height, u32 level_count, u32 resident_level, u64 frame)
+{
+    residency->format = format;
+    residency->width = width;
+    residency->height = height;
+    residency->level_count = level_count;
+    residency->resident_level = resident_level;
+    residency->target_level = resident_level;
+    // Assume what was loaded is needed until usage says otherwise, so a texture isn't dropped before
+    // it has been drawn.
+    residency->window_level = resident_level;
+    residency->previous_window_level = resident_level;
+    residency->last_used_frame = frame;
+}
+
+u64 texture_residency_size(const texture_residency *residency, u32 top_level)
+{
+    u64 size = 0;
+    for (u32 level = top_level; level < residency->level_count; ++level)
+    {
+        size += texture_format_level_size(residency->format, residency->width, residency->height, level);
+    }
+    return size;
+}
+
+u32 texture_residency_level_for_size(const texture_residency *residency, f32 screen_size)
+{
+    u32 largest = residency->width > residency->height ? residency->width : residency->height;
+    u32 level = 0;
+    while (level + 1 < residency->level_count && (f32)(largest >> (level + 1)) >= screen_size)
+    {
+        level++;
+    }
+    return level;
+}
+
+void texture_residency_report_usage(texture_residency *residency, f32 screen_size, u64 frame)
+{
+    if (residency->level_count == 0)
+    {
+        return;
+    }
+    u32 level = texture_residency_level_for_size(residency, screen_size);
+    if (level < residency->window_level)
+    {
+        residency->window_level = level;
+    }
+    residency->last_used_frame = frame;
+}
+
+u32 texture_residency_plan(texture_residency *records, u32 count, u64 budget, u64 frame, u32 max_changes, u32 *out_changes)
+{
+    // Start a new window every so often, forgetting usage from two windows ago.
+    b8 roll = frame % TEXTURE_RESIDENCY_WINDOW_FRAMES == 0;
+    u64 total = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        texture_residency *r = &records[i];
+        if (r->level_count == 0)
+        {
+            continue;
+        }
+        if (roll)
+        {
+            r->previous_window_level = r->window_level;
+            r->window_level = r->level_count - 1;
+        }
+        total += texture_residency_size(r, r->target_level);
+    }
+
+    u32 change_count = 0;
+
+    // Raise textures drawn this frame which need finer levels.
+    for (u32 i = 0; i < count && change_count < max_changes; ++i)
+    {
+        texture_residency *r = &records[i];
+        u32 wanted = wanted_level(r);
+        if (!is_idle(r) || r->last_used_frame != frame || wanted >= r->target_level)
+        {
+            continue;
+        }
+
+        u64 growth = texture_residency_size(r, wanted) - texture_residency_size(r, r->target_level);
+        while (total + growth > budget && change_count + 1 < max_changes)
+        {
+            // Only textures which weren't drawn this frame make room.
+            u32 victim = find_victim(records, count, i, false, frame);
+            if (victim == INVALID_ID)
+            {
+                break;
+            }
+            texture_residency *v = &records[victim];
+            total -= texture_residency_size(v, v->target_level) - texture_residency_size(v, v->target_level + 1);
+            v->target_level++;
+            out_changes[change_count++] = victim;
+        }
+
+        // Without room for all of it, come up as far as fits.
+        while (total + growth > budget && wanted < r->target_level)
+        {
+            wanted++;
+            growth = texture_residency_size(r, wanted) - texture_residency_size(r, r->target_level);
+        }
+        if (wanted < r->target_level && change_count < max_changes)
+        {
+            total += growth;
+            r->target_level = wanted;
+            out_changes[change_count++] = i;
+        }
+    }
+
+    // Lower textures which no longer need their top levels.
+    for (u32 i = 0; i < count && change_count < max_changes; ++i)
+    {
+        texture_residency *r = &records[i];
+        u32 wanted = wanted_level(r);
+        if (!is_idle(r) || wanted <= r->target_level)
+        {
+            continue;
+        }
+        total -= texture_residency_size(r, r->target_level) - texture_residency_size(r, wanted);
+        r->target_level = wanted;
+        out_changes[change_count++] = i;
+    }
+
+    // Still over budget, so drop levels which are needed, least recently used first.
+    while (total > budget && change_count < max_changes)
+    {
+        u32 victim = find_victim(records, count, INVALID_ID, true, frame);
+        if (victim == INVALID_ID)
+        {
+            break;
+        }
+        texture_residency *v = &records[victim];
+        total -= texture_residency_size(v, v->target_level) - texture_residency_size(v, v->target_level + 1);
+        v->target_level++;
+        out_changes[change_count++] = victim;
+    }
+
+    return change_count;
+}
+
+void texture_residency_complete(texture_residency *residency, b8 success)
+{
+    if (success)
+    {
+        residency->resident_level = residency->target_level;
+    }
+    else
+    {
+        residency->target_level = residency->resident_level;
+    }
+}
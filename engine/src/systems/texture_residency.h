@@ -0,0 +1,89 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/resource_types.h"
+
+/**
+ * Decides which mip levels of each texture to keep on the GPU. The renderer reports how large each
+ * texture is drawn on screen; a texture only needs the levels at least that many texels across. Levels
+ * are dropped when they stop being needed, and when a memory budget is exceeded, starting with the least
+ * recently used textures. Only the top resident level is chosen; every level below it stays resident.
+ */
+
+// How many frames usage is gathered over. A texture keeps the finest level it needed over the current and
+// previous window, so it doesn't drop a level the moment it moves away.
+#define TEXTURE_RESIDENCY_WINDOW_FRAMES 120
+
+// Textures are never dropped below this size, where a reload costs more than it saves.
+#define TEXTURE_RESIDENCY_MIN_SIZE 64
+
+typedef struct texture_residency
+{
+    texture_format format;
+    // The size of level 0.
+    u32 width;
+    u32 height;
+    // The levels in the full chain. 0 for a texture which isn't tracked.
+    u32 level_count;
+    // The top level on the GPU.
+    u32 resident_level;
+    // The top level being streamed to. The same as resident_level when nothing is in flight.
+    u32 target_level;
+    // The finest level usage has asked for in the current and previous windows.
+    u32 window_level;
+    u32 previous_window_level;
+    u64 last_used_frame;
+} texture_residency;
+
+/**
+ * @brief Starts tracking a texture which has just been loaded.
+ * 
+ * @param residency A pointer to the record.
+ * @param format The format of the texture.
+ * @param width The width of level 0.
+ * @param height The height of level 0.
+ * @param level_count The levels in the full chain.
+ * @param resident_level The top level which was loaded.
+ * @param frame The current frame.
+ */
+MAPI void texture_residency_track(texture_residency *residency, texture_format format, u32 width, u32 height, u32 level_count, u32 resident_level, u64 frame);
+
+/**
+ * @brief Gets the GPU memory, in bytes, used by the levels from top_level down.
+ */
+MAPI u64 texture_residency_size(const texture_residency *residency, u32 top_level);
+
+/**
+ * @brief Gets the coarsest level which still has at least screen_size texels across its longer side.
+ */
+MAPI u32 texture_residency_level_for_size(const texture_residency *residency, f32 screen_size);
+
+/**
+ * @brief Records that a texture was drawn this frame, screen_size pixels across at its largest.
+ */
+MAPI void texture_residency_report_usage(texture_residency *residency, f32 screen_size, u64 frame);
+
+/**
+ * @brief Picks new target levels. Textures drawn this frame which need finer levels are raised, making
+ * room under the budget by dropping a level from the least recently used textures. Textures which no
+ * longer need their top levels are lowered. Then, while over budget, the least recently used textures
+ * drop a level at a time. Textures with a stream in flight are left alone.
+ * 
+ * @param records An array of records. Untracked records are skipped.
+ * @param count The number of records.
+ * @param budget The GPU memory, in bytes, textures should fit in.
+ * @param frame The current frame.
+ * @param max_changes The most target levels to change.
+ * @param out_changes An array of at least max_changes to hold the indices of the records whose
+ * target_level now differs from resident_level.
+ * @return The number of indices written to out_changes.
+ */
+MAPI u32 texture_residency_plan(texture_residency *records, u32 count, u64 budget, u64 frame, u32 max_changes, u32 *out_changes);
+
+/**
+ * @brief Finishes a stream started by texture_residency_plan.
+ * 
+ * @param residency A pointer to the record.
+ * @param success True if target_level is now resident; false to forget the target.
+ */
+MAPI void texture_residency_complete(texture_residency *residency, b8 success);
@@ -4,9 +4,26 @@
 #include "core/mstring.h"
 #include "core/mmemory.h"
 #include "containers/hashtable.h"
+#include "containers/id_pool.h"
+#include "platform/vfs.h"
+#include "platform/platform.h"
+#include "core/job_system.h"
+#include "resources/block_compression.h"
+#include "resources/cooked_texture.h"
+#include "resources/image.h"
+#include "resources/texture_atlas.h"
+#include "systems/texture_residency.h"
 
 #include "renderer/renderer_frontend.h"
 
+// The most textures to start streaming in a frame.
+#define TEXTURE_STREAMING_MAX_CHANGES 8
+
+#define TEXTURE_ATLAS_NAME "texture_atlas"
+
+// The most atlas regions to update separately in a frame. Past this, whole layers are updated.
+#define TEXTURE_ATLAS_MAX_DIRTY_REGIONS 64
+
 // TODO: resource loader.
 #define STB_IMAGE_IMPLEMENTATION
 #include "vendor/stb_image.h"
@@ -21,6 +38,30 @@ typedef struct texture_system_state
 
     // Hashtable for texture lookups.
     hashtable registered_texture_table;
+
+    // Slots in registered_textures which are not in use.
+    id_pool free_slots;
+
+    // Counts the jobs of asynchronous loads which have not finished.
+    job_counter pending_loads;
+
+    // Which mip levels of each registered texture are resident, indexed the same.
+    texture_residency *residency;
+    // Counts calls to texture_system_update.
+    u64 frame;
+
+    // Small textures are packed into the atlas texture, rather than getting textures of their own.
+    // The pixels of every layer are kept, and the regions which change are copied into the atlas
+    // texture in place.
+    texture atlas_texture;
+    texture_atlas atlas;
+    // Where each registered texture packed into the atlas is, indexed the same as registered_textures.
+    texture_atlas_region *atlas_regions;
+    u8 *atlas_pixels;
+    // What has been packed since the atlas texture was last updated. If too much has, every layer.
+    texture_region atlas_dirty_regions[TEXTURE_ATLAS_MAX_DIRTY_REGIONS];
+    u32 atlas_dirty_count;
+    b8 atlas_all_dirty;
 } texture_system_state;
 
 typedef struct texture_reference
@@ -30,26 +71,103 @@ typedef struct texture_reference
     b8 auto_release;
 } texture_reference;
 
+// Pixels decoded from a file, ready to upload.
+typedef struct decoded_texture
+{
+    u32 width;
+    u32 height;
+    u8 channel_count;
+    b8 has_transparency;
+    texture_format format;
+    // Levels in pixels, largest first.
+    u32 mip_levels;
+    // The level of the full image that pixels starts at, and the size of the full image.
+    u32 base_level;
+    u32 full_width;
+    u32 full_height;
+    const u8 *pixels;
+    // The cooked texture pixels point into, if they were not decoded into an allocation.
+    vfs_file cooked_file;
+    // The cache entry pixels point into, if they came from the cache.
+    file_mapping cache_mapping;
+    // If not 0, the mallocate allocation pixels point into, rather than one from stb_image.
+    void *allocation;
+    u64 allocation_size;
+} decoded_texture;
+
+// An asynchronous load, from being queued until it has been swapped in.
+typedef enum texture_load_kind
+{
+    // The first load of a texture, into a placeholder.
+    TEXTURE_LOAD_INITIAL,
+    // Streaming a different set of levels of a texture which is already loaded.
+    TEXTURE_LOAD_STREAMING,
+    // Replacing a loaded texture with its loose image file, after it has been edited.
+    TEXTURE_LOAD_RELOAD,
+} texture_load_kind;
+
+typedef struct texture_load
+{
+    char name[TEXTURE_NAME_MAX_LENGTH];
+    u32 handle;
+    // The top mip level to load.
+    u32 base_level;
+    texture_load_kind kind;
+    b8 opened;
+    const char *failure_reason;
+    decoded_texture decoded;
+    job_counter decode_counter;
+} texture_load;
+
 static texture_system_state *state_ptr = 0;
 
+// Find free slots the way they were found before the free list, for benchmarks.
+static b8 slot_scan_enabled = false;
+
 b8 create_default_textures(texture_system_state *state);
 void destroy_default_textures(texture_system_state *state);
+void texture_file_name(const char *texture_name, char *out_file_name);
 b8 load_texture(const char *texture_name, texture *t);
+b8 decode_texture(const void *file_data, u64 file_size, decoded_texture *out_decoded, const char **out_failure_reason);
+b8 open_texture(const char *texture_name, u32 base_level, decoded_texture *out_decoded, b8 *out_opened, const char **out_failure_reason);
+void free_decoded_texture(decoded_texture *decoded);
+void prepare_upload(const char *texture_name, const decoded_texture *decoded, texture *out_texture);
+void swap_in_texture(texture *t, const texture *uploaded);
+void upload_texture(const char *texture_name, decoded_texture *decoded, texture *t);
+void track_residency(const texture *t, const decoded_texture *decoded);
+b8 pack_into_atlas(const char *texture_name, const decoded_texture *decoded, texture *t);
 void destroy_texture(texture *t);
 
 b8 texture_system_initialise(u64 *memory_requirement, void *state, texture_system_config config)
 {
     if (config.max_texture_count == 0)
     {
-        MFATAL("texture_system_initialize - config.max_texture_count must be > 0.");
+        MFATAL_CH(LOG_CHANNEL_TEXTURE, "texture_system_initialize - config.max_texture_count must be > 0.");
+        return false;
+    }
+
+    if (config.atlas_layer_count != 0 && (config.atlas_size == 0 || config.atlas_size % TEXTURE_ATLAS_PADDING != 0))
+    {
+        MFATAL_CH(LOG_CHANNEL_TEXTURE, "texture_system_initialize - config.atlas_size must be a multiple of %u.", TEXTURE_ATLAS_PADDING);
         return false;
     }
 
-    // Block of memory will contain state structure, then block for array, then block for hashtable.
+    // Block of memory will contain state structure, then block for array, then block for hashtable,
+    // then block for the free slots, then block for residency, then blocks for the atlas.
     u64 struct_requirement = sizeof(texture_system_state);
     u64 array_requirement = sizeof(texture) * config.max_texture_count;
     u64 hashtable_requirement = sizeof(texture_reference) * config.max_texture_count;
-    *memory_requirement = struct_requirement + array_requirement + hashtable_requirement;
+    u64 free_slots_requirement = sizeof(u32) * config.max_texture_count;
+    u64 residency_requirement = sizeof(texture_residency) * config.max_texture_count;
+    u64 atlas_regions_requirement = 0;
+    u64 atlas_requirement = 0;
+    if (config.atlas_layer_count != 0)
+    {
+        atlas_regions_requirement = sizeof(texture_atlas_region) * config.max_texture_count;
+        atlas_requirement = texture_atlas_memory_requirement(config.atlas_size, config.atlas_layer_count);
+    }
+    *memory_requirement = struct_requirement + array_requirement + hashtable_requirement + free_slots_requirement + residency_requirement +
+                          atlas_regions_requirement + atlas_requirement;
 
     if (!state)
     {
@@ -76,6 +194,25 @@ b8 texture_system_initialise(u64 *memory_requirement, void *state, texture_syste
     invalid_ref.reference_count = 0;
     hashtable_fill(&state_ptr->registered_texture_table, &invalid_ref);
 
+    // Free slots are after the hashtable.
+    id_pool_create(config.max_texture_count, hashtable_block + hashtable_requirement, &state_ptr->free_slots);
+
+    // Residency is after the free slots. Zeroed, so nothing is tracked.
+    state_ptr->residency = hashtable_block + hashtable_requirement + free_slots_requirement;
+
+    // The atlas is after the residency. Its texture is created by the first texture_system_update
+    // after something is packed into it. Its id is past those of registered textures, so the renderer
+    // can tell it apart from them.
+    state_ptr->atlas_texture.id = config.max_texture_count;
+    state_ptr->atlas_texture.generation = INVALID_ID;
+    if (config.atlas_layer_count != 0)
+    {
+        void *atlas_block = (void *)state_ptr->residency + residency_requirement;
+        state_ptr->atlas_regions = atlas_block;
+        texture_atlas_create(config.atlas_size, config.atlas_layer_count, atlas_block + atlas_regions_requirement, &state_ptr->atlas);
+        state_ptr->atlas_pixels = mallocate((u64)config.atlas_size * config.atlas_size * 4 * config.atlas_layer_count, MEMORY_TAG_TEXTURE);
+    }
+
     // Invalidate all textures in the array.
     u32 count = state_ptr->config.max_texture_count;
     for (u32 i = 0; i < count; ++i)
@@ -84,6 +221,12 @@ b8 texture_system_initialise(u64 *memory_requirement, void *state, texture_syste
         state_ptr->registered_textures[i].generation = INVALID_ID;
     }
 
+    if (config.cache_path && !filesystem_create_directory(config.cache_path))
+    {
+        MWARN_CH(LOG_CHANNEL_TEXTURE, "Unable to create texture cache directory '%s'. Textures will not be cached.", config.cache_path);
+        state_ptr->config.cache_path = 0;
+    }
+
     // Create default textures for use in the system.
     create_default_textures(state_ptr);
 
@@ -94,28 +237,94 @@ void texture_system_shutdown(void *state)
 {
     if (state_ptr)
     {
-        // Destroy all loaded textures.
+        // Let asynchronous loads finish, so none are left holding a slot or decoded pixels.
+        job_system_wait(&state_ptr->pending_loads);
+
+        // Destroy all loaded textures. Those packed into the atlas go with it.
         for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i)
         {
             texture *t = &state_ptr->registered_textures[i];
-            if (t->generation != INVALID_ID)
+            if (t->generation != INVALID_ID && !t->atlas)
             {
                 renderer_destroy_texture(t);
             }
         }
 
+        if (state_ptr->atlas_pixels)
+        {
+            if (state_ptr->atlas_texture.internal_data)
+            {
+                renderer_destroy_texture(&state_ptr->atlas_texture);
+            }
+            mfree(state_ptr->atlas_pixels, (u64)state_ptr->config.atlas_size * state_ptr->config.atlas_size * 4 * state_ptr->config.atlas_layer_count, MEMORY_TAG_TEXTURE);
+        }
+
         destroy_default_textures(state_ptr);
 
         state_ptr = 0;
     }
 }
 
-texture *texture_system_acquire(const char *name, b8 auto_release)
+void texture_system_set_slot_scan_enabled(b8 enabled)
+{
+    slot_scan_enabled = enabled;
+}
+
+// Takes a slot which holds no texture.
+static b8 take_free_slot(u32 *out_handle)
+{
+    if (!slot_scan_enabled)
+    {
+        return id_pool_acquire(&state_ptr->free_slots, out_handle);
+    }
+
+    for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i)
+    {
+        if (state_ptr->registered_textures[i].id == INVALID_ID)
+        {
+            *out_handle = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Gives back a slot from take_free_slot, once its texture has been invalidated.
+static void release_slot(u32 handle)
+{
+    if (!slot_scan_enabled)
+    {
+        id_pool_release(&state_ptr->free_slots, handle);
+    }
+}
+
+static void texture_decode_job(void *params);
+static void texture_upload_job(void *params);
+static b8 open_texture_image(const char *texture_name, vfs_file *file, u32 base_level, decoded_texture *out_decoded, const char **out_failure_reason);
+
+// Queues a texture to be decoded on a worker, then uploaded and swapped in on the main thread.
+static void begin_async_load(const char *name, u32 handle, u32 base_level, texture_load_kind kind)
+{
+    texture_load *load = mallocate(sizeof(texture_load), MEMORY_TAG_TEXTURE);
+    string_ncopy(load->name, name, TEXTURE_NAME_MAX_LENGTH);
+    load->handle = handle;
+    load->base_level = base_level;
+    load->kind = kind;
+
+    job_desc decode = {texture_decode_job, load, JOB_FLAG_NONE};
+    job_system_run(&decode, 1, &load->decode_counter);
+
+    // Uploads have to happen on the main thread, which talks to the renderer.
+    job_desc upload = {texture_upload_job, load, JOB_FLAG_MAIN_THREAD};
+    job_system_run_after(&upload, 1, &load->decode_counter, &state_ptr->pending_loads);
+}
+
+static texture *acquire_texture(const char *name, b8 auto_release, b8 async)
 {
     // Return default texture, but warn about it since this should be returned via get_default_texture();
     if (strings_equali(name, DEFAULT_TEXTURE_NAME))
     {
-        MWARN("texture_system_acquire called for default texture. Use texture_system_get_default_texture for texture 'default'.");
+        MWARN_CH(LOG_CHANNEL_TEXTURE, "texture_system_acquire called for default texture. Use texture_system_get_default_texture for texture 'default'.");
         return &state_ptr->default_texture;
     }
 
@@ -130,41 +339,37 @@ texture *texture_system_acquire(const char *name, b8 auto_release)
         ref.reference_count++;
         if (ref.handle == INVALID_ID)
         {
-            // This means no texture exists here. Find a free index first.
-            u32 count = state_ptr->config.max_texture_count;
-            texture *t = 0;
-            for (u32 i = 0; i < count; ++i)
+            // This means no texture exists here. Take a free slot and use its index as the handle.
+            if (!take_free_slot(&ref.handle))
             {
-                if (state_ptr->registered_textures[i].id == INVALID_ID)
-                {
-                    // A free slot has been found. Use its index as the handle.
-                    ref.handle = i;
-                    t = &state_ptr->registered_textures[i];
-                    break;
-                }
+                MFATAL_CH(LOG_CHANNEL_TEXTURE, "texture_system_acquire - Texture system cannot hold anymore textures. Adjust configuration to allow more.");
+                return 0;
             }
+            texture *t = &state_ptr->registered_textures[ref.handle];
+            // Also use the handle as the texture id. Set before loading, which tracks residency by id.
+            t->id = ref.handle;
 
-            // Make sure an empty slot was actually found.
-            if (!t || ref.handle == INVALID_ID)
+            if (async)
             {
-                MFATAL("texture_system_acquire - Texture system cannot hold anymore textures. Adjust configuration to allow more.");
-                return 0;
+                // Hold the slot with a placeholder. Its generation stays invalid, so it is drawn as the
+                // default texture until the real one is swapped in.
+                string_ncopy(t->name, name, TEXTURE_NAME_MAX_LENGTH);
+                begin_async_load(name, ref.handle, 0, TEXTURE_LOAD_INITIAL);
             }
-
-            // Create new texture.
-            if (!load_texture(name, t))
+            else if (!load_texture(name, t))
             {
-                MERROR("Failed to load texture '%s'.", name);
+                // Create new texture.
+                MERROR_CH(LOG_CHANNEL_TEXTURE, "Failed to load texture '%s'.", name);
+                t->id = INVALID_ID;
+                release_slot(ref.handle);
                 return 0;
             }
 
-            // Also use the handle as the texture id.
-            t->id = ref.handle;
-            MTRACE("Texture '%s' does not yet exist. Created, and ref_count is now %i.", name, ref.reference_count);
+            MTRACE_CH(LOG_CHANNEL_TEXTURE, "Texture '%s' does not yet exist. %s, and ref_count is now %i.", name, async ? "Loading" : "Created", ref.reference_count);
         }
         else
         {
-            MTRACE("Texture '%s' already exists, ref_count increased to %i.", name, ref.reference_count);
+            MTRACE_CH(LOG_CHANNEL_TEXTURE, "Texture '%s' already exists, ref_count increased to %i.", name, ref.reference_count);
         }
 
         // Update the entry.
@@ -173,10 +378,172 @@ texture *texture_system_acquire(const char *name, b8 auto_release)
     }
 
     // NOTE: This would only happen in the event something went wrong with the state.
-    MERROR("texture_system_acquire failed to acquire texture '%s'. Null pointer will be returned.", name);
+    MERROR_CH(LOG_CHANNEL_TEXTURE, "texture_system_acquire failed to acquire texture '%s'. Null pointer will be returned.", name);
     return 0;
 }
 
+texture *texture_system_acquire(const char *name, b8 auto_release)
+{
+    return acquire_texture(name, auto_release, false);
+}
+
+texture *texture_system_acquire_async(const char *name, b8 auto_release)
+{
+    return acquire_texture(name, auto_release, true);
+}
+
+b8 texture_system_acquire_batch(const char **names, u32 count, b8 auto_release, texture **out_textures)
+{
+    if (!state_ptr)
+    {
+        MERROR_CH(LOG_CHANNEL_TEXTURE, "texture_system_acquire_batch called before texture system initialization!");
+        return false;
+    }
+
+    // Take a reference to each texture, reserving slots for the ones which aren't loaded. The reference
+    // is stored straight away, so a name repeated later in the batch finds the slot and shares it.
+    texture_load *loads = mallocate(sizeof(texture_load) * count, MEMORY_TAG_TEXTURE);
+    u32 load_count = 0;
+    b8 result = true;
+    for (u32 i = 0; i < count; ++i)
+    {
+        out_textures[i] = 0;
+        if (strings_equali(names[i], DEFAULT_TEXTURE_NAME))
+        {
+            out_textures[i] = &state_ptr->default_texture;
+            continue;
+        }
+
+        texture_reference ref;
+        if (!hashtable_get(&state_ptr->registered_texture_table, names[i], &ref))
+        {
+            MERROR_CH(LOG_CHANNEL_TEXTURE, "texture_system_acquire_batch failed to acquire texture '%s'.", names[i]);
+            result = false;
+            continue;
+        }
+
+        if (ref.reference_count == 0)
+        {
+            ref.auto_release = auto_release;
+        }
+        if (ref.handle == INVALID_ID)
+        {
+            if (!take_free_slot(&ref.handle))
+            {
+                MFATAL_CH(LOG_CHANNEL_TEXTURE, "texture_system_acquire_batch - Texture system cannot hold anymore textures. Adjust configuration to allow more.");
+                result = false;
+                continue;
+            }
+
+            // Held as a placeholder until it is uploaded.
+            texture *t = &state_ptr->registered_textures[ref.handle];
+            string_ncopy(t->name, names[i], TEXTURE_NAME_MAX_LENGTH);
+            t->id = ref.handle;
+
+            texture_load *load = &loads[load_count++];
+            string_ncopy(load->name, names[i], TEXTURE_NAME_MAX_LENGTH);
+            load->handle = ref.handle;
+        }
+        ref.reference_count++;
+        hashtable_set(&state_ptr->registered_texture_table, names[i], &ref);
+        out_textures[i] = &state_ptr->registered_textures[ref.handle];
+    }
+
+    if (load_count > 0)
+    {
+        // Decode everything in parallel. Waiting on the main thread helps out with the decoding.
+        job_desc *decodes = mallocate(sizeof(job_desc) * load_count, MEMORY_TAG_TEXTURE);
+        for (u32 i = 0; i < load_count; ++i)
+        {
+            decodes[i].entry = texture_decode_job;
+            decodes[i].params = &loads[i];
+            decodes[i].flags = JOB_FLAG_NONE;
+        }
+        job_counter decoded = {0};
+        job_system_run(decodes, load_count, &decoded);
+        job_system_wait(&decoded);
+        mfree(decodes, sizeof(job_desc) * load_count, MEMORY_TAG_TEXTURE);
+
+        // Create all of the decoded textures at once, so they share one upload.
+        texture *uploads = mallocate(sizeof(texture) * load_count, MEMORY_TAG_TEXTURE);
+        texture **upload_textures = mallocate(sizeof(texture *) * load_count, MEMORY_TAG_TEXTURE);
+        const u8 **upload_pixels = mallocate(sizeof(u8 *) * load_count, MEMORY_TAG_TEXTURE);
+        u32 upload_count = 0;
+        for (u32 i = 0; i < load_count; ++i)
+        {
+            texture_load *load = &loads[i];
+            if (load->decoded.pixels)
+            {
+                // Small textures are packed into the atlas instead, and are done with already.
+                texture *t = &state_ptr->registered_textures[load->handle];
+                if (pack_into_atlas(load->name, &load->decoded, t))
+                {
+                    track_residency(t, &load->decoded);
+                    free_decoded_texture(&load->decoded);
+                    continue;
+                }
+
+                prepare_upload(load->name, &load->decoded, &uploads[upload_count]);
+                upload_textures[upload_count] = &uploads[upload_count];
+                upload_pixels[upload_count] = load->decoded.pixels;
+                upload_count++;
+                continue;
+            }
+
+            if (!load->opened)
+            {
+                MERROR_CH(LOG_CHANNEL_TEXTURE, "Failed to load texture '%s'.", load->name);
+            }
+            else
+            {
+                MWARN_CH(LOG_CHANNEL_TEXTURE, "Failed to decode texture '%s': %s", load->name, load->failure_reason);
+            }
+
+            // Give the slot back, and clear the references the batch took.
+            texture *t = &state_ptr->registered_textures[load->handle];
+            for (u32 j = 0; j < count; ++j)
+            {
+                if (out_textures[j] == t)
+                {
+                    out_textures[j] = 0;
+                }
+            }
+            texture_reference invalid_ref = {0, INVALID_ID, false};
+            hashtable_set(&state_ptr->registered_texture_table, load->name, &invalid_ref);
+            mzero_memory(t, sizeof(texture));
+            t->id = INVALID_ID;
+            t->generation = INVALID_ID;
+            release_slot(load->handle);
+            result = false;
+        }
+
+        if (upload_count > 0)
+        {
+            renderer_create_textures(upload_pixels, upload_textures, upload_count);
+        }
+
+        upload_count = 0;
+        for (u32 i = 0; i < load_count; ++i)
+        {
+            texture_load *load = &loads[i];
+            if (load->decoded.pixels)
+            {
+                swap_in_texture(&state_ptr->registered_textures[load->handle], &uploads[upload_count++]);
+                track_residency(&state_ptr->registered_textures[load->handle], &load->decoded);
+                free_decoded_texture(&load->decoded);
+            }
+        }
+
+        mfree(upload_pixels, sizeof(u8 *) * load_count, MEMORY_TAG_TEXTURE);
+        mfree(upload_textures, sizeof(texture *) * load_count, MEMORY_TAG_TEXTURE);
+        mfree(uploads, sizeof(texture) * load_count, MEMORY_TAG_TEXTURE);
+    }
+
+    MTRACE_CH(LOG_CHANNEL_TEXTURE, "Acquired a batch of %u textures, %u of which were loaded.", count, load_count);
+    mfree(loads, sizeof(texture_load) * count, MEMORY_TAG_TEXTURE);
+    return result;
+}
+
 void texture_system_release(const char *name)
 {
     // Ignore release requests for the default texture.
@@ -189,7 +556,7 @@ void texture_system_release(const char *name)
     {
         if (ref.reference_count == 0)
         {
-            MWARN("Tried to release non-existent texture: '%s'", name);
+            MWARN_CH(LOG_CHANNEL_TEXTURE, "Tried to release non-existent texture: '%s'", name);
             return;
         }
 
@@ -203,17 +570,19 @@ void texture_system_release(const char *name)
         {
             texture *t = &state_ptr->registered_textures[ref.handle];
 
-            // Destroy/reset texture.
+            // Destroy/reset texture, and free up its slot.
             destroy_texture(t);
+            mzero_memory(&state_ptr->residency[ref.handle], sizeof(texture_residency));
+            release_slot(ref.handle);
 
             // Reset the reference.
             ref.handle = INVALID_ID;
             ref.auto_release = false;
-            MTRACE("Released texture '%s'., Texture unloaded because reference count=0 and auto_release=true.", name_copy);
+            MTRACE_CH(LOG_CHANNEL_TEXTURE, "Released texture '%s'., Texture unloaded because reference count=0 and auto_release=true.", name_copy);
         }
         else
         {
-            MTRACE("Released texture '%s', now has a reference count of '%i' (auto_release=%s).", name_copy, ref.reference_count, ref.auto_release ? "true" : "false");
+            MTRACE_CH(LOG_CHANNEL_TEXTURE, "Released texture '%s', now has a reference count of '%i' (auto_release=%s).", name_copy, ref.reference_count, ref.auto_release ? "true" : "false");
         }
 
         // Update the entry.
@@ -221,7 +590,7 @@ void texture_system_release(const char *name)
     }
     else
     {
-        MERROR("texture_system_release failed to release texture '%s'.", name);
+        MERROR_CH(LOG_CHANNEL_TEXTURE, "texture_system_release failed to release texture '%s'.", name);
     }
 }
 
@@ -232,15 +601,195 @@ texture *texture_system_get_default_texture()
         return &state_ptr->default_texture;
     }
 
-    MERROR("texture_system_get_default_texture called before texture system initialization! Null pointer returned.");
+    MERROR_CH(LOG_CHANNEL_TEXTURE, "texture_system_get_default_texture called before texture system initialization! Null pointer returned.");
     return 0;
 }
 
+void texture_system_reload(const char *name)
+{
+    texture_reference ref;
+    if (!state_ptr || !hashtable_get(&state_ptr->registered_texture_table, name, &ref) || ref.handle == INVALID_ID)
+    {
+        // Not loaded, so there is nothing to reload.
+        return;
+    }
+
+    // Read and decoded on a worker like any other load, then swapped in on the main thread.
+    begin_async_load(name, ref.handle, 0, TEXTURE_LOAD_RELOAD);
+}
+
+void texture_system_report_usage(texture *t, f32 screen_size)
+{
+    // Only registered textures stream; the default texture and placeholders don't.
+    if (!state_ptr || t->id >= state_ptr->config.max_texture_count || t != &state_ptr->registered_textures[t->id])
+    {
+        return;
+    }
+    texture_residency_report_usage(&state_ptr->residency[t->id], screen_size, state_ptr->frame);
+}
+
+// Copies what has been packed into the atlas since the last update into the atlas texture, creating
+// it the first time.
+static void flush_atlas()
+{
+    if (state_ptr->atlas_dirty_count == 0 && !state_ptr->atlas_all_dirty)
+    {
+        return;
+    }
+
+    if (state_ptr->atlas_texture.generation == INVALID_ID)
+    {
+        texture upload;
+        mzero_memory(&upload, sizeof(texture));
+        string_ncopy(upload.name, TEXTURE_ATLAS_NAME, TEXTURE_NAME_MAX_LENGTH);
+        upload.width = state_ptr->config.atlas_size;
+        upload.height = state_ptr->config.atlas_size;
+        upload.channel_count = 4;
+        upload.generation = INVALID_ID;
+        upload.format = TEXTURE_FORMAT_RGBA8;
+        upload.mip_levels = 1;
+        upload.max_mip_levels = TEXTURE_ATLAS_MIP_LEVELS;
+        upload.layer_count = state_ptr->config.atlas_layer_count;
+        renderer_create_texture(state_ptr->atlas_pixels, &upload);
+        swap_in_texture(&state_ptr->atlas_texture, &upload);
+    }
+    else if (state_ptr->atlas_all_dirty)
+    {
+        u32 layer_count = state_ptr->config.atlas_layer_count;
+        texture_region *layers = mallocate(sizeof(texture_region) * layer_count, MEMORY_TAG_TEXTURE);
+        for (u32 i = 0; i < layer_count; ++i)
+        {
+            layers[i].layer = i;
+            layers[i].width = state_ptr->config.atlas_size;
+            layers[i].height = state_ptr->config.atlas_size;
+        }
+        renderer_update_texture(&state_ptr->atlas_texture, state_ptr->atlas_pixels, layer_count, layers);
+        mfree(layers, sizeof(texture_region) * layer_count, MEMORY_TAG_TEXTURE);
+    }
+    else
+    {
+        renderer_update_texture(&state_ptr->atlas_texture, state_ptr->atlas_pixels, state_ptr->atlas_dirty_count, state_ptr->atlas_dirty_regions);
+    }
+
+    state_ptr->atlas_dirty_count = 0;
+    state_ptr->atlas_all_dirty = false;
+}
+
+void texture_system_update()
+{
+    if (!state_ptr)
+    {
+        return;
+    }
+
+    flush_atlas();
+
+    u64 frame = state_ptr->frame++;
+    if (state_ptr->config.streaming_budget == 0)
+    {
+        return;
+    }
+
+    u32 changes[TEXTURE_STREAMING_MAX_CHANGES];
+    u32 change_count = texture_residency_plan(state_ptr->residency, state_ptr->config.max_texture_count, state_ptr->config.streaming_budget,
+                                              frame, TEXTURE_STREAMING_MAX_CHANGES, changes);
+    for (u32 i = 0; i < change_count; ++i)
+    {
+        u32 handle = changes[i];
+        const texture_residency *r = &state_ptr->residency[handle];
+        MTRACE_CH(LOG_CHANNEL_TEXTURE, "Streaming texture '%s' from level %u to %u.", state_ptr->registered_textures[handle].name, r->resident_level, r->target_level);
+        begin_async_load(state_ptr->registered_textures[handle].name, handle, r->target_level, TEXTURE_LOAD_STREAMING);
+    }
+}
+
+// Runs on a worker. Failures are left for texture_upload_job to report, since it knows whether the
+// texture is still wanted.
+static void texture_decode_job(void *params)
+{
+    texture_load *load = params;
+    if (load->kind != TEXTURE_LOAD_RELOAD)
+    {
+        open_texture(load->name, load->base_level, &load->decoded, &load->opened, &load->failure_reason);
+        return;
+    }
+
+    // Always the loose image; that is what is being edited, and neither an archive nor a cooked
+    // texture has the edit yet.
+    char file_name[512];
+    vfs_file file;
+    texture_file_name(load->name, file_name);
+    if (vfs_open_loose(file_name, FILE_ACCESS_SEQUENTIAL, &file))
+    {
+        load->opened = true;
+        open_texture_image(load->name, &file, load->base_level, &load->decoded, &load->failure_reason);
+    }
+}
+
+static void texture_upload_job(void *params)
+{
+    texture_load *load = params;
+    texture *t = &state_ptr->registered_textures[load->handle];
+
+    // The texture may have been released, and the slot reused, while it was being decoded.
+    if (t->id == load->handle && strings_equal(t->name, load->name))
+    {
+        if (load->kind == TEXTURE_LOAD_STREAMING)
+        {
+            if (load->decoded.pixels)
+            {
+                upload_texture(load->name, &load->decoded, t);
+                MTRACE_CH(LOG_CHANNEL_TEXTURE, "Streamed texture '%s' to level %u (%ux%u).", load->name, load->base_level, t->width, t->height);
+            }
+            else
+            {
+                // Keep the levels which are resident, and let a later plan try again.
+                MWARN_CH(LOG_CHANNEL_TEXTURE, "Failed to stream texture '%s' to level %u.", load->name, load->base_level);
+            }
+            texture_residency_complete(&state_ptr->residency[load->handle], load->decoded.pixels != 0);
+        }
+        else if (load->kind == TEXTURE_LOAD_RELOAD)
+        {
+            if (load->decoded.pixels)
+            {
+                upload_texture(load->name, &load->decoded, t);
+                track_residency(t, &load->decoded);
+                MINFO_CH(LOG_CHANNEL_TEXTURE, "Reloaded texture '%s' (generation %u).", load->name, t->generation);
+            }
+            else
+            {
+                // Leave the existing texture as it was, so a failed reload keeps the last good one.
+                MWARN_CH(LOG_CHANNEL_TEXTURE, "Unable to reload texture '%s': %s", load->name,
+                         !load->opened ? "the file could not be opened" : load->failure_reason ? load->failure_reason : "the file could not be decoded");
+            }
+        }
+        else if (load->decoded.pixels)
+        {
+            upload_texture(load->name, &load->decoded, t);
+            track_residency(t, &load->decoded);
+            MTRACE_CH(LOG_CHANNEL_TEXTURE, "Texture '%s' finished loading (generation %u).", load->name, t->generation);
+        }
+        else if (!load->opened)
+        {
+            MERROR_CH(LOG_CHANNEL_TEXTURE, "Failed to load texture '%s'. It will be drawn as the default texture.", load->name);
+        }
+        else
+        {
+            MWARN_CH(LOG_CHANNEL_TEXTURE, "Failed to decode texture '%s': %s", load->name, load->failure_reason);
+        }
+    }
+
+    if (load->decoded.pixels)
+    {
+        free_decoded_texture(&load->decoded);
+    }
+    mfree(load, sizeof(texture_load), MEMORY_TAG_TEXTURE);
+}
+
 b8 create_default_textures(texture_system_state *state)
 {
     // NOTE: Create default texture, a 256x256 blue/white checkerboard pattern.
     // This is done in code to eliminate asset dependencies.
-    MTRACE("Creating default texture...");
+    MTRACE_CH(LOG_CHANNEL_TEXTURE, "Creating default texture...");
     const u32 tex_dimension = 256;
     const u32 channels = 4;
     const u32 pixel_count = tex_dimension * tex_dimension;
@@ -279,6 +828,8 @@ b8 create_default_textures(texture_system_state *state)
     state->default_texture.channel_count = 4;
     state->default_texture.generation = INVALID_ID;
     state->default_texture.has_transparency = false;
+    state->default_texture.format = TEXTURE_FORMAT_RGBA8;
+    state->default_texture.mip_levels = 1;
     renderer_create_texture(pixels, &state->default_texture);
     // Manually set the texture generation to invalid since this is a default texture.
     state->default_texture.generation = INVALID_ID;
@@ -294,101 +845,429 @@ void destroy_default_textures(texture_system_state *state)
     }
 }
 
-b8 load_texture(const char *texture_name, texture *t)
+// Gets the name of a texture's file, relative to the asset root.
+void texture_file_name(const char *texture_name, char *out_file_name)
 {
     // TODO: Should be able to be located anywhere.
-    char *format_str = "assets/textures/%s.%s";
-    const i32 required_channel_count = 4;
-    stbi_set_flip_vertically_on_load(true);
-    char full_file_path[512];
-
     // TODO: try different extensions
-    string_format(full_file_path, format_str, texture_name, "png");
+    string_format(out_file_name, "textures/%s.%s", texture_name, "png");
+}
 
-    // Use a temporary texture to load into.
-    texture temp_texture;
+b8 load_texture(const char *texture_name, texture *t)
+{
+    decoded_texture decoded;
+    b8 opened = false;
+    const char *failure_reason = 0;
+    if (!open_texture(texture_name, 0, &decoded, &opened, &failure_reason))
+    {
+        if (failure_reason)
+        {
+            MWARN_CH(LOG_CHANNEL_TEXTURE, "load_texture() failed to load texture '%s': %s", texture_name, failure_reason);
+        }
+        return false;
+    }
 
-    u8 *data = stbi_load(
-        full_file_path,
-        (i32 *)&temp_texture.width,
-        (i32 *)&temp_texture.height,
-        (i32 *)&temp_texture.channel_count,
-        required_channel_count);
+    upload_texture(texture_name, &decoded, t);
+    track_residency(t, &decoded);
+    free_decoded_texture(&decoded);
+    return true;
+}
 
-    temp_texture.channel_count = required_channel_count;
+// Decodes an image to 8 bit RGBA. Safe to call from any thread; doesn't log or touch the system state.
+b8 decode_texture(const void *file_data, u64 file_size, decoded_texture *out_decoded, const char **out_failure_reason)
+{
+    const i32 required_channel_count = 4;
+    // Set per thread, since decodes run on workers at the same time.
+    stbi_set_flip_vertically_on_load_thread(true);
 
-    if (data)
-    {
-        u32 current_generation = t->generation;
-        t->generation = INVALID_ID;
+    mzero_memory(out_decoded, sizeof(decoded_texture));
+    i32 width;
+    i32 height;
+    i32 channel_count;
+    u8 *data = stbi_load_from_memory((const stbi_uc *)file_data, (i32)file_size, &width, &height, &channel_count, required_channel_count);
 
-        u64 total_size = temp_texture.width * temp_texture.height * required_channel_count;
-        // Check for transparency
-        b32 has_transparency = false;
-        for (u64 i = 0; i < total_size; i += required_channel_count)
+    // The failure reason is per thread as well.
+    const char *failure_reason = stbi_failure_reason();
+    if (failure_reason)
+    {
+        *out_failure_reason = failure_reason;
+        // Clear the error so the next load doesn't fail.
+        stbi__err(0, 0);
+        if (data)
         {
-            u8 a = data[i + 3];
-            if (a < 255)
-            {
-                has_transparency = true;
-                break;
-            }
+            stbi_image_free(data);
         }
+        return false;
+    }
+    if (!data)
+    {
+        return false;
+    }
 
-        if (stbi_failure_reason())
-        {
-            MWARN("load_texture() failed to load file '%s': %s", full_file_path, stbi_failure_reason());
-            // Clear the error so the next load doesn't fail.
-            stbi__err(0, 0);
-            return false;
-        }
+    out_decoded->width = (u32)width;
+    out_decoded->height = (u32)height;
+    out_decoded->channel_count = required_channel_count;
+    out_decoded->format = TEXTURE_FORMAT_RGBA8;
+    out_decoded->mip_levels = 1;
+    out_decoded->full_width = (u32)width;
+    out_decoded->full_height = (u32)height;
+    out_decoded->pixels = data;
+
+    // Check for transparency
+    out_decoded->has_transparency = image_has_transparency_rgba8(data, (u64)width * height);
+    return true;
+}
 
-        // Take a copy of the name.
-        string_ncopy(temp_texture.name, texture_name, TEXTURE_NAME_MAX_LENGTH);
-        temp_texture.generation = INVALID_ID;
-        temp_texture.has_transparency = has_transparency;
+// Points a decoded texture at the levels of a cooked texture from base_level down.
+static void use_cooked_texture(const cooked_texture *cooked, u32 base_level, decoded_texture *out_decoded)
+{
+    u32 level = base_level < cooked->header->level_count ? base_level : cooked->header->level_count - 1;
+    out_decoded->width = cooked->header->width >> level ? cooked->header->width >> level : 1;
+    out_decoded->height = cooked->header->height >> level ? cooked->header->height >> level : 1;
+    out_decoded->channel_count = 4;
+    out_decoded->has_transparency = (cooked->header->flags & COOKED_TEXTURE_FLAG_TRANSPARENCY) != 0;
+    out_decoded->format = cooked->header->format;
+    out_decoded->mip_levels = cooked->header->level_count - level;
+    out_decoded->base_level = level;
+    out_decoded->full_width = cooked->header->width;
+    out_decoded->full_height = cooked->header->height;
+    out_decoded->pixels = cooked->levels[level];
+}
 
-        // Acquire internal texture resources and upload to GPU.
-        renderer_create_texture(data, &temp_texture);
+// Makes the names of cache entries being written unique, so writers can't collide.
+static matomic_i32 cache_write_count;
 
-        // Take a copy of the old texture.
-        texture old = *t;
+// FNV-1a, seeded so that entries written by an older cooked texture version miss.
+static u64 hash_cache_key(const void *data, u64 size)
+{
+    u64 hash = 14695981039346656037ULL ^ COOKED_TEXTURE_VERSION;
+    const u8 *bytes = data;
+    for (u64 i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
 
-        // Assign the temp texture to the pointer.
-        *t = temp_texture;
+// Maps a cache entry, if there is one for the same image file.
+static b8 open_cached_texture(const char *path, u64 file_hash, u32 base_level, decoded_texture *out_decoded)
+{
+    if (!filesystem_exists(path) || !filesystem_map(path, FILE_ACCESS_SEQUENTIAL, &out_decoded->cache_mapping))
+    {
+        return false;
+    }
 
-        // Destroy the old texture.
-        renderer_destroy_texture(&old);
+    const file_mapping *mapping = &out_decoded->cache_mapping;
+    cooked_texture cooked;
+    if (!cooked_texture_cache_entry_parse(mapping->data, mapping->size, file_hash, &cooked))
+    {
+        // From an older version of the image, or of the format. It is replaced once decoded.
+        filesystem_unmap(&out_decoded->cache_mapping);
+        return false;
+    }
+    use_cooked_texture(&cooked, base_level, out_decoded);
+    return true;
+}
 
-        if (current_generation == INVALID_ID)
+// Replaces decoded pixels with a cooked texture holding their full mip chain, written to the cache
+// at path along with the hash of the image file. Writing is best effort; the texture is used whether or
+// not the entry could be written. Returns false, leaving the decoded pixels as they are, if the image is
+// too large to cook.
+static b8 cache_texture(const char *path, u64 file_hash, u32 base_level, decoded_texture *decoded)
+{
+    u64 entry_size = 0;
+    u8 *data = cooked_texture_cache_entry_create(decoded->pixels, decoded->width, decoded->height, decoded->has_transparency, file_hash, &entry_size);
+    cooked_texture cooked;
+    if (!data || !cooked_texture_cache_entry_parse(data, entry_size, file_hash, &cooked))
+    {
+        if (data)
         {
-            t->generation = 0;
+            mfree(data, entry_size, MEMORY_TAG_TEXTURE);
         }
-        else
+        return false;
+    }
+
+    // Written beside the entry and moved over it once complete, so nothing can map a partly written
+    // entry, or have one truncated under its mapping.
+    char temp_path[VFS_MAX_PATH_LENGTH];
+    string_format(temp_path, "%s.%d.tmp", path, platform_atomic_add_i32(&cache_write_count, 1, MATOMIC_RELAXED));
+    file_handle file;
+    if (filesystem_open(temp_path, FILE_MODE_WRITE, true, &file))
+    {
+        u64 written = 0;
+        b8 complete = filesystem_write(&file, entry_size, data, &written) && written == entry_size;
+        filesystem_close(&file);
+        if (!complete || !filesystem_rename(temp_path, path))
         {
-            t->generation = current_generation + 1;
+            filesystem_delete(temp_path);
         }
+    }
+
+    free_decoded_texture(decoded);
+    use_cooked_texture(&cooked, base_level, decoded);
+    decoded->allocation = data;
+    decoded->allocation_size = entry_size;
+    return true;
+}
+
+// Decodes a texture's opened image file, or uses its cache entry, and closes the file. Returns the
+// levels from base_level down, the same as open_texture.
+static b8 open_texture_image(const char *texture_name, vfs_file *file, u32 base_level, decoded_texture *out_decoded, const char **out_failure_reason)
+{
+    mzero_memory(out_decoded, sizeof(decoded_texture));
+    // The texture's cache entry skips the decode, if it was made from the same image. Each texture has
+    // one entry, replaced when its image changes, so the cache never holds more than the textures do.
+    char cache_path[VFS_MAX_PATH_LENGTH];
+    u64 file_hash = 0;
+    const char *cache_directory = state_ptr ? state_ptr->config.cache_path : 0;
+    if (cache_directory)
+    {
+        file_hash = hash_cache_key(file->data, file->size);
+        string_format(cache_path, "%s/%016llx.mtex", cache_directory, (unsigned long long)hash_cache_key(texture_name, string_length(texture_name)));
+        if (open_cached_texture(cache_path, file_hash, base_level, out_decoded))
+        {
+            vfs_close(file);
+            return true;
+        }
+    }
+
+    b8 result = decode_texture(file->data, file->size, out_decoded, out_failure_reason);
+    vfs_close(file);
+    if (!result)
+    {
+        return false;
+    }
 
-        // Clean up data.
-        stbi_image_free(data);
+    if (cache_directory && cache_texture(cache_path, file_hash, base_level, out_decoded))
+    {
         return true;
     }
-    else
+
+    // Filter down to the base level. Each level is filtered from the one above, the same as a cooked
+    // chain, so the result matches what would have been sampled from the full texture.
+    u32 level_count = texture_mip_count(out_decoded->width, out_decoded->height);
+    u32 level = base_level < level_count ? base_level : level_count - 1;
+    for (u32 i = 0; i < level; ++i)
+    {
+        u32 width = out_decoded->width > 1 ? out_decoded->width / 2 : 1;
+        u32 height = out_decoded->height > 1 ? out_decoded->height / 2 : 1;
+        u64 size = (u64)width * height * 4;
+        u8 *pixels = mallocate(size, MEMORY_TAG_TEXTURE);
+        image_downsample_rgba8(out_decoded->pixels, out_decoded->width, out_decoded->height, pixels);
+        free_decoded_texture(out_decoded);
+        out_decoded->pixels = pixels;
+        out_decoded->allocation = pixels;
+        out_decoded->allocation_size = size;
+        out_decoded->width = width;
+        out_decoded->height = height;
+    }
+    out_decoded->base_level = level;
+    return true;
+}
+
+// Opens a texture's cooked file if there is one, otherwise decodes its image. Only the levels from
+// base_level down are returned, clamped to the smallest level. Like decode_texture, safe to call from any
+// thread. out_opened is set if a file was found.
+
+b8 open_texture(const char *texture_name, u32 base_level, decoded_texture *out_decoded, b8 *out_opened, const char **out_failure_reason)
+{
+    mzero_memory(out_decoded, sizeof(decoded_texture));
+    char file_name[512];
+    string_format(file_name, "textures/%s.%s", texture_name, "mtex");
+    if (vfs_exists(file_name) && vfs_open(file_name, FILE_ACCESS_SEQUENTIAL, &out_decoded->cooked_file))
     {
-        if (stbi_failure_reason())
+        *out_opened = true;
+        // Cooked textures are already in the format the GPU wants, so are uploaded straight out of the file.
+        cooked_texture cooked;
+        if (cooked_texture_parse(out_decoded->cooked_file.data, out_decoded->cooked_file.size, &cooked))
         {
-            MWARN("load_texture() failed to load file '%s': %s", full_file_path, stbi_failure_reason());
-            // Clear the error so the next load doesn't fail.
-            stbi__err(0, 0);
+            use_cooked_texture(&cooked, base_level, out_decoded);
+            return true;
         }
+
+        // Fall back to the image; only reported if that fails too.
+        vfs_close(&out_decoded->cooked_file);
+        *out_failure_reason = "corrupt or outdated cooked texture";
+    }
+
+    // Decode straight out of the archive or a mapping of the file, rather than reading it into a copy first.
+    texture_file_name(texture_name, file_name);
+    vfs_file file;
+    if (!vfs_open(file_name, FILE_ACCESS_SEQUENTIAL, &file))
+    {
+        return false;
+    }
+    *out_opened = true;
+    return open_texture_image(texture_name, &file, base_level, out_decoded, out_failure_reason);
+}
+
+// Frees what open_texture or decode_texture returned.
+void free_decoded_texture(decoded_texture *decoded)
+{
+    if (decoded->cooked_file.source != VFS_SOURCE_NONE)
+    {
+        vfs_close(&decoded->cooked_file);
+    }
+    else if (decoded->cache_mapping.data)
+    {
+        filesystem_unmap(&decoded->cache_mapping);
+    }
+    else if (decoded->allocation)
+    {
+        mfree(decoded->allocation, decoded->allocation_size, MEMORY_TAG_TEXTURE);
+    }
+    else
+    {
+        stbi_image_free((void *)decoded->pixels);
+    }
+    decoded->pixels = 0;
+    decoded->allocation = 0;
+    decoded->allocation_size = 0;
+}
+
+// Fills out a texture for decoded pixels, ready to be created by the renderer.
+void prepare_upload(const char *texture_name, const decoded_texture *decoded, texture *out_texture)
+{
+    mzero_memory(out_texture, sizeof(texture));
+    string_ncopy(out_texture->name, texture_name, TEXTURE_NAME_MAX_LENGTH);
+    out_texture->width = decoded->width;
+    out_texture->height = decoded->height;
+    out_texture->channel_count = decoded->channel_count;
+    out_texture->generation = INVALID_ID;
+    out_texture->has_transparency = decoded->has_transparency;
+    out_texture->format = decoded->format;
+    out_texture->mip_levels = decoded->mip_levels;
+}
+
+// Swaps a texture the renderer has created, or one packed into the atlas, into t in place, bumping
+// its generation so anything holding t picks up the change.
+void swap_in_texture(texture *t, const texture *uploaded)
+{
+    u32 current_generation = t->generation;
+
+    // Take a copy of the old texture.
+    texture old = *t;
+
+    // Assign the new texture to the pointer, keeping the id so a reload is a drop-in replacement.
+    *t = *uploaded;
+    t->id = old.id;
+
+    // Destroy the old texture. A placeholder has nothing to destroy.
+    if (old.atlas)
+    {
+        texture_atlas_free(&state_ptr->atlas, &state_ptr->atlas_regions[old.id]);
+    }
+    else if (old.internal_data)
+    {
+        renderer_destroy_texture(&old);
+    }
+
+    if (current_generation == INVALID_ID)
+    {
+        t->generation = 0;
+    }
+    else
+    {
+        t->generation = current_generation + 1;
+    }
+}
+
+// Creates the GPU texture for decoded pixels and swaps it into t. Main thread only. The pixels are
+// not freed.
+void upload_texture(const char *texture_name, decoded_texture *decoded, texture *t)
+{
+    if (pack_into_atlas(texture_name, decoded, t))
+    {
+        return;
+    }
+
+    // Use a temporary texture to load into.
+    texture temp_texture;
+    prepare_upload(texture_name, decoded, &temp_texture);
+
+    // Acquire internal texture resources and upload to GPU.
+    renderer_create_texture(decoded->pixels, &temp_texture);
+
+    swap_in_texture(t, &temp_texture);
+}
+
+// Starts tracking the residency of a texture which has just been loaded, from scratch.
+void track_residency(const texture *t, const decoded_texture *decoded)
+{
+    if (t->id >= state_ptr->config.max_texture_count)
+    {
+        return;
+    }
+    // Textures in the atlas are small, and always at full resolution.
+    if (t->atlas)
+    {
+        mzero_memory(&state_ptr->residency[t->id], sizeof(texture_residency));
+        return;
+    }
+    // The renderer may have generated levels beyond those decoded, so count from what it created.
+    texture_residency_track(&state_ptr->residency[t->id], t->format, decoded->full_width, decoded->full_height,
+                            decoded->base_level + t->mip_levels, decoded->base_level, state_ptr->frame);
+}
+
+// Packs decoded pixels into the atlas and swaps them into t, if they are small enough and there is
+// room. Main thread only.
+b8 pack_into_atlas(const char *texture_name, const decoded_texture *decoded, texture *t)
+{
+    if (!state_ptr->atlas_pixels || t->id >= state_ptr->config.max_texture_count)
+    {
+        return false;
+    }
+
+    // Only full resolution RGBA8 images small enough to leave room for others are packed.
+    u32 largest_size = state_ptr->config.atlas_size / 4;
+    if (decoded->format != TEXTURE_FORMAT_RGBA8 || decoded->base_level != 0 || decoded->width > largest_size || decoded->height > largest_size)
+    {
         return false;
     }
+
+    texture_atlas_region region;
+    if (!texture_atlas_allocate(&state_ptr->atlas, decoded->width, decoded->height, &region))
+    {
+        MTRACE_CH(LOG_CHANNEL_TEXTURE, "No room in the texture atlas for '%s'; it gets a texture of its own.", texture_name);
+        return false;
+    }
+
+    u64 layer_size = (u64)state_ptr->config.atlas_size * state_ptr->config.atlas_size * 4;
+    texture_atlas_write(&state_ptr->atlas, &region, decoded->pixels, state_ptr->atlas_pixels + layer_size * region.layer);
+    if (state_ptr->atlas_dirty_count < TEXTURE_ATLAS_MAX_DIRTY_REGIONS)
+    {
+        state_ptr->atlas_dirty_regions[state_ptr->atlas_dirty_count++] = texture_atlas_padded_region(&region);
+    }
+    else
+    {
+        state_ptr->atlas_all_dirty = true;
+    }
+
+    texture packed;
+    prepare_upload(texture_name, decoded, &packed);
+    packed.mip_levels = 1;
+    packed.atlas = &state_ptr->atlas_texture;
+    packed.atlas_layer = region.layer;
+    packed.atlas_uv_transform = texture_atlas_uv_transform(&state_ptr->atlas, &region);
+
+    // Any old region is freed by the swap, so the new one is recorded after.
+    swap_in_texture(t, &packed);
+    state_ptr->atlas_regions[t->id] = region;
+    return true;
 }
 
 void destroy_texture(texture *t)
 {
-    // Clean up backend resources.
-    renderer_destroy_texture(t);
+    // Clean up backend resources. A texture in the atlas just gives back its room.
+    if (t->atlas)
+    {
+        texture_atlas_free(&state_ptr->atlas, &state_ptr->atlas_regions[t->id]);
+    }
+    else
+    {
+        renderer_destroy_texture(t);
+    }
 
     mzero_memory(t->name, sizeof(char) * TEXTURE_NAME_MAX_LENGTH);
     mzero_memory(t, sizeof(texture));
@@ -5,14 +5,87 @@
 typedef struct texture_system_config
 {
     u32 max_texture_count;
+    // GPU memory, in bytes, for textures to fit in by streaming mip levels in and out. 0 disables
+    // streaming, keeping every texture at full resolution.
+    u64 streaming_budget;
+    // Directory to cache decoded images in, with their mip chains, so they don't have to be decoded
+    // again on the next run. Each texture has one entry, used while the image file hashes the same and
+    // replaced when it changes. 0 disables the cache.
+    const char *cache_path;
+    // The width and height of the atlas small textures are packed into, and how many layers it has.
+    // Textures up to a quarter of atlas_size across share it rather than getting textures of their
+    // own. 0 layers disables the atlas.
+    u32 atlas_size;
+    u32 atlas_layer_count;
 } texture_system_config;
 
 #define DEFAULT_TEXTURE_NAME "default"
 
-b8 texture_system_initialise(u64 *memory_requirement, void *state, texture_system_config config);
-void texture_system_shutdown(void *state);
+MAPI b8 texture_system_initialise(u64 *memory_requirement, void *state, texture_system_config config);
+MAPI void texture_system_shutdown(void *state);
 
-texture *texture_system_acquire(const char *name, b8 auto_release);
-void texture_system_release(const char *name);
+MAPI texture *texture_system_acquire(const char *name, b8 auto_release);
 
-texture *texture_system_get_default_texture();
\ No newline at end of file
+/**
+ * @brief Acquires a texture without waiting for it to load, so it never stalls the frame. A texture which
+ * is not loaded yet is returned straight away with an invalid generation, and is drawn as the default
+ * texture. It is decoded on a job worker, then uploaded and swapped in place on the main thread with its
+ * generation bumped. If it fails to load it stays as the default texture.
+ * 
+ * @param name The name of the texture.
+ * @param auto_release Whether to unload the texture once its reference count reaches zero. Only applies
+ * the first time the texture is acquired.
+ * @return The texture, which may still be loading.
+ */
+texture *texture_system_acquire_async(const char *name, b8 auto_release);
+
+/**
+ * @brief Acquires many textures at once, i.e. for a level load. Repeated names share a texture. The
+ * textures which are not loaded yet are decoded in parallel on job workers, then uploaded together
+ * in one submission. Blocks until they are all loaded.
+ * 
+ * @param names An array of texture names.
+ * @param count The number of names.
+ * @param auto_release Whether to unload textures once their reference count reaches zero. Only applies
+ * to textures acquired for the first time.
+ * @param out_textures An array of count pointers to hold the textures, in the same order as names.
+ * Entries are 0 for textures which could not be loaded.
+ * @return True if every texture was acquired; otherwise false.
+ */
+b8 texture_system_acquire_batch(const char **names, u32 count, b8 auto_release, texture **out_textures);
+MAPI void texture_system_release(const char *name);
+
+/**
+ * @brief Switches between taking slots for new textures from the free list, and scanning every slot
+ * for an unused one, for benchmarks. Only change this while the system isn't initialised. Disabled
+ * by default.
+ */
+MAPI void texture_system_set_slot_scan_enabled(b8 enabled);
+
+/**
+ * @brief Reports that a texture was drawn this frame, for streaming. Called by the renderer for each
+ * texture it draws.
+ * 
+ * @param t A pointer to the texture.
+ * @param screen_size How many pixels across the texture covers on screen, at its largest.
+ */
+void texture_system_report_usage(texture *t, f32 screen_size);
+
+/**
+ * @brief Uploads the atlas if textures have been packed into it, then streams mip levels of textures in
+ * and out, based on the usage reported last frame and the streaming budget. Levels are loaded in the
+ * background like asynchronous acquires, and swapped in when ready. Call once per frame, before rendering.
+ */
+void texture_system_update();
+
+texture *texture_system_get_default_texture();
+
+/**
+ * @brief Reloads a texture from its loose file, i.e. after it has been edited. The file is read and
+ * decoded in the background; once it is ready the texture is replaced in place and its generation bumped, so anything
+ * holding a pointer to it picks up the change. Does nothing if the texture is not loaded. Always
+ * reloads the image, not a cooked texture, so the edit shows up without recooking.
+ * 
+ * @param name The name of the texture.
+ */
+void texture_system_reload(const char *name);
\ No newline at end of file
@@ -13,6 +13,8 @@ b8 create_game(game *out_game)
     out_game->app_config.start_width = 1280;
     out_game->app_config.start_height = 720; 
     out_game->app_config.name = "Matcha Engine Testbed";
+    out_game->app_config.target_frame_rate = 60;
+    out_game->app_config.update_rate = 60;
     out_game->initialise = game_initialise;
     out_game->update = game_update;
     out_game->render = game_render;
@@ -47,18 +47,35 @@ void camera_yaw(game_state *state, f32 amount)
     state->camera_view_dirty = true;
 }
 
-b8 game_initialise(game *game_inst)
+void camera_reset(game_state *state)
 {
-    MDEBUG("game_initialise() called!");
-    
-    game_state *state = ((game_state *)game_inst->state);
-    
     state->camera_position = (vec3){0, 0, 30.0f};
     state->camera_euler = vec3_zero();
+    state->previous_camera_position = state->camera_position;
+    state->previous_camera_euler = state->camera_euler;
     
     state->view = mat4_translation(state->camera_position);
     state->view = mat4_inverse(state->view);
     state->camera_view_dirty = true;
+}
+
+b8 game_initialise(game *game_inst)
+{
+    MDEBUG("game_initialise() called!");
+    
+    game_state *state = ((game_state *)game_inst->state);
+    camera_reset(state);
+    
+    input_action_bind_key(GAME_ACTION_YAW_LEFT, KEY_LEFT);
+    input_action_bind_key(GAME_ACTION_YAW_RIGHT, KEY_RIGHT);
+    input_action_bind_key(GAME_ACTION_PITCH_UP, KEY_UP);
+    input_action_bind_key(GAME_ACTION_PITCH_DOWN, KEY_DOWN);
+    input_action_bind_key(GAME_ACTION_MOVE_FORWARD, KEY_W);
+    input_action_bind_key(GAME_ACTION_MOVE_BACKWARD, KEY_S);
+    input_action_bind_key(GAME_ACTION_MOVE_LEFT, KEY_A);
+    input_action_bind_key(GAME_ACTION_MOVE_RIGHT, KEY_D);
+    input_action_bind_key(GAME_ACTION_MOVE_UP, KEY_SPACE);
+    input_action_bind_key(GAME_ACTION_MOVE_DOWN, KEY_X);
     
     return true;
 }
@@ -66,17 +83,19 @@ b8 game_initialise(game *game_inst)
 b8 game_update(game *game_inst, f32 delta_time)
 {
     game_state *state = (game_state *)game_inst->state;
+    state->previous_camera_position = state->camera_position;
+    state->previous_camera_euler = state->camera_euler;
     
     static u64 alloc_count = 0;
     u64 prev_alloc_count = alloc_count;
     alloc_count = get_memory_alloc_count();
-    if (input_is_key_up('M') && input_was_key_down('M'))
+    if (input_is_key_released('M'))
     {
         MDEBUG("Allocations: %llu (%llu this frame)", alloc_count, alloc_count - prev_alloc_count);
     }
     
     // TODO(satvik): temp
-    if (input_is_key_up('T') && input_was_key_down('T'))
+    if (input_is_key_released('T'))
     {
         MDEBUG("Swapping textures!");
         event_context context = {};
@@ -84,52 +103,77 @@ b8 game_update(game *game_inst, f32 delta_time)
     }
     // TODO(satvik): end temp
     
+    // Input recording for benchmarking. Both start from the same camera pose so that replays follow
+    // the recorded camera path exactly.
+    if (!input_is_replaying())
+    {
+        if (input_is_key_released(KEY_F5))
+        {
+            if (input_is_recording())
+            {
+                input_recording_stop();
+            }
+            else
+            {
+                camera_reset(state);
+                input_recording_start("input.mrec", 1.0 / 60.0);
+            }
+        }
+        else if (input_is_key_released(KEY_F6) && !input_is_recording())
+        {
+            camera_reset(state);
+            input_replay_start("input.mrec");
+        }
+    }
+    
     // HACK: temp code to move camera around.
-    if (input_is_key_down(KEY_LEFT))
+    u64 actions = input_get_actions_down();
+    
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_YAW_LEFT))
         camera_yaw(state, 2.0f * delta_time);
     
-    if (input_is_key_down(KEY_RIGHT))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_YAW_RIGHT))
         camera_yaw(state, -2.0f * delta_time);
     
-    if (input_is_key_down(KEY_UP))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_PITCH_UP))
         camera_pitch(state, 2.0f * delta_time);
     
-    if (input_is_key_down(KEY_DOWN))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_PITCH_DOWN))
         camera_pitch(state, -2.0f * delta_time);
     
     f32 temp_move_speed = 20.0f;
     vec3 velocity = vec3_zero();
     
-    if (input_is_key_down('W'))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_MOVE_FORWARD))
     {
         vec3 forward = mat4_forward(state->view);
         velocity = vec3_add(velocity, forward);
     }
     
-    if (input_is_key_down('S'))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_MOVE_BACKWARD))
     {
         vec3 backward = mat4_backward(state->view);
         velocity = vec3_add(velocity, backward);
     }
     
-    if (input_is_key_down('A'))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_MOVE_LEFT))
     {
         vec3 left = mat4_left(state->view);
         velocity = vec3_add(velocity, left);
     }
     
-    if (input_is_key_down('D'))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_MOVE_RIGHT))
     {
         vec3 right = mat4_right(state->view);
         velocity = vec3_add(velocity, right);
     }
     
-    if (input_is_key_down(KEY_SPACE))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_MOVE_UP))
     {
         velocity.y += 1.0f;
     }
     
-    if (input_is_key_down('X'))
+    if (INPUT_ACTION_SET(actions, GAME_ACTION_MOVE_DOWN))
     {
         velocity.y -= 1.0f;
     }
@@ -147,14 +191,21 @@ b8 game_update(game *game_inst, f32 delta_time)
     
     recalculate_view_matrix(state);
     
-    // HACK: This should not be available outside of the engine.
-    renderer_set_view(state->view);
-    
     return true;
 }
 
-b8 game_render(game *game_inst, f32 delta_time)
+b8 game_render(game *game_inst, f32 delta_time, f32 alpha)
 {
+    game_state *state = (game_state *)game_inst->state;
+    
+    // Draw the camera part way between the last two updates, so motion is smooth whatever the update rate.
+    vec3 position = vec3_lerp(state->previous_camera_position, state->camera_position, alpha);
+    vec3 euler = vec3_lerp(state->previous_camera_euler, state->camera_euler, alpha);
+    mat4 view = mat4_mul(mat4_euler_xyz(euler.x, euler.y, euler.z), mat4_translation(position));
+    
+    // HACK: This should not be available outside of the engine.
+    renderer_set_view(mat4_inverse(view));
+    
     return true;
 }
 
@@ -5,12 +5,29 @@
 
 #include <math/mmath.h>
 
+typedef enum game_action
+{
+    GAME_ACTION_YAW_LEFT,
+    GAME_ACTION_YAW_RIGHT,
+    GAME_ACTION_PITCH_UP,
+    GAME_ACTION_PITCH_DOWN,
+    GAME_ACTION_MOVE_FORWARD,
+    GAME_ACTION_MOVE_BACKWARD,
+    GAME_ACTION_MOVE_LEFT,
+    GAME_ACTION_MOVE_RIGHT,
+    GAME_ACTION_MOVE_UP,
+    GAME_ACTION_MOVE_DOWN,
+} game_action;
+
 typedef struct game_state
 {
     f32 delta_time;
     mat4 view;
     vec3 camera_position;
     vec3 camera_euler;
+    // The camera as of the previous update, which rendering blends from.
+    vec3 previous_camera_position;
+    vec3 previous_camera_euler;
     b8 camera_view_dirty;
 } game_state;
 
@@ -18,6 +35,6 @@ b8 game_initialise(game *game_inst);
 
 b8 game_update(game *game_inst, f32 delta_time);
 
-b8 game_render(game *game_inst, f32 delta_time);
+b8 game_render(game *game_inst, f32 delta_time, f32 alpha);
 
 void game_on_resize(game *game_inst, u32 width, u32 height);
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "id_pool_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <containers/id_pool.h>
+
+u8 id_pool_should_acquire_in_order()
+{
+    id_pool pool;
+    u32 memory[4];
+    id_pool_create(4, memory, &pool);
+    
+    for (u32 i = 0; i < 4; ++i)
+    {
+        u32 id = INVALID_ID;
+        expect_to_be_true(id_pool_acquire(&pool, &id));
+        expect_should_be(i, id);
+    }
+    
+    // Full.
+    u32 id = INVALID_ID;
+    expect_to_be_false(id_pool_acquire(&pool, &id));
+    expect_should_be(INVALID_ID, id);
+    
+    id_pool_destroy(&pool);
+    expect_should_be(0, pool.free_ids);
+    return true;
+}
+
+u8 id_pool_should_reuse_released_ids()
+{
+    id_pool pool;
+    u32 memory[4];
+    id_pool_create(4, memory, &pool);
+    
+    u32 ids[4];
+    for (u32 i = 0; i < 4; ++i)
+    {
+        id_pool_acquire(&pool, &ids[i]);
+    }
+    
+    id_pool_release(&pool, ids[2]);
+    id_pool_release(&pool, ids[0]);
+    expect_should_be(2, pool.free_count);
+    
+    // Most recently released first.
+    u32 id = INVALID_ID;
+    expect_to_be_true(id_pool_acquire(&pool, &id));
+    expect_should_be(0, id);
+    expect_to_be_true(id_pool_acquire(&pool, &id));
+    expect_should_be(2, id);
+    expect_to_be_false(id_pool_acquire(&pool, &id));
+    
+    // Out of range ids are ignored.
+    id_pool_release(&pool, 4);
+    expect_should_be(0, pool.free_count);
+    return true;
+}
+
+void id_pool_register_tests()
+{
+    test_manager_register_test(id_pool_should_acquire_in_order, "Id pool should acquire in order");
+    test_manager_register_test(id_pool_should_reuse_released_ids, "Id pool should reuse released ids");
+}
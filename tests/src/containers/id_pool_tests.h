@@ -0,0 +1,3 @@
+#pragma once
+
+void id_pool_register_tests();
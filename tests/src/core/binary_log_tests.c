@@ -0,0 +1,196 @@
+#include "binary_log_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/binary_log.h>
+#include <core/mmemory.h>
+#include <core/mstring.h>
+
+typedef struct decoded_entries
+{
+    u32 count;
+    log_channel channels[4];
+    log_level levels[4];
+    char messages[4][256];
+} decoded_entries;
+
+static void write_entry(binary_log_state *state, log_channel channel, log_level level, const char *format, ...)
+{
+    __builtin_va_list args;
+    va_start(args, format);
+    binary_log_write(state, channel, level, format, args);
+    va_end(args);
+}
+
+static void on_entry(log_channel channel, log_level level, f64 timestamp, const char *message, void *user_data)
+{
+    decoded_entries *entries = user_data;
+    if (entries->count < 4)
+    {
+        entries->channels[entries->count] = channel;
+        entries->levels[entries->count] = level;
+        string_ncopy(entries->messages[entries->count], message, 255);
+        entries->messages[entries->count][255] = 0;
+    }
+    entries->count++;
+}
+
+u8 binary_log_should_parse_specs()
+{
+    binary_log_spec spec;
+    const char *format = "a %-8.3f b %lld %*.*s %%";
+    
+    expect_to_be_true(binary_log_next_spec(format, 0, &spec));
+    expect_should_be(2, spec.start);
+    expect_should_be(6, spec.length);
+    expect_should_be(3, spec.precision);
+    expect_should_be(BINARY_LOG_ARG_F64, spec.type);
+    
+    expect_to_be_true(binary_log_next_spec(format, spec.start + spec.length, &spec));
+    expect_should_be(BINARY_LOG_ARG_I64, spec.type);
+    
+    expect_to_be_true(binary_log_next_spec(format, spec.start + spec.length, &spec));
+    expect_to_be_true(spec.width_is_arg);
+    expect_to_be_true(spec.precision_is_arg);
+    expect_should_be(BINARY_LOG_ARG_STRING, spec.type);
+    
+    expect_to_be_true(binary_log_next_spec(format, spec.start + spec.length, &spec));
+    expect_should_be(BINARY_LOG_ARG_NONE, spec.type);
+    
+    expect_to_be_false(binary_log_next_spec(format, spec.start + spec.length, &spec));
+    
+    return true;
+}
+
+u8 binary_log_should_round_trip_entries()
+{
+    binary_log_state *state = mallocate(sizeof(binary_log_state), MEMORY_TAG_APPLICATION);
+    binary_log_begin(state, 0);
+    
+    const char *format = "value %d, %.2f, '%s', %llu%%";
+    u64 used_before = state->buffer_used;
+    write_entry(state, LOG_CHANNEL_GENERAL, LOG_LEVEL_INFO, format, -12, 3.14159, "hello", 42ULL);
+    u64 first_size = state->buffer_used - used_before;
+    // Second use of the same format should reuse its definition.
+    used_before = state->buffer_used;
+    write_entry(state, LOG_CHANNEL_RENDERER, LOG_LEVEL_WARN, format, 7, 0.5, "world", 1ULL);
+    expect_should_be(1, state->next_format_id);
+    expect_should_be(first_size - (sizeof(u8) + sizeof(u32) + sizeof(u16) + string_length(format)), state->buffer_used - used_before);
+    // Star precision bounds how much of the string is stored.
+    write_entry(state, LOG_CHANNEL_TEXTURE, LOG_LEVEL_ERROR, "precision %.*s", 3, "abcdef");
+    
+    decoded_entries entries = {0};
+    expect_to_be_true(binary_log_decode(state->buffer, state->buffer_used, on_entry, &entries));
+    expect_should_be(3, entries.count);
+    expect_should_be(LOG_LEVEL_INFO, entries.levels[0]);
+    expect_to_be_true(strings_equal("value -12, 3.14, 'hello', 42%", entries.messages[0]));
+    expect_should_be(LOG_CHANNEL_RENDERER, entries.channels[1]);
+    expect_should_be(LOG_LEVEL_WARN, entries.levels[1]);
+    expect_to_be_true(strings_equal("value 7, 0.50, 'world', 1%", entries.messages[1]));
+    expect_should_be(LOG_CHANNEL_TEXTURE, entries.channels[2]);
+    expect_to_be_true(strings_equal("precision abc", entries.messages[2]));
+    
+    // A truncated log should be rejected.
+    entries.count = 0;
+    expect_to_be_false(binary_log_decode(state->buffer, state->buffer_used - 1, on_entry, &entries));
+    
+    mfree(state, sizeof(binary_log_state), MEMORY_TAG_APPLICATION);
+    return true;
+}
+
+u8 binary_log_should_apply_star_precision_to_one_argument()
+{
+    binary_log_state *state = mallocate(sizeof(binary_log_state), MEMORY_TAG_APPLICATION);
+    binary_log_begin(state, 0);
+    
+    // A precision given as an argument bounds only the argument after it, not later strings.
+    write_entry(state, LOG_CHANNEL_GENERAL, LOG_LEVEL_INFO, "%.*f %s %.*s %s", 1, 3.14159, "hello", 2, "world", "again");
+    write_entry(state, LOG_CHANNEL_GENERAL, LOG_LEVEL_INFO, "%*d '%s'", 4, 7, "padded");
+    
+    decoded_entries entries = {0};
+    expect_to_be_true(binary_log_decode(state->buffer, state->buffer_used, on_entry, &entries));
+    expect_should_be(2, entries.count);
+    expect_to_be_true(strings_equal("3.1 hello wo again", entries.messages[0]));
+    expect_to_be_true(strings_equal("   7 'padded'", entries.messages[1]));
+    
+    mfree(state, sizeof(binary_log_state), MEMORY_TAG_APPLICATION);
+    return true;
+}
+
+// Appends a value to a hand built log.
+#define APPEND_VALUE(buffer, size, value)                     \
+{                                                             \
+mcopy_memory((buffer) + (size), &(value), sizeof(value));     \
+(size) += sizeof(value);                                      \
+}
+
+// Starts a hand built log with its header and one record of the given type.
+static u64 begin_malformed_log(u8 *buffer, u8 record_type)
+{
+    u64 size = 0;
+    u32 magic = BINARY_LOG_MAGIC;
+    u32 version = BINARY_LOG_VERSION;
+    APPEND_VALUE(buffer, size, magic);
+    APPEND_VALUE(buffer, size, version);
+    APPEND_VALUE(buffer, size, record_type);
+    return size;
+}
+
+u8 binary_log_should_reject_oversized_strings()
+{
+    // Big enough to hold any u16 length, so only the length check can reject them.
+    u64 buffer_size = 70000;
+    u8 *buffer = mallocate(buffer_size, MEMORY_TAG_APPLICATION);
+    u8 channel = LOG_CHANNEL_GENERAL;
+    u8 level = LOG_LEVEL_INFO;
+    f64 timestamp = 0.0;
+    decoded_entries entries = {0};
+    
+    // A text record longer than any message.
+    u64 size = begin_malformed_log(buffer, BINARY_LOG_RECORD_TEXT);
+    u16 length = 65535;
+    APPEND_VALUE(buffer, size, channel);
+    APPEND_VALUE(buffer, size, level);
+    APPEND_VALUE(buffer, size, timestamp);
+    APPEND_VALUE(buffer, size, length);
+    mset_memory(buffer + size, 'a', length);
+    size += length;
+    expect_to_be_false(binary_log_decode(buffer, size, on_entry, &entries));
+    expect_should_be(0, entries.count);
+    
+    // A string argument longer than the writer ever stores.
+    size = begin_malformed_log(buffer, BINARY_LOG_RECORD_FORMAT);
+    u32 id = 0;
+    const char *format = "%s";
+    u16 format_length = 2;
+    APPEND_VALUE(buffer, size, id);
+    APPEND_VALUE(buffer, size, format_length);
+    mcopy_memory(buffer + size, format, format_length);
+    size += format_length;
+    u8 record_type = BINARY_LOG_RECORD_ENTRY;
+    u16 string_length = BINARY_LOG_MAX_STRING_LENGTH + 100;
+    u16 payload_size = sizeof(u16) + string_length;
+    APPEND_VALUE(buffer, size, record_type);
+    APPEND_VALUE(buffer, size, channel);
+    APPEND_VALUE(buffer, size, level);
+    APPEND_VALUE(buffer, size, id);
+    APPEND_VALUE(buffer, size, timestamp);
+    APPEND_VALUE(buffer, size, payload_size);
+    APPEND_VALUE(buffer, size, string_length);
+    mset_memory(buffer + size, 'b', string_length);
+    size += string_length;
+    expect_to_be_false(binary_log_decode(buffer, size, on_entry, &entries));
+    expect_should_be(0, entries.count);
+    
+    mfree(buffer, buffer_size, MEMORY_TAG_APPLICATION);
+    return true;
+}
+
+void binary_log_register_tests()
+{
+    test_manager_register_test(binary_log_should_parse_specs, "Binary log should parse format specifications");
+    test_manager_register_test(binary_log_should_round_trip_entries, "Binary log should round trip entries");
+    test_manager_register_test(binary_log_should_apply_star_precision_to_one_argument, "Binary log should apply star precision to one argument");
+    test_manager_register_test(binary_log_should_reject_oversized_strings, "Binary log should reject oversized strings");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void binary_log_register_tests();
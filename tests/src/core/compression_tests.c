@@ -0,0 +1,65 @@
+#include "compression_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/compression.h>
+#include <core/mmemory.h>
+
+u8 compression_should_round_trip()
+{
+    const u64 size = 4096;
+    u8 *source = mallocate(size, MEMORY_TAG_APPLICATION);
+    // Repeating runs with some noise, so both literals and (overlapping) matches are produced.
+    u32 seed = 12345;
+    for (u64 i = 0; i < size; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        source[i] = (i % 512) < 400 ? (u8)(i % 3) : (u8)(seed >> 16);
+    }
+    
+    u64 bound = compression_bound(size);
+    u8 *compressed = mallocate(bound, MEMORY_TAG_APPLICATION);
+    u64 compressed_size = compression_compress(source, size, compressed, bound);
+    expect_should_not_be(0, compressed_size);
+    expect_to_be_true(compressed_size < size / 2);
+    
+    u8 *decompressed = mallocate(size, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(compression_decompress(compressed, compressed_size, decompressed, size));
+    for (u64 i = 0; i < size; ++i)
+    {
+        expect_should_be(source[i], decompressed[i]);
+    }
+    
+    // The wrong size, or truncated input, should be rejected.
+    expect_to_be_false(compression_decompress(compressed, compressed_size, decompressed, size - 1));
+    expect_to_be_false(compression_decompress(compressed, compressed_size - 1, decompressed, size));
+    
+    mfree(decompressed, size, MEMORY_TAG_APPLICATION);
+    mfree(compressed, bound, MEMORY_TAG_APPLICATION);
+    mfree(source, size, MEMORY_TAG_APPLICATION);
+    return true;
+}
+
+u8 compression_should_store_tiny_input()
+{
+    const char source[] = "abc";
+    u8 compressed[32];
+    u64 compressed_size = compression_compress(source, 3, compressed, sizeof(compressed));
+    // A token followed by the literals.
+    expect_should_be(4, compressed_size);
+    
+    char decompressed[3];
+    expect_to_be_true(compression_decompress(compressed, compressed_size, decompressed, 3));
+    expect_should_be('c', decompressed[2]);
+    
+    // Too small a destination is refused rather than overrun.
+    expect_should_be(0, compression_compress(source, 3, compressed, 4));
+    return true;
+}
+
+void compression_register_tests()
+{
+    test_manager_register_test(compression_should_round_trip, "Compression should round trip data");
+    test_manager_register_test(compression_should_store_tiny_input, "Compression should store tiny input");
+}
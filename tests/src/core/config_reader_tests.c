@@ -0,0 +1,82 @@
+#include "config_reader_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/config_reader.h>
+#include <core/mstring.h>
+
+u8 config_reader_should_read_entries()
+{
+    // Not null-terminated at the end, with mixed line endings, comments and padding.
+    const char text[] = "# A comment\r\n\nversion=1\r\n  name =  test material \n\t\ndiffuse_colour = 1.0 0.5 0.25 1.0\nbroken line\ndiffuse_map_name=  cobblestone";
+    config_reader reader;
+    config_reader_create(text, sizeof(text) - 1, &reader);
+    
+    config_entry entry;
+    expect_to_be_true(config_reader_next(&reader, &entry));
+    expect_to_be_true(string_view_equali(entry.key, "VERSION"));
+    expect_to_be_true(string_view_equali(entry.value, "1"));
+    expect_should_be(3, entry.line_number);
+    
+    expect_to_be_true(config_reader_next(&reader, &entry));
+    expect_to_be_true(string_view_equali(entry.key, "name"));
+    expect_to_be_true(string_view_equali(entry.value, "test material"));
+    expect_to_be_false(string_view_equali(entry.value, "test"));
+    expect_to_be_false(string_view_equali(entry.value, "test material 2"));
+    
+    expect_to_be_true(config_reader_next(&reader, &entry));
+    expect_to_be_true(string_view_equali(entry.key, "diffuse_colour"));
+    char colour[64];
+    string_view_copy(colour, entry.value, sizeof(colour));
+    vec4 parsed;
+    expect_to_be_true(string_to_vec4(colour, &parsed));
+    expect_float_to_be(0.25f, parsed.z);
+    
+    // A line without '=' comes back whole, without a value.
+    expect_to_be_true(config_reader_next(&reader, &entry));
+    expect_to_be_true(entry.value.str == 0);
+    expect_to_be_true(string_view_equali(entry.key, "broken line"));
+    expect_should_be(7, entry.line_number);
+    
+    expect_to_be_true(config_reader_next(&reader, &entry));
+    expect_to_be_true(string_view_equali(entry.key, "diffuse_map_name"));
+    char name[8];
+    expect_should_be(7, string_view_copy(name, entry.value, sizeof(name)));
+    expect_to_be_true(strings_equal("cobbles", name));
+    
+    expect_to_be_false(config_reader_next(&reader, &entry));
+    
+    return true;
+}
+
+u8 config_reader_should_handle_empty_values()
+{
+    const char text[] = "name=\n=value\n   \n";
+    config_reader reader;
+    config_reader_create(text, sizeof(text) - 1, &reader);
+    
+    config_entry entry;
+    expect_to_be_true(config_reader_next(&reader, &entry));
+    expect_to_be_true(string_view_equali(entry.key, "name"));
+    expect_to_be_true(entry.value.str != 0);
+    expect_should_be(0, entry.value.length);
+    
+    expect_to_be_true(config_reader_next(&reader, &entry));
+    expect_should_be(0, entry.key.length);
+    expect_to_be_true(string_view_equali(entry.value, "value"));
+    
+    expect_to_be_false(config_reader_next(&reader, &entry));
+    
+    // An empty buffer has no entries.
+    config_reader_create(text, 0, &reader);
+    expect_to_be_false(config_reader_next(&reader, &entry));
+    
+    return true;
+}
+
+void config_reader_register_tests()
+{
+    test_manager_register_test(config_reader_should_read_entries, "Config reader should read entries");
+    test_manager_register_test(config_reader_should_handle_empty_values, "Config reader should handle empty values");
+}
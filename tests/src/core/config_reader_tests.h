@@ -0,0 +1,3 @@
+#pragma once
+
+void config_reader_register_tests();
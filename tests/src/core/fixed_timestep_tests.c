@@ -0,0 +1,67 @@
+#include "fixed_timestep_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/fixed_timestep.h>
+
+u8 fixed_timestep_should_accumulate_steps()
+{
+    fixed_timestep timestep;
+    fixed_timestep_create(30, &timestep);
+    
+    // Rendering at 120Hz, a 30Hz update falls on every fourth frame.
+    f64 step = 0;
+    u32 total = 0;
+    for (u32 i = 0; i < 3; ++i)
+    {
+        total += fixed_timestep_advance(&timestep, 1.0 / 120.0, &step);
+    }
+    expect_should_be(0, total);
+    expect_float_to_be(0.75f, fixed_timestep_alpha(&timestep));
+    
+    expect_should_be(1, fixed_timestep_advance(&timestep, 1.0 / 120.0 + 0.0001, &step));
+    expect_float_to_be((f32)(1.0 / 30.0), (f32)step);
+    expect_to_be_true(fixed_timestep_alpha(&timestep) < 0.01f);
+    
+    // A long frame runs several updates.
+    expect_should_be(3, fixed_timestep_advance(&timestep, 0.1, &step));
+    expect_should_be(0, timestep.dropped_step_count);
+    return true;
+}
+
+u8 fixed_timestep_should_drop_backlog()
+{
+    fixed_timestep timestep;
+    fixed_timestep_create(60, &timestep);
+    
+    // A one second hitch would need 60 updates; only the maximum run and the rest are dropped.
+    f64 step = 0;
+    expect_should_be(FIXED_TIMESTEP_MAX_STEPS, fixed_timestep_advance(&timestep, 1.0 + 0.5 / 60.0, &step));
+    expect_should_be(60 - FIXED_TIMESTEP_MAX_STEPS, timestep.dropped_step_count);
+    
+    // The fraction of a step is kept.
+    expect_to_be_true(fixed_timestep_alpha(&timestep) > 0.49f && fixed_timestep_alpha(&timestep) < 0.51f);
+    return true;
+}
+
+u8 fixed_timestep_should_update_every_frame_when_unfixed()
+{
+    fixed_timestep timestep;
+    fixed_timestep_create(0, &timestep);
+    
+    f64 step = 0;
+    expect_should_be(1, fixed_timestep_advance(&timestep, 0.001, &step));
+    expect_float_to_be(0.001f, (f32)step);
+    expect_should_be(1, fixed_timestep_advance(&timestep, 0.25, &step));
+    expect_float_to_be(0.25f, (f32)step);
+    expect_float_to_be(1.0f, fixed_timestep_alpha(&timestep));
+    return true;
+}
+
+void fixed_timestep_register_tests()
+{
+    test_manager_register_test(fixed_timestep_should_accumulate_steps, "Fixed timestep should accumulate steps");
+    test_manager_register_test(fixed_timestep_should_drop_backlog, "Fixed timestep should drop backlog");
+    test_manager_register_test(fixed_timestep_should_update_every_frame_when_unfixed, "Fixed timestep should update every frame when unfixed");
+}
@@ -0,0 +1,72 @@
+#include "frame_pacer_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/frame_pacer.h>
+#include <platform/platform.h>
+
+u8 frame_pacer_should_space_frames()
+{
+    frame_pacer pacer;
+    frame_pacer_create(200, &pacer);
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < 10; ++i)
+    {
+        frame_pacer_end_frame(&pacer);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    // Ten 5ms frames. Waits end at or after their deadline, never before.
+    expect_to_be_true(elapsed >= 0.05);
+    expect_should_be(10, pacer.stats.frame_count);
+    expect_to_be_true(frame_pacer_average_error(&pacer) >= 0);
+    return true;
+}
+
+u8 frame_pacer_should_count_missed_frames()
+{
+    frame_pacer pacer;
+    frame_pacer_create(200, &pacer);
+
+    // Work for longer than a frame.
+    f64 busy_until = platform_get_absolute_time() + 0.01;
+    while (platform_get_absolute_time() < busy_until)
+    {
+    }
+    f64 overran_at = platform_get_absolute_time();
+    frame_pacer_end_frame(&pacer);
+    expect_should_be(1, pacer.stats.missed_count);
+
+    // The next frame gets its full length, rather than being cut short to catch up.
+    frame_pacer_end_frame(&pacer);
+    expect_to_be_true(platform_get_absolute_time() - overran_at >= 0.005);
+    expect_should_be(1, pacer.stats.missed_count);
+
+    frame_pacer_reset_stats(&pacer);
+    expect_should_be(0, pacer.stats.frame_count);
+    return true;
+}
+
+u8 frame_pacer_should_not_wait_when_unlimited()
+{
+    frame_pacer pacer;
+    frame_pacer_create(0, &pacer);
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < 100; ++i)
+    {
+        frame_pacer_end_frame(&pacer);
+    }
+    expect_to_be_true(platform_get_absolute_time() - start < 0.005);
+    expect_should_be(0, pacer.stats.missed_count);
+    return true;
+}
+
+void frame_pacer_register_tests()
+{
+    test_manager_register_test(frame_pacer_should_space_frames, "Frame pacer should space frames out");
+    test_manager_register_test(frame_pacer_should_count_missed_frames, "Frame pacer should count missed frames");
+    test_manager_register_test(frame_pacer_should_not_wait_when_unlimited, "Frame pacer should not wait when unlimited");
+}
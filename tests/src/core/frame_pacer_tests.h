@@ -0,0 +1,3 @@
+#pragma once
+
+void frame_pacer_register_tests();
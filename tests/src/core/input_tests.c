@@ -0,0 +1,117 @@
+#include "input_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/input.h>
+#include <core/mmemory.h>
+#include <platform/filesystem.h>
+
+#define INPUT_TEST_RECORDING "input_test.mrec"
+
+static void *start_input(u64 *memory_requirement)
+{
+    input_system_initialise(memory_requirement, 0);
+    void *state = mallocate(*memory_requirement, MEMORY_TAG_APPLICATION);
+    input_system_initialise(memory_requirement, state);
+    return state;
+}
+
+static void stop_input(void *state, u64 memory_requirement)
+{
+    input_system_shutdown(state);
+    mfree(state, memory_requirement, MEMORY_TAG_APPLICATION);
+}
+
+// Records A held for two frames, the left button and a mouse move, then B held when it ends.
+static b8 record_test_input()
+{
+    if (!input_recording_start(INPUT_TEST_RECORDING, 1.0 / 60.0))
+    {
+        return false;
+    }
+    input_process_key(KEY_A, true, 0.0);
+    input_update(1.0 / 60.0);
+    input_process_button(BUTTON_LEFT, true, 0.0);
+    input_process_mouse_move(10, 20, 0.0);
+    input_update(1.0 / 60.0);
+    input_process_key(KEY_A, false, 0.0);
+    input_process_button(BUTTON_LEFT, false, 0.0);
+    input_update(1.0 / 60.0);
+    input_process_key(KEY_B, true, 0.0);
+    input_update(1.0 / 60.0);
+    input_recording_stop();
+
+    // Let go of what is still held live, so only the replay presses anything.
+    input_process_key(KEY_B, false, 0.0);
+    input_update(1.0 / 60.0);
+    return true;
+}
+
+u8 input_should_replay_a_recording()
+{
+    u64 memory_requirement = 0;
+    void *state = start_input(&memory_requirement);
+    expect_to_be_true(record_test_input());
+    expect_to_be_true(input_is_key_up(KEY_B));
+
+    expect_to_be_true(input_replay_start(INPUT_TEST_RECORDING));
+    expect_to_be_true(input_is_replaying());
+    expect_to_be_true(input_is_key_down(KEY_A));
+    expect_to_be_true(input_is_button_up(BUTTON_LEFT));
+
+    input_update(1.0 / 60.0);
+    expect_to_be_true(input_is_key_down(KEY_A));
+    expect_to_be_true(input_is_button_down(BUTTON_LEFT));
+    i32 x = 0;
+    i32 y = 0;
+    input_get_mouse_position(&x, &y);
+    expect_should_be(10, x);
+    expect_should_be(20, y);
+
+    input_update(1.0 / 60.0);
+    expect_to_be_true(input_is_key_up(KEY_A));
+    expect_to_be_true(input_is_button_up(BUTTON_LEFT));
+
+    // Live input is ignored while replaying.
+    input_process_key(KEY_C, true, 0.0);
+    input_update(1.0 / 60.0);
+    expect_to_be_true(input_is_key_down(KEY_B));
+    expect_to_be_true(input_is_key_up(KEY_C));
+
+    // The recording ended with B held, which the end of the replay lets go of.
+    input_update(1.0 / 60.0);
+    expect_to_be_false(input_is_replaying());
+    expect_to_be_true(input_is_key_up(KEY_B));
+
+    filesystem_delete(INPUT_TEST_RECORDING);
+    stop_input(state, memory_requirement);
+    return true;
+}
+
+u8 input_should_release_everything_when_a_replay_is_aborted()
+{
+    u64 memory_requirement = 0;
+    void *state = start_input(&memory_requirement);
+    expect_to_be_true(record_test_input());
+
+    expect_to_be_true(input_replay_start(INPUT_TEST_RECORDING));
+    input_update(1.0 / 60.0);
+    expect_to_be_true(input_is_key_down(KEY_A));
+    expect_to_be_true(input_is_button_down(BUTTON_LEFT));
+
+    input_process_key(KEY_ESCAPE, true, 0.0);
+    expect_to_be_false(input_is_replaying());
+    expect_to_be_true(input_is_key_up(KEY_A));
+    expect_to_be_true(input_is_button_up(BUTTON_LEFT));
+
+    filesystem_delete(INPUT_TEST_RECORDING);
+    stop_input(state, memory_requirement);
+    return true;
+}
+
+void input_register_tests()
+{
+    test_manager_register_test(input_should_replay_a_recording, "Input should replay a recording");
+    test_manager_register_test(input_should_release_everything_when_a_replay_is_aborted, "Input should release everything when a replay is aborted");
+}
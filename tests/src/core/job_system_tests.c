@@ -0,0 +1,352 @@
+#include "job_system_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/job_system.h>
+#include <core/mmemory.h>
+#include <platform/platform.h>
+
+#define SUM_JOB_COUNT 256
+#define SUM_VALUES_PER_JOB 1000
+
+typedef struct sum_job
+{
+    u32 first;
+    u64 result;
+} sum_job;
+
+static void sum_entry(void *params)
+{
+    sum_job *job = params;
+    job->result = 0;
+    for (u32 i = 0; i < SUM_VALUES_PER_JOB; ++i)
+    {
+        job->result += job->first + i;
+    }
+}
+
+static void *start_job_system(u32 worker_count, u32 fiber_count, u64 *memory_requirement)
+{
+    job_system_config config;
+    config.worker_count = worker_count;
+    config.fiber_count = fiber_count;
+    config.fiber_stack_size = 64 * 1024;
+    job_system_initialise(memory_requirement, 0, config);
+    void *state = mallocate(*memory_requirement, MEMORY_TAG_APPLICATION);
+    if (!job_system_initialise(memory_requirement, state, config))
+    {
+        mfree(state, *memory_requirement, MEMORY_TAG_APPLICATION);
+        return 0;
+    }
+    return state;
+}
+
+static void stop_job_system(void *state, u64 memory_requirement)
+{
+    job_system_shutdown(state);
+    mfree(state, memory_requirement, MEMORY_TAG_APPLICATION);
+}
+
+u8 job_system_should_run_all_jobs()
+{
+    u64 memory_requirement = 0;
+    void *state = start_job_system(4, 16, &memory_requirement);
+    expect_should_not_be(0, state);
+
+    static sum_job jobs[SUM_JOB_COUNT];
+    job_desc descs[SUM_JOB_COUNT];
+    for (u32 i = 0; i < SUM_JOB_COUNT; ++i)
+    {
+        jobs[i].first = i * SUM_VALUES_PER_JOB;
+        jobs[i].result = 0;
+        descs[i].entry = sum_entry;
+        descs[i].params = &jobs[i];
+        descs[i].flags = JOB_FLAG_NONE;
+    }
+
+    job_counter counter = {0};
+    job_system_run(descs, SUM_JOB_COUNT, &counter);
+    job_system_wait(&counter);
+    expect_to_be_true(job_counter_is_done(&counter));
+
+    u64 total = 0;
+    for (u32 i = 0; i < SUM_JOB_COUNT; ++i)
+    {
+        total += jobs[i].result;
+    }
+    u64 n = (u64)SUM_JOB_COUNT * SUM_VALUES_PER_JOB;
+    expect_should_be(n * (n - 1) / 2, total);
+
+    stop_job_system(state, memory_requirement);
+    return true;
+}
+
+typedef struct stage_job
+{
+    matomic_i32 *stage_one_done;
+    i32 stage_one_seen;
+} stage_job;
+
+static void stage_one_entry(void *params)
+{
+    matomic_i32 *done = params;
+    // Take a little while, so stage two would likely start early if it was not held back.
+    for (volatile u32 i = 0; i < 100000; ++i)
+    {
+    }
+    platform_atomic_add_i32(done, 1, MATOMIC_ACQ_REL);
+}
+
+static void stage_two_entry(void *params)
+{
+    stage_job *job = params;
+    job->stage_one_seen = platform_atomic_load_i32(job->stage_one_done, MATOMIC_ACQUIRE);
+}
+
+u8 job_system_should_respect_dependencies()
+{
+    u64 memory_requirement = 0;
+    void *state = start_job_system(4, 16, &memory_requirement);
+    expect_should_not_be(0, state);
+
+    matomic_i32 stage_one_done = {0};
+    job_desc stage_one[8];
+    for (u32 i = 0; i < 8; ++i)
+    {
+        stage_one[i].entry = stage_one_entry;
+        stage_one[i].params = &stage_one_done;
+        stage_one[i].flags = JOB_FLAG_NONE;
+    }
+
+    stage_job stage_two_jobs[16];
+    job_desc stage_two[16];
+    for (u32 i = 0; i < 16; ++i)
+    {
+        stage_two_jobs[i].stage_one_done = &stage_one_done;
+        stage_two_jobs[i].stage_one_seen = -1;
+        stage_two[i].entry = stage_two_entry;
+        stage_two[i].params = &stage_two_jobs[i];
+        stage_two[i].flags = JOB_FLAG_NONE;
+    }
+
+    job_counter stage_one_counter = {0};
+    job_counter stage_two_counter = {0};
+    job_system_run(stage_one, 8, &stage_one_counter);
+    job_system_run_after(stage_two, 16, &stage_one_counter, &stage_two_counter);
+    job_system_wait(&stage_two_counter);
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        expect_should_be(8, stage_two_jobs[i].stage_one_seen);
+    }
+
+    stop_job_system(state, memory_requirement);
+    return true;
+}
+
+#define REUSE_ITERATION_COUNT 2000
+
+typedef struct reuse_job
+{
+    matomic_i32 first_done;
+    i32 first_seen;
+} reuse_job;
+
+static void reuse_first_entry(void *params)
+{
+    reuse_job *job = params;
+    platform_atomic_store_i32(&job->first_done, 1, MATOMIC_RELEASE);
+}
+
+static void reuse_second_entry(void *params)
+{
+    reuse_job *job = params;
+    job->first_seen = platform_atomic_load_i32(&job->first_done, MATOMIC_ACQUIRE);
+}
+
+u8 job_system_should_allow_reusing_finished_counters()
+{
+    u64 memory_requirement = 0;
+    void *state = start_job_system(4, 16, &memory_requirement);
+    expect_should_not_be(0, state);
+
+    // The same counter is reused as soon as it is done, while its dependents from the previous use may
+    // still be getting released. Those releases must not start the next use's dependents early.
+    static reuse_job jobs[REUSE_ITERATION_COUNT];
+    job_counter counter = {0};
+    job_counter second_counter = {0};
+    for (u32 i = 0; i < REUSE_ITERATION_COUNT; ++i)
+    {
+        jobs[i].first_seen = -1;
+        job_desc first = {reuse_first_entry, &jobs[i], JOB_FLAG_NONE};
+        job_desc second = {reuse_second_entry, &jobs[i], JOB_FLAG_NONE};
+        job_system_run(&first, 1, &counter);
+        job_system_run_after(&second, 1, &counter, &second_counter);
+        job_system_wait(&counter);
+    }
+    job_system_wait(&second_counter);
+
+    for (u32 i = 0; i < REUSE_ITERATION_COUNT; ++i)
+    {
+        expect_should_be(1, jobs[i].first_seen);
+    }
+
+    stop_job_system(state, memory_requirement);
+    return true;
+}
+
+static void count_entry(void *params)
+{
+    platform_atomic_add_i32(params, 1, MATOMIC_ACQ_REL);
+}
+
+u8 job_system_should_run_main_thread_jobs_on_update()
+{
+    u64 memory_requirement = 0;
+    void *state = start_job_system(2, 0, &memory_requirement);
+    expect_should_not_be(0, state);
+
+    matomic_i32 run_count = {0};
+    job_desc desc;
+    desc.entry = count_entry;
+    desc.params = &run_count;
+    desc.flags = JOB_FLAG_MAIN_THREAD;
+
+    job_counter counter = {0};
+    job_system_run(&desc, 1, &counter);
+    // Workers must leave it alone.
+    for (volatile u32 i = 0; i < 1000000; ++i)
+    {
+    }
+    expect_should_be(0, platform_atomic_load_i32(&run_count, MATOMIC_ACQUIRE));
+    expect_to_be_false(job_counter_is_done(&counter));
+
+    job_system_update();
+    expect_should_be(1, platform_atomic_load_i32(&run_count, MATOMIC_ACQUIRE));
+    expect_to_be_true(job_counter_is_done(&counter));
+
+    stop_job_system(state, memory_requirement);
+    return true;
+}
+
+typedef struct gated_job
+{
+    matomic_i32 gate_runs;
+    job_counter gate_counter;
+} gated_job;
+
+// Waits on a job only the main thread can run.
+static void gated_entry(void *params)
+{
+    gated_job *job = params;
+    job_desc gate;
+    gate.entry = count_entry;
+    gate.params = &job->gate_runs;
+    gate.flags = JOB_FLAG_MAIN_THREAD;
+    job_system_run(&gate, 1, &job->gate_counter);
+    job_system_wait(&job->gate_counter);
+}
+
+// Waits for the gated job to finish.
+static void follower_entry(void *params)
+{
+    job_system_wait(params);
+}
+
+u8 job_system_should_suspend_waiting_jobs()
+{
+    // A single worker, so the follower can only run while the gated job is put aside. Were it run
+    // on top of the gated job instead, it would wait forever for the job beneath it.
+    u64 memory_requirement = 0;
+    void *state = start_job_system(1, 8, &memory_requirement);
+    expect_should_not_be(0, state);
+
+    gated_job gated = {0};
+    job_counter gated_counter = {0};
+    job_counter follower_counter = {0};
+
+    job_desc desc;
+    desc.entry = gated_entry;
+    desc.params = &gated;
+    desc.flags = JOB_FLAG_NONE;
+    job_system_run(&desc, 1, &gated_counter);
+
+    desc.entry = follower_entry;
+    desc.params = &gated_counter;
+    job_system_run(&desc, 1, &follower_counter);
+
+    while (!job_counter_is_done(&follower_counter))
+    {
+        job_system_update();
+    }
+    expect_to_be_true(job_counter_is_done(&gated_counter));
+    expect_should_be(1, platform_atomic_load_i32(&gated.gate_runs, MATOMIC_ACQUIRE));
+
+    stop_job_system(state, memory_requirement);
+    return true;
+}
+
+#define DRAIN_ITERATION_COUNT 20000
+
+typedef struct drain_check
+{
+    matomic_i32 *run_count;
+    // How many jobs had been added to the counter when this was queued after it.
+    i32 expected;
+    matomic_i32 *early_count;
+} drain_check;
+
+static void drain_check_entry(void *params)
+{
+    drain_check *check = params;
+    if (platform_atomic_load_i32(check->run_count, MATOMIC_ACQUIRE) < check->expected)
+    {
+        platform_atomic_add_i32(check->early_count, 1, MATOMIC_ACQ_REL);
+    }
+}
+
+u8 job_system_should_count_jobs_added_while_draining()
+{
+    u64 memory_requirement = 0;
+    void *state = start_job_system(4, 16, &memory_requirement);
+    expect_should_not_be(0, state);
+
+    // Jobs keep being added to the counter while the workers finish earlier ones, so it often goes
+    // back up while the last of them is releasing its waiters. Each check queued after the counter
+    // must still only run once every job added before it has finished.
+    static drain_check checks[DRAIN_ITERATION_COUNT];
+    matomic_i32 run_count = {0};
+    matomic_i32 early_count = {0};
+    job_desc desc = {count_entry, &run_count, JOB_FLAG_NONE};
+    job_counter counter = {0};
+    job_counter check_counter = {0};
+    for (u32 i = 0; i < DRAIN_ITERATION_COUNT; ++i)
+    {
+        job_system_run(&desc, 1, &counter);
+        checks[i].run_count = &run_count;
+        checks[i].expected = (i32)i + 1;
+        checks[i].early_count = &early_count;
+        job_desc check = {drain_check_entry, &checks[i], JOB_FLAG_NONE};
+        job_system_run_after(&check, 1, &counter, &check_counter);
+    }
+    job_system_wait(&counter);
+    expect_should_be(DRAIN_ITERATION_COUNT, platform_atomic_load_i32(&run_count, MATOMIC_ACQUIRE));
+    expect_to_be_true(job_counter_is_done(&counter));
+
+    job_system_wait(&check_counter);
+    expect_should_be(0, platform_atomic_load_i32(&early_count, MATOMIC_ACQUIRE));
+
+    stop_job_system(state, memory_requirement);
+    return true;
+}
+
+void job_system_register_tests()
+{
+    test_manager_register_test(job_system_should_run_all_jobs, "Job system should run every job exactly once");
+    test_manager_register_test(job_system_should_respect_dependencies, "Job system should not start jobs before their dependency");
+    test_manager_register_test(job_system_should_run_main_thread_jobs_on_update, "Job system should run main thread jobs only on update");
+    test_manager_register_test(job_system_should_suspend_waiting_jobs, "Job system should suspend jobs waiting on a counter");
+    test_manager_register_test(job_system_should_allow_reusing_finished_counters, "Job system should allow reusing finished counters");
+    test_manager_register_test(job_system_should_count_jobs_added_while_draining, "Job system should count jobs added while a counter drains");
+}
@@ -0,0 +1,47 @@
+#include "logger_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/logger.h>
+
+// Counts how often a log call's arguments are evaluated.
+static i32 count_evaluation(i32 *count)
+{
+    return ++(*count);
+}
+
+u8 logger_should_skip_channels_below_their_level()
+{
+    u8 previous_level = log_channel_levels[LOG_CHANNEL_TEXTURE];
+    i32 evaluations = 0;
+
+    // Above the channel's level, the arguments aren't even evaluated.
+    logging_set_channel_level(LOG_CHANNEL_TEXTURE, LOG_LEVEL_ERROR);
+    MWARN_CH(LOG_CHANNEL_TEXTURE, "Skipped %d.", count_evaluation(&evaluations));
+    expect_should_be(0, evaluations);
+
+    // Other channels keep their own levels.
+    MWARN_CH(LOG_CHANNEL_GENERAL, "Logged %d. This warning is intentional.", count_evaluation(&evaluations));
+    expect_should_be(1, evaluations);
+
+    logging_set_channel_level(LOG_CHANNEL_TEXTURE, LOG_LEVEL_WARN);
+    MWARN_CH(LOG_CHANNEL_TEXTURE, "Logged %d. This warning is intentional.", count_evaluation(&evaluations));
+    expect_should_be(2, evaluations);
+
+    // A logging call is a single statement, so it can be the body of an if with an else.
+    b8 took_else = false;
+    if (evaluations == 0)
+        MWARN_CH(LOG_CHANNEL_TEXTURE, "Not logged.");
+    else
+        took_else = true;
+    expect_to_be_true(took_else);
+
+    logging_set_channel_level(LOG_CHANNEL_TEXTURE, (log_level)previous_level);
+    return true;
+}
+
+void logger_register_tests()
+{
+    test_manager_register_test(logger_should_skip_channels_below_their_level, "Logger should skip channels below their level");
+}
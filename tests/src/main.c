@@ -2,6 +2,21 @@
 
 #include "memory/linear_allocator_tests.h"
 #include "containers/hashtable_tests.h"
+#include "containers/id_pool_tests.h"
+#include "core/binary_log_tests.h"
+#include "core/logger_tests.h"
+#include "core/config_reader_tests.h"
+#include "core/compression_tests.h"
+#include "core/job_system_tests.h"
+#include "platform/threading_tests.h"
+#include "core/frame_pacer_tests.h"
+#include "core/fixed_timestep_tests.h"
+#include "core/input_tests.h"
+#include "resources/block_compression_tests.h"
+#include "resources/image_tests.h"
+#include "resources/cooked_texture_tests.h"
+#include "resources/texture_atlas_tests.h"
+#include "systems/texture_residency_tests.h"
 
 #include <core/logger.h>
 
@@ -13,6 +28,21 @@ int main()
     // TODO(satvik): add test registrations here.
     linear_allocator_register_tests();
     hashtable_register_tests();
+    id_pool_register_tests();
+    binary_log_register_tests();
+    logger_register_tests();
+    config_reader_register_tests();
+    compression_register_tests();
+    job_system_register_tests();
+    threading_register_tests();
+    frame_pacer_register_tests();
+    fixed_timestep_register_tests();
+    input_register_tests();
+    block_compression_register_tests();
+    image_register_tests();
+    cooked_texture_register_tests();
+    texture_atlas_register_tests();
+    texture_residency_register_tests();
     
     MDEBUG("Starting tests...");
     
@@ -0,0 +1,115 @@
+#include "threading_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <platform/platform.h>
+
+#define INCREMENT_THREAD_COUNT 4
+#define INCREMENTS_PER_THREAD 100000
+
+static u32 increment_thread(void *params)
+{
+    matomic_i32 *counter = params;
+    for (u32 i = 0; i < INCREMENTS_PER_THREAD; ++i)
+    {
+        platform_atomic_add_i32(counter, 1, MATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+u8 atomics_should_not_lose_increments()
+{
+    matomic_i32 counter = {0};
+    mthread threads[INCREMENT_THREAD_COUNT];
+    for (u32 i = 0; i < INCREMENT_THREAD_COUNT; ++i)
+    {
+        expect_to_be_true(platform_thread_create(increment_thread, &counter, &threads[i]));
+        platform_thread_set_name(&threads[i], "Test incrementer");
+    }
+    for (u32 i = 0; i < INCREMENT_THREAD_COUNT; ++i)
+    {
+        platform_thread_join(&threads[i]);
+    }
+    expect_should_be(INCREMENT_THREAD_COUNT * INCREMENTS_PER_THREAD, platform_atomic_load_i32(&counter, MATOMIC_SEQ_CST));
+    return true;
+}
+
+u8 atomics_should_compare_exchange()
+{
+    matomic_i64 value = {5};
+    i64 expected = 4;
+    expect_to_be_false(platform_atomic_compare_exchange_i64(&value, &expected, 10, MATOMIC_SEQ_CST));
+    // A failed exchange reports the current value.
+    expect_should_be(5, expected);
+    expect_to_be_true(platform_atomic_compare_exchange_i64(&value, &expected, 10, MATOMIC_SEQ_CST));
+    expect_should_be(10, platform_atomic_load_i64(&value, MATOMIC_SEQ_CST));
+    expect_should_be(10, platform_atomic_exchange_i64(&value, 20, MATOMIC_SEQ_CST));
+    expect_should_be(20, platform_atomic_load_i64(&value, MATOMIC_SEQ_CST));
+    return true;
+}
+
+typedef struct handoff
+{
+    mmutex mutex;
+    mcondition condition;
+    u32 produced;
+    u32 consumed;
+} handoff;
+
+#define HANDOFF_COUNT 1000
+
+static u32 handoff_producer(void *params)
+{
+    handoff *h = params;
+    for (u32 i = 0; i < HANDOFF_COUNT; ++i)
+    {
+        platform_mutex_lock(&h->mutex);
+        // Wait for the last one to be taken, so every value is handed over one at a time.
+        while (h->produced != h->consumed)
+        {
+            platform_condition_wait(&h->condition, &h->mutex);
+        }
+        h->produced++;
+        platform_mutex_unlock(&h->mutex);
+        platform_condition_broadcast(&h->condition);
+    }
+    return 0;
+}
+
+u8 condition_should_hand_off_between_threads()
+{
+    handoff h = {0};
+    expect_to_be_true(platform_mutex_create(&h.mutex));
+    expect_to_be_true(platform_condition_create(&h.condition));
+
+    mthread producer;
+    expect_to_be_true(platform_thread_create(handoff_producer, &h, &producer));
+
+    for (u32 i = 0; i < HANDOFF_COUNT; ++i)
+    {
+        platform_mutex_lock(&h.mutex);
+        while (h.produced == h.consumed)
+        {
+            platform_condition_wait(&h.condition, &h.mutex);
+        }
+        h.consumed++;
+        platform_mutex_unlock(&h.mutex);
+        platform_condition_signal(&h.condition);
+    }
+
+    platform_thread_join(&producer);
+    expect_should_be(HANDOFF_COUNT, h.produced);
+    expect_should_be(HANDOFF_COUNT, h.consumed);
+
+    platform_condition_destroy(&h.condition);
+    platform_mutex_destroy(&h.mutex);
+    return true;
+}
+
+void threading_register_tests()
+{
+    test_manager_register_test(atomics_should_not_lose_increments, "Atomics should not lose increments across threads");
+    test_manager_register_test(atomics_should_compare_exchange, "Atomics should compare and exchange");
+    test_manager_register_test(condition_should_hand_off_between_threads, "Condition variable should hand off between threads");
+}
@@ -0,0 +1,201 @@
+#include "block_compression_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/mmemory.h>
+#include <resources/block_compression.h>
+#include <resources/cooked_texture.h>
+
+static i32 max_channel_error(const u8 *a, const u8 *b, u32 pixel_count, u32 first_channel, u32 channel_count)
+{
+    i32 max_error = 0;
+    for (u32 i = 0; i < pixel_count; ++i)
+    {
+        for (u32 c = first_channel; c < first_channel + channel_count; ++c)
+        {
+            i32 error = a[i * 4 + c] - b[i * 4 + c];
+            error = error < 0 ? -error : error;
+            max_error = error > max_error ? error : max_error;
+        }
+    }
+    return max_error;
+}
+
+u8 block_compression_should_size_formats()
+{
+    expect_should_be(5 * 3 * 4, texture_format_size(TEXTURE_FORMAT_RGBA8, 5, 3));
+    // Rounded up to 2x1 blocks.
+    expect_should_be(2 * 8, texture_format_size(TEXTURE_FORMAT_BC1, 5, 3));
+    expect_should_be(2 * 16, texture_format_size(TEXTURE_FORMAT_BC3, 5, 3));
+    expect_should_be(16, texture_format_size(TEXTURE_FORMAT_BC7, 1, 1));
+    expect_to_be_false(texture_format_is_compressed(TEXTURE_FORMAT_RGBA8));
+    expect_to_be_true(texture_format_is_compressed(TEXTURE_FORMAT_BC1));
+    return true;
+}
+
+u8 block_compression_should_size_mip_levels()
+{
+    expect_should_be(1, texture_mip_count(1, 1));
+    expect_should_be(9, texture_mip_count(256, 256));
+    // The longer side decides; 300x17 runs 300, 150, 75, 37, 18, 9, 4, 2, 1.
+    expect_should_be(9, texture_mip_count(300, 17));
+
+    expect_should_be(150 * 8 * 4, texture_format_level_size(TEXTURE_FORMAT_RGBA8, 300, 17, 1));
+    // Past 1 pixel high, the height stays at 1.
+    expect_should_be(9 * 1 * 4, texture_format_level_size(TEXTURE_FORMAT_RGBA8, 300, 17, 5));
+    // A 1x1 level is still a whole block.
+    expect_should_be(16, texture_format_level_size(TEXTURE_FORMAT_BC3, 300, 17, 8));
+    return true;
+}
+
+u8 block_compression_should_roundtrip_solid_block()
+{
+    // Exactly representable as 565.
+    u8 pixels[64];
+    for (u32 i = 0; i < 16; ++i)
+    {
+        pixels[i * 4 + 0] = 255;
+        pixels[i * 4 + 1] = 0;
+        pixels[i * 4 + 2] = 255;
+        pixels[i * 4 + 3] = 255;
+    }
+
+    u8 block[8];
+    u8 decoded[64];
+    bc1_encode_block(pixels, block);
+    bc1_decode_block(block, decoded);
+    expect_should_be(0, max_channel_error(pixels, decoded, 16, 0, 4));
+    return true;
+}
+
+u8 block_compression_should_bound_gradient_error()
+{
+    u8 pixels[64];
+    for (u32 i = 0; i < 16; ++i)
+    {
+        pixels[i * 4 + 0] = (u8)(10 + i * 15);
+        pixels[i * 4 + 1] = (u8)(200 - i * 10);
+        pixels[i * 4 + 2] = (u8)(60 + i * 4);
+        pixels[i * 4 + 3] = 255;
+    }
+
+    u8 block[8];
+    u8 decoded[64];
+    bc1_encode_block(pixels, block);
+    bc1_decode_block(block, decoded);
+    // Four colours along the line spanning 225 levels of red can be up to about a sixth of that off.
+    expect_to_be_true(max_channel_error(pixels, decoded, 16, 0, 3) <= 40);
+    // Opaque; no index may select transparent black.
+    expect_should_be(0, max_channel_error(pixels, decoded, 16, 3, 1));
+    return true;
+}
+
+u8 block_compression_should_encode_alpha()
+{
+    u8 pixels[64];
+    for (u32 i = 0; i < 16; ++i)
+    {
+        pixels[i * 4 + 0] = 128;
+        pixels[i * 4 + 1] = 64;
+        pixels[i * 4 + 2] = 32;
+        pixels[i * 4 + 3] = (u8)(i * 17);
+    }
+
+    u8 block[16];
+    u8 decoded[64];
+    bc3_encode_block(pixels, block);
+    bc3_decode_block(block, decoded);
+    // 8 levels spread over 0-255 are at most half a step, 255 / 14, out.
+    expect_to_be_true(max_channel_error(pixels, decoded, 16, 3, 1) <= 19);
+    expect_should_be(0, decoded[3]);
+    expect_should_be(255, decoded[63]);
+
+    // Two alpha values are the endpoints, so are exact.
+    for (u32 i = 0; i < 16; ++i)
+    {
+        pixels[i * 4 + 3] = i % 2 ? 0 : 255;
+    }
+    bc3_encode_block(pixels, block);
+    bc3_decode_block(block, decoded);
+    expect_should_be(0, max_channel_error(pixels, decoded, 16, 3, 1));
+    return true;
+}
+
+u8 block_compression_should_handle_partial_blocks()
+{
+    // 5x3: the last column is a second block, padded by repeating the edge.
+    const u32 width = 5;
+    const u32 height = 3;
+    u8 pixels[5 * 3 * 4];
+    for (u32 i = 0; i < width * height; ++i)
+    {
+        b8 last_column = i % width == width - 1;
+        pixels[i * 4 + 0] = last_column ? 0 : 255;
+        pixels[i * 4 + 1] = last_column ? 255 : 0;
+        pixels[i * 4 + 2] = 0;
+        pixels[i * 4 + 3] = last_column ? 0 : 255;
+    }
+
+    u8 compressed[2 * 16];
+    u8 decoded[5 * 3 * 4];
+    mset_memory(decoded, 0xCD, sizeof(decoded));
+    expect_to_be_true(block_compress_image(pixels, width, height, TEXTURE_FORMAT_BC3, compressed));
+    expect_to_be_true(block_decompress_image(compressed, width, height, TEXTURE_FORMAT_BC3, decoded));
+    expect_should_be(0, max_channel_error(pixels, decoded, width * height, 0, 4));
+
+    // BC7 isn't encoded or decoded on the CPU.
+    expect_to_be_false(block_compress_image(pixels, width, height, TEXTURE_FORMAT_BC7, compressed));
+    return true;
+}
+
+u8 cooked_texture_should_validate_levels()
+{
+    // 8x4 BC1 with all four levels down to 1x1: 16 + 8 + 8 + 8 bytes.
+    u8 file[sizeof(cooked_texture_header) + 40] = {0};
+    cooked_texture_header *header = (cooked_texture_header *)file;
+    header->magic = COOKED_TEXTURE_MAGIC;
+    header->version = COOKED_TEXTURE_VERSION;
+    header->format = TEXTURE_FORMAT_BC1;
+    header->width = 8;
+    header->height = 4;
+    header->level_count = 4;
+
+    cooked_texture cooked;
+    expect_to_be_true(cooked_texture_parse(file, sizeof(file), &cooked));
+    expect_should_be(file + sizeof(cooked_texture_header), cooked.levels[0]);
+    expect_should_be(file + sizeof(cooked_texture_header) + 32, cooked.levels[3]);
+
+    // Truncated.
+    expect_to_be_false(cooked_texture_parse(file, sizeof(file) - 1, &cooked));
+    expect_should_be(0, cooked.header);
+
+    // A level past 1x1.
+    header->level_count = 5;
+    expect_to_be_false(cooked_texture_parse(file, sizeof(file), &cooked));
+
+    header->level_count = 4;
+    header->version = COOKED_TEXTURE_VERSION + 1;
+    expect_to_be_false(cooked_texture_parse(file, sizeof(file), &cooked));
+
+    // Dimensions so large that the level sizes would wrap around and pass the size check.
+    header->version = COOKED_TEXTURE_VERSION;
+    header->width = 0xFFFFFFFDU;
+    header->height = 4;
+    header->level_count = 1;
+    expect_to_be_false(cooked_texture_parse(file, sizeof(file), &cooked));
+    header->width = COOKED_TEXTURE_MAX_SIZE + 1;
+    expect_to_be_false(cooked_texture_parse(file, sizeof(file), &cooked));
+    return true;
+}
+
+void block_compression_register_tests()
+{
+    test_manager_register_test(block_compression_should_size_formats, "Block compression should size formats");
+    test_manager_register_test(block_compression_should_size_mip_levels, "Block compression should size mip levels");
+    test_manager_register_test(block_compression_should_roundtrip_solid_block, "Block compression should roundtrip a solid block");
+    test_manager_register_test(block_compression_should_bound_gradient_error, "Block compression should bound gradient error");
+    test_manager_register_test(block_compression_should_encode_alpha, "Block compression should encode alpha");
+    test_manager_register_test(block_compression_should_handle_partial_blocks, "Block compression should handle partial blocks");
+    test_manager_register_test(cooked_texture_should_validate_levels, "Cooked texture should validate levels");
+}
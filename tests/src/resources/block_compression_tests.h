@@ -0,0 +1,3 @@
+#pragma once
+
+void block_compression_register_tests();
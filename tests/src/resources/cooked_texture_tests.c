@@ -0,0 +1,111 @@
+#include "cooked_texture_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/mmemory.h>
+#include <resources/cooked_texture.h>
+#include <resources/image.h>
+
+#define COOKED_TEST_WIDTH 4
+#define COOKED_TEST_HEIGHT 2
+#define COOKED_TEST_HASH 0x1234567890abcdefULL
+
+static void fill_test_pixels(u8 *pixels)
+{
+    for (u32 i = 0; i < COOKED_TEST_WIDTH * COOKED_TEST_HEIGHT * 4; ++i)
+    {
+        pixels[i] = (u8)(i * 7);
+    }
+}
+
+static u8 expect_bytes(const u8 *expected, const u8 *actual, u64 size)
+{
+    for (u64 i = 0; i < size; ++i)
+    {
+        expect_should_be(expected[i], actual[i]);
+    }
+    return true;
+}
+
+u8 cooked_texture_should_round_trip_a_cache_entry()
+{
+    u8 pixels[COOKED_TEST_WIDTH * COOKED_TEST_HEIGHT * 4];
+    fill_test_pixels(pixels);
+    u64 size = 0;
+    u8 *entry = cooked_texture_cache_entry_create(pixels, COOKED_TEST_WIDTH, COOKED_TEST_HEIGHT, true, COOKED_TEST_HASH, &size);
+    expect_should_not_be(0, entry);
+
+    cooked_texture cooked;
+    expect_to_be_true(cooked_texture_cache_entry_parse(entry, size, COOKED_TEST_HASH, &cooked));
+    expect_should_be(COOKED_TEST_WIDTH, cooked.header->width);
+    expect_should_be(COOKED_TEST_HEIGHT, cooked.header->height);
+    expect_should_be(3, cooked.header->level_count);
+    expect_should_be(COOKED_TEXTURE_FLAG_TRANSPARENCY, cooked.header->flags);
+    if (!expect_bytes(pixels, cooked.levels[0], sizeof(pixels)))
+    {
+        return false;
+    }
+
+    // Each level is filtered from the one above.
+    u8 level_1[2 * 1 * 4];
+    image_downsample_rgba8(pixels, COOKED_TEST_WIDTH, COOKED_TEST_HEIGHT, level_1);
+    if (!expect_bytes(level_1, cooked.levels[1], sizeof(level_1)))
+    {
+        return false;
+    }
+    u8 level_2[4];
+    image_downsample_rgba8(level_1, 2, 1, level_2);
+    if (!expect_bytes(level_2, cooked.levels[2], sizeof(level_2)))
+    {
+        return false;
+    }
+
+    mfree(entry, size, MEMORY_TAG_TEXTURE);
+    return true;
+}
+
+u8 cooked_texture_should_reject_a_stale_cache_entry()
+{
+    u8 pixels[COOKED_TEST_WIDTH * COOKED_TEST_HEIGHT * 4];
+    fill_test_pixels(pixels);
+    u64 size = 0;
+    u8 *entry = cooked_texture_cache_entry_create(pixels, COOKED_TEST_WIDTH, COOKED_TEST_HEIGHT, false, COOKED_TEST_HASH, &size);
+    expect_should_not_be(0, entry);
+
+    // Made from a different image file.
+    cooked_texture cooked;
+    expect_to_be_false(cooked_texture_cache_entry_parse(entry, size, COOKED_TEST_HASH + 1, &cooked));
+    expect_should_be(0, cooked.header);
+
+    // Cut short, down to less than the hash.
+    expect_to_be_false(cooked_texture_cache_entry_parse(entry, size - 1, COOKED_TEST_HASH, &cooked));
+    expect_to_be_false(cooked_texture_cache_entry_parse(entry, sizeof(u64) - 1, COOKED_TEST_HASH, &cooked));
+    expect_to_be_false(cooked_texture_cache_entry_parse(entry, 0, COOKED_TEST_HASH, &cooked));
+
+    // Written by an older version of the format.
+    cooked_texture_header *header = (cooked_texture_header *)entry;
+    header->version = COOKED_TEXTURE_VERSION + 1;
+    expect_to_be_false(cooked_texture_cache_entry_parse(entry, size, COOKED_TEST_HASH, &cooked));
+
+    mfree(entry, size, MEMORY_TAG_TEXTURE);
+    return true;
+}
+
+u8 cooked_texture_should_not_cache_an_image_too_large_to_cook()
+{
+    // Too large to be read back, so not made at all. The pixels aren't touched.
+    u8 pixel[4] = {0};
+    u64 size = 0;
+    expect_should_be(0, cooked_texture_cache_entry_create(pixel, COOKED_TEXTURE_MAX_SIZE + 1, 1, false, COOKED_TEST_HASH, &size));
+    expect_should_be(0, cooked_texture_cache_entry_create(pixel, 1, COOKED_TEXTURE_MAX_SIZE + 1, false, COOKED_TEST_HASH, &size));
+    expect_should_be(0, size);
+    return true;
+}
+
+void cooked_texture_register_tests()
+{
+    test_manager_register_test(cooked_texture_should_round_trip_a_cache_entry, "Cooked texture should round trip a cache entry");
+    test_manager_register_test(cooked_texture_should_reject_a_stale_cache_entry, "Cooked texture should reject a stale cache entry");
+    test_manager_register_test(cooked_texture_should_not_cache_an_image_too_large_to_cook, "Cooked texture should not cache an image too large to cook");
+}
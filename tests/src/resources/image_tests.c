@@ -0,0 +1,160 @@
+#include "image_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/mmemory.h>
+#include <resources/image.h>
+
+// Odd, so the SIMD versions also run their scalar tails.
+#define IMAGE_TEST_PIXEL_COUNT 67
+
+static void fill_pattern(u8 *pixels, u64 pixel_count)
+{
+    for (u64 i = 0; i < pixel_count * 4; ++i)
+    {
+        pixels[i] = (u8)(i * 37 + 11);
+    }
+}
+
+u8 image_should_detect_transparency()
+{
+    u8 pixels[IMAGE_TEST_PIXEL_COUNT * 4];
+    for (u32 simd = 0; simd < 2; ++simd)
+    {
+        image_set_simd_enabled(simd);
+        mset_memory(pixels, 255, sizeof(pixels));
+        expect_to_be_false(image_has_transparency_rgba8(pixels, IMAGE_TEST_PIXEL_COUNT));
+
+        // Every position, including those past the last whole SIMD run.
+        for (u32 i = 0; i < IMAGE_TEST_PIXEL_COUNT; ++i)
+        {
+            pixels[i * 4 + 3] = 254;
+            expect_to_be_true(image_has_transparency_rgba8(pixels, IMAGE_TEST_PIXEL_COUNT));
+            // Only pixels before it are checked.
+            expect_to_be_false(image_has_transparency_rgba8(pixels, i));
+            pixels[i * 4 + 3] = 255;
+        }
+
+        // Colour channels don't count.
+        pixels[0] = 0;
+        pixels[IMAGE_TEST_PIXEL_COUNT * 4 - 2] = 0;
+        expect_to_be_false(image_has_transparency_rgba8(pixels, IMAGE_TEST_PIXEL_COUNT));
+    }
+    image_set_simd_enabled(true);
+    return true;
+}
+
+u8 image_should_premultiply_alpha()
+{
+    // Every colour with every alpha, one per channel of a 256 pixel row per alpha.
+    u8 row[256 * 4];
+    u8 scalar_row[256 * 4];
+    for (u32 alpha = 0; alpha < 256; ++alpha)
+    {
+        for (u32 i = 0; i < 256; ++i)
+        {
+            row[i * 4 + 0] = (u8)i;
+            row[i * 4 + 1] = (u8)(255 - i);
+            row[i * 4 + 2] = (u8)(i * 7);
+            row[i * 4 + 3] = (u8)alpha;
+        }
+        mcopy_memory(scalar_row, row, sizeof(row));
+
+        image_set_simd_enabled(true);
+        image_premultiply_alpha_rgba8(row, 255);
+        image_set_simd_enabled(false);
+        image_premultiply_alpha_rgba8(scalar_row, 255);
+
+        for (u32 i = 0; i < 255; ++i)
+        {
+            expect_should_be((u8)((i * alpha + 127) / 255), row[i * 4 + 0]);
+            expect_should_be((u8)alpha, row[i * 4 + 3]);
+        }
+        for (u32 i = 0; i < sizeof(row); ++i)
+        {
+            expect_should_be(scalar_row[i], row[i]);
+        }
+        // Past the end is untouched.
+        expect_should_be(255, row[255 * 4]);
+    }
+    image_set_simd_enabled(true);
+    return true;
+}
+
+u8 image_should_swizzle()
+{
+    u8 pixels[IMAGE_TEST_PIXEL_COUNT * 4];
+    u8 source[IMAGE_TEST_PIXEL_COUNT * 4];
+    fill_pattern(source, IMAGE_TEST_PIXEL_COUNT);
+    const u8 orders[3][4] = {{2, 1, 0, 3}, {3, 3, 0, 1}, {0, 1, 2, 3}};
+    for (u32 simd = 0; simd < 2; ++simd)
+    {
+        image_set_simd_enabled(simd);
+        for (u32 o = 0; o < 3; ++o)
+        {
+            mcopy_memory(pixels, source, sizeof(pixels));
+            image_swizzle_rgba8(pixels, IMAGE_TEST_PIXEL_COUNT, orders[o]);
+            for (u32 i = 0; i < IMAGE_TEST_PIXEL_COUNT; ++i)
+            {
+                for (u32 c = 0; c < 4; ++c)
+                {
+                    expect_should_be(source[i * 4 + orders[o][c]], pixels[i * 4 + c]);
+                }
+            }
+        }
+    }
+    image_set_simd_enabled(true);
+    return true;
+}
+
+u8 image_should_convert_srgb()
+{
+    u8 pixels[] = {0, 128, 255, 128, 188, 255, 0, 7};
+    image_srgb_to_linear_rgba8(pixels, 2);
+    expect_should_be(0, pixels[0]);
+    expect_should_be(55, pixels[1]);
+    expect_should_be(255, pixels[2]);
+    expect_should_be(128, pixels[3]);
+    expect_should_be(128, pixels[4]);
+
+    image_linear_to_srgb_rgba8(pixels, 2);
+    expect_should_be(0, pixels[0]);
+    expect_should_be(128, pixels[1]);
+    expect_should_be(255, pixels[2]);
+    expect_should_be(128, pixels[3]);
+    expect_should_be(188, pixels[4]);
+    expect_should_be(7, pixels[7]);
+    return true;
+}
+
+u8 image_should_downsample()
+{
+    // 3x2 halves to 1x1, dropping the last column.
+    u8 pixels[3 * 2 * 4] = {
+        0, 10, 20, 255, 4, 10, 20, 255, 99, 99, 99, 99,
+        1, 10, 20, 255, 2, 11, 20, 0, 99, 99, 99, 99};
+    u8 out[4];
+    image_downsample_rgba8(pixels, 3, 2, out);
+    // Red averages 7 / 4, which rounds to 2.
+    expect_should_be(2, out[0]);
+    expect_should_be(10, out[1]);
+    expect_should_be(20, out[2]);
+    expect_should_be(191, out[3]);
+
+    // A 1 pixel wide image keeps its width.
+    u8 column[2 * 4];
+    image_downsample_rgba8(pixels, 1, 4, column);
+    expect_should_be(2, column[0]);
+    expect_should_be(50, column[4]);
+    return true;
+}
+
+void image_register_tests()
+{
+    test_manager_register_test(image_should_detect_transparency, "Image should detect transparency");
+    test_manager_register_test(image_should_premultiply_alpha, "Image should premultiply alpha");
+    test_manager_register_test(image_should_swizzle, "Image should swizzle");
+    test_manager_register_test(image_should_convert_srgb, "Image should convert sRGB");
+    test_manager_register_test(image_should_downsample, "Image should downsample");
+}
@@ -0,0 +1,273 @@
+#include "texture_atlas_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/mmemory.h>
+#include <resources/texture_atlas.h>
+
+#define ATLAS_TEST_SIZE 64
+#define ATLAS_TEST_LAYERS 2
+
+// Room for the atlas's bookkeeping, checked against what it asks for.
+static u8 atlas_memory[2048];
+
+static u8 create_test_atlas(texture_atlas *atlas)
+{
+    expect_to_be_true(texture_atlas_memory_requirement(ATLAS_TEST_SIZE, ATLAS_TEST_LAYERS) <= sizeof(atlas_memory));
+    texture_atlas_create(ATLAS_TEST_SIZE, ATLAS_TEST_LAYERS, atlas_memory, atlas);
+    return true;
+}
+
+static u8 expect_region(u32 layer, u32 x, u32 y, const texture_atlas_region *region)
+{
+    expect_should_be(layer, region->layer);
+    expect_should_be(x, region->x);
+    expect_should_be(y, region->y);
+    return true;
+}
+
+u8 texture_atlas_should_pack_onto_shelves()
+{
+    texture_atlas atlas;
+    if (!create_test_atlas(&atlas))
+    {
+        return false;
+    }
+
+    // 8x8 entries take 16x16 with padding, so four fit on a shelf.
+    texture_atlas_region region;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        expect_to_be_true(texture_atlas_allocate(&atlas, 8, 8, &region));
+        if (!expect_region(0, 4 + i * 16, 4, &region))
+        {
+            return false;
+        }
+        expect_should_be(8, region.width);
+        expect_should_be(8, region.height);
+    }
+
+    // The next starts a new shelf underneath.
+    expect_to_be_true(texture_atlas_allocate(&atlas, 8, 8, &region));
+    if (!expect_region(0, 4, 20, &region))
+    {
+        return false;
+    }
+
+    // A taller entry needs a shelf of its own.
+    expect_to_be_true(texture_atlas_allocate(&atlas, 20, 20, &region));
+    if (!expect_region(0, 4, 36, &region))
+    {
+        return false;
+    }
+
+    // A slightly shorter one shares a shelf, taking the least tall which fits.
+    expect_to_be_true(texture_atlas_allocate(&atlas, 2, 2, &region));
+    if (!expect_region(0, 20, 20, &region))
+    {
+        return false;
+    }
+
+    // Entries which can't fit with their padding, or are empty, are refused.
+    expect_to_be_false(texture_atlas_allocate(&atlas, 64, 8, &region));
+    expect_to_be_false(texture_atlas_allocate(&atlas, 0, 8, &region));
+    return true;
+}
+
+u8 texture_atlas_should_fill_every_layer()
+{
+    texture_atlas atlas;
+    if (!create_test_atlas(&atlas))
+    {
+        return false;
+    }
+
+    // Sixteen 8x8 entries fill a layer.
+    texture_atlas_region region;
+    for (u32 i = 0; i < 16 * ATLAS_TEST_LAYERS; ++i)
+    {
+        expect_to_be_true(texture_atlas_allocate(&atlas, 8, 8, &region));
+        if (!expect_region(i / 16, 4 + (i % 4) * 16, 4 + (i % 16) / 4 * 16, &region))
+        {
+            return false;
+        }
+    }
+
+    expect_to_be_false(texture_atlas_allocate(&atlas, 8, 8, &region));
+    return true;
+}
+
+u8 texture_atlas_should_reuse_freed_space()
+{
+    texture_atlas atlas;
+    if (!create_test_atlas(&atlas))
+    {
+        return false;
+    }
+
+    texture_atlas_region regions[3];
+    for (u32 i = 0; i < 3; ++i)
+    {
+        expect_to_be_true(texture_atlas_allocate(&atlas, 8, 8, &regions[i]));
+    }
+
+    // Space freed in the middle of a shelf is reused by an entry which fits.
+    texture_atlas_free(&atlas, &regions[1]);
+    texture_atlas_region region;
+    expect_to_be_true(texture_atlas_allocate(&atlas, 6, 6, &region));
+    if (!expect_region(0, 20, 4, &region))
+    {
+        return false;
+    }
+    regions[1] = region;
+
+    // Freeing the last entry on a shelf makes room at its end again.
+    texture_atlas_free(&atlas, &regions[2]);
+    expect_to_be_true(texture_atlas_allocate(&atlas, 8, 8, &region));
+    if (!expect_region(0, 36, 4, &region))
+    {
+        return false;
+    }
+    regions[2] = region;
+
+    // Once the layer is empty it is packed from the start again, even with a different height.
+    for (u32 i = 0; i < 3; ++i)
+    {
+        texture_atlas_free(&atlas, &regions[i]);
+    }
+    expect_should_be(0, atlas.shelf_count);
+    expect_should_be(0, atlas.free_count);
+    expect_to_be_true(texture_atlas_allocate(&atlas, 20, 20, &region));
+    if (!expect_region(0, 4, 4, &region))
+    {
+        return false;
+    }
+    return true;
+}
+
+u8 texture_atlas_should_map_coordinates()
+{
+    texture_atlas atlas;
+    if (!create_test_atlas(&atlas))
+    {
+        return false;
+    }
+
+    texture_atlas_region region = {1, 4, 20, 8, 16};
+    vec4 transform = texture_atlas_uv_transform(&atlas, &region);
+    expect_float_to_be(0.125f, transform.x);
+    expect_float_to_be(0.25f, transform.y);
+    expect_float_to_be(0.0625f, transform.z);
+    expect_float_to_be(0.3125f, transform.w);
+    return true;
+}
+
+u8 texture_atlas_should_wrap_padding()
+{
+    texture_atlas atlas;
+    if (!create_test_atlas(&atlas))
+    {
+        return false;
+    }
+
+    // A 2x2 entry whose pixels are numbered 1 to 4 in every channel.
+    const u8 pixels[2 * 2 * 4] = {1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4};
+    static u8 layer_pixels[ATLAS_TEST_SIZE * ATLAS_TEST_SIZE * 4];
+    mzero_memory(layer_pixels, sizeof(layer_pixels));
+
+    texture_atlas_region region;
+    expect_to_be_true(texture_atlas_allocate(&atlas, 2, 2, &region));
+    texture_atlas_write(&atlas, &region, pixels, layer_pixels);
+
+    // The entry and its padding, which repeats it to TEXTURE_ATLAS_PADDING texels all around.
+    for (i32 y = -TEXTURE_ATLAS_PADDING; y < 2 + TEXTURE_ATLAS_PADDING; ++y)
+    {
+        for (i32 x = -TEXTURE_ATLAS_PADDING; x < 2 + TEXTURE_ATLAS_PADDING; ++x)
+        {
+            u32 expected = 1 + ((x + TEXTURE_ATLAS_PADDING) % 2) + ((y + TEXTURE_ATLAS_PADDING) % 2) * 2;
+            u64 index = ((u64)(region.y + y) * ATLAS_TEST_SIZE + region.x + x) * 4;
+            expect_should_be(expected, layer_pixels[index]);
+            expect_should_be(expected, layer_pixels[index + 3]);
+        }
+    }
+
+    // Nothing past the padding is touched.
+    u64 past = ((u64)region.y * ATLAS_TEST_SIZE + region.x + 2 + TEXTURE_ATLAS_PADDING) * 4;
+    expect_should_be(0, layer_pixels[past]);
+    return true;
+}
+
+u8 texture_atlas_should_wrap_like_the_sampler()
+{
+    // Inside the entry, every mode samples the same place.
+    expect_float_to_be(0.5f, texture_atlas_wrap(0.5f, 8, TEXTURE_REPEAT_REPEAT, 0));
+    expect_float_to_be(0.5f, texture_atlas_wrap(0.5f, 8, TEXTURE_REPEAT_MIRRORED_REPEAT, 0));
+    expect_float_to_be(0.5f, texture_atlas_wrap(0.5f, 8, TEXTURE_REPEAT_CLAMP_TO_EDGE, 0));
+
+    // Outside it, each samples somewhere different.
+    expect_float_to_be(0.25f, texture_atlas_wrap(1.25f, 8, TEXTURE_REPEAT_REPEAT, 0));
+    expect_float_to_be(0.75f, texture_atlas_wrap(1.25f, 8, TEXTURE_REPEAT_MIRRORED_REPEAT, 0));
+    expect_float_to_be(0.9375f, texture_atlas_wrap(1.25f, 8, TEXTURE_REPEAT_CLAMP_TO_EDGE, 0));
+    expect_float_to_be(0.75f, texture_atlas_wrap(-0.25f, 8, TEXTURE_REPEAT_REPEAT, 0));
+    expect_float_to_be(0.25f, texture_atlas_wrap(-0.25f, 8, TEXTURE_REPEAT_MIRRORED_REPEAT, 0));
+    expect_float_to_be(0.0625f, texture_atlas_wrap(-0.25f, 8, TEXTURE_REPEAT_CLAMP_TO_EDGE, 0));
+
+    // Mirroring flips every other repeat, and stays half a texel in from the edges like clamping.
+    expect_float_to_be(0.25f, texture_atlas_wrap(2.25f, 8, TEXTURE_REPEAT_MIRRORED_REPEAT, 0));
+    expect_float_to_be(0.9375f, texture_atlas_wrap(1.0f, 8, TEXTURE_REPEAT_MIRRORED_REPEAT, 0));
+
+    // Further down the mip chain texels are wider, so clamping stays further in, down to the last level.
+    expect_float_to_be(0.875f, texture_atlas_wrap(1.25f, 8, TEXTURE_REPEAT_CLAMP_TO_EDGE, 1));
+    expect_float_to_be(0.25f, texture_atlas_wrap(-0.25f, 8, TEXTURE_REPEAT_MIRRORED_REPEAT, 2));
+    expect_float_to_be(0.25f, texture_atlas_wrap(-0.25f, 8, TEXTURE_REPEAT_CLAMP_TO_EDGE, 5));
+    expect_float_to_be(0.25f, texture_atlas_wrap(1.25f, 8, TEXTURE_REPEAT_REPEAT, 2));
+
+    // An entry narrower than a texel there is sampled in the middle.
+    expect_float_to_be(0.5f, texture_atlas_wrap(0.0f, 2, TEXTURE_REPEAT_CLAMP_TO_EDGE, 2));
+    return true;
+}
+
+u8 texture_atlas_should_report_what_writes_change()
+{
+    texture_atlas atlas;
+    if (!create_test_atlas(&atlas))
+    {
+        return false;
+    }
+
+    texture_atlas_region first;
+    texture_atlas_region second;
+    expect_to_be_true(texture_atlas_allocate(&atlas, 5, 3, &first));
+    expect_to_be_true(texture_atlas_allocate(&atlas, 5, 3, &second));
+
+    // The padded region covers the entry and its padding, and is aligned so that it still covers
+    // whole texels at the smallest atlas mip level.
+    texture_region padded = texture_atlas_padded_region(&second);
+    u32 alignment = 1 << (TEXTURE_ATLAS_MIP_LEVELS - 1);
+    expect_should_be(second.layer, padded.layer);
+    expect_should_be(second.x - TEXTURE_ATLAS_PADDING, padded.x);
+    expect_should_be(second.y - TEXTURE_ATLAS_PADDING, padded.y);
+    expect_to_be_true(padded.width >= 5 + TEXTURE_ATLAS_PADDING * 2);
+    expect_to_be_true(padded.height >= 3 + TEXTURE_ATLAS_PADDING * 2);
+    expect_should_be(0, padded.x % alignment);
+    expect_should_be(0, padded.y % alignment);
+    expect_should_be(0, padded.width % alignment);
+    expect_should_be(0, padded.height % alignment);
+
+    // Neighbouring entries' padded regions don't overlap, so updating one leaves the other alone.
+    texture_region neighbour = texture_atlas_padded_region(&first);
+    expect_to_be_true(neighbour.x + neighbour.width <= padded.x);
+    return true;
+}
+
+void texture_atlas_register_tests()
+{
+    test_manager_register_test(texture_atlas_should_pack_onto_shelves, "Texture atlas should pack onto shelves");
+    test_manager_register_test(texture_atlas_should_fill_every_layer, "Texture atlas should fill every layer");
+    test_manager_register_test(texture_atlas_should_reuse_freed_space, "Texture atlas should reuse freed space");
+    test_manager_register_test(texture_atlas_should_map_coordinates, "Texture atlas should map coordinates");
+    test_manager_register_test(texture_atlas_should_wrap_padding, "Texture atlas should wrap padding");
+    test_manager_register_test(texture_atlas_should_wrap_like_the_sampler, "Texture atlas should wrap like the sampler");
+    test_manager_register_test(texture_atlas_should_report_what_writes_change, "Texture atlas should report what writes change");
+}
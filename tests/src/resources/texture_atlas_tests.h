@@ -0,0 +1,3 @@
+#pragma once
+
+void texture_atlas_register_tests();
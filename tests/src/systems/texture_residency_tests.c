@@ -0,0 +1,139 @@
+#include "texture_residency_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <systems/texture_residency.h>
+
+// A square RGBA8 texture with a full mip chain.
+static void track_square(texture_residency *residency, u32 size, u32 resident_level, u64 frame)
+{
+    u32 level_count = 1;
+    while ((size >> (level_count - 1)) > 1)
+    {
+        level_count++;
+    }
+    texture_residency_track(residency, TEXTURE_FORMAT_RGBA8, size, size, level_count, resident_level, frame);
+}
+
+u8 texture_residency_should_pick_level_for_size()
+{
+    texture_residency residency = {0};
+    texture_residency_track(&residency, TEXTURE_FORMAT_RGBA8, 512, 256, 10, 0, 0);
+    expect_should_be(0, texture_residency_level_for_size(&residency, 512.0f));
+    // Level 1 is 256 across, not enough for 300 pixels.
+    expect_should_be(0, texture_residency_level_for_size(&residency, 300.0f));
+    expect_should_be(1, texture_residency_level_for_size(&residency, 256.0f));
+    expect_should_be(2, texture_residency_level_for_size(&residency, 100.0f));
+    expect_should_be(9, texture_residency_level_for_size(&residency, 0.5f));
+
+    // Levels from 8 (2x1) down: 8 + 4 bytes.
+    expect_should_be(12, texture_residency_size(&residency, 8));
+    return true;
+}
+
+u8 texture_residency_should_drop_unused_levels()
+{
+    texture_residency residency = {0};
+    track_square(&residency, 1024, 0, 0);
+
+    // Drawn small, but still needs level 0 from when it was loaded until the windows roll over.
+    u32 changes[4];
+    texture_residency_report_usage(&residency, 100.0f, 1);
+    expect_should_be(0, texture_residency_plan(&residency, 1, 0xFFFFFFFF, 1, 4, changes));
+
+    u32 change_count = 0;
+    for (u64 frame = 2; frame <= TEXTURE_RESIDENCY_WINDOW_FRAMES * 2 && change_count == 0; ++frame)
+    {
+        texture_residency_report_usage(&residency, 100.0f, frame);
+        change_count = texture_residency_plan(&residency, 1, 0xFFFFFFFF, frame, 4, changes);
+    }
+    expect_should_be(1, change_count);
+    expect_should_be(0, changes[0]);
+    // 1024 >> 3 = 128, the coarsest level with at least 100 texels.
+    expect_should_be(3, residency.target_level);
+    expect_should_be(0, residency.resident_level);
+
+    // Nothing more is planned while the stream is in flight.
+    expect_should_be(0, texture_residency_plan(&residency, 1, 0xFFFFFFFF, TEXTURE_RESIDENCY_WINDOW_FRAMES * 3, 4, changes));
+    texture_residency_complete(&residency, true);
+    expect_should_be(3, residency.resident_level);
+
+    // Not drawn at all for two windows, it drops to the smallest size kept, 64 texels.
+    change_count = 0;
+    for (u64 frame = TEXTURE_RESIDENCY_WINDOW_FRAMES * 3 + 1; frame <= TEXTURE_RESIDENCY_WINDOW_FRAMES * 6 && change_count == 0; ++frame)
+    {
+        change_count = texture_residency_plan(&residency, 1, 0xFFFFFFFF, frame, 4, changes);
+    }
+    expect_should_be(1, change_count);
+    expect_should_be(4, residency.target_level);
+    return true;
+}
+
+u8 texture_residency_should_evict_least_recently_used()
+{
+    texture_residency records[3] = {0};
+    track_square(&records[0], 256, 0, 0);
+    track_square(&records[1], 256, 0, 0);
+    track_square(&records[2], 256, 0, 0);
+
+    // Room for one texture in full and two without their top level.
+    u64 budget = texture_residency_size(&records[0], 0) + texture_residency_size(&records[1], 1) * 2;
+
+    // 0 is drawn every frame; 2 was drawn more recently than 1.
+    texture_residency_report_usage(&records[2], 256.0f, 1);
+    texture_residency_report_usage(&records[0], 256.0f, 2);
+    u32 changes[4];
+    u32 change_count = texture_residency_plan(records, 3, budget, 2, 4, changes);
+    expect_should_be(2, change_count);
+    expect_should_be(1, changes[0]);
+    expect_should_be(2, changes[1]);
+    expect_should_be(0, records[0].target_level);
+    expect_should_be(1, records[1].target_level);
+    expect_should_be(1, records[2].target_level);
+
+    // A failed stream keeps what was resident.
+    texture_residency_complete(&records[1], false);
+    expect_should_be(0, records[1].target_level);
+    return true;
+}
+
+u8 texture_residency_should_make_room_to_raise()
+{
+    texture_residency records[2] = {0};
+    track_square(&records[0], 256, 2, 0);
+    track_square(&records[1], 256, 0, 0);
+
+    // Only enough for one texture in full.
+    u64 budget = texture_residency_size(&records[0], 0) + texture_residency_size(&records[0], 2);
+
+    // 0 moves up close; 1 isn't drawn, so makes room a level at a time and 0 comes up as far as fits.
+    texture_residency_report_usage(&records[0], 256.0f, 5);
+    u32 changes[4];
+    u32 change_count = texture_residency_plan(records, 2, budget, 5, 4, changes);
+    expect_should_be(2, change_count);
+    expect_should_be(1, changes[0]);
+    expect_should_be(0, changes[1]);
+    expect_should_be(1, records[1].target_level);
+    expect_should_be(1, records[0].target_level);
+    texture_residency_complete(&records[0], true);
+    texture_residency_complete(&records[1], true);
+
+    // Once 1 has dropped again there is room for 0 in full.
+    texture_residency_report_usage(&records[0], 256.0f, 6);
+    change_count = texture_residency_plan(records, 2, budget, 6, 4, changes);
+    expect_should_be(2, change_count);
+    expect_should_be(1, changes[0]);
+    expect_should_be(0, changes[1]);
+    expect_should_be(2, records[1].target_level);
+    expect_should_be(0, records[0].target_level);
+    return true;
+}
+
+void texture_residency_register_tests()
+{
+    test_manager_register_test(texture_residency_should_pick_level_for_size, "Texture residency should pick level for size");
+    test_manager_register_test(texture_residency_should_drop_unused_levels, "Texture residency should drop unused levels");
+    test_manager_register_test(texture_residency_should_evict_least_recently_used, "Texture residency should evict least recently used");
+    test_manager_register_test(texture_residency_should_make_room_to_raise, "Texture residency should make room to raise");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void texture_residency_register_tests();
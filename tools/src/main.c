@@ -0,0 +1,945 @@
+#include <defines.h>
+#include <containers/darray.h>
+#include <containers/id_pool.h>
+#include <core/binary_log.h>
+#include <core/compression.h>
+#include <core/logger.h>
+#include <core/mmemory.h>
+#include <core/mstring.h>
+#include <platform/filesystem.h>
+#include <platform/pack.h>
+#include <platform/platform.h>
+#include <platform/vfs.h>
+#include <renderer/renderer_frontend.h>
+#include <resources/block_compression.h>
+#include <resources/cooked_texture.h>
+#include <resources/image.h>
+#include <resources/resource_types.h>
+#include <systems/material_system.h>
+#include <systems/texture_system.h>
+
+#include <stdio.h>
+
+// The engine's copy of stb_image isn't exported, so the tools build their own.
+#define STB_IMAGE_IMPLEMENTATION
+#include <vendor/stb_image.h>
+
+#if MPLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+typedef b8 (*PFN_tool_command)(i32 argc, char **argv);
+
+typedef struct tool_command
+{
+    const char *name;
+    const char *usage;
+    PFN_tool_command run;
+} tool_command;
+
+static void decodelog_on_entry(log_channel channel, log_level level, f64 timestamp, const char *message, void *user_data)
+{
+    const char *level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
+    if (channel == LOG_CHANNEL_GENERAL)
+    {
+        fprintf((FILE *)user_data, "[%.6f] %s%s\n", timestamp, level_strings[level], message);
+    }
+    else
+    {
+        fprintf((FILE *)user_data, "[%.6f] %s[%s] %s\n", timestamp, level_strings[level], logging_channel_name(channel), message);
+    }
+}
+
+static b8 decodelog(i32 argc, char **argv)
+{
+    if (argc < 1)
+    {
+        return false;
+    }
+
+    file_handle in;
+    if (!filesystem_open(argv[0], FILE_MODE_READ, true, &in))
+    {
+        fprintf(stderr, "Unable to open '%s' for reading.\n", argv[0]);
+        return false;
+    }
+
+    u8 *data = 0;
+    u64 size = 0;
+    b8 read = filesystem_read_all_bytes(&in, &data, &size);
+    filesystem_close(&in);
+    if (!read)
+    {
+        fprintf(stderr, "Unable to read '%s'.\n", argv[0]);
+        if (data)
+        {
+            mfree(data, size, MEMORY_TAG_STRING);
+        }
+        return false;
+    }
+
+    FILE *out = stdout;
+    if (argc > 1)
+    {
+        out = fopen(argv[1], "w");
+        if (!out)
+        {
+            fprintf(stderr, "Unable to open '%s' for writing.\n", argv[1]);
+            mfree(data, size, MEMORY_TAG_STRING);
+            return false;
+        }
+    }
+
+    b8 result = binary_log_decode(data, size, decodelog_on_entry, out);
+    if (!result)
+    {
+        // Everything up to the bad record has still been written out.
+        fprintf(stderr, "'%s' is malformed or truncated.\n", argv[0]);
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    mfree(data, size, MEMORY_TAG_STRING);
+    return result;
+}
+
+#define PACK_MAX_PATH_LENGTH 512
+
+// Recursively collects the paths of all files under directory, relative to the root the walk started at.
+static b8 collect_files(const char *root, const char *relative, char ***files)
+{
+    char directory[PACK_MAX_PATH_LENGTH];
+    if (relative[0])
+    {
+        string_format(directory, "%s/%s", root, relative);
+    }
+    else
+    {
+        string_copy(directory, root);
+    }
+
+#if MPLATFORM_WINDOWS
+    char pattern[PACK_MAX_PATH_LENGTH];
+    string_format(pattern, "%s/*", directory);
+    WIN32_FIND_DATAA find_data;
+    HANDLE find = FindFirstFileA(pattern, &find_data);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "Unable to list directory '%s'.\n", directory);
+        return false;
+    }
+    do
+    {
+        const char *entry_name = find_data.cFileName;
+        b8 is_directory = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+    DIR *dir = opendir(directory);
+    if (!dir)
+    {
+        fprintf(stderr, "Unable to list directory '%s'.\n", directory);
+        return false;
+    }
+    struct dirent *dir_entry;
+    while ((dir_entry = readdir(dir)))
+    {
+        const char *entry_name = dir_entry->d_name;
+        char full_path[PACK_MAX_PATH_LENGTH];
+        string_format(full_path, "%s/%s", directory, entry_name);
+        struct stat info;
+        if (stat(full_path, &info) != 0)
+        {
+            continue;
+        }
+        b8 is_directory = S_ISDIR(info.st_mode);
+#endif
+        if (strings_equal(entry_name, ".") || strings_equal(entry_name, ".."))
+        {
+            continue;
+        }
+
+        char entry_path[PACK_MAX_PATH_LENGTH];
+        if (string_length(relative) + string_length(entry_name) + 2 >= PACK_MAX_PATH_LENGTH)
+        {
+            fprintf(stderr, "Path too long, skipping: '%s/%s'.\n", relative, entry_name);
+            continue;
+        }
+        if (relative[0])
+        {
+            string_format(entry_path, "%s/%s", relative, entry_name);
+        }
+        else
+        {
+            string_copy(entry_path, entry_name);
+        }
+
+        if (is_directory)
+        {
+            if (!collect_files(root, entry_path, files))
+            {
+#if MPLATFORM_WINDOWS
+                FindClose(find);
+#else
+                closedir(dir);
+#endif
+                return false;
+            }
+        }
+        else
+        {
+            char *name = string_duplicate(entry_path);
+            darray_push(*files, name);
+        }
+#if MPLATFORM_WINDOWS
+    } while (FindNextFileA(find, &find_data));
+    FindClose(find);
+#else
+    }
+    closedir(dir);
+#endif
+    return true;
+}
+
+static b8 write_padding(FILE *out, u64 *offset, u64 alignment)
+{
+    static const u8 zeroes[PACK_ALIGNMENT] = {0};
+    u64 padding = (alignment - (*offset % alignment)) % alignment;
+    if (padding && fwrite(zeroes, 1, padding, out) != padding)
+    {
+        return false;
+    }
+    *offset += padding;
+    return true;
+}
+
+// Writes one file's data, compressed if that saves enough to be worth decompressing at load.
+static b8 pack_write_entry(FILE *out, u64 *offset, const char *path, b8 compress, pack_entry *entry)
+{
+    file_mapping mapping;
+    if (!filesystem_map(path, FILE_ACCESS_SEQUENTIAL, &mapping))
+    {
+        return false;
+    }
+
+    const void *data = mapping.data;
+    u64 size = mapping.size;
+    entry->uncompressed_size = mapping.size;
+    entry->flags = PACK_ENTRY_FLAG_NONE;
+
+    u8 *compressed = 0;
+    u64 bound = compression_bound(mapping.size);
+    if (compress && mapping.size > 0)
+    {
+        compressed = mallocate(bound, MEMORY_TAG_RESOURCE);
+        u64 compressed_size = compression_compress(mapping.data, mapping.size, compressed, bound);
+        // Already compressed formats, i.e. png, rarely shrink; keep those stored as-is.
+        if (compressed_size && compressed_size < mapping.size - mapping.size / 16)
+        {
+            data = compressed;
+            size = compressed_size;
+            entry->flags = PACK_ENTRY_FLAG_COMPRESSED;
+        }
+    }
+
+    b8 result = write_padding(out, offset, PACK_ALIGNMENT);
+    entry->offset = *offset;
+    entry->size = size;
+    if (result && size && fwrite(data, 1, size, out) != size)
+    {
+        result = false;
+    }
+    *offset += size;
+
+    if (compressed)
+    {
+        mfree(compressed, bound, MEMORY_TAG_RESOURCE);
+    }
+    filesystem_unmap(&mapping);
+    return result;
+}
+
+// Adds an entry to a pack directory with linear probing, the same way pack_find looks up. Fails if
+// another entry has the same hash.
+static b8 pack_insert_entry(pack_entry *slots, u32 slot_count, const pack_entry *entry)
+{
+    u32 mask = slot_count - 1;
+    u32 slot = entry->hash & mask;
+    while (slots[slot].hash != 0)
+    {
+        if (slots[slot].hash == entry->hash)
+        {
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = *entry;
+    return true;
+}
+
+static b8 pack(i32 argc, char **argv)
+{
+    if (argc < 2)
+    {
+        return false;
+    }
+    const char *input_directory = argv[0];
+    const char *output_path = argv[1];
+    b8 compress = argc > 2 && strings_equal(argv[2], "-c");
+
+    char **files = darray_create(char *);
+    if (!collect_files(input_directory, "", &files))
+    {
+        return false;
+    }
+    u32 file_count = (u32)darray_length(files);
+
+    FILE *out = fopen(output_path, "wb");
+    if (!out)
+    {
+        fprintf(stderr, "Unable to open '%s' for writing.\n", output_path);
+        return false;
+    }
+
+    pack_header header = {0};
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.entry_count = file_count;
+    header.slot_count = pack_slot_count(file_count);
+
+    u64 slots_size = sizeof(pack_entry) * header.slot_count;
+    pack_entry *slots = mallocate(slots_size, MEMORY_TAG_RESOURCE);
+    u64 names_size = 0;
+
+    // The header is rewritten once the offsets are known.
+    b8 result = fwrite(&header, sizeof(pack_header), 1, out) == 1;
+    u64 offset = sizeof(pack_header);
+    u64 stored_total = 0;
+    u64 uncompressed_total = 0;
+    for (u32 i = 0; result && i < file_count; ++i)
+    {
+        pack_entry entry = {0};
+        entry.hash = pack_hash_name(files[i]);
+        entry.name_offset = (u32)names_size;
+        names_size += string_length(files[i]) + 1;
+
+        char path[PACK_MAX_PATH_LENGTH];
+        string_format(path, "%s/%s", input_directory, files[i]);
+        if (!pack_write_entry(out, &offset, path, compress, &entry))
+        {
+            fprintf(stderr, "Unable to pack '%s'.\n", path);
+            result = false;
+            break;
+        }
+        stored_total += entry.size;
+        uncompressed_total += entry.uncompressed_size;
+
+        if (!pack_insert_entry(slots, header.slot_count, &entry))
+        {
+            // Names are case-insensitive, so i.e. "a.png" and "A.png" would collide.
+            fprintf(stderr, "'%s' clashes with another entry.\n", files[i]);
+            result = false;
+        }
+    }
+
+    if (result)
+    {
+        result = write_padding(out, &offset, PACK_ALIGNMENT);
+        header.directory_offset = offset;
+        result = result && fwrite(slots, 1, slots_size, out) == slots_size;
+        offset += slots_size;
+
+        header.names_offset = offset;
+        header.names_size = names_size;
+        for (u32 i = 0; result && i < file_count; ++i)
+        {
+            u64 length = string_length(files[i]) + 1;
+            result = fwrite(files[i], 1, length, out) == length;
+        }
+
+        result = result && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(pack_header), 1, out) == 1;
+    }
+
+    fclose(out);
+    if (result)
+    {
+        printf("Packed %u files into '%s': %llu bytes stored, %llu uncompressed.\n",
+               file_count, output_path, stored_total, uncompressed_total);
+    }
+    else
+    {
+        fprintf(stderr, "Failed to write '%s'.\n", output_path);
+        remove(output_path);
+    }
+
+    mfree(slots, slots_size, MEMORY_TAG_RESOURCE);
+    for (u32 i = 0; i < file_count; ++i)
+    {
+        mfree(files[i], string_length(files[i]) + 1, MEMORY_TAG_STRING);
+    }
+    darray_destroy(files);
+    return result;
+}
+
+// Creates each missing directory along a file's path.
+static void make_parent_directories(const char *path)
+{
+    char directory[PACK_MAX_PATH_LENGTH];
+    string_ncopy(directory, path, PACK_MAX_PATH_LENGTH - 1);
+    directory[PACK_MAX_PATH_LENGTH - 1] = 0;
+    for (char *c = directory + 1; *c; ++c)
+    {
+        if (*c != '/' && *c != '\\')
+        {
+            continue;
+        }
+        char separator = *c;
+        *c = 0;
+#if MPLATFORM_WINDOWS
+        CreateDirectoryA(directory, 0);
+#else
+        mkdir(directory, 0755);
+#endif
+        *c = separator;
+    }
+}
+
+// Converts an image to a cooked texture with a full mip chain. TEXTURE_FORMAT_MAX picks a format from
+// the image: BC3 if it has transparency, otherwise BC1.
+static b8 cook_texture(const char *input_path, const char *output_path, texture_format format)
+{
+    // Flipped the same way the texture system flips images it decodes.
+    stbi_set_flip_vertically_on_load(true);
+    i32 width;
+    i32 height;
+    i32 channel_count;
+    u8 *pixels = stbi_load(input_path, &width, &height, &channel_count, 4);
+    if (!pixels)
+    {
+        fprintf(stderr, "Unable to load '%s': %s\n", input_path, stbi_failure_reason());
+        return false;
+    }
+
+    u64 pixel_count = (u64)width * height;
+    b8 has_transparency = image_has_transparency_rgba8(pixels, pixel_count);
+    if (format == TEXTURE_FORMAT_MAX)
+    {
+        format = has_transparency ? TEXTURE_FORMAT_BC3 : TEXTURE_FORMAT_BC1;
+    }
+
+    cooked_texture_header header = {0};
+    header.magic = COOKED_TEXTURE_MAGIC;
+    header.version = COOKED_TEXTURE_VERSION;
+    header.format = format;
+    header.width = (u32)width;
+    header.height = (u32)height;
+    header.level_count = texture_mip_count(header.width, header.height);
+    header.flags = has_transparency ? COOKED_TEXTURE_FLAG_TRANSPARENCY : COOKED_TEXTURE_FLAG_NONE;
+
+    make_parent_directories(output_path);
+    FILE *out = fopen(output_path, "wb");
+    b8 result = out && fwrite(&header, sizeof(cooked_texture_header), 1, out) == 1;
+
+    // Each level is filtered from the uncompressed level above it, not from compressed data.
+    u64 rgba_size = pixel_count * 4;
+    u8 *level_pixels = mallocate(rgba_size, MEMORY_TAG_TEXTURE);
+    u8 *next_pixels = mallocate(rgba_size, MEMORY_TAG_TEXTURE);
+    u8 *compressed = mallocate(texture_format_size(format, header.width, header.height), MEMORY_TAG_TEXTURE);
+    mcopy_memory(level_pixels, pixels, rgba_size);
+    u64 total_size = 0;
+    for (u32 level = 0; result && level < header.level_count; ++level)
+    {
+        u32 level_width = header.width >> level ? header.width >> level : 1;
+        u32 level_height = header.height >> level ? header.height >> level : 1;
+        u64 level_size = texture_format_size(format, level_width, level_height);
+        const u8 *level_data = level_pixels;
+        if (texture_format_is_compressed(format))
+        {
+            block_compress_image(level_pixels, level_width, level_height, format, compressed);
+            level_data = compressed;
+        }
+        result = fwrite(level_data, 1, level_size, out) == level_size;
+        total_size += level_size;
+
+        image_downsample_rgba8(level_pixels, level_width, level_height, next_pixels);
+        u8 *temp = level_pixels;
+        level_pixels = next_pixels;
+        next_pixels = temp;
+    }
+
+    if (out)
+    {
+        fclose(out);
+    }
+    if (result)
+    {
+        const char *format_names[TEXTURE_FORMAT_MAX] = {"rgba", "bc1", "bc3", "bc7"};
+        printf("Cooked '%s' (%ux%u, %s, %u levels): %llu bytes, from %llu as RGBA.\n", output_path, header.width,
+               header.height, format_names[format], header.level_count, total_size, rgba_size);
+    }
+    else
+    {
+        fprintf(stderr, "Failed to write '%s'.\n", output_path);
+        remove(output_path);
+    }
+
+    mfree(compressed, texture_format_size(format, header.width, header.height), MEMORY_TAG_TEXTURE);
+    mfree(next_pixels, rgba_size, MEMORY_TAG_TEXTURE);
+    mfree(level_pixels, rgba_size, MEMORY_TAG_TEXTURE);
+    stbi_image_free(pixels);
+    return result;
+}
+
+static b8 ends_with(const char *str, const char *suffix)
+{
+    u64 length = string_length(str);
+    u64 suffix_length = string_length(suffix);
+    return length >= suffix_length && strings_equali(str + length - suffix_length, suffix);
+}
+
+// Cooks one image, or every png under a directory into the same layout under the output directory.
+static b8 cooktex(i32 argc, char **argv)
+{
+    if (argc < 2)
+    {
+        return false;
+    }
+    const char *input_path = argv[0];
+    const char *output_path = argv[1];
+
+    texture_format format = TEXTURE_FORMAT_MAX;
+    if (argc > 2)
+    {
+        if (strings_equali(argv[2], "bc1"))
+        {
+            format = TEXTURE_FORMAT_BC1;
+        }
+        else if (strings_equali(argv[2], "bc3"))
+        {
+            format = TEXTURE_FORMAT_BC3;
+        }
+        else if (strings_equali(argv[2], "rgba"))
+        {
+            format = TEXTURE_FORMAT_RGBA8;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown format '%s'. BC7 isn't encoded by the cooker.\n", argv[2]);
+            return false;
+        }
+    }
+
+    if (!ends_with(input_path, ".png"))
+    {
+        char **files = darray_create(char *);
+        if (!collect_files(input_path, "", &files))
+        {
+            return false;
+        }
+
+        b8 result = true;
+        u32 file_count = (u32)darray_length(files);
+        for (u32 i = 0; i < file_count; ++i)
+        {
+            if (result && ends_with(files[i], ".png"))
+            {
+                char source[PACK_MAX_PATH_LENGTH];
+                char destination[PACK_MAX_PATH_LENGTH];
+                string_format(source, "%s/%s", input_path, files[i]);
+                // Swap "png" for "mtex".
+                string_format(destination, "%s/%.*s.mtex", output_path, (i32)(string_length(files[i]) - 4), files[i]);
+                result = cook_texture(source, destination, format);
+            }
+            mfree(files[i], string_length(files[i]) + 1, MEMORY_TAG_STRING);
+        }
+        darray_destroy(files);
+        return result;
+    }
+
+    return cook_texture(input_path, output_path, format);
+}
+
+// Writes a pack of count 1x1 cooked textures and count materials, named benchslots_<i>, for
+// benchslots to load. Every texture shares the same data.
+static b8 benchslots_write_pack(const char *path, u32 count)
+{
+    FILE *out = fopen(path, "wb");
+    if (!out)
+    {
+        fprintf(stderr, "Unable to open '%s' for writing.\n", path);
+        return false;
+    }
+
+    pack_header header = {0};
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.entry_count = count * 2;
+    header.slot_count = pack_slot_count(header.entry_count);
+    u64 slots_size = sizeof(pack_entry) * header.slot_count;
+    pack_entry *slots = mallocate(slots_size, MEMORY_TAG_RESOURCE);
+    char **names = mallocate(sizeof(char *) * header.entry_count, MEMORY_TAG_STRING);
+
+    // The header is rewritten once the offsets are known.
+    u64 offset = sizeof(pack_header);
+    b8 result = fwrite(&header, sizeof(pack_header), 1, out) == 1 && write_padding(out, &offset, PACK_ALIGNMENT);
+
+    struct
+    {
+        cooked_texture_header header;
+        u8 pixel[4];
+    } texture_data = {0};
+    texture_data.header.magic = COOKED_TEXTURE_MAGIC;
+    texture_data.header.version = COOKED_TEXTURE_VERSION;
+    texture_data.header.format = TEXTURE_FORMAT_RGBA8;
+    texture_data.header.width = 1;
+    texture_data.header.height = 1;
+    texture_data.header.level_count = 1;
+    mset_memory(texture_data.pixel, 255, sizeof(texture_data.pixel));
+    u64 texture_offset = offset;
+    result = result && fwrite(&texture_data, sizeof(texture_data), 1, out) == 1;
+    offset += sizeof(texture_data);
+
+    u64 names_size = 0;
+    for (u32 i = 0; result && i < header.entry_count; ++i)
+    {
+        char name[PACK_MAX_PATH_LENGTH];
+        pack_entry entry = {0};
+        if (i < count)
+        {
+            string_format(name, "textures/benchslots_%u.mtex", i);
+            entry.offset = texture_offset;
+            entry.size = sizeof(texture_data);
+        }
+        else
+        {
+            char material[64];
+            string_format(material, "name=benchslots_%u\n", i - count);
+            string_format(name, "materials/benchslots_%u.mmt", i - count);
+            result = write_padding(out, &offset, PACK_ALIGNMENT);
+            entry.offset = offset;
+            entry.size = string_length(material);
+            result = result && fwrite(material, 1, entry.size, out) == entry.size;
+            offset += entry.size;
+        }
+        entry.uncompressed_size = entry.size;
+        entry.hash = pack_hash_name(name);
+        entry.name_offset = (u32)names_size;
+        names[i] = string_duplicate(name);
+        names_size += string_length(name) + 1;
+        result = result && pack_insert_entry(slots, header.slot_count, &entry);
+    }
+
+    if (result)
+    {
+        result = write_padding(out, &offset, PACK_ALIGNMENT);
+        header.directory_offset = offset;
+        result = result && fwrite(slots, 1, slots_size, out) == slots_size;
+        offset += slots_size;
+
+        header.names_offset = offset;
+        header.names_size = names_size;
+        for (u32 i = 0; result && i < header.entry_count; ++i)
+        {
+            u64 length = string_length(names[i]) + 1;
+            result = fwrite(names[i], 1, length, out) == length;
+        }
+
+        result = result && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(pack_header), 1, out) == 1;
+    }
+    fclose(out);
+    if (!result)
+    {
+        fprintf(stderr, "Failed to write '%s'.\n", path);
+        remove(path);
+    }
+
+    for (u32 i = 0; i < header.entry_count; ++i)
+    {
+        if (names[i])
+        {
+            mfree(names[i], string_length(names[i]) + 1, MEMORY_TAG_STRING);
+        }
+    }
+    mfree(names, sizeof(char *) * header.entry_count, MEMORY_TAG_STRING);
+    mfree(slots, slots_size, MEMORY_TAG_RESOURCE);
+    return result;
+}
+
+typedef struct benchslots_times
+{
+    f64 texture_acquire;
+    f64 texture_release;
+    f64 material_acquire;
+    f64 material_release;
+    // Names which hash to the same table entry share a resource, so fewer than count are loaded.
+    u32 texture_count;
+    u32 material_count;
+} benchslots_times;
+
+// Loads then releases every texture and material in the pack through the texture and material
+// systems, timing each pass.
+static void benchslots_run(u32 count, b8 scan, benchslots_times *out_times)
+{
+    texture_system_set_slot_scan_enabled(scan);
+    material_system_set_slot_scan_enabled(scan);
+
+    // Four times as many slots as names, to keep down how many share a hashtable entry.
+    texture_system_config texture_config = {0};
+    texture_config.max_texture_count = count * 4;
+    u64 texture_memory_size = 0;
+    texture_system_initialise(&texture_memory_size, 0, texture_config);
+    void *texture_memory = mallocate(texture_memory_size, MEMORY_TAG_APPLICATION);
+    texture_system_initialise(&texture_memory_size, texture_memory, texture_config);
+
+    material_system_config material_config = {count * 4};
+    u64 material_memory_size = 0;
+    material_system_initialise(&material_memory_size, 0, material_config);
+    void *material_memory = mallocate(material_memory_size, MEMORY_TAG_APPLICATION);
+    material_system_initialise(&material_memory_size, material_memory, material_config);
+
+    u64 loaded_size = sizeof(b8) * count * 4;
+    b8 *loaded = mallocate(loaded_size, MEMORY_TAG_APPLICATION);
+    char name[TEXTURE_NAME_MAX_LENGTH];
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < count; ++i)
+    {
+        string_format(name, "benchslots_%u", i);
+        texture *t = texture_system_acquire(name, true);
+        if (t && !loaded[t->id])
+        {
+            loaded[t->id] = true;
+            out_times->texture_count++;
+        }
+    }
+    out_times->texture_acquire = platform_get_absolute_time() - start;
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < count; ++i)
+    {
+        string_format(name, "benchslots_%u", i);
+        texture_system_release(name);
+    }
+    out_times->texture_release = platform_get_absolute_time() - start;
+
+    mzero_memory(loaded, loaded_size);
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < count; ++i)
+    {
+        string_format(name, "benchslots_%u", i);
+        material *m = material_system_acquire(name);
+        if (m && !loaded[m->id])
+        {
+            loaded[m->id] = true;
+            out_times->material_count++;
+        }
+    }
+    out_times->material_acquire = platform_get_absolute_time() - start;
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < count; ++i)
+    {
+        string_format(name, "benchslots_%u", i);
+        material_system_release(name);
+    }
+    out_times->material_release = platform_get_absolute_time() - start;
+
+    mfree(loaded, loaded_size, MEMORY_TAG_APPLICATION);
+    material_system_shutdown(material_memory);
+    mfree(material_memory, material_memory_size, MEMORY_TAG_APPLICATION);
+    texture_system_shutdown(texture_memory);
+    mfree(texture_memory, texture_memory_size, MEMORY_TAG_APPLICATION);
+    texture_system_set_slot_scan_enabled(false);
+    material_system_set_slot_scan_enabled(false);
+}
+
+static void benchslots_print(const char *name, f64 scan_time, f64 pool_time, u32 count)
+{
+    printf("  %-17s scan %10.3fms (%8.1fns each), free list %10.3fms (%8.1fns each)\n", name, scan_time * 1000.0,
+           scan_time * 1e9 / count, pool_time * 1000.0, pool_time * 1e9 / count);
+}
+
+// Times acquiring and releasing count textures and materials through their systems, on the null
+// renderer, finding free slots by scanning as before and with the free list.
+static b8 benchslots(i32 argc, char **argv)
+{
+    u32 count = 50000;
+    if (argc > 0 && (!string_to_u32(argv[0], &count) || count == 0))
+    {
+        return false;
+    }
+
+    const char *pack_path = "benchslots.mpk";
+    if (!benchslots_write_pack(pack_path, count))
+    {
+        return false;
+    }
+
+    // Keep the per resource logging out of the timings.
+    logging_set_channel_level(LOG_CHANNEL_TEXTURE, LOG_LEVEL_WARN);
+    logging_set_channel_level(LOG_CHANNEL_MATERIAL, LOG_LEVEL_WARN);
+    logging_set_channel_level(LOG_CHANNEL_RENDERER, LOG_LEVEL_WARN);
+
+    vfs_config vfs_sys_config = {pack_path, "."};
+    u64 vfs_memory_size = 0;
+    vfs_initialise(&vfs_memory_size, 0, vfs_sys_config);
+    void *vfs_memory = mallocate(vfs_memory_size, MEMORY_TAG_APPLICATION);
+    vfs_initialise(&vfs_memory_size, vfs_memory, vfs_sys_config);
+
+    u64 renderer_memory_size = 0;
+    renderer_system_initialise(&renderer_memory_size, 0, 0, RENDERER_BACKEND_TYPE_NULL);
+    void *renderer_memory = mallocate(renderer_memory_size, MEMORY_TAG_APPLICATION);
+    b8 result = renderer_system_initialise(&renderer_memory_size, renderer_memory, "benchslots", RENDERER_BACKEND_TYPE_NULL);
+    if (result)
+    {
+        benchslots_times scan = {0};
+        benchslots_times pool = {0};
+        benchslots_run(count, true, &scan);
+        benchslots_run(count, false, &pool);
+
+        printf("Acquired and released %u textures and %u materials (%u names each).\n", pool.texture_count, pool.material_count, count);
+        benchslots_print("texture acquire:", scan.texture_acquire, pool.texture_acquire, count);
+        benchslots_print("texture release:", scan.texture_release, pool.texture_release, count);
+        benchslots_print("material acquire:", scan.material_acquire, pool.material_acquire, count);
+        benchslots_print("material release:", scan.material_release, pool.material_release, count);
+    }
+
+    renderer_system_shutdown(renderer_memory);
+    mfree(renderer_memory, renderer_memory_size, MEMORY_TAG_APPLICATION);
+    vfs_shutdown(vfs_memory);
+    mfree(vfs_memory, vfs_memory_size, MEMORY_TAG_APPLICATION);
+    filesystem_delete(pack_path);
+    return result;
+}
+
+typedef void (*PFN_benchimage_op)(u8 *pixels, u64 pixel_count);
+
+static void benchimage_scan(u8 *pixels, u64 pixel_count)
+{
+    image_has_transparency_rgba8(pixels, pixel_count);
+}
+
+static void benchimage_premultiply(u8 *pixels, u64 pixel_count)
+{
+    image_premultiply_alpha_rgba8(pixels, pixel_count);
+}
+
+static void benchimage_swizzle(u8 *pixels, u64 pixel_count)
+{
+    const u8 bgra[4] = {2, 1, 0, 3};
+    image_swizzle_rgba8(pixels, pixel_count, bgra);
+}
+
+static void benchimage_srgb(u8 *pixels, u64 pixel_count)
+{
+    image_srgb_to_linear_rgba8(pixels, pixel_count);
+}
+
+// Times op over an image, restoring the pixels before each run so every run does the same work.
+static f64 benchimage_time(PFN_benchimage_op op, u8 *pixels, const u8 *source, u64 pixel_count, u32 runs)
+{
+    f64 total = 0.0;
+    for (u32 i = 0; i < runs; ++i)
+    {
+        mcopy_memory(pixels, source, pixel_count * 4);
+        f64 start = platform_get_absolute_time();
+        op(pixels, pixel_count);
+        total += platform_get_absolute_time() - start;
+    }
+    return total / runs;
+}
+
+// Times the image operations on an opaque synthetic image, with the scalar code and with SIMD.
+static b8 benchimage(i32 argc, char **argv)
+{
+    u32 width = 4096;
+    u32 height = 4096;
+    if ((argc > 0 && (!string_to_u32(argv[0], &width) || width == 0)) ||
+        (argc > 1 && (!string_to_u32(argv[1], &height) || height == 0)))
+    {
+        return false;
+    }
+
+    u64 pixel_count = (u64)width * height;
+    u8 *source = mallocate(pixel_count * 4, MEMORY_TAG_TEXTURE);
+    u8 *pixels = mallocate(pixel_count * 4, MEMORY_TAG_TEXTURE);
+    for (u64 i = 0; i < pixel_count; ++i)
+    {
+        source[i * 4 + 0] = (u8)i;
+        source[i * 4 + 1] = (u8)(i >> 8);
+        source[i * 4 + 2] = (u8)(i >> 16);
+        // Opaque, so the scan has to look at every pixel.
+        source[i * 4 + 3] = 255;
+    }
+
+    struct
+    {
+        const char *name;
+        PFN_benchimage_op op;
+    } ops[] = {
+        {"alpha scan", benchimage_scan},
+        {"premultiply", benchimage_premultiply},
+        {"swizzle", benchimage_swizzle},
+        {"sRGB to linear", benchimage_srgb},
+    };
+    const u32 runs = 10;
+
+    printf("%ux%u image, average of %u runs%s.\n", width, height, runs, image_simd_supported() ? "" : " (no SIMD on this target)");
+    for (u32 i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i)
+    {
+        image_set_simd_enabled(false);
+        f64 scalar_time = benchimage_time(ops[i].op, pixels, source, pixel_count, runs);
+        image_set_simd_enabled(true);
+        f64 simd_time = benchimage_time(ops[i].op, pixels, source, pixel_count, runs);
+        printf("  %-15s scalar %8.3fms, SIMD %8.3fms (%.1fx)\n", ops[i].name, scalar_time * 1000.0, simd_time * 1000.0,
+               simd_time > 0.0 ? scalar_time / simd_time : 0.0);
+    }
+
+    mfree(pixels, pixel_count * 4, MEMORY_TAG_TEXTURE);
+    mfree(source, pixel_count * 4, MEMORY_TAG_TEXTURE);
+    return true;
+}
+
+static tool_command commands[] = {
+    {"decodelog", "decodelog <input.mlog> [output.log]", decodelog},
+    {"pack", "pack <input directory> <output.mpk> [-c]", pack},
+    {"cooktex", "cooktex <input.png|input directory> <output.mtex|output directory> [bc1|bc3|rgba]", cooktex},
+    {"benchslots", "benchslots [count]", benchslots},
+    {"benchimage", "benchimage [width] [height]", benchimage},
+};
+
+static void print_usage()
+{
+    printf("Usage: tools <command> [arguments]\nCommands:\n");
+    for (u32 i = 0; i < sizeof(commands) / sizeof(tool_command); ++i)
+    {
+        printf("  %s\n", commands[i].usage);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return 1;
+    }
+
+    for (u32 i = 0; i < sizeof(commands) / sizeof(tool_command); ++i)
+    {
+        if (strings_equal(argv[1], commands[i].name))
+        {
+            if (!commands[i].run(argc - 2, argv + 2))
+            {
+                return 1;
+            }
+            return 0;
+        }
+    }
+
+    print_usage();
+    return 1;
+}